@@ -20,13 +20,18 @@ class WsGatewayModule : public IM::Module {
                            const Json::Value& payload = Json::Value(),
                            const std::string& ackid = "");
 
+    // 推送事件给群内在本节点在线的全部成员（成员取自 GroupMembership 缓存）
+    static void PushToGroup(uint64_t group_id, const std::string& event,
+                            const Json::Value& payload = Json::Value());
+
     // 主动推送一条 IM 消息事件
-    // talk_mode: 1=单聊 2=群聊（当前实现重点覆盖单聊）
+    // talk_mode: 1=单聊 2=群聊（群聊推送给本节点在线的群成员）
     // to_from_id: 单聊=对端用户ID，群聊=群ID
     // from_id: 发送者用户ID
-    // body: 与 REST 返回一致的消息体（msg_id/sequence/msg_type/.../extra/quote）
+    // body: 消息信封，即与 REST 返回一致的消息体 JSON（msg_id/sequence/msg_type/.../extra/quote），
+    //       原样嵌入下行帧，所有接收连接共用同一次编码
     static void PushImMessage(uint8_t talk_mode, uint64_t to_from_id, uint64_t from_id,
-                              const Json::Value& body);
+                              const std::string& body);
 };
 
 }  // namespace IM::api
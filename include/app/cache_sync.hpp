@@ -0,0 +1,57 @@
+#ifndef __IM_APP_CACHE_SYNC_HPP__
+#define __IM_APP_CACHE_SYNC_HPP__
+
+#include <atomic>
+#include <functional>
+#include <string>
+
+#include "io/thread.hpp"
+
+namespace IM::app {
+
+// 本地缓存的跨节点失效通道：写入提交后向 Redis 频道发布失效键，
+// 各节点订阅该频道并使本地缓存中对应的条目失效。
+// 说明：
+// - redis 为 redis.config 中的实例名，为空时不启用，其它节点只能依赖各缓存的 ttl 收敛；
+// - 订阅使用独立连接和线程（pub/sub 连接不能放回连接池）；
+// - 消息格式为 "<节点令牌>:<失效键>"，忽略本节点发出的消息（本节点已在提交后修补缓存）；
+// - pub/sub 不保证送达：订阅建立或断线重连后调用 on_reset 清空全部缓存，
+//   发布失败时依赖 ttl 兜底。
+class CacheSync {
+   public:
+    // 处理一条失效键，返回是否为合法消息
+    typedef std::function<bool(const std::string& key)> MessageHandler;
+
+    CacheSync(const std::string& name, const std::string& redis, const std::string& channel,
+              MessageHandler on_message, std::function<void()> on_reset);
+    ~CacheSync();
+
+    bool isEnabled() const { return !m_redis.empty(); }
+
+    // 启动订阅线程（未启用或已启动时为空操作）
+    void start();
+    // 停止订阅线程
+    void stop();
+
+    // 通知其它节点 key 对应的缓存已失效
+    void publish(const std::string& key);
+
+   private:
+    void run();
+    bool onMessage(const std::string& msg);
+
+   private:
+    std::string m_name;     // 日志与线程名
+    std::string m_redis;    // redis.config 中的实例名
+    std::string m_channel;  // 频道名
+    std::string m_token;    // 本节点令牌
+    MessageHandler m_onMessage;
+    std::function<void()> m_onReset;
+    Thread::ptr m_thread;
+    std::atomic<bool> m_started{false};
+    std::atomic<bool> m_stopping{false};
+};
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_CACHE_SYNC_HPP__
@@ -0,0 +1,120 @@
+#ifndef __IM_APP_GROUP_MEMBERSHIP_HPP__
+#define __IM_APP_GROUP_MEMBERSHIP_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "app/result.hpp"
+#include "base/singleton.hpp"
+#include "dao/group_dao.hpp"
+#include "ds/roaring_bitmap.hpp"
+#include "io/lock.hpp"
+
+namespace IM::app {
+
+// 群成员关系缓存：每个群的成员、管理员（含群主）、单独禁言成员各用一个 RoaringBitmap 表示，
+// 群消息扇出与发言权限校验直接在内存中做集合运算，不再每条消息查询 im_talk_session。
+// 说明：
+// - 首次访问时从 im_group/im_group_member 装载，按群做 LRU，并按 ttl 过期重载；
+// - 本节点的入群/退群/角色/禁言变更在数据库提交后调用 on* 系列方法修补缓存，
+//   其它节点的变更经 GroupMembershipSync 调用 invalidate，ttl 只作为通知丢失时的兜底；
+// - 缓存只用于发言校验与消息扇出，群管理操作的权限校验读数据库；
+//   装载期间发生的变更会使本次装载结果不入缓存，避免装入过期数据；
+// - 禁言到期时间保存在 mute_until 中，到期后在下一次访问时从 muted 中移除；
+// - 用户ID超出 uint32 范围的群无法用位图表示，装载返回失败，调用方应回退到数据库查询。
+class GroupMembership {
+   public:
+    enum Role { kRoleNone = 0, kRoleMember = 1, kRoleAdmin = 2, kRoleLeader = 3 };
+
+    // 装载群状态与成员；群不存在时返回 true 且 state.id 为 0
+    typedef std::function<bool(const uint64_t group_id, IM::dao::GroupState& state,
+                               std::vector<IM::dao::GroupMemberItem>& members, std::string* err)>
+        Loader;
+
+    struct Options {
+        size_t max_groups = 100000;  // 单节点缓存的群数上限
+        uint32_t ttl = 10;           // 缓存有效期（秒，0 表示不过期）
+    };
+
+    // 按 group.membership.* 配置构造，从数据库装载
+    GroupMembership();
+    GroupMembership(const Options& opts, Loader loader);
+
+    // 成员角色；不是成员（或群不存在/已解散）时 role 为 kRoleNone。装载失败返回 false
+    bool getRole(const uint64_t group_id, const uint64_t user_id, uint8_t& role,
+                 std::string* err = nullptr);
+    // 发言权限：成员、未被单独禁言、全员禁言时仅管理员与群主可发言
+    VoidResult checkSpeak(const uint64_t group_id, const uint64_t user_id);
+
+    // 全部成员
+    bool getMembers(const uint64_t group_id, IM::ds::RoaringBitmap& out,
+                    std::string* err = nullptr);
+    // 当前可发言的成员：成员 - 禁言；全员禁言时为管理员与群主
+    bool getSpeakers(const uint64_t group_id, IM::ds::RoaringBitmap& out,
+                     std::string* err = nullptr);
+
+    // 成员变更（群未缓存时忽略）
+    void onJoin(const uint64_t group_id, const std::vector<uint64_t>& user_ids,
+                const uint8_t role = kRoleMember);
+    void onLeave(const uint64_t group_id, const std::vector<uint64_t>& user_ids);
+    void onRole(const uint64_t group_id, const uint64_t user_id, const uint8_t role);
+    // until 为禁言到期时间（秒），0 表示解除禁言
+    void onNoSpeak(const uint64_t group_id, const uint64_t user_id, const std::time_t until);
+    void onMute(const uint64_t group_id, const bool all_mute);
+    // 使群缓存失效（其它节点上的变更、解散、转让等整体变更）
+    void invalidate(const uint64_t group_id);
+    // 清空全部缓存（跨节点失效通知可能丢失时使用）
+    void invalidateAll();
+
+    size_t getGroupCount();
+
+   private:
+    struct Group {
+        IM::ds::RoaringBitmap members;
+        IM::ds::RoaringBitmap admins;  // 管理员与群主
+        IM::ds::RoaringBitmap muted;   // 单独禁言中的成员
+        std::unordered_map<uint32_t, std::time_t> mute_until;
+        std::time_t next_unmute = 0;   // muted 中最早的到期时间（0 表示无禁言）
+        uint64_t leader_id = 0;
+        bool exists = false;           // 群存在且未解散
+        bool all_mute = false;
+        uint64_t loaded_at = 0;        // 装载时间（秒）
+        std::list<uint64_t>::iterator lru;
+    };
+
+    struct Shard {
+        Mutex mutex;
+        std::unordered_map<uint64_t, Group> groups;
+        std::list<uint64_t> lru;                       // front 为最近访问
+        std::unordered_map<uint64_t, uint64_t> loading;  // group_id -> 装载令牌（0 表示已作废）
+    };
+
+    Shard& getShard(const uint64_t group_id) { return m_shards[group_id % kShardCount]; }
+    // 取得（必要时装载）群并在分片锁内执行 cb；装载失败返回 false
+    bool with(const uint64_t group_id, const std::function<void(Group&)>& cb, std::string* err);
+    bool build(const uint64_t group_id, Group& out, std::string* err);
+    // 变更前调用：作废进行中的装载，返回已缓存的群（未缓存返回 nullptr）
+    Group* prepareUpdate(Shard& shard, const uint64_t group_id);
+    void expireMutes(Group& group, const std::time_t now);
+    void erase(Shard& shard, const uint64_t group_id);
+
+   private:
+    static constexpr size_t kShardCount = 16;
+    Shard m_shards[kShardCount];
+    size_t m_maxShardGroups;
+    uint32_t m_ttl;
+    Loader m_loader;
+    std::atomic<uint64_t> m_tokenSeq{0};
+};
+
+typedef Singleton<GroupMembership> GroupMembershipMgr;
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_GROUP_MEMBERSHIP_HPP__
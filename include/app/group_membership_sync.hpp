@@ -0,0 +1,39 @@
+#ifndef __IM_APP_GROUP_MEMBERSHIP_SYNC_HPP__
+#define __IM_APP_GROUP_MEMBERSHIP_SYNC_HPP__
+
+#include <cstdint>
+
+#include "app/cache_sync.hpp"
+#include "base/singleton.hpp"
+
+namespace IM::app {
+
+// 群成员缓存的跨节点失效：成员/角色/禁言变更提交后向 Redis 频道发布群ID，
+// 各节点订阅该频道并使本地 GroupMembership 中对应的群失效。
+// 说明：
+// - 通过 group.membership.sync_redis 指定 redis.config 中的实例名，为空时不启用，
+//   其它节点只能依赖 group.membership.ttl 收敛；
+// - 订阅与重连后的全量失效见 CacheSync。
+class GroupMembershipSync {
+   public:
+    GroupMembershipSync();
+
+    bool isEnabled() const { return m_sync.isEnabled(); }
+
+    // 启动订阅线程（未启用或已启动时为空操作）
+    void start() { m_sync.start(); }
+    // 停止订阅线程
+    void stop() { m_sync.stop(); }
+
+    // 通知其它节点群成员关系已变更
+    void publish(const uint64_t group_id);
+
+   private:
+    CacheSync m_sync;
+};
+
+typedef Singleton<GroupMembershipSync> GroupMembershipSyncMgr;
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_GROUP_MEMBERSHIP_SYNC_HPP__
@@ -0,0 +1,42 @@
+#ifndef __IM_APP_GROUP_SERVICE_HPP__
+#define __IM_APP_GROUP_SERVICE_HPP__
+
+#include <vector>
+
+#include "dao/group_dao.hpp"
+#include "result.hpp"
+
+namespace IM::app {
+
+// 群成员管理：权限校验在事务内读数据库（锁定群行与成员行），提交后修补本节点的
+// GroupMembership 缓存并经 GroupMembershipSync 通知其它节点失效
+class GroupService {
+   public:
+    // 邀请好友入群（邀请人需为群成员）
+    static VoidResult InviteMembers(const uint64_t operator_id, const uint64_t group_id,
+                                    const std::vector<uint64_t>& user_ids);
+
+    // 退出群聊（群主需先转让群）
+    static VoidResult Secede(const uint64_t user_id, const uint64_t group_id);
+
+    // 移出群成员（管理员可移出普通成员，群主可移出管理员）
+    static VoidResult RemoveMembers(const uint64_t operator_id, const uint64_t group_id,
+                                    const std::vector<uint64_t>& user_ids);
+
+    // 设置/取消管理员（仅群主）；action: 1=设置 2=取消
+    static VoidResult AssignAdmin(const uint64_t operator_id, const uint64_t group_id,
+                                  const uint64_t user_id, const uint8_t action);
+
+    // 成员禁言（管理员/群主）；action: 1=禁言 2=解除；duration 为禁言秒数，0 表示长期
+    static VoidResult SetNoSpeak(const uint64_t operator_id, const uint64_t group_id,
+                                 const uint64_t user_id, const uint8_t action,
+                                 const uint32_t duration = 0);
+
+    // 全员禁言（管理员/群主）；action: 1=开启 2=关闭
+    static VoidResult SetMute(const uint64_t operator_id, const uint64_t group_id,
+                              const uint8_t action);
+};
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_GROUP_SERVICE_HPP__
@@ -0,0 +1,119 @@
+#ifndef __IM_APP_MESSAGE_CACHE_HPP__
+#define __IM_APP_MESSAGE_CACHE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/singleton.hpp"
+#include "dao/message_dao.hpp"
+#include "io/lock.hpp"
+
+namespace IM::app {
+
+// 会话最近消息缓存：每个 talk 保留最近 N 条已构建完成的 MessageRecord，
+// 供 LoadRecords 首屏（cursor=0）直接从内存返回，省去 ListRecentDescWithFilter 及其 NOT EXISTS 反连接。
+// 说明：
+// - 仅缓存未撤回的消息（与 LoadRecords 的 SQL 过滤一致），按 sequence 升序保存；
+// - 用户侧删除记录随条目保存（deleted_by），读取时在内存中按用户过滤；
+// - 写路径（发送/撤回/删除/状态）在事务提交后调用 on* 系列方法修补缓存；
+// - 回源期间（loading）发生的撤回/删除/状态修改会使本次回源作废，避免装入过期数据；
+// - 按 talk 做 LRU，整个节点缓存的消息条数受 message.recent_cache.max_records 限制；
+// - 条目中的发送者昵称、头像（含信封）在资料修改后由 onProfile 原地更新；
+// - 其它节点的写入经 MessageCacheSync 调用 invalidate / invalidateSender，每个会话的缓存
+//   在装载 ttl 秒后过期重载，作为通知丢失时的兜底。
+class RecentMessageCache {
+   public:
+    struct Item {
+        IM::dao::MessageRecord rec;
+        std::vector<uint64_t> deleted_by;  // 已删除该消息的用户（有序）
+    };
+
+    struct Options {
+        size_t capacity = 50;         // 每个会话保留的消息条数（0 表示不启用）
+        size_t max_records = 200000;  // 单节点缓存的消息条数上限
+        uint32_t ttl = 300;           // 会话缓存有效期（秒，0 表示不过期）
+    };
+
+    // 按 message.recent_cache.* 配置构造
+    RecentMessageCache();
+    explicit RecentMessageCache(const Options& opts);
+
+    bool isEnabled() const { return m_capacity > 0; }
+    size_t getCapacity() const { return m_capacity; }
+
+    // 读取 user 视角下的最近 limit 条消息（sequence 降序）。未命中或缓存不足以给出精确结果时返回 false。
+    bool getRecent(const uint64_t talk_id, const uint64_t user_id, const size_t limit,
+                   std::vector<IM::dao::MessageRecord>& out);
+
+    // 开始回源：登记 loading 状态并返回令牌；已缓存或正在回源时返回 0。
+    uint64_t beginLoad(const uint64_t talk_id);
+    // 结束回源：items 为按 sequence 升序的最近消息；complete 表示会话内已无更早的消息。
+    void finishLoad(const uint64_t talk_id, const uint64_t token, std::vector<Item>&& items,
+                    bool complete);
+    // 放弃回源
+    void abortLoad(const uint64_t talk_id, const uint64_t token);
+
+    // 新消息写入（未缓存该会话时忽略）；deleted_by 非 0 表示该用户不可见（如失效消息的接收者）
+    void onSend(const uint64_t talk_id, const IM::dao::MessageRecord& rec,
+                const uint64_t deleted_by = 0);
+    void onRevoke(const uint64_t talk_id, const std::string& msg_id);
+    void onUserDelete(const uint64_t talk_id, const uint64_t user_id,
+                      const std::vector<std::string>& msg_ids);
+    void onStatus(const uint64_t talk_id, const std::string& msg_id, const uint8_t status);
+    // 发送者修改了昵称/头像：更新其全部缓存消息并重建信封
+    void onProfile(const uint64_t user_id, const std::string& nickname,
+                   const std::string& avatar);
+    // 使整个会话的缓存失效（清空聊天记录等批量操作）
+    void invalidate(const uint64_t talk_id);
+    // 使包含该用户所发消息的会话失效（其它节点的资料修改）
+    void invalidateSender(const uint64_t user_id);
+    // 清空全部缓存（跨节点通知可能丢失时）
+    void invalidateAll();
+
+    size_t getRecordCount();
+
+   private:
+    struct TalkRing {
+        std::deque<Item> items;  // sequence 升序
+        bool complete = false;   // 会话内所有可见消息均在 items 中
+        bool loading = false;    // 正在回源
+        bool dirty = false;      // 回源期间发生了无法合并的修改
+        uint64_t token = 0;
+        std::time_t loaded_at = 0;  // 开始回源的时间
+        std::list<uint64_t>::iterator lru;
+    };
+
+    struct Shard {
+        Mutex mutex;
+        std::unordered_map<uint64_t, TalkRing> talks;
+        std::list<uint64_t> lru;  // front 为最近访问
+        size_t records = 0;
+    };
+
+    Shard& getShard(const uint64_t talk_id) { return m_shards[talk_id % kShardCount]; }
+    void touch(Shard& shard, TalkRing& ring);
+    void erase(Shard& shard, const uint64_t talk_id);
+    void insert(Shard& shard, TalkRing& ring, Item&& item);
+    void prune(Shard& shard, const uint64_t keep_talk_id);
+
+   private:
+    static constexpr size_t kShardCount = 16;
+    Shard m_shards[kShardCount];
+    size_t m_capacity;          // 每个会话保留的消息条数
+    size_t m_maxShardRecords;   // 每个分片最多缓存的消息条数
+    uint32_t m_ttl;             // 会话缓存有效期（秒）
+    std::atomic<uint64_t> m_tokenSeq{0};
+};
+
+typedef Singleton<RecentMessageCache> RecentMessageCacheMgr;
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_MESSAGE_CACHE_HPP__
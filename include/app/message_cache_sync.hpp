@@ -0,0 +1,42 @@
+#ifndef __IM_APP_MESSAGE_CACHE_SYNC_HPP__
+#define __IM_APP_MESSAGE_CACHE_SYNC_HPP__
+
+#include <cstdint>
+
+#include "app/cache_sync.hpp"
+#include "base/singleton.hpp"
+
+namespace IM::app {
+
+// 最近消息缓存的跨节点失效：会话内消息的发送/撤回/删除/状态修改提交后向 Redis 频道
+// 发布会话ID，用户修改昵称/头像后发布 "u<用户ID>"，各节点订阅该频道并使本地
+// RecentMessageCache 中对应的会话失效。
+// 说明：
+// - 通过 message.recent_cache.sync_redis 指定 redis.config 中的实例名，为空时不启用，
+//   其它节点只能依赖 message.recent_cache.ttl 收敛；
+// - 订阅与重连后的全量失效见 CacheSync。
+class MessageCacheSync {
+   public:
+    MessageCacheSync();
+
+    bool isEnabled() const { return m_sync.isEnabled(); }
+
+    // 启动订阅线程（未启用或已启动时为空操作）
+    void start() { m_sync.start(); }
+    // 停止订阅线程
+    void stop() { m_sync.stop(); }
+
+    // 通知其它节点会话内的消息已变更
+    void publish(const uint64_t talk_id);
+    // 通知其它节点该用户的昵称/头像已变更
+    void publishSender(const uint64_t user_id);
+
+   private:
+    CacheSync m_sync;
+};
+
+typedef Singleton<MessageCacheSync> MessageCacheSyncMgr;
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_MESSAGE_CACHE_SYNC_HPP__
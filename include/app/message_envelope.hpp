@@ -0,0 +1,35 @@
+#ifndef __IM_APP_MESSAGE_ENVELOPE_HPP__
+#define __IM_APP_MESSAGE_ENVELOPE_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dao/message_dao.hpp"
+
+namespace IM::app {
+
+// 消息信封：一条 MessageRecord 的规范 JSON（字段与 REST 响应、im.message 推送的 body 一致），
+// 以只读、引用计数的字节串挂在 MessageRecord::json 上。
+// 说明：
+// - 发送时在记录定稿后构建一次，REST 响应、WebSocket 推送、最近消息缓存都直接复用这段字节；
+// - 修改记录字段（如缓存中的状态更新）后须重新 Build，旧信封仍被持有者安全地读取；
+// - 没有信封的记录（如直接从库中读出）由 Append 按字段现场序列化，输出与信封一致。
+class MessageEnvelope {
+   public:
+    // 按 rec 当前字段构建信封并挂到 rec.json 上
+    static void Build(IM::dao::MessageRecord& rec);
+
+    // 把 rec 的 JSON 对象追加到 out：有信封时直接拷贝字节
+    static void Append(const IM::dao::MessageRecord& rec, std::string& out);
+
+    // 把一组记录写成 JSON 数组追加到 out
+    static void AppendList(const std::vector<IM::dao::MessageRecord>& recs, std::string& out);
+
+   private:
+    static void Encode(const IM::dao::MessageRecord& rec, std::string& out);
+};
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_MESSAGE_ENVELOPE_HPP__
@@ -0,0 +1,135 @@
+#ifndef __IM_APP_MESSAGE_SEARCH_HPP__
+#define __IM_APP_MESSAGE_SEARCH_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/singleton.hpp"
+#include "ds/roaring_bitmap.hpp"
+#include "io/lock.hpp"
+#include "io/semaphore.hpp"
+#include "io/thread.hpp"
+
+namespace IM::app {
+
+// 本地消息全文检索索引（进程内倒排索引），替代对 content_text 的 LIKE '%kw%' 全表扫描。
+// 说明：
+// - 分词：字母数字串按整词（ASCII 小写、全角转半角）；汉字/假名/谚文按单字 + 重叠二元组，
+//   查询时连续 CJK 串取二元组（单字取单字）；
+// - 倒排按 (talk_id, 词) 组织，posting 为会话内命中消息的 sequence 集合（RoaringBitmap）；
+// - 写入先追加 WAL（不做 fsync，进程崩溃后可重放）再更新内存表；
+//   内存表达到 flush_docs 条后由后台线程冻结并写成只读段文件；
+// - 段文件：posting 区 + 按会话分块的有序词典 + 会话表 + 定长 footer，mmap 后二分查找；
+// - 撤回记为 tombstone（每会话一个 RoaringBitmap），查询时扣除，全量合并时物理清除；
+// - 段数达到 merge_segments 时后台把全部段 k 路归并为一个；
+// - 每个会话记录覆盖水位 synced：sequence 不大于它的消息都已处理过（入索引或无可索引内容），
+//   水位之后的消息（其他节点发送、启用索引前的历史）需由调用方补录或改走数据库查询。
+// 索引只给出候选 sequence：二元组可能误命中，用户侧删除也不在索引中，调用方需回表校验。
+class MessageSearchIndex {
+   public:
+    struct Options {
+        std::string dir;              // 索引目录（WAL/段/tombstone）
+        size_t flush_docs = 100000;   // 内存表落盘阈值（消息条数）
+        size_t merge_segments = 8;    // 段数达到该值时触发全量合并（0 表示不合并）
+    };
+
+    // 按 message.search.* 配置构造；未启用时所有操作为空操作
+    MessageSearchIndex();
+    explicit MessageSearchIndex(const Options& opts);
+    ~MessageSearchIndex();
+
+    bool isEnabled() const { return m_enabled; }
+
+    // 分词（结果已去重）。for_query=true 时 CJK 串只取二元组（单字串取单字）。
+    static void Tokenize(const std::string& text, std::vector<std::string>& terms,
+                         bool for_query = false);
+
+    // 索引一条消息；sequence 超出 uint32 范围的消息不入索引
+    bool add(const uint64_t talk_id, const uint64_t sequence, const std::string& text);
+    // 撤回/删除一条消息
+    void remove(const uint64_t talk_id, const uint64_t sequence);
+
+    // 会话的覆盖水位（未记录时为 0）
+    uint64_t getSynced(const uint64_t talk_id);
+    // 水位等于 from 时推进到 to（to > from），返回是否推进；
+    // 调用方须保证 (from, to] 内的消息都已 add。比较后设置保证并发补录不会越过未处理的消息。
+    bool advanceSynced(const uint64_t talk_id, const uint64_t from, const uint64_t to);
+
+    // 查询会话内同时包含全部 terms 且 sequence < before（0 表示不限）的消息，按 sequence 降序最多 limit 条
+    void search(const uint64_t talk_id, const std::vector<std::string>& terms,
+                const uint64_t before, const size_t limit, std::vector<uint64_t>& out);
+
+    // 同步落盘当前内存表（段数达到阈值时顺带合并）
+    bool flush();
+    // 同步把全部段合并为一个
+    bool merge();
+    // 停止后台线程（不落盘，未落盘部分由 WAL 在下次启动时恢复）
+    void stop();
+
+    size_t getSegmentCount();
+    size_t getMemDocCount();
+
+   private:
+    struct MemTable {
+        typedef std::shared_ptr<MemTable> ptr;
+        typedef std::unordered_map<std::string, std::vector<uint32_t>> TermMap;
+        // talk_id -> 词 -> sequence 列表；posting 用追加数组保存（为单条消息建 RoaringBitmap
+        // 开销过大），落盘/查询时再转为位图
+        std::unordered_map<uint64_t, TermMap> talks;
+        size_t docs = 0;
+        size_t removes = 0;
+        std::vector<std::string> wals;  // 内容落盘后可删除的 WAL 文件
+    };
+    class Segment;
+    typedef std::unordered_map<uint64_t, IM::ds::RoaringBitmap> TombMap;
+    typedef std::unordered_map<uint64_t, uint32_t> SyncedMap;
+
+    void init();
+    void run();
+    bool replayWal(const std::string& path);
+    bool openWal();
+    void appendWal(const char type, const uint64_t talk_id, const uint32_t sequence,
+                   const std::string& text);
+    void applyAdd(MemTable& mem, const uint64_t talk_id, const uint32_t sequence,
+                  const std::vector<std::string>& terms);
+    void applyRemove(const uint64_t talk_id, const uint32_t sequence);
+    bool doFlush();
+    bool doMerge();
+    bool saveTombstones();
+    bool loadTombstones();
+    bool saveSynced(const SyncedMap& synced);
+    bool loadSynced();
+    std::string segmentPath(const uint64_t id) const;
+
+   private:
+    bool m_enabled = false;
+    Options m_opts;
+
+    RWMutex m_mutex;          // 保护内存表、段列表、tombstone、WAL
+    MemTable::ptr m_mem;      // 可写内存表
+    MemTable::ptr m_imm;      // 正在落盘的内存表
+    std::vector<std::shared_ptr<Segment>> m_segments;  // 按 id 升序
+    TombMap m_tombs;          // 最近一次冻结之后的撤回
+    TombMap m_sealedTombs;    // 最近一次冻结之前的撤回（全量合并后可清除）
+    SyncedMap m_synced;       // 会话覆盖水位
+    int m_walFd = -1;
+    std::string m_walPath;
+    uint64_t m_nextWalId = 1;
+    uint64_t m_nextSegId = 1;
+
+    Mutex m_flushMutex;  // 串行化落盘与合并
+    Semaphore m_sem;
+    Thread::ptr m_thread;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_flushPending{false};
+};
+
+typedef Singleton<MessageSearchIndex> MessageSearchIndexMgr;
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_MESSAGE_SEARCH_HPP__
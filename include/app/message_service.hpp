@@ -27,6 +27,17 @@ class MessageService {
                                                       const uint16_t msg_type, uint64_t cursor,
                                                       uint32_t limit);
 
+    // 会话内全文检索（按 sequence DESC 返回命中的消息）。
+    // 说明：由 MessageSearchIndex 给出候选、回表校验关键词（ASCII 不区分大小写）；
+    // 索引未启用或未覆盖该会话（缺口超过 message.search.catchup_limit）时改用数据库 LIKE 检索；
+    // 单次请求最多检查 limit*10 条候选，返回的 cursor 为最后检查到的 sequence，
+    // 因此返回条数不足 limit 不代表已到头，items 为空且 cursor 不变才表示没有更多结果。
+    static MessageRecordPageResult SearchMessages(const uint64_t current_user_id,
+                                                  const uint8_t talk_mode,
+                                                  const uint64_t to_from_id,
+                                                  const std::string& keyword, uint64_t cursor,
+                                                  uint32_t limit);
+
     // 获取转发消息记录（传入一组消息ID，返回消息详情；不分页）。
     static MessageRecordListResult LoadForwardRecords(const uint64_t current_user_id,
                                                       const uint8_t talk_mode,
@@ -75,6 +86,9 @@ class MessageService {
     // 根据 talk_mode 与对象ID 获取会话 talk_id（不存在返回 0）。
     static uint64_t resolveTalkId(const uint8_t talk_mode, const uint64_t to_from_id);
 
+    // 回源装载会话最近消息缓存（RecentMessageCache）；已缓存或装载失败返回 false。
+    static bool fillRecentCache(const uint64_t talk_id);
+
     // 将 DAO Message 转换为前端需要的记录结构（补充用户昵称头像、引用）。
     static bool buildRecord(const IM::dao::Message& msg, IM::dao::MessageRecord& out,
                             std::string* err);
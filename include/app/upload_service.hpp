@@ -0,0 +1,64 @@
+#ifndef __IM_APP_UPLOAD_SERVICE_HPP__
+#define __IM_APP_UPLOAD_SERVICE_HPP__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "result.hpp"
+
+namespace IM::app {
+
+// 分片上传会话
+struct UploadSession {
+    std::string upload_id;
+    uint64_t user_id = 0;
+    std::string file_name;
+    uint64_t file_size = 0;
+    uint32_t shard_size = 0;
+    uint32_t shard_num = 0;
+    std::vector<uint32_t> uploaded;  // 已上传的分片序号（升序），用于断点续传
+    bool finished = false;           // 是否已合并完成
+    std::string path;                // 合并后的文件路径（完成后有效）
+    std::string sha256;              // 合并后文件的 SHA-256（完成后有效）
+};
+
+using UploadSessionResult = Result<UploadSession>;
+
+// 分片上传：分片请求体直接从连接落盘，不在内存中缓存整个文件
+// 目录结构：<upload.dir>/<upload_id>/{meta.json, <index>.part, <index>.tmp}
+// - 合并（整文件读写 + SHA-256）在 CpuPool 中执行，不占用 IOManager 线程；
+// - 每个用户未完成的会话数受 upload.max_sessions_per_user 限制；
+// - 超过 upload.session_ttl 无写入的未完成会话由周期清理删除。
+class UploadService {
+   public:
+    /// 请求体读取函数：把请求体写入 fd（语义同 HttpSession::readBodyTo）
+    typedef std::function<void(const char* data, size_t len)> BodyObserver;
+    typedef std::function<int64_t(int fd, uint64_t max_size, const BodyObserver& observer)>
+        BodyReader;
+
+    // 创建分片上传会话；该用户未完成的会话数已达上限时返回 429
+    static UploadSessionResult InitMultipart(const uint64_t user_id, const std::string& file_name,
+                                             const uint64_t file_size);
+
+    // 查询上传进度（已上传分片列表）
+    static UploadSessionResult GetStatus(const uint64_t user_id, const std::string& upload_id);
+
+    // 上传一个分片；expect_sha256 非空时校验分片摘要（需经用户态计算，不走 splice）
+    // 全部分片到齐后自动合并，返回的会话 finished=true；CpuPool 繁忙时返回 429，
+    // 分片已保存，重传任一分片即可再次触发合并
+    static UploadSessionResult WritePart(const uint64_t user_id, const std::string& upload_id,
+                                         const uint32_t split_index, const BodyReader& reader,
+                                         const std::string& expect_sha256);
+
+    // 删除超过 upload.session_ttl 无写入的未完成会话，以及已完成会话中残留的
+    // 分片/临时文件；返回删除的会话数（阻塞的磁盘操作，不要在 IOManager 线程调用）
+    static size_t CleanupExpired();
+
+    // 启动周期清理定时器，清理任务提交到 CpuPool 执行（幂等）
+    static void InitCleanupTimer();
+};
+
+}  // namespace IM::app
+
+#endif  // __IM_APP_UPLOAD_SERVICE_HPP__
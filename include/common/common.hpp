@@ -32,6 +32,15 @@ bool VerifyJwt(const std::string& token, std::string* out_uid = nullptr);
 // JWT 是否过期
 bool IsJwtExpired(const std::string& token);
 
+// JWT 撤销（登出等场景）：令牌在本节点上立即失效，直到其自然过期
+void RevokeJwt(const std::string& token);
+
+// 撤销用户此前签发的全部 JWT（修改/找回密码）：本节点上立即失效
+void RevokeUserJwts(const uint64_t uid);
+
+// 从请求头 Authorization 中提取访问令牌，没有时返回空串
+std::string GetBearerToken(IM::http::HttpRequest::ptr req);
+
 // 从请求中提取 uid
 UidResult GetUidFromToken(IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res);
 
@@ -11,6 +11,11 @@
 #ifndef __IM_CONFIG_CONFIG_VAR_HPP__
 #define __IM_CONFIG_CONFIG_VAR_HPP__
 
+#include <atomic>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+
 #include "io/lock.hpp"
 #include "lexical_cast.hpp"
 #include "base/macro.hpp"
@@ -25,6 +30,12 @@ namespace IM {
      * ConfigVar 是配置系统的核心类，它封装了特定类型的配置项。
      * 通过模板参数可以支持任意数据类型，并提供配置值的自动序列化和反序列化功能。
      * 同时支持配置变更时的回调通知机制。
+     *
+     * 读路径（getValue）不加锁：
+     * - 算术/枚举类型保存一份 std::atomic<T> 副本，读取即一次原子 load；
+     * - 其他类型（string、容器等）在 setValue 时发布不可变快照（shared_ptr<const T>）并递增版本号，
+     *   每个线程缓存自己拿到的快照，版本号未变时直接从线程本地缓存拷贝，避免争用共享的锁/引用计数。
+     * 写路径（setValue/监听器管理）仍由读写锁串行化。
      */
 template <class T, class fromStr = LexicalCast<std::string, T>,
           class toStr = LexicalCast<T, std::string>>
@@ -48,6 +59,7 @@ class ConfigVar : public ConfigVariableBase {
     ConfigVar(const std::string& name, const T& default_value, const std::string& description)
         : ConfigVariableBase(name, description), m_val(default_value) {
         IM_ASSERT(!name.empty());
+        publish(default_value);
     }
 
     /**
@@ -118,6 +130,7 @@ class ConfigVar : public ConfigVariableBase {
             }
             old_value = m_val;
             m_val = v;
+            publish(v);
             cbs = m_cbs;
         }
 
@@ -128,12 +141,24 @@ class ConfigVar : public ConfigVariableBase {
     }
 
     /**
-         * @brief 获取配置项的值
+         * @brief 获取配置项的值（无锁）
          * @return 当前配置项的值
          */
     T getValue() const {
-        RWMutexType::ReadLock lock(m_mutex);
-        return m_val;
+        if constexpr (kAtomic) {
+            return m_atomicVal.load(std::memory_order_acquire);
+        } else {
+            // 线程本地缓存：变量 id -> (版本号, 快照)
+            static thread_local std::unordered_map<uint64_t, std::pair<uint64_t, SnapshotPtr>>
+                t_cache;
+            const uint64_t version = m_version.load(std::memory_order_acquire);
+            auto& c = t_cache[m_id];
+            if (!c.second || c.first != version) {
+                c.second = std::atomic_load(&m_snapshot);
+                c.first = version;
+            }
+            return *c.second;
+        }
     }
 
     /**
@@ -188,10 +213,41 @@ class ConfigVar : public ConfigVariableBase {
         return it == m_cbs.end() ? nullptr : it->second;
     }
 
+   private:
+    /// 可直接用 std::atomic 保存的类型
+    static constexpr bool kAtomic =
+        (std::is_arithmetic<T>::value || std::is_enum<T>::value) && sizeof(T) <= sizeof(uint64_t);
+    using SnapshotPtr = std::shared_ptr<const T>;
+    using AtomicType = typename std::conditional<kAtomic, std::atomic<T>, char>::type;
+
+    /**
+         * @brief 发布新值供无锁读取，调用方需持有写锁（构造函数除外）
+         * @param[in] v 新的配置值
+         */
+    void publish(const T& v) {
+        if constexpr (kAtomic) {
+            m_atomicVal.store(v, std::memory_order_release);
+        } else {
+            // 先替换快照再递增版本号，读者看到新版本时一定能拿到新快照
+            std::atomic_store(&m_snapshot, SnapshotPtr(std::make_shared<const T>(v)));
+            m_version.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    static uint64_t NextId() {
+        static std::atomic<uint64_t> s_id{0};
+        return ++s_id;
+    }
+
    private:
     T m_val;                                   // 配置值
     std::map<uint64_t, ConfigChangeCb> m_cbs;  // 配置改变时的回调函数
     RWMutexType m_mutex;                       // 读写锁
+
+    const uint64_t m_id = NextId();            // 线程本地快照缓存的键
+    AtomicType m_atomicVal{};                  // 算术类型的无锁副本
+    SnapshotPtr m_snapshot;                    // 非算术类型的不可变快照
+    std::atomic<uint64_t> m_version{0};        // 快照版本号
 };
 }  // namespace IM
 
@@ -0,0 +1,74 @@
+#ifndef __IM_DAO_GROUP_DAO_HPP__
+#define __IM_DAO_GROUP_DAO_HPP__
+
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/mysql.hpp"
+
+namespace IM::dao {
+
+// 群基础状态（im_group 中与权限相关的字段）
+struct GroupState {
+    uint64_t id = 0;            // 群ID
+    uint64_t leader_id = 0;     // 群主用户ID
+    uint8_t is_mute = 2;        // 全员禁言：1=开启 2=关闭
+    uint8_t is_dismissed = 0;   // 是否已解散：0=否 1=是
+};
+
+// 群成员（im_group_member 中未退出的成员）
+struct GroupMemberItem {
+    uint64_t user_id = 0;            // 成员用户ID
+    uint8_t role = 1;                // 角色：1=成员 2=管理员 3=群主
+    std::time_t no_speak_until = 0;  // 禁言到期时间（0 表示未禁言）
+};
+
+class GroupDao {
+   public:
+    // 查询群状态；群不存在返回 false 且不写 err
+    static bool GetState(const uint64_t group_id, GroupState& out, std::string* err = nullptr);
+
+    // 列出群内全部未退出成员
+    static bool ListMembers(const uint64_t group_id, std::vector<GroupMemberItem>& out,
+                            std::string* err = nullptr);
+
+    // 事务内读取成员角色（1=成员 2=管理员 3=群主）并锁定群行与成员行；
+    // 群不存在、已解散或不是成员时 role 为 0
+    static bool GetRoleForUpdateWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                         const uint64_t group_id, const uint64_t user_id,
+                                         uint8_t& role, std::string* err = nullptr);
+
+    // 加入群：已退出的成员恢复为 role，已在群内的成员保持原角色
+    static bool AddMemberWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                  const uint64_t user_id, const uint8_t role,
+                                  std::string* err = nullptr);
+
+    // 退群/移出（软删除）；成员不在群内时返回 true 且不写 err
+    static bool RemoveMemberWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                     const uint64_t user_id, std::string* err = nullptr);
+
+    // 按实际成员数回写 im_group.member_num
+    static bool RefreshMemberNumWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                         const uint64_t group_id, std::string* err = nullptr);
+
+    // 修改成员角色
+    static bool UpdateRoleWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                   const uint64_t user_id, const uint8_t role,
+                                   std::string* err = nullptr);
+
+    // 设置成员禁言到期时间（0 表示解除禁言）
+    static bool UpdateNoSpeakWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                      const uint64_t group_id, const uint64_t user_id,
+                                      const std::time_t until, std::string* err = nullptr);
+
+    // 设置全员禁言：1=开启 2=关闭
+    static bool UpdateMuteWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                   const uint8_t is_mute, std::string* err = nullptr);
+};
+
+}  // namespace IM::dao
+
+#endif  // __IM_DAO_GROUP_DAO_HPP__
@@ -44,6 +44,8 @@ struct MessageRecord {
     std::string send_time;   // 发送时间字符串
     std::string extra;       // 额外 JSON
     std::string quote;       // 引用消息 JSON
+    // 消息信封：按以上字段预序列化的 JSON（只读共享），为空表示尚未构建，见 app::MessageEnvelope
+    std::shared_ptr<const std::string> json;
 };
 
 struct MessagePage {
@@ -68,7 +70,8 @@ class MessageDao {
 
     // 与 ListRecentDesc 功能类似，但可下推过滤条件：
     // - user_id != 0 时，排除该用户在 im_message_user_delete 表中标记为删除的消息
-    // - msg_type != 0 时，仅返回指定 msg_type 的消息
+    // - msg_type != 0 时，仅返回指定 msg_type 的消息（走 idx_talk_type_seq_desc 索引范围扫描）
+    // - 始终排除已撤回的消息
     static bool ListRecentDescWithFilter(const uint64_t talk_id, const uint64_t anchor_seq,
                                          const size_t limit, const uint64_t user_id,
                                          const uint16_t msg_type, std::vector<Message>& out,
@@ -81,6 +84,20 @@ class MessageDao {
                                          const uint16_t msg_type, std::vector<Message>& out,
                                          std::string* err = nullptr);
 
+    // 按会话内序号批量获取消息（sequence 降序），用于全文检索回表：
+    // 排除已撤回的消息；user_id != 0 时排除该用户已删除的消息。
+    static bool ListBySequences(const uint64_t talk_id, const std::vector<uint64_t>& sequences,
+                                const uint64_t user_id, std::vector<Message>& out,
+                                std::string* err = nullptr);
+
+    // 会话内关键词子串检索（sequence 降序，anchor_seq=0 时从最新开始），全文检索索引
+    // 未覆盖该会话时使用：沿 (talk_id, sequence) 索引倒序扫描并以 LIKE 过滤 content_text；
+    // 排除已撤回的消息；user_id != 0 时排除该用户已删除的消息。
+    static bool SearchByKeyword(const uint64_t talk_id, const std::string& keyword,
+                                const uint64_t anchor_seq, const size_t limit,
+                                const uint64_t user_id, std::vector<Message>& out,
+                                std::string* err = nullptr);
+
     // 会话内获取大于某序号的消息（升序）。
     static bool ListAfterAsc(const uint64_t talk_id, const uint64_t after_seq, const size_t limit,
                              std::vector<Message>& out, std::string* err = nullptr);
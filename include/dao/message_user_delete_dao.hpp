@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "db/mysql.hpp"
 
@@ -18,6 +20,11 @@ class MessageUserDeleteDao {
     static bool MarkAllMessagesDeletedByUserInTalk(const std::shared_ptr<IM::MySQL>& db,
                                                    const uint64_t talk_id, const uint64_t user_id,
                                                    std::string* err = nullptr);
+
+    // 批量查询一组消息的删除记录，输出 (msg_id, user_id) 对（用于最近消息缓存回源）
+    static bool ListByMsgIds(const std::vector<std::string>& msg_ids,
+                             std::vector<std::pair<std::string, uint64_t>>& out,
+                             std::string* err = nullptr);
 };
 }  // namespace IM::dao
 
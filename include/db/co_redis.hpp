@@ -0,0 +1,88 @@
+#ifndef __IM_DB_CO_REDIS_HPP__
+#define __IM_DB_CO_REDIS_HPP__
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/redis.hpp"
+#include "io/iomanager.hpp"
+#include "io/lock.hpp"
+#include "net/socket.hpp"
+
+namespace IM {
+
+/**
+ * @brief 协程 Redis 客户端
+ * @details 直接在调用方所在的 IOManager 上收发 RESP，不经过 FoxThread：
+ *          - socket 由 hook 层托管，send/recv 阻塞时让出协程；
+ *          - 多个协程复用同一条连接：命令按提交顺序写入发送缓冲，等待者按同样顺序排队，
+ *            读协程用 hiredis 的增量解析器（redisReader）逐个取出回复并按序唤醒；
+ *          - 同一时刻只有一个协程负责写 socket，其余协程追加到缓冲区后直接等待回复，
+ *            写协程会把积累的命令合并成一次 send。
+ *          必须在 IOManager 调度的协程中调用。
+ */
+class CoRedis : public IRedis {
+   public:
+    typedef std::shared_ptr<CoRedis> ptr;
+    typedef Mutex MutexType;
+
+    CoRedis(const std::map<std::string, std::string>& conf);
+    ~CoRedis();
+
+    virtual ReplyPtr cmd(const char* fmt, ...);
+    virtual ReplyPtr cmd(const char* fmt, va_list ap);
+    virtual ReplyPtr cmd(const std::vector<std::string>& argv);
+    virtual bool pipeline(RedisBatch& batch);
+
+    bool isConnected();
+
+   private:
+    enum WaiterState { RUNNING = 0, PARKED = 1, DONE = 2, FAILED = 3 };
+
+    struct Waiter {
+        typedef std::shared_ptr<Waiter> ptr;
+        Scheduler* scheduler = nullptr;
+        Coroutine::ptr fiber;
+        std::vector<ReplyPtr> replies;
+        std::atomic<size_t> received{0};  // 只由读协程递增
+        std::atomic<int> state{RUNNING};
+    };
+
+    static void Wake(Waiter::ptr w, int state);
+
+    // 发送 data（包含 count 条命令）并等待 count 条回复
+    bool request(const std::string& data, size_t count, std::vector<ReplyPtr>& replies);
+    // 将命令与等待者登记到连接上；返回 false 表示连接已失效
+    bool submit(Socket::ptr sock, const std::string& data, size_t count, Waiter::ptr w,
+                bool& writer);
+    bool wait(Waiter::ptr w);
+    Socket::ptr getConnection();
+    Socket::ptr connect();
+    void flush(Socket::ptr sock);
+    void readLoop(Socket::ptr sock);
+    void deliver(Socket::ptr sock, ReplyPtr reply);
+    void onError(Socket::ptr sock, const char* reason);
+    ReplyPtr checkReply(ReplyPtr r, const char* what);
+
+   private:
+    std::string m_host;
+    uint16_t m_port;
+    uint64_t m_connectMs;
+    uint64_t m_cmdTimeoutMs;
+    uint64_t m_nextConnectTime;  // 连接失败后的重试时间点（毫秒）
+
+    MutexType m_mutex;
+    Socket::ptr m_sock;
+    std::string m_sendBuf;
+    bool m_writing;
+    std::deque<Waiter::ptr> m_waiters;  // 与发出的命令一一对应
+    CoroutineSemaphore m_connSem;       // 同一时刻只有一个协程建立连接
+};
+
+}  // namespace IM
+
+#endif  // __IM_DB_CO_REDIS_HPP__
@@ -145,6 +145,7 @@ class MySQL : public IDB, public std::enable_shared_from_this<MySQL> {
     std::shared_ptr<MYSQL> getRaw();
 
     uint64_t getAffectedRows();
+    bool isNonBlock() const { return m_nonblock; }
 
     ISQLData::ptr query(const char* format, ...) override;
     ISQLData::ptr query(const char* format, va_list ap);
@@ -169,6 +170,17 @@ class MySQL : public IDB, public std::enable_shared_from_this<MySQL> {
    private:
     bool isNeedCheck();
 
+    /**
+     * @brief 执行文本 SQL（非阻塞模式下在协程内让出等待，不阻塞工作线程）
+     * @return 0 成功，非 0 失败
+     */
+    int realQuery(const std::string& sql);
+    // 取回结果集（非阻塞模式下同样以协程方式等待）
+    MYSQL_RES* storeResult();
+    MYSQL_RES* queryResult(const std::string& sql);
+    // 非阻塞等待超时/失败后关闭连接
+    void onAsyncBroken(int rt);
+
    private:
     std::map<std::string, std::string> m_params;
     std::shared_ptr<MYSQL> m_mysql;
@@ -179,6 +191,10 @@ class MySQL : public IDB, public std::enable_shared_from_this<MySQL> {
     uint64_t m_lastUsedTime;
     bool m_hasError;
     int32_t m_poolSize;
+    // 连接参数 nonblock=1 时文本查询/建连走 *_nonblocking 接口 + IOManager 事件
+    // （预处理语句 libmysqlclient 无异步接口，仍为阻塞调用）
+    bool m_nonblock;
+    uint64_t m_queryTimeout;  // 非阻塞模式下单次等待超时（毫秒，0 不限）
 };
 
 class MySQLTransaction : public ITransaction {
@@ -261,11 +277,15 @@ class MySQLStmt : public IStmt, public std::enable_shared_from_this<MySQLStmt> {
 
    private:
     MySQLStmt(MySQL::ptr db, MYSQL_STMT* stmt);
+    // 非阻塞连接：将绑定参数替换进 SQL 文本（m_stmt 为空时使用）
+    bool render(std::string& out);
 
    private:
     MySQL::ptr m_mysql;
     MYSQL_STMT* m_stmt;
     std::vector<MYSQL_BIND> m_binds;
+    std::string m_sql;
+    std::vector<size_t> m_placeholders;
 };
 
 class MySQLManager {
@@ -17,10 +17,56 @@
 
 namespace IM {
 typedef std::shared_ptr<redisReply> ReplyPtr;
+struct FoxRedisBatchCtx;
+
+/**
+ * @brief Redis 批量命令
+ * @details 收集 N 条命令后通过 IRedis::pipeline 一次性发送，按添加顺序返回每条命令的回复：
+ *          - Redis：单连接 pipeline，一次往返；
+ *          - RedisCluster：hiredis-vip 按 key 的 slot 将命令分发到各节点并按节点 pipeline；
+ *          - FoxRedis/FoxRedisCluster：整批只切换一次 FoxThread，异步连接上连续写出。
+ *          transaction=true 时以 MULTI/EXEC 包裹（仅单节点类型支持，集群模式下失败）。
+ */
+class RedisBatch {
+   public:
+    typedef std::shared_ptr<RedisBatch> ptr;
+
+    RedisBatch(bool transaction = false) : m_transaction(transaction) {}
+
+    // 添加命令，返回命令下标；格式化失败返回 -1
+    int add(const char* fmt, ...);
+    int add(const char* fmt, va_list ap);
+    int add(const std::vector<std::string>& argv);
+
+    size_t size() const { return m_cmds.size(); }
+    bool empty() const { return m_cmds.empty(); }
+    bool isTransaction() const { return m_transaction; }
+    void clear();
+
+    // pipeline 之后读取回复；未收到回复（超时/连接错误）时为空
+    ReplyPtr getReply(size_t idx) const;
+    bool isOk(size_t idx) const;
+    int64_t getInteger(size_t idx, int64_t def = 0) const;
+    std::string getString(size_t idx, const std::string& def = "") const;
+    bool getArray(size_t idx, std::vector<std::string>& out) const;
+    // 没有回复或回复为错误的命令数
+    size_t getFailedCount() const;
+
+    // 供 IRedis 实现使用：RESP 格式的命令及回复槽位
+    const std::vector<std::string>& getCmds() const { return m_cmds; }
+    std::vector<ReplyPtr>& getReplies() { return m_replies; }
+    // 事务模式下将 EXEC 的数组回复拆分到各命令
+    bool setExecReply(ReplyPtr exec);
+
+   private:
+    bool m_transaction;
+    std::vector<std::string> m_cmds;
+    std::vector<ReplyPtr> m_replies;
+};
 
 class IRedis {
    public:
-    enum Type { REDIS = 1, REDIS_CLUSTER = 2, FOX_REDIS = 3, FOX_REDIS_CLUSTER = 4 };
+    enum Type { REDIS = 1, REDIS_CLUSTER = 2, FOX_REDIS = 3, FOX_REDIS_CLUSTER = 4, CO_REDIS = 5 };
     typedef std::shared_ptr<IRedis> ptr;
     IRedis() : m_logEnable(true) {}
     virtual ~IRedis() {}
@@ -28,6 +74,8 @@ class IRedis {
     virtual ReplyPtr cmd(const char* fmt, ...) = 0;
     virtual ReplyPtr cmd(const char* fmt, va_list ap) = 0;
     virtual ReplyPtr cmd(const std::vector<std::string>& argv) = 0;
+    // 一次性发送 batch 中的全部命令；全部命令都收到回复时返回 true
+    virtual bool pipeline(RedisBatch& batch) = 0;
 
     const std::string& getName() const { return m_name; }
     void setName(const std::string& v) { m_name = v; }
@@ -87,6 +135,7 @@ class Redis : public ISyncRedis {
     virtual int appendCmd(const std::vector<std::string>& argv);
 
     virtual ReplyPtr getReply();
+    virtual bool pipeline(RedisBatch& batch);
 
    private:
     std::string m_host;
@@ -116,6 +165,7 @@ class RedisCluster : public ISyncRedis {
     virtual int appendCmd(const std::vector<std::string>& argv);
 
     virtual ReplyPtr getReply();
+    virtual bool pipeline(RedisBatch& batch);
 
    private:
     std::string m_host;
@@ -146,11 +196,15 @@ class FoxRedis : public IRedis {
     virtual ReplyPtr cmd(const char* fmt, va_list ap);
     virtual ReplyPtr cmd(const std::vector<std::string>& argv);
 
+    virtual bool pipeline(RedisBatch& batch);
+
     bool init();
     int getCtxCount() const { return m_ctxCount; }
 
    private:
     static void OnAuthCb(redisAsyncContext* c, void* rp, void* priv);
+    static void BatchCmdCb(redisAsyncContext* c, void* r, void* privdata);
+    void pbatch(FoxRedisBatchCtx* bctx);
 
    private:
     struct FCtx {
@@ -221,11 +275,16 @@ class FoxRedisCluster : public IRedis {
     virtual ReplyPtr cmd(const char* fmt, va_list ap);
     virtual ReplyPtr cmd(const std::vector<std::string>& argv);
 
+    virtual bool pipeline(RedisBatch& batch);
+
     int getCtxCount() const { return m_ctxCount; }
 
     bool init();
 
    private:
+    static void BatchCmdCb(redisClusterAsyncContext* c, void* r, void* privdata);
+    void pbatch(FoxRedisBatchCtx* bctx);
+
     struct FCtx {
         std::string cmd;
         Scheduler* scheduler;
@@ -277,6 +336,8 @@ class RedisManager {
    public:
     RedisManager();
     IRedis::ptr get(const std::string& name);
+    // 读取 redis.config 中某个实例的配置（供需要独占连接的场景，如 pub/sub 订阅）
+    bool getConfig(const std::string& name, std::map<std::string, std::string>& out);
 
     std::ostream& dump(std::ostream& os);
 
@@ -301,6 +362,8 @@ class RedisUtil {
     static ReplyPtr TryCmd(const std::string& name, uint32_t count, const char* fmt, ...);
     static ReplyPtr TryCmd(const std::string& name, uint32_t count,
                            const std::vector<std::string>& args);
+
+    static bool Pipeline(const std::string& name, RedisBatch& batch);
 };
 
 }  // namespace IM
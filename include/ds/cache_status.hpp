@@ -6,7 +6,7 @@
 #include <sstream>
 #include <string>
 
-#include "util.hpp"
+#include "util/util.hpp"
 
 namespace IM::ds {
 class CacheStatus {
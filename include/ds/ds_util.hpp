@@ -3,6 +3,10 @@
 
 #include <math.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
 #include <vector>
 
 #include "util/hash_util.hpp"
@@ -218,6 +222,60 @@ void SortLast(const T& data, const int& size) {
     }
 }
 
+// 以下为 writeTo/readFrom 使用的流读写工具（K/V 为 POD）
+template <class T>
+bool ReadFromStream(std::istream& is, T& v) {
+    if (!is) {
+        return false;
+    }
+    is.read((char*)&v, sizeof(v));
+    return (bool)is;
+}
+
+inline bool ReadFixFromStream(std::istream& is, char* data, const uint64_t& size) {
+    uint64_t offset = 0;
+    while (is && offset < size) {
+        is.read(data + offset, size - offset);
+        offset += is.gcount();
+    }
+    return offset == size;
+}
+
+// speed 为每秒字节数上限，按分片读写并在超前时休眠
+inline bool ReadFixFromStreamWithSpeed(std::istream& is, char* data, const uint64_t& size,
+                                       const uint64_t& speed = -1) {
+    if (speed == (uint64_t)-1 || speed == 0) {
+        return ReadFixFromStream(is, data, size);
+    }
+    const uint64_t per = std::max(speed / 100, (uint64_t)64 * 1024);
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t offset = 0;
+    while (is && offset < size) {
+        is.read(data + offset, std::min(per, size - offset));
+        offset += is.gcount();
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(offset * 1000 / speed));
+    }
+    return offset == size;
+}
+
+inline bool WriteFixToStreamWithSpeed(std::ostream& os, const char* data, const uint64_t& size,
+                                      const uint64_t& speed = -1) {
+    if (speed == (uint64_t)-1 || speed == 0) {
+        os.write(data, size);
+        return (bool)os;
+    }
+    const uint64_t per = std::max(speed / 100, (uint64_t)64 * 1024);
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t offset = 0;
+    while (os && offset < size) {
+        const uint64_t n = std::min(per, size - offset);
+        os.write(data + offset, n);
+        offset += n;
+        std::this_thread::sleep_until(start + std::chrono::milliseconds(offset * 1000 / speed));
+    }
+    return (bool)os;
+}
+
 }  // namespace IM::ds
 
 #endif // __IM_DS_DS_UTIL_HPP__
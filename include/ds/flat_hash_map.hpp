@@ -0,0 +1,581 @@
+#ifndef __IM_DS_FLAT_HASH_MAP_HPP__
+#define __IM_DS_FLAT_HASH_MAP_HPP__
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "base/noncopyable.hpp"
+#include "ds/ds_util.hpp"
+#include "io/lock.hpp"
+
+namespace IM::ds {
+
+// 开放寻址哈希表（Swiss table 结构）：
+// - 每个槽位对应 1 字节控制字节：空 / 已删除 / 占用（存哈希低 7 位 H2）；
+// - 16 个槽位为一组，按组探测，组内用 SSE2 一次比较 16 个控制字节，命中后才比较键；
+// - 组序号按三角数探测，遇到含空槽的组即可判定不存在；负载上限 7/8。
+namespace swiss {
+
+static const int8_t kEmpty = -128;
+static const int8_t kDeleted = -2;
+static const size_t kGroupWidth = 16;
+
+// 对用户哈希再混合一次，保证恒等哈希（整型、指针）的低位与高位都有足够熵
+inline uint64_t Mix(uint64_t h) {
+    h ^= h >> 32;
+    h *= 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+inline int8_t H2(uint64_t hash) {
+    return (int8_t)(hash & 0x7f);
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// 一组 16 个控制字节，match* 返回命中位置的位掩码
+class Group {
+   public:
+#if defined(__SSE2__)
+    explicit Group(const int8_t* ctrl) : m_ctrl(_mm_load_si128((const __m128i*)ctrl)) {}
+
+    uint32_t match(int8_t h2) const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(h2)));
+    }
+    uint32_t matchEmpty() const {
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(kEmpty)));
+    }
+    // 空与已删除的最高位均为 1
+    uint32_t matchEmptyOrDeleted() const { return _mm_movemask_epi8(m_ctrl); }
+
+   private:
+    __m128i m_ctrl;
+#else
+    explicit Group(const int8_t* ctrl) { memcpy(m_ctrl, ctrl, kGroupWidth); }
+
+    uint32_t match(int8_t h2) const {
+        uint32_t m = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            m |= (uint32_t)(m_ctrl[i] == h2) << i;
+        }
+        return m;
+    }
+    uint32_t matchEmpty() const { return match(kEmpty); }
+    uint32_t matchEmptyOrDeleted() const {
+        uint32_t m = 0;
+        for (size_t i = 0; i < kGroupWidth; ++i) {
+            m |= (uint32_t)(m_ctrl[i] < 0) << i;
+        }
+        return m;
+    }
+
+   private:
+    int8_t m_ctrl[kGroupWidth];
+#endif
+};
+
+// 一张定长的表：控制字节 + 槽位；扩容时整体换表
+template <class K, class V>
+struct Table {
+    typedef Pair<K, V> Slot;
+
+    size_t capacity = 0;     /// 槽位数，2 的幂且不小于 kGroupWidth
+    size_t size = 0;         /// 占用的槽位数
+    size_t growth_left = 0;  /// 还能占用的空槽数（负载上限 7/8，已删除槽不计入）
+    int8_t* ctrl = nullptr;
+    Slot* slots = nullptr;
+
+    static size_t MaxLoad(size_t capacity) { return capacity - capacity / 8; }
+
+    // 容纳 n 个元素所需的最小容量
+    static size_t CapacityFor(size_t n) {
+        size_t cap = kGroupWidth;
+        while (MaxLoad(cap) < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    static Table* Create(size_t capacity) {
+        Table* t = new Table();
+        t->capacity = capacity;
+        t->growth_left = MaxLoad(capacity);
+        t->ctrl = static_cast<int8_t*>(::operator new(capacity, std::align_val_t(kGroupWidth)));
+        memset(t->ctrl, kEmpty, capacity);
+        t->slots = std::allocator<Slot>().allocate(capacity);
+        return t;
+    }
+
+    // 析构元素并释放内存
+    static void Free(Table* t) {
+        if (!t) {
+            return;
+        }
+        t->destroyAll();
+        ::operator delete(t->ctrl, std::align_val_t(kGroupWidth));
+        std::allocator<Slot>().deallocate(t->slots, t->capacity);
+        delete t;
+    }
+
+    // 把 old 的元素移入新表（容量 capacity），old 中的元素被析构但内存保留，由调用方释放
+    template <class HashFn>
+    static Table* Rehash(Table* old, size_t capacity, const HashFn& hashfn) {
+        Table* t = Create(capacity);
+        for (size_t i = 0; i < old->capacity; ++i) {
+            if (old->ctrl[i] < 0) {
+                continue;
+            }
+            const uint64_t hash = hashfn(old->slots[i].first);
+            const size_t pos = t->findInsertPos(hash);
+            t->ctrl[pos] = H2(hash);
+            new (&t->slots[pos]) Slot(std::move(old->slots[i]));
+            old->slots[i].~Slot();
+            old->ctrl[i] = kEmpty;
+        }
+        t->size = old->size;
+        t->growth_left -= old->size;
+        old->size = 0;
+        return t;
+    }
+
+    // 不修改任何状态，可在 seqlock 读路径上与写者并发执行：探测组数有上限，不会死循环
+    template <class Eq>
+    Slot* find(const K& k, uint64_t hash, const Eq& eq) const {
+        const size_t mask = capacity / kGroupWidth - 1;
+        const int8_t h2 = H2(hash);
+        size_t g = (hash >> 7) & mask;
+        for (size_t step = 0; step <= mask; ++step) {
+            Group group(ctrl + g * kGroupWidth);
+            for (uint32_t m = group.match(h2); m; m &= m - 1) {
+                const size_t i = g * kGroupWidth + __builtin_ctz(m);
+                if (eq(slots[i].first, k)) {
+                    return &slots[i];
+                }
+            }
+            if (group.matchEmpty()) {
+                return nullptr;
+            }
+            g = (g + step + 1) & mask;
+        }
+        return nullptr;
+    }
+
+    // 探测序列上第一个空或已删除的槽位；调用方保证 size < capacity
+    size_t findInsertPos(uint64_t hash) const {
+        const size_t mask = capacity / kGroupWidth - 1;
+        size_t g = (hash >> 7) & mask;
+        for (size_t step = 0;; ++step) {
+            uint32_t m = Group(ctrl + g * kGroupWidth).matchEmptyOrDeleted();
+            if (m) {
+                return g * kGroupWidth + __builtin_ctz(m);
+            }
+            g = (g + step + 1) & mask;
+        }
+    }
+
+    // 插入已确认不存在的键；调用方保证 growth_left > 0
+    template <class KK, class VV>
+    Slot* insert(uint64_t hash, KK&& k, VV&& v) {
+        const size_t pos = findInsertPos(hash);
+        if (ctrl[pos] == kEmpty) {
+            --growth_left;
+        }
+        new (&slots[pos]) Slot(std::forward<KK>(k), std::forward<VV>(v));
+        ctrl[pos] = H2(hash);
+        ++size;
+        return &slots[pos];
+    }
+
+    void erase(Slot* slot) {
+        const size_t i = slot - slots;
+        slot->~Slot();
+        // 所在组仍有空槽时，经过该组的探测必然在此结束，可直接置空；否则留下删除标记
+        if (Group(ctrl + (i & ~(kGroupWidth - 1))).matchEmpty()) {
+            ctrl[i] = kEmpty;
+            ++growth_left;
+        } else {
+            ctrl[i] = kDeleted;
+        }
+        --size;
+    }
+
+    void destroyAll() {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0) {
+                slots[i].~Slot();
+            }
+            ctrl[i] = kEmpty;
+        }
+        size = 0;
+        growth_left = MaxLoad(capacity);
+    }
+
+    // 扩容后的容量：删除标记较多时原容量重建，否则翻倍
+    size_t nextCapacity() const { return size * 2 <= MaxLoad(capacity) ? capacity : capacity * 2; }
+
+    template <class F>
+    bool foreach(F f) {
+        for (size_t i = 0; i < capacity; ++i) {
+            if (ctrl[i] >= 0 && !f(slots[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+}  // namespace swiss
+
+/**
+ * @brief 开放寻址哈希表（单线程）
+ * @details 接口与 HashMap 一致（get/set/del/exists/rforeach/wforeach/getTotal），
+ *          另提供 find/operator[]/reserve。非线程安全，并发场景使用 ConcurrentFlatHashMap。
+ */
+template <class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class FlatHashMap : Noncopyable {
+   public:
+    typedef std::shared_ptr<FlatHashMap> ptr;
+    typedef Pair<K, V> value_type;
+
+    typedef std::function<bool(const K& k, const V& v)> rcallback;
+    typedef std::function<bool(const K& k, V& v)> wcallback;
+
+    FlatHashMap(size_t size = 0) : m_table(Table::Create(Table::CapacityFor(size))) {}
+
+    ~FlatHashMap() { Table::Free(m_table); }
+
+    V* find(const K& k) {
+        Slot* slot = m_table->find(k, hashOf(k), m_eq);
+        return slot ? &slot->second : nullptr;
+    }
+
+    bool get(const K& k, V& v) const {
+        const Slot* slot = m_table->find(k, hashOf(k), m_eq);
+        if (!slot) {
+            return false;
+        }
+        v = slot->second;
+        return true;
+    }
+
+    bool exists(const K& k) const { return m_table->find(k, hashOf(k), m_eq) != nullptr; }
+
+    /// 插入或覆盖，返回是否为新插入
+    bool set(const K& k, const V& v) {
+        const uint64_t hash = hashOf(k);
+        Slot* slot = m_table->find(k, hash, m_eq);
+        if (slot) {
+            slot->second = v;
+            return false;
+        }
+        grow();
+        m_table->insert(hash, k, v);
+        return true;
+    }
+
+    V& operator[](const K& k) {
+        const uint64_t hash = hashOf(k);
+        Slot* slot = m_table->find(k, hash, m_eq);
+        if (!slot) {
+            grow();
+            slot = m_table->insert(hash, k, V());
+        }
+        return slot->second;
+    }
+
+    bool del(const K& k) {
+        Slot* slot = m_table->find(k, hashOf(k), m_eq);
+        if (!slot) {
+            return false;
+        }
+        m_table->erase(slot);
+        return true;
+    }
+
+    uint64_t getTotal() const { return m_table->size; }
+    uint64_t getCapacity() const { return m_table->capacity; }
+
+    void reserve(size_t size) {
+        size_t cap = Table::CapacityFor(size);
+        if (cap > m_table->capacity) {
+            rehash(cap);
+        }
+    }
+
+    void clear() { m_table->destroyAll(); }
+
+    void swap(FlatHashMap& oth) { std::swap(m_table, oth.m_table); }
+
+    void rforeach(rcallback cb) const {
+        m_table->foreach([&cb](Slot& s) { return cb(s.first, s.second); });
+    }
+
+    void wforeach(wcallback cb) {
+        m_table->foreach([&cb](Slot& s) { return cb(s.first, s.second); });
+    }
+
+    std::ostream& dump(std::ostream& os) const {
+        os << "[FlatHashMap total=" << m_table->size << " capacity=" << m_table->capacity
+           << " rate=" << (m_table->size * 1.0 / m_table->capacity) << "]" << std::endl;
+        return os;
+    }
+
+   private:
+    typedef swiss::Table<K, V> Table;
+    typedef typename Table::Slot Slot;
+
+    uint64_t hashOf(const K& k) const { return swiss::Mix(m_hash(k)); }
+
+    void grow() {
+        if (m_table->growth_left == 0) {
+            rehash(m_table->nextCapacity());
+        }
+    }
+
+    void rehash(size_t capacity) {
+        Table* t = Table::Rehash(m_table, capacity, [this](const K& k) { return hashOf(k); });
+        Table::Free(m_table);
+        m_table = t;
+    }
+
+   private:
+    Table* m_table;
+    mutable Hash m_hash;  /// 兼容 operator() 非 const 的哈希（如 Murmur3Hash）
+    Eq m_eq;
+};
+
+/**
+ * @brief 分片并发开放寻址哈希表，面向读多写少
+ * @details 按哈希高位分成若干片，每片一张 swiss::Table、一把写锁和一个 seqlock 序号：
+ *          - K/V 均可平凡复制时，读路径不加锁：读序号 -> 查表并拷贝值 -> 校验序号，
+ *            与写者冲突则重试；扩容后旧表内存保留到析构，保证并发读者不会访问已释放内存
+ *            （旧表容量之和小于当前容量）；
+ *          - 否则（如 std::string、shared_ptr）读路径退化为分片读锁。
+ *          写操作只锁所在分片。rforeach/wforeach 逐片加锁遍历，回调中不要再访问本表。
+ */
+template <class K, class V, class Hash = std::hash<K>, class Eq = std::equal_to<K>>
+class ConcurrentFlatHashMap : Noncopyable {
+   public:
+    typedef std::shared_ptr<ConcurrentFlatHashMap> ptr;
+    typedef Pair<K, V> value_type;
+
+    typedef std::function<bool(const K& k, const V& v)> rcallback;
+    typedef std::function<bool(const K& k, V& v)> wcallback;
+
+    /// 读路径是否为无锁的 seqlock 模式
+    static constexpr bool kOptimistic =
+        std::is_trivially_copyable<K>::value && std::is_trivially_copyable<V>::value;
+
+    ConcurrentFlatHashMap(uint32_t shards = 64, size_t size = 0) {
+        m_shardNum = 1;
+        while (m_shardNum < shards) {
+            m_shardNum <<= 1;
+        }
+        m_shards.reset(new Shard[m_shardNum]);
+        const size_t cap = Table::CapacityFor(size / m_shardNum + 1);
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            m_shards[i].table.store(Table::Create(cap), std::memory_order_relaxed);
+        }
+    }
+
+    ~ConcurrentFlatHashMap() {
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Table::Free(m_shards[i].table.load(std::memory_order_relaxed));
+            for (auto t : m_shards[i].retired) {
+                Table::Free(t);
+            }
+        }
+    }
+
+    bool get(const K& k, V& v) const {
+        return read(k, [&v](const Slot* slot) {
+            if (slot) {
+                v = slot->second;
+            }
+        });
+    }
+
+    bool exists(const K& k) const {
+        return read(k, [](const Slot*) {});
+    }
+
+    /// 插入或覆盖，返回是否为新插入
+    bool set(const K& k, const V& v) {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        RWMutex::WriteLock lock(s.mutex);
+        SeqWriteGuard guard(s.seq);
+        Table* t = s.table.load(std::memory_order_relaxed);
+        Slot* slot = t->find(k, hash, m_eq);
+        if (slot) {
+            slot->second = v;
+            return false;
+        }
+        if (t->growth_left == 0) {
+            t = grow(s, t);
+        }
+        t->insert(hash, k, v);
+        m_total.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool del(const K& k) {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        RWMutex::WriteLock lock(s.mutex);
+        Table* t = s.table.load(std::memory_order_relaxed);
+        Slot* slot = t->find(k, hash, m_eq);
+        if (!slot) {
+            return false;
+        }
+        SeqWriteGuard guard(s.seq);
+        t->erase(slot);
+        m_total.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint64_t getTotal() const { return m_total.load(std::memory_order_relaxed); }
+
+    void clear() {
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            RWMutex::WriteLock lock(s.mutex);
+            SeqWriteGuard guard(s.seq);
+            Table* t = s.table.load(std::memory_order_relaxed);
+            m_total.fetch_sub(t->size, std::memory_order_relaxed);
+            t->destroyAll();
+        }
+    }
+
+    void rforeach(rcallback cb) const {
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            RWMutex::ReadLock lock(s.mutex);
+            if (!s.table.load(std::memory_order_relaxed)->foreach(
+                    [&cb](Slot& n) { return cb(n.first, n.second); })) {
+                return;
+            }
+        }
+    }
+
+    void wforeach(wcallback cb) {
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            RWMutex::WriteLock lock(s.mutex);
+            SeqWriteGuard guard(s.seq);
+            if (!s.table.load(std::memory_order_relaxed)->foreach(
+                    [&cb](Slot& n) { return cb(n.first, n.second); })) {
+                return;
+            }
+        }
+    }
+
+    std::ostream& dump(std::ostream& os) const {
+        uint64_t capacity = 0;
+        uint64_t retired = 0;
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            RWMutex::ReadLock lock(m_shards[i].mutex);
+            capacity += m_shards[i].table.load(std::memory_order_relaxed)->capacity;
+            retired += m_shards[i].retired.size();
+        }
+        os << "[ConcurrentFlatHashMap total=" << getTotal() << " shards=" << m_shardNum
+           << " capacity=" << capacity << " retired=" << retired
+           << " optimistic=" << kOptimistic << "]" << std::endl;
+        return os;
+    }
+
+   private:
+    typedef swiss::Table<K, V> Table;
+    typedef typename Table::Slot Slot;
+
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> seq{0};      /// 奇数表示写者正在修改
+        std::atomic<Table*> table{nullptr};
+        mutable RWMutex mutex;             /// 写者互斥；非 seqlock 模式下也用于读
+        std::vector<Table*> retired;       /// seqlock 模式下扩容换下的旧表
+    };
+
+    // seqlock 写端：进入时序号变奇数，退出时变偶数
+    struct SeqWriteGuard {
+        SeqWriteGuard(std::atomic<uint64_t>& seq) : m_seq(seq) {
+            m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        ~SeqWriteGuard() {
+            m_seq.store(m_seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+        std::atomic<uint64_t>& m_seq;
+    };
+
+    uint64_t hashOf(const K& k) const { return swiss::Mix(m_hash(k)); }
+
+    // 分片取哈希高位，表内组序号取低位，两者互不相关
+    Shard& shardOf(uint64_t hash) const { return m_shards[(hash >> 40) & (m_shardNum - 1)]; }
+
+    // cb 在找到/未找到时以槽位指针（可能为空）调用一次，seqlock 模式下可能因重试被多次调用
+    template <class F>
+    bool read(const K& k, const F& cb) const {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        if constexpr (kOptimistic) {
+            for (;;) {
+                const uint64_t seq = s.seq.load(std::memory_order_acquire);
+                if (seq & 1) {
+                    swiss::CpuRelax();
+                    continue;
+                }
+                const Table* t = s.table.load(std::memory_order_acquire);
+                const Slot* slot = t->find(k, hash, m_eq);
+                cb(slot);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) == seq) {
+                    return slot != nullptr;
+                }
+            }
+        } else {
+            RWMutex::ReadLock lock(s.mutex);
+            const Slot* slot = s.table.load(std::memory_order_relaxed)->find(k, hash, m_eq);
+            cb(slot);
+            return slot != nullptr;
+        }
+    }
+
+    Table* grow(Shard& s, Table* old) {
+        Table* t =
+            Table::Rehash(old, old->nextCapacity(), [this](const K& k) { return hashOf(k); });
+        s.table.store(t, std::memory_order_release);
+        if (kOptimistic) {
+            s.retired.push_back(old);
+        } else {
+            Table::Free(old);
+        }
+        return t;
+    }
+
+   private:
+    uint32_t m_shardNum;
+    std::unique_ptr<Shard[]> m_shards;
+    std::atomic<uint64_t> m_total{0};
+    mutable Hash m_hash;  /// 兼容 operator() 非 const 的哈希（如 Murmur3Hash）
+    Eq m_eq;
+};
+
+}  // namespace IM::ds
+
+#endif // __IM_DS_FLAT_HASH_MAP_HPP__
@@ -5,10 +5,10 @@
 #include <iostream>
 #include <memory>
 
-#include "ds_util.hpp"
-#include "lock.hpp"
+#include "ds/ds_util.hpp"
+#include "io/lock.hpp"
 #include "base/macro.hpp"
-#include "util.hpp"
+#include "util/util.hpp"
 
 namespace IM::ds {
 template <class K, class V, class PosHash = Murmur3Hash<K>>
@@ -8,8 +8,8 @@
 #include <unordered_map>
 #include <vector>
 
-#include "cache_status.hpp"
-#include "lock.hpp"
+#include "ds/cache_status.hpp"
+#include "io/lock.hpp"
 
 namespace IM::ds {
 template <class K, class V, class MutexType = Mutex>
@@ -29,6 +29,8 @@ class RoaringBitmap {
     void set(uint32_t idx, bool v);
 
     void set(uint32_t from, uint32_t size, bool v);
+    // 批量置位（无需有序，可重复）
+    void addMany(size_t n, const uint32_t* vals);
     bool get(uint32_t from, uint32_t size, bool v) const;
 
     RoaringBitmap& operator&=(const RoaringBitmap& b);
@@ -59,6 +61,14 @@ class RoaringBitmap {
     void writeTo(ByteArray::ptr ba) const;
     bool readFrom(ByteArray::ptr ba);
 
+    // 以紧凑格式追加序列化结果到 out（不带长度前缀；稀疏位图退化为 uint32 数组）
+    void writeTo(std::string& out) const;
+    // 从紧凑格式的内存块反序列化，数据损坏或越界返回 false
+    bool readFrom(const char* data, size_t size);
+
+    // 尽量转换为 run 容器（序列化前调用）
+    bool runOptimize();
+
     // uncompress to compress
     // uncompress to uncompress
     bool cross(const RoaringBitmap& b) const;
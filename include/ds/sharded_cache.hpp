@@ -0,0 +1,539 @@
+#ifndef __IM_DS_SHARDED_CACHE_HPP__
+#define __IM_DS_SHARDED_CACHE_HPP__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "ds/cache_status.hpp"
+#include "ds/flat_hash_map.hpp"
+#include "io/lock.hpp"
+#include "util/time_util.hpp"
+
+namespace IM::ds {
+
+/**
+ * @brief TinyLFU 频率草图
+ * @details 4 行 count-min，每个计数器 4 位（每个 uint64 存 16 个），上限 15；
+ *          累计增量达到容量的 10 倍后全体减半，使频率随时间衰减。
+ *          非线程安全：由 ShardedCache 在分片独占锁下更新和读取（包括减半），只有一个写者。
+ */
+class FrequencySketch {
+   public:
+    void init(size_t capacity) {
+        size_t width = 64;
+        while (width < capacity * 4) {
+            width <<= 1;
+        }
+        m_mask = width - 1;
+        m_rowWords = width / 16;
+        m_words.reset(new uint64_t[m_rowWords * kDepth]());
+        m_sampleSize = std::max<size_t>(capacity * 10, 64);
+        m_additions = 0;
+    }
+
+    void increment(uint64_t hash) {
+        bool added = false;
+        for (int i = 0; i < kDepth; ++i) {
+            size_t idx = index(hash, i);
+            uint64_t& word = m_words[i * m_rowWords + idx / 16];
+            const int shift = (idx & 15) * 4;
+            if (((word >> shift) & 0xf) < 15) {
+                word += 1ULL << shift;
+                added = true;
+            }
+        }
+        if (added && ++m_additions >= m_sampleSize) {
+            reset();
+        }
+    }
+
+    uint32_t estimate(uint64_t hash) const {
+        uint32_t freq = 15;
+        for (int i = 0; i < kDepth; ++i) {
+            size_t idx = index(hash, i);
+            const uint64_t w = m_words[i * m_rowWords + idx / 16];
+            freq = std::min<uint32_t>(freq, (w >> ((idx & 15) * 4)) & 0xf);
+        }
+        return freq;
+    }
+
+   private:
+    static constexpr int kDepth = 4;
+
+    // 双重哈希选取各行的计数器
+    size_t index(uint64_t hash, int i) const {
+        const uint32_t h1 = (uint32_t)hash;
+        const uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+        return (h1 + i * h2) & m_mask;
+    }
+
+    void reset() {
+        for (size_t i = 0; i < m_rowWords * kDepth; ++i) {
+            m_words[i] = (m_words[i] >> 1) & 0x7777777777777777ULL;
+        }
+        m_additions = m_sampleSize / 2;
+    }
+
+   private:
+    std::unique_ptr<uint64_t[]> m_words;
+    size_t m_mask = 0;
+    size_t m_rowWords = 0;
+    size_t m_sampleSize = 0;
+    size_t m_additions = 0;
+};
+
+/**
+ * @brief 分片并发缓存：CLOCK 淘汰 + TinyLFU 准入 + 时间轮 TTL
+ * @details - 按哈希高位分成若干独立分片；每个分片再按线程分成若干条纹（默认取硬件线程数，
+ *            上限 16），每个条纹一把读写锁和一个读缓冲区，线程固定使用同一条纹；
+ *          - get 只持所在条纹的读锁：置访问位（已置位则不写），把键哈希追加到条纹的读缓冲，
+ *            读次数/命中数计在条纹上，不写其它线程共享的缓存行；
+ *          - 写操作持分片全部条纹的写锁（独占），并顺带把读缓冲排空到频率草图；读缓冲写满时
+ *            由 get 尝试非阻塞地独占排空，拿不到锁则丢弃后续记录，直到下次排空；
+ *          - 分片满时 CLOCK 指针扫描，跳过并清除访问位，选出淘汰候选；新键的访问频率
+ *            低于候选时拒绝写入，避免一次性扫描把热点挤出；访问频率只在 get 时记录，
+ *            先 get 未命中再 set 的用法下不会重复计数；
+ *          - 带 TTL 的条目挂在每片 256 格的时间轮上，set/checkTimeout 时推进时间轮回收，
+ *            get 时按过期时间惰性判定，不依赖回收频率；
+ *          - 统计按分片和条纹累计，getStatus 合并为一个 CacheStatus。
+ *          淘汰与过期回收会调用 prune 回调（在分片写锁内），del 与 clear 不调用。
+ */
+template <class K, class V, class Hash = std::hash<K>>
+class ShardedCache {
+   public:
+    typedef std::shared_ptr<ShardedCache> ptr;
+    typedef std::function<void(const K&, const V&)> prune_callback;
+
+    /**
+     * @param[in] max_size 最大条目数，按分片均分（向上取整）
+     * @param[in] shards 分片数，取不小于它的 2 的幂
+     * @param[in] tick_ms 时间轮刻度（毫秒）
+     * @param[in] stripes 每个分片的条纹数，取不小于它的 2 的幂；0 表示取硬件线程数（上限 16）
+     */
+    ShardedCache(size_t max_size, uint32_t shards = 64, uint32_t tick_ms = 1000,
+                 uint32_t stripes = 0)
+        : m_tickMs(std::max<uint32_t>(tick_ms, 1)) {
+        m_shardNum = 1;
+        while (m_shardNum < shards) {
+            m_shardNum <<= 1;
+        }
+        const uint32_t per = std::max<size_t>((max_size + m_shardNum - 1) / m_shardNum, 1);
+        m_maxSize = (size_t)per * m_shardNum;
+        if (!stripes) {
+            stripes = std::min(std::thread::hardware_concurrency(), kMaxStripes);
+        }
+        m_stripeNum = 1;
+        while (m_stripeNum < stripes) {
+            m_stripeNum <<= 1;
+        }
+        m_shards.reset(new Shard[m_shardNum]);
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            s.stripes.reset(new Stripe[m_stripeNum]);
+            s.capacity = per;
+            s.entries.reset(new Entry[per]);
+            s.index.reserve(per);
+            s.free.reserve(per);
+            for (uint32_t j = per; j > 0; --j) {
+                s.free.push_back(j - 1);
+            }
+            s.sketch.init(per);
+            s.wheel.assign(kWheelSize, kNil);
+        }
+    }
+
+    /**
+     * @brief 写入或覆盖
+     * @param[in] ttl_ms 存活时间，0 表示不过期
+     * @return 是否写入；新键因访问频率低于淘汰候选被拒绝时返回 false
+     */
+    bool set(const K& k, const V& v, uint64_t ttl_ms = 0) {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        s.status.incSet();
+        const uint64_t now = IM::TimeUtil::NowToMS();
+        const uint64_t expire = ttl_ms ? now + ttl_ms : 0;
+
+        ShardLock lock(s, m_stripeNum);
+        drain(s);
+        advance(s, now);
+        uint32_t idx = 0;
+        if (s.index.get(k, idx)) {
+            Entry& e = s.entries[idx];
+            e.val = v;
+            e.ref.store(1, std::memory_order_relaxed);
+            setExpire(s, idx, expire);
+            return true;
+        }
+        if (s.free.empty()) {
+            const uint32_t victim = findVictim(s, now);
+            Entry& ve = s.entries[victim];
+            const bool expired = ve.expire && ve.expire <= now;
+            if (!expired && s.sketch.estimate(hash) < s.sketch.estimate(hashOf(ve.key))) {
+                ++s.rejected;
+                return false;
+            }
+            evict(s, victim, expired);
+        }
+        idx = s.free.back();
+        s.free.pop_back();
+        Entry& e = s.entries[idx];
+        e.key = k;
+        e.val = v;
+        e.used = true;
+        e.ref.store(0, std::memory_order_relaxed);
+        s.index.set(k, idx);
+        setExpire(s, idx, expire);
+        return true;
+    }
+
+    bool get(const K& k, V& v) {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        Stripe& st = stripeOf(s);
+        bool hit = false;
+        uint32_t n = 0;
+        {
+            RWMutex::ReadLock lock(st.mutex);
+            n = record(st, hash);
+            uint32_t idx = 0;
+            if (s.index.get(k, idx)) {
+                Entry& e = s.entries[idx];
+                if (!e.expire || e.expire > IM::TimeUtil::NowToMS()) {
+                    if (!e.ref.load(std::memory_order_relaxed)) {
+                        e.ref.store(1, std::memory_order_relaxed);
+                    }
+                    v = e.val;
+                    st.hits.fetch_add(1, std::memory_order_relaxed);
+                    hit = true;
+                }
+            }
+        }
+        // 每写满一轮缓冲区尝试排空一次
+        if (n % kBufferSize == 0) {
+            tryDrain(s);
+        }
+        return hit;
+    }
+
+    V get(const K& k) {
+        V v{};
+        get(k, v);
+        return v;
+    }
+
+    bool del(const K& k) {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        s.status.incDel();
+        ShardLock lock(s, m_stripeNum);
+        uint32_t idx = 0;
+        if (!s.index.get(k, idx)) {
+            return false;
+        }
+        remove(s, idx);
+        return true;
+    }
+
+    bool exists(const K& k) const {
+        const uint64_t hash = hashOf(k);
+        Shard& s = shardOf(hash);
+        RWMutex::ReadLock lock(stripeOf(s).mutex);
+        uint32_t idx = 0;
+        if (!s.index.get(k, idx)) {
+            return false;
+        }
+        const uint64_t expire = s.entries[idx].expire;
+        return !expire || expire > IM::TimeUtil::NowToMS();
+    }
+
+    size_t size() const {
+        size_t total = 0;
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            RWMutex::ReadLock lock(stripeOf(m_shards[i]).mutex);
+            total += m_shards[i].capacity - m_shards[i].free.size();
+        }
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    void clear() {
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            ShardLock lock(s, m_stripeNum);
+            for (uint32_t j = 0; j < s.capacity; ++j) {
+                if (s.entries[j].used) {
+                    remove(s, j);
+                }
+            }
+        }
+    }
+
+    /// 推进所有分片的时间轮，回收已过期条目，返回回收数量
+    size_t checkTimeout(const uint64_t& ts = IM::TimeUtil::NowToMS()) {
+        size_t count = 0;
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            Shard& s = m_shards[i];
+            ShardLock lock(s, m_stripeNum);
+            count += advance(s, ts);
+        }
+        return count;
+    }
+
+    size_t getMaxSize() const { return m_maxSize; }
+    uint32_t getShardNum() const { return m_shardNum; }
+
+    /// 需在并发使用前设置
+    void setPruneCallback(prune_callback cb) { m_cb = cb; }
+
+    /// 各分片统计之和
+    CacheStatus getStatus() const {
+        CacheStatus status;
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            status.merge(m_shards[i].status);
+            for (uint32_t j = 0; j < m_stripeNum; ++j) {
+                const Stripe& st = m_shards[i].stripes[j];
+                status.incGet(st.gets.load(std::memory_order_relaxed));
+                status.incHit(st.hits.load(std::memory_order_relaxed));
+            }
+        }
+        return status;
+    }
+
+    /// 因访问频率不足被拒绝写入的次数
+    uint64_t getRejected() const {
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < m_shardNum; ++i) {
+            RWMutex::ReadLock lock(stripeOf(m_shards[i]).mutex);
+            total += m_shards[i].rejected;
+        }
+        return total;
+    }
+
+    std::string toStatusString() const {
+        std::stringstream ss;
+        ss << getStatus().toString() << " total=" << size() << " rejected=" << getRejected();
+        return ss.str();
+    }
+
+   private:
+    static constexpr uint32_t kNil = (uint32_t)-1;
+    static constexpr uint32_t kWheelSize = 256;
+    static constexpr uint32_t kMaxStripes = 16;
+    static constexpr uint32_t kBufferSize = 16;
+
+    struct Entry {
+        K key{};
+        V val{};
+        uint64_t expire = 0;          /// 过期时间（毫秒），0 表示不过期
+        uint32_t wslot = 0;           /// 所在时间轮格
+        uint32_t wprev = kNil;        /// 时间轮链表
+        uint32_t wnext = kNil;
+        std::atomic<uint8_t> ref{0};  /// CLOCK 访问位
+        bool used = false;
+    };
+
+    // 线程条纹：读者只写本条纹所在的缓存行
+    struct alignas(64) Stripe {
+        mutable RWMutex mutex;            /// get 持读锁，写操作持全部条纹的写锁
+        std::atomic<uint32_t> tail{0};    /// 读缓冲已追加次数，超过容量的记录被丢弃
+        std::atomic<uint64_t> gets{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> buffer[kBufferSize];  /// 待计入频率草图的键哈希
+    };
+
+    struct alignas(64) Shard {
+        std::unique_ptr<Stripe[]> stripes;
+        FlatHashMap<K, uint32_t, Hash> index;  /// key -> entries 下标
+        std::unique_ptr<Entry[]> entries;
+        std::vector<uint32_t> free;            /// 空闲下标
+        uint32_t capacity = 0;
+        uint32_t hand = 0;                     /// CLOCK 指针
+        FrequencySketch sketch;
+        std::vector<uint32_t> wheel;           /// 每格链表头
+        uint64_t tick = 0;                     /// 时间轮已处理到的刻度
+        uint64_t rejected = 0;
+        CacheStatus status;
+    };
+
+    uint64_t hashOf(const K& k) const { return swiss::Mix(m_hash(k)); }
+
+    Shard& shardOf(uint64_t hash) const { return m_shards[(hash >> 40) & (m_shardNum - 1)]; }
+
+    Stripe& stripeOf(const Shard& s) const { return s.stripes[ThreadProbe() & (m_stripeNum - 1)]; }
+
+    // 线程首次使用时分配的序号，用于选择条纹
+    static uint32_t ThreadProbe() {
+        static std::atomic<uint32_t> s_next{0};
+        static thread_local uint32_t t_probe = s_next.fetch_add(1, std::memory_order_relaxed);
+        return t_probe;
+    }
+
+    // 独占分片：按下标顺序获取全部条纹的写锁
+    class ShardLock : Noncopyable {
+       public:
+        ShardLock(Shard& s, uint32_t n) : m_shard(s), m_num(n) {
+            for (uint32_t i = 0; i < m_num; ++i) {
+                m_shard.stripes[i].mutex.wrlock();
+            }
+        }
+        ~ShardLock() {
+            for (uint32_t i = m_num; i > 0; --i) {
+                m_shard.stripes[i - 1].mutex.unlock();
+            }
+        }
+
+       private:
+        Shard& m_shard;
+        uint32_t m_num;
+    };
+
+    // 记录一次读（需持有条纹读锁），返回本轮追加后的计数
+    static uint32_t record(Stripe& st, uint64_t hash) {
+        st.gets.fetch_add(1, std::memory_order_relaxed);
+        const uint32_t t = st.tail.fetch_add(1, std::memory_order_relaxed);
+        if (t < kBufferSize) {
+            st.buffer[t].store(hash, std::memory_order_relaxed);
+        }
+        return t + 1;
+    }
+
+    // 非阻塞地独占分片并排空读缓冲，任一条纹被占用则放弃
+    void tryDrain(Shard& s) {
+        uint32_t locked = 0;
+        while (locked < m_stripeNum && s.stripes[locked].mutex.trywrlock()) {
+            ++locked;
+        }
+        if (locked == m_stripeNum) {
+            drain(s);
+        }
+        while (locked > 0) {
+            s.stripes[--locked].mutex.unlock();
+        }
+    }
+
+    // 以下函数需独占分片（持有全部条纹的写锁）
+
+    // 把各条纹读缓冲中的访问计入频率草图
+    void drain(Shard& s) {
+        for (uint32_t i = 0; i < m_stripeNum; ++i) {
+            Stripe& st = s.stripes[i];
+            const uint32_t n = std::min(st.tail.load(std::memory_order_relaxed), kBufferSize);
+            for (uint32_t j = 0; j < n; ++j) {
+                s.sketch.increment(st.buffer[j].load(std::memory_order_relaxed));
+            }
+            st.tail.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t findVictim(Shard& s, uint64_t now) {
+        // 每个条目至多被跳过一次（清除访问位后第二圈必然选中）
+        for (uint32_t n = 0; n <= s.capacity * 2; ++n) {
+            const uint32_t i = s.hand;
+            s.hand = (s.hand + 1) % s.capacity;
+            Entry& e = s.entries[i];
+            if (!e.used) {
+                continue;
+            }
+            if ((e.expire && e.expire <= now) || !e.ref.load(std::memory_order_relaxed)) {
+                return i;
+            }
+            e.ref.store(0, std::memory_order_relaxed);
+        }
+        return s.hand;
+    }
+
+    void evict(Shard& s, uint32_t idx, bool timeout) {
+        Entry& e = s.entries[idx];
+        if (m_cb) {
+            m_cb(e.key, e.val);
+        }
+        if (timeout) {
+            s.status.incTimeout();
+        } else {
+            s.status.incPrune();
+        }
+        remove(s, idx);
+    }
+
+    void remove(Shard& s, uint32_t idx) {
+        Entry& e = s.entries[idx];
+        setExpire(s, idx, 0);
+        s.index.del(e.key);
+        e.key = K();
+        e.val = V();
+        e.used = false;
+        e.ref.store(0, std::memory_order_relaxed);
+        s.free.push_back(idx);
+    }
+
+    void setExpire(Shard& s, uint32_t idx, uint64_t expire) {
+        Entry& e = s.entries[idx];
+        if (e.expire) {
+            // 摘出时间轮
+            if (e.wprev != kNil) {
+                s.entries[e.wprev].wnext = e.wnext;
+            } else {
+                s.wheel[e.wslot] = e.wnext;
+            }
+            if (e.wnext != kNil) {
+                s.entries[e.wnext].wprev = e.wprev;
+            }
+            e.wprev = e.wnext = kNil;
+        }
+        e.expire = expire;
+        if (!expire) {
+            return;
+        }
+        // 已经过去的刻度不会再被处理，至少挂到下一格（其间由 get 惰性判定过期）
+        e.wslot = std::max(expire / m_tickMs, s.tick + 1) % kWheelSize;
+        uint32_t& head = s.wheel[e.wslot];
+        e.wnext = head;
+        if (head != kNil) {
+            s.entries[head].wprev = idx;
+        }
+        head = idx;
+    }
+
+    // 处理 (tick, now] 之间的各格，超过一圈时每格只处理一次
+    size_t advance(Shard& s, uint64_t now) {
+        const uint64_t now_tick = now / m_tickMs;
+        if (s.tick == 0 || now_tick <= s.tick) {
+            s.tick = std::max(s.tick, now_tick);
+            return 0;
+        }
+        size_t count = 0;
+        const uint64_t steps = std::min<uint64_t>(now_tick - s.tick, kWheelSize);
+        for (uint64_t t = s.tick + 1; t <= s.tick + steps; ++t) {
+            uint32_t idx = s.wheel[t % kWheelSize];
+            while (idx != kNil) {
+                const uint32_t next = s.entries[idx].wnext;
+                if (s.entries[idx].expire <= now) {
+                    evict(s, idx, true);
+                    ++count;
+                }
+                idx = next;
+            }
+        }
+        s.tick = now_tick;
+        return count;
+    }
+
+   private:
+    uint32_t m_shardNum;
+    uint32_t m_stripeNum;
+    size_t m_maxSize;
+    uint32_t m_tickMs;
+    std::unique_ptr<Shard[]> m_shards;
+    prune_callback m_cb;
+    mutable Hash m_hash;
+};
+
+}  // namespace IM::ds
+
+#endif // __IM_DS_SHARDED_CACHE_HPP__
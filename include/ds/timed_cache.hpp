@@ -1,12 +1,18 @@
 #ifndef __IM_DS_TIMED_CACHE_HPP__
 #define __IM_DS_TIMED_CACHE_HPP__
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <set>
+#include <sstream>
 #include <unordered_map>
+#include <vector>
 
-#include "cache_status.hpp"
-#include "lock.hpp"
-#include "util.hpp"
+#include "ds/cache_status.hpp"
+#include "io/lock.hpp"
+#include "util/time_util.hpp"
+#include "util/util.hpp"
 
 namespace IM::ds {
 template <class K, class V, class RWMutexType = RWMutex>
@@ -54,7 +60,7 @@ class TimedCache {
         if (it != m_cache.end()) {
             m_cache.erase(it);
         }
-        auto sit = m_timed.insert(Item(k, v, expired + GetCurrentMS()));
+        auto sit = m_timed.insert(Item(k, v, expired + IM::TimeUtil::NowToMS()));
         m_cache.insert(std::make_pair(k, sit.first));
         prune();
     }
@@ -96,6 +102,7 @@ class TimedCache {
         m_cache.erase(it);
         lock.unlock();
         m_status->incHit();
+        return true;
     }
 
     bool expired(const K& k, const uint64_t& ts) {
@@ -104,7 +111,7 @@ class TimedCache {
         if (it == m_cache.end()) {
             return false;
         }
-        uint64_t tts = ts + GetCurrentMS();
+        uint64_t tts = ts + IM::TimeUtil::NowToMS();
         if (it->second->ts == tts) {
             return true;
         }
@@ -173,7 +180,7 @@ class TimedCache {
         }
     }
 
-    size_t checkTimeout(const uint64_t& ts = GetCurrentMS()) {
+    size_t checkTimeout(const uint64_t& ts = IM::TimeUtil::NowToMS()) {
         size_t size = 0;
         typename RWMutexType::WriteLock lock(m_mutex);
         for (auto it = m_timed.begin(); it != m_timed.end();) {
@@ -327,7 +334,7 @@ class HashTimedCache {
         return ss.str();
     }
 
-    size_t checkTimeout(const uint64_t& ts = GetCurrentMS()) {
+    size_t checkTimeout(const uint64_t& ts = IM::TimeUtil::NowToMS()) {
         size_t size = 0;
         for (auto& i : m_datas) {
             size += i->checkTimeout(ts);
@@ -545,6 +545,32 @@ class HttpRequest {
     uint8_t m_parserParamFlag;  /// 参数是否已解析
 };
 
+/**
+     * @brief 文件响应体
+     * @details 持有一个只读文件描述符，析构时关闭；可被多个响应共享（如静态文件的 fd 缓存），
+     *          由 HttpSession::sendResponse 以 sendfile 发送
+     */
+class HttpFile {
+   public:
+    /// 智能指针类型定义
+    using ptr = std::shared_ptr<HttpFile>;
+
+    /**
+         * @brief 构造函数
+         * @param[in] fd 已打开的文件描述符（所有权转移给 HttpFile）
+         * @param[in] size 文件大小
+         */
+    HttpFile(int fd, uint64_t size) : m_fd(fd), m_size(size) {}
+    ~HttpFile();
+
+    int getFd() const { return m_fd; }
+    uint64_t getSize() const { return m_size; }
+
+   private:
+    int m_fd;
+    uint64_t m_size;
+};
+
 /**
      * @brief HTTP响应结构体
      */
@@ -609,6 +635,21 @@ class HttpResponse {
          */
     void setBody(const std::string& v);
 
+    /**
+         * @brief 以文件区间作为响应消息体（不读入内存）
+         * @param[in] file 文件
+         * @param[in] offset 起始偏移
+         * @param[in] length 长度
+         */
+    void setFileBody(HttpFile::ptr file, uint64_t offset, uint64_t length);
+
+    /**
+         * @brief 返回文件响应体，未设置时为nullptr
+         */
+    const HttpFile::ptr& getFile() const { return m_file; }
+    uint64_t getFileOffset() const { return m_fileOffset; }
+    uint64_t getFileLength() const { return m_fileLength; }
+
     /**
          * @brief 设置响应原因
          * @param[in] v 原因
@@ -727,6 +768,9 @@ class HttpResponse {
     std::string m_reason;                /// 响应原因
     MapType m_headers;                   /// 响应头部MAP
     std::vector<std::string> m_cookies;  /// Cookie列表
+    HttpFile::ptr m_file;                /// 文件响应体
+    uint64_t m_fileOffset = 0;           /// 文件响应体起始偏移
+    uint64_t m_fileLength = 0;           /// 文件响应体长度
 };
 
 /**
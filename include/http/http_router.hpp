@@ -0,0 +1,89 @@
+#ifndef __IM_HTTP_HTTP_ROUTER_HPP__
+#define __IM_HTTP_HTTP_ROUTER_HPP__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "http.hpp"
+#include "http_servlet.hpp"
+
+namespace IM::http {
+
+/**
+     * @brief 编译后的路由表（基数树）
+     *
+     * 构建完成后只读，可被多个线程无锁并发查询；路由变更时由 ServletDispatch 整体重建。
+     * 支持的路由写法：
+     * - 精确路径：/api/v1/user/detail
+     * - 路径参数：/api/v1/user/:uid，:uid 匹配到下一个 '/' 为止，匹配值写入请求参数
+     * - 前缀通配：/wss/ 后跟单个 '*'（只允许出现在末尾），匹配剩余任意字符，最长前缀优先
+     * - 其他 fnmatch 通配（含 '?'、'[' 或中间的 '*'）：树中无匹配时按添加顺序逐个 fnmatch
+     * 匹配优先级：静态路径 > 路径参数 > 前缀通配 > fnmatch 通配。
+     * 不含参数的静态路径另建一张哈希索引，命中时一次查找即可返回，无需逐字节走树。
+     */
+class HttpRouter {
+   public:
+    typedef std::shared_ptr<const HttpRouter> ptr;
+    typedef std::vector<std::pair<std::string, std::string>> ParamList;
+
+    /**
+         * @brief 路由定义
+         */
+    struct Route {
+        std::string pattern;                             ///< 路由路径
+        HttpMethod method = HttpMethod::INVALID_METHOD;  ///< INVALID_METHOD 表示不区分方法
+        bool glob = false;                               ///< 是否为通配路由
+        IServletCreator::ptr creator;
+    };
+
+    /**
+         * @brief 匹配结果
+         */
+    struct Result {
+        Servlet::ptr servlet;            ///< 匹配到的 servlet，未匹配为空
+        bool method_not_allowed = false;  ///< 路径命中但没有对应方法的处理器
+    };
+
+    /**
+         * @brief 构建路由表，非法路由记录错误日志后跳过
+         * @param[in] routes 路由列表，同一通配路由以先出现的为准
+         */
+    explicit HttpRouter(const std::vector<Route>& routes);
+    ~HttpRouter();
+
+    /**
+         * @brief 查找路由
+         * @param[in] method 请求方法，INVALID_METHOD 表示只匹配不区分方法的路由
+         * @param[in] path 请求路径
+         * @param[out] params 路径参数（可为空）
+         */
+    Result match(HttpMethod method, const std::string& path, ParamList* params = nullptr) const;
+
+    size_t size() const { return m_size; }
+
+   private:
+    struct Target;
+    struct Handlers;
+    struct Node;
+
+    bool insert(const Route& r);
+    // 把静态文本插入 node 之下，返回文本结束处的节点
+    static Node* InsertStatic(Node* node, std::string s);
+    static Servlet::ptr Resolve(const Target& t);
+    const Handlers* find(const Node* node, const std::string& path, size_t pos,
+                         ParamList* params) const;
+    Result select(const Handlers* h, HttpMethod method) const;
+
+   private:
+    std::unique_ptr<Node> m_root;
+    std::unordered_map<std::string, const Handlers*> m_statics;  ///< 静态路径 -> 树中的叶子
+    std::vector<std::pair<std::string, std::unique_ptr<Handlers>>> m_globs;  ///< fnmatch 通配
+    size_t m_size = 0;
+};
+
+}  // namespace IM::http
+
+#endif  // __IM_HTTP_HTTP_ROUTER_HPP__
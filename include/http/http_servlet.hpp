@@ -1,7 +1,9 @@
 #ifndef __IM_HTTP_HTTP_SERVLET_HPP__
 #define __IM_HTTP_HTTP_SERVLET_HPP__
 
+#include <atomic>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -48,6 +50,13 @@ class Servlet {
          */
     const std::string& getName() const;
 
+    /**
+         * @brief 是否自行读取请求体
+         * @details 为 true 时服务器只解析请求头就调用 handle，请求体留在连接上，
+         *          由 servlet 通过 HttpSession::readBody/readBodyTo 流式读取
+         */
+    virtual bool isStreaming() const { return false; }
+
    protected:
     /// 名称
     std::string m_name;
@@ -68,14 +77,18 @@ class FunctionServlet : public Servlet {
     /**
          * @brief 构造函数
          * @param[in] cb 回调函数
+         * @param[in] streaming 是否由回调自行流式读取请求体
          */
-    FunctionServlet(callback cb);
+    FunctionServlet(callback cb, bool streaming = false);
     virtual int32_t handle(HttpRequest::ptr request, HttpResponse::ptr response,
                            HttpSession::ptr session) override;
+    bool isStreaming() const override { return m_streaming; }
 
    private:
     /// 回调函数
     callback m_cb;
+    /// 是否流式读取请求体
+    bool m_streaming;
 };
 
 class IServletCreator {
@@ -111,8 +124,14 @@ class ServletCreator : public IServletCreator {
     std::string getName() const override { return TypeToName<T>(); }
 };
 
+class HttpRouter;
+
 /**
      * @brief Servlet分发器
+     *
+     * 路由注册后编译为基数树（HttpRouter），每次变更整体重建并发布新的只读路由表；
+     * 查询时各线程使用自己缓存的路由表，版本号不变时无需加锁。
+     * 精确路由支持 "/:name" 路径参数，匹配值通过 HttpRequest::getParam 读取。
      */
 class ServletDispatch : public Servlet {
    public:
@@ -160,6 +179,23 @@ class ServletDispatch : public Servlet {
     void addServletCreator(const std::string& uri, IServletCreator::ptr creator);
     void addGlobServletCreator(const std::string& uri, IServletCreator::ptr creator);
 
+    /**
+         * @brief 添加指定请求方法的servlet
+         * @param[in] method 请求方法
+         * @param[in] uri uri，可包含 "/:name" 路径参数
+         * @param[in] slt servlet
+         * @note 路径命中但方法不匹配（且无不区分方法的servlet）时返回 405
+         */
+    void addRoute(HttpMethod method, const std::string& uri, Servlet::ptr slt);
+
+    /**
+         * @brief 添加指定请求方法的servlet
+         * @param[in] method 请求方法
+         * @param[in] uri uri，可包含 "/:name" 路径参数
+         * @param[in] cb FunctionServlet回调函数
+         */
+    void addRoute(HttpMethod method, const std::string& uri, FunctionServlet::callback cb);
+
     template <class T>
     void addServletCreator(const std::string& uri) {
         addServletCreator(uri, std::make_shared<ServletCreator<T>>());
@@ -214,18 +250,44 @@ class ServletDispatch : public Servlet {
          */
     Servlet::ptr getMatchedServlet(const std::string& uri);
 
+    /**
+         * @brief 按请求方法与路径获取servlet，并把路径参数写入请求参数
+         * @param[in] request HTTP请求
+         * @return 优先精准匹配,其次模糊匹配,方法不匹配返回405,最后返回默认
+         */
+    Servlet::ptr getMatchedServlet(HttpRequest::ptr request);
+
     void listAllServletCreator(std::map<std::string, IServletCreator::ptr>& infos);
     void listAllGlobServletCreator(std::map<std::string, IServletCreator::ptr>& infos);
 
+   private:
+    /**
+         * @brief 重建并发布路由表，调用方需持有写锁
+         */
+    void rebuild();
+
+    /**
+         * @brief 获取当前线程缓存的路由表
+         */
+    const HttpRouter* getRouter();
+
    private:
     /// 精准匹配servlet MAP
     /// uri(/IM/xxx) -> servlet
     std::unordered_map<std::string, IServletCreator::ptr> m_datas;
+    /// 区分请求方法的servlet
+    /// uri(/IM/:id) -> (method -> servlet)
+    std::unordered_map<std::string, std::map<HttpMethod, IServletCreator::ptr>> m_methodDatas;
     /// 模糊匹配servlet 数组
     /// uri(/IM/*) -> servlet
     std::vector<std::pair<std::string, IServletCreator::ptr>> m_globs;
-    Servlet::ptr m_default;  /// 默认servlet，所有路径都没匹配到时使用
-    RWMutexType m_mutex;     /// 读写互斥量
+    Servlet::ptr m_default;           /// 默认servlet，所有路径都没匹配到时使用
+    Servlet::ptr m_methodNotAllowed;  /// 路径命中但请求方法不匹配时使用
+    RWMutexType m_mutex;              /// 读写互斥量（保护上面的路由定义）
+
+    std::shared_ptr<const HttpRouter> m_router;  /// 编译后的路由表
+    std::atomic<uint64_t> m_version{0};          /// 路由表版本号
+    const uint64_t m_id;                         /// 线程本地路由表缓存的键
 };
 
 /**
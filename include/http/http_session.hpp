@@ -1,17 +1,24 @@
 #ifndef __IM_HTTP_HTTP_SESSION_HPP__
 #define __IM_HTTP_HTTP_SESSION_HPP__
 
+#include <functional>
+
 #include "http.hpp"
 #include "streams/socket_stream.hpp"
 
 namespace IM::http {
 /**
      * @brief HTTPSession封装
+     * @details 请求头与请求体分开读取：recvRequestHeader 只解析请求头，请求体留在连接上，
+     *          由 recvBody 一次性读入内存，或由流式 servlet 通过 readBody/readBodyTo 边读边处理。
+     *          支持 Content-Length 与 Transfer-Encoding: chunked 两种请求体。
      */
 class HttpSession : public SocketStream {
    public:
     /// 智能指针类型定义
     typedef std::shared_ptr<HttpSession> ptr;
+    /// 请求体数据观察回调（如计算摘要），data 为解码后的请求体片段
+    typedef std::function<void(const char* data, size_t len)> BodyObserver;
 
     /**
          * @brief 构造函数
@@ -24,12 +31,55 @@ class HttpSession : public SocketStream {
          * @brief 接收HTTP请求
          * @return 返回HttpRequest对象的智能指针
          * @details 该函数负责从Socket中接收HTTP请求数据，并将其解析为HttpRequest对象
-         *          包括解析HTTP请求行、请求头和请求体
+         *          包括解析HTTP请求行、请求头和请求体（即 recvRequestHeader + recvBody）
          */
     HttpRequest::ptr recvRequest();
 
     /**
-         * @brief 发送HTTP响应
+         * @brief 只接收并解析HTTP请求头
+         * @return 失败（连接关闭、解析出错、请求头过大）返回nullptr
+         */
+    HttpRequest::ptr recvRequestHeader();
+
+    /**
+         * @brief 把剩余请求体完整读入 req 的 body
+         * @param[out] too_large 请求体超过 http.request.max_body_size 时置为 true
+         * @return 是否成功
+         */
+    bool recvBody(HttpRequest::ptr req, bool* too_large = nullptr);
+
+    /**
+         * @brief 流式读取请求体（chunked 已解码）
+         * @return >0 读取的字节数，=0 请求体已读完，<0 连接异常或格式错误
+         */
+    int readBody(void* buffer, size_t length);
+
+    /**
+         * @brief 把剩余请求体写入文件描述符
+         * @param[in] fd 目标文件（从当前文件偏移处写入）
+         * @param[in] max_size 允许写入的最大字节数
+         * @param[in] observer 非空时每段数据都经过用户态回调；为空且请求体定长时用 splice 零拷贝落盘
+         * @return >=0 写入字节数，-1 读写失败，-2 请求体超过 max_size
+         */
+    int64_t readBodyTo(int fd, uint64_t max_size, const BodyObserver& observer = nullptr);
+
+    /**
+         * @brief 丢弃剩余请求体（保持长连接），超过 max_size 时放弃并返回 false
+         */
+    bool discardBody(uint64_t max_size);
+
+    /**
+         * @brief 请求体是否已读完（无请求体时为 true）
+         */
+    bool isBodyComplete() const { return m_bodyMode == BODY_NONE; }
+
+    /**
+         * @brief 请求体总长度；chunked 请求体返回 -1
+         */
+    int64_t getBodyLength() const { return m_bodyLength; }
+
+    /**
+         * @brief 发送HTTP响应（带文件响应体时先发头部，再用 sendfile 发送文件区间）
          * @param[in] rsp HTTP响应
          * @return >0 发送成功
          *         =0 对方关闭
@@ -37,12 +87,34 @@ class HttpSession : public SocketStream {
          */
     int sendResponse(HttpResponse::ptr rsp);
 
+    /**
+         * @brief 发送文件区间：明文连接用 sendfile，TLS 连接 pread 到缓冲区后加密写出
+         */
+    bool sendFile(int fd, uint64_t offset, uint64_t length);
+
     int read(void* buffer, size_t length) override;
     int read(ByteArray::ptr ba, size_t length) override;
 
    protected:
-    std::string m_leftoverBuf;
+    enum BodyMode { BODY_NONE, BODY_LENGTH, BODY_CHUNKED };
+
+    /// 读取下一个 chunk 的长度行（末块时消费 trailer 并结束请求体）
+    bool nextChunk();
+    /// 从缓冲区/连接读取一行（不含 CRLF），超过 max 字节仍无换行返回 false
+    bool readLine(std::string& line, size_t max);
+    /// 是否为 TLS 连接（数据需在用户态加解密，不能走 splice/sendfile）
+    bool isSecure() const;
+    /// 用 splice 把定长请求体从 socket 搬到 fd，不支持时返回 -3 由调用方回退
+    int64_t spliceBodyTo(int fd);
+
+   protected:
+    std::string m_leftoverBuf;   /// 已从 socket 读出但尚未消费的数据
+    size_t m_leftoverPos = 0;    /// m_leftoverBuf 中已消费的位置
+    BodyMode m_bodyMode = BODY_NONE;
+    uint64_t m_bodyLeft = 0;     /// 定长：剩余字节；chunked：当前块剩余字节
+    int64_t m_bodyLength = 0;
+    bool m_chunkStarted = false;
 };
 }  // namespace IM::http
 
-#endif // __IM_HTTP_HTTP_SESSION_HPP__
\ No newline at end of file
+#endif // __IM_HTTP_HTTP_SESSION_HPP__
@@ -0,0 +1,64 @@
+#ifndef __IM_HTTP_SERVLETS_STATIC_FILE_SERVLET_HPP__
+#define __IM_HTTP_SERVLETS_STATIC_FILE_SERVLET_HPP__
+
+#include <sys/types.h>
+
+#include "ds/timed_cache.hpp"
+#include "http/http_servlet.hpp"
+
+namespace IM::http {
+
+/**
+     * @brief 静态文件Servlet
+     * @details 以 root 目录为根提供 GET/HEAD 文件下载：
+     *          - 响应体为文件区间，由 HttpSession 以 sendfile（TLS 下为 mmap）发送，不经用户态缓冲；
+     *          - 支持单区间 Range/If-Range、If-None-Match、If-Modified-Since；
+     *          - 客户端接受 gzip 且存在更新的 <file>.gz 时直接发送预压缩文件；
+     *          - 打开的 fd 与 stat 结果缓存在 HashTimedCache 中，超过 stat_ttl 后重新 stat 校验。
+     *          通过 addGlobServlet("<prefix>*", ...) 注册，请求路径去掉 prefix 后映射到 root 下。
+     */
+class StaticFileServlet : public Servlet {
+   public:
+    typedef std::shared_ptr<StaticFileServlet> ptr;
+
+    struct Options {
+        std::string root;                  /// 根目录（绝对路径）
+        std::string prefix = "/";          /// URL 前缀
+        std::string index = "index.html";  /// 目录请求的默认文件
+        uint32_t max_age = 86400;          /// Cache-Control max-age（秒）
+        uint32_t cache_size = 4096;        /// 缓存的文件数上限
+        uint32_t stat_ttl = 2000;          /// 缓存项重新 stat 的间隔（毫秒）
+        bool gzip = true;                  /// 是否发送预压缩的 .gz 文件
+    };
+
+    StaticFileServlet(const Options& opts);
+    virtual int32_t handle(HttpRequest::ptr request, HttpResponse::ptr response,
+                           HttpSession::ptr session) override;
+
+    /// 文件缓存命中统计
+    std::string getCacheStatus() { return m_cache.toStatusString(); }
+
+   private:
+    /// 缓存的文件信息；file 为空表示不存在或不是普通文件
+    struct Entry {
+        typedef std::shared_ptr<const Entry> ptr;
+        HttpFile::ptr file;
+        uint64_t size = 0;
+        time_t mtime = 0;
+        ino_t ino = 0;
+        uint64_t checked_ms = 0;  /// 最近一次 stat 的时间
+        std::string etag;
+        std::string last_modified;
+    };
+
+    /// 查找文件（走缓存），path 为 root 下的绝对路径
+    Entry::ptr lookup(const std::string& path);
+
+   private:
+    Options m_opts;
+    IM::ds::HashTimedCache<std::string, Entry::ptr> m_cache;
+};
+
+}  // namespace IM::http
+
+#endif // __IM_HTTP_SERVLETS_STATIC_FILE_SERVLET_HPP__
@@ -11,6 +11,7 @@
 
 #include <ucontext.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -68,8 +69,10 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
 
     /**
          * @brief 切换到当前协程执行
+         * @return 协程切出时的状态（直接 swapOut 切出的记为 HOLD）
+         * @details 返回后协程可能已被其他线程恢复，调度器应使用返回值而不是再读 getState()
          */
-    void swapIn();
+    State swapIn();
 
     /**
          * @brief 协程让出执行权
@@ -104,6 +107,13 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
          */
     void setState(State state);
 
+    /**
+         * @brief 是否仍占用着某个线程的执行栈
+         * @details YieldToHold 在切出前就把状态置为 HOLD，此时上下文可能还没保存完；
+         *          调度器需等到 swapIn 返回（本标志清除）后才能在其他线程恢复它。
+         */
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
    public:
     /**
          * @brief 设置当前协程
@@ -150,12 +160,13 @@ class Coroutine : public std::enable_shared_from_this<Coroutine>, Noncopyable {
     static uint64_t GetCoroutineId();
 
    private:
-    uint64_t m_id = 0;            /// 协程id
-    uint32_t m_stack_size = 0;    /// 协程栈大小
-    State m_state = State::INIT;  /// 协程当前状态
-    ucontext_t m_ctx;             /// 协程上下文，用于保存和切换上下文环境
-    void* m_stack = nullptr;      /// 协程栈空间
-    std::function<void()> m_cb;   /// 协程要执行的回调函数
+    uint64_t m_id = 0;                   /// 协程id
+    uint32_t m_stack_size = 0;           /// 协程栈大小
+    State m_state = State::INIT;         /// 协程当前状态
+    std::atomic<bool> m_running{false};  /// swapIn 尚未返回
+    ucontext_t m_ctx;                    /// 协程上下文，用于保存和切换上下文环境
+    void* m_stack = nullptr;             /// 协程栈空间
+    std::function<void()> m_cb;          /// 协程要执行的回调函数
 };
 
 /**
@@ -0,0 +1,89 @@
+/**
+ * @file    cpu_pool.hpp
+ * @brief   CPU 密集型任务的卸载线程池
+ * @author  DreamTraveler233
+ * @date    2023-01-01
+ * @note    供协程把 RSA 解密、PBKDF2 等耗时计算交给独立线程执行，避免阻塞 IOManager 线程。
+ */
+
+#ifndef __IM_IO_CPU_POOL_HPP__
+#define __IM_IO_CPU_POOL_HPP__
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <vector>
+
+#include "base/noncopyable.hpp"
+#include "base/singleton.hpp"
+#include "io/lock.hpp"
+#include "io/semaphore.hpp"
+#include "io/thread.hpp"
+
+namespace IM {
+
+/**
+ * @class   CpuPool
+ * @brief   有界的 CPU 任务执行器
+ *
+ * - 线程数由 cpu_pool.threads 配置（0 表示取 CPU 核数），首次提交任务时启动；
+ * - 排队任务数超过 cpu_pool.max_queue 时拒绝提交，调用方据此返回 429 做过载保护；
+ * - await 在协程中调用时：提交任务后让出当前协程，任务执行完毕后由工作线程把协程
+ *   重新放回原调度器；不在协程调度器中（或已在池线程内）调用时直接同步执行。
+ */
+class CpuPool : Noncopyable {
+   public:
+    typedef Mutex MutexType;
+
+    CpuPool();
+    ~CpuPool();
+
+    /**
+     * @brief   提交任务并等待其完成
+     * @param   cb  任务回调
+     * @return  队列已满（任务未执行）返回 false
+     */
+    bool await(std::function<void()> cb);
+
+    /**
+     * @brief   提交任务，不等待结果
+     * @param   cb  任务回调
+     * @return  队列已满（任务未执行）返回 false
+     */
+    bool submit(std::function<void()> cb);
+
+    /**
+     * @brief   停止所有工作线程（已排队的任务会先执行完）
+     */
+    void stop();
+
+    size_t getThreadCount() const { return m_threadCount; }
+    size_t getMaxQueue() const { return m_maxQueue; }
+    /// 当前排队中的任务数
+    size_t getPending() const { return m_pending; }
+    /// 因队列已满被拒绝的任务累计数
+    uint64_t getRejected() const { return m_rejected; }
+
+   private:
+    bool push(std::function<void()>&& cb);
+    void start();
+    void run();
+
+   private:
+    MutexType m_mutex;
+    std::deque<std::function<void()>> m_tasks;
+    std::vector<Thread::ptr> m_threads;
+    Semaphore m_sem;  // 每个排队任务对应一次 notify
+    size_t m_threadCount;
+    size_t m_maxQueue;
+    bool m_started;
+    bool m_stopping;
+    std::atomic<size_t> m_pending{0};
+    std::atomic<uint64_t> m_rejected{0};
+};
+
+typedef Singleton<CpuPool> CpuPoolMgr;
+
+}  // namespace IM
+
+#endif  // __IM_IO_CPU_POOL_HPP__
@@ -0,0 +1,86 @@
+/**
+ * @file fd_table.hpp
+ * @brief 按文件描述符下标的分块表
+ * @author IM
+ *
+ * 该文件定义了FdTable模板，供FdManager（hook层fd上下文）与IOManager（epoll事件上下文）
+ * 共用。表按固定大小分块，元素在块内连续存放；块只增不减、地址固定，因此读路径
+ * 只需一次原子load加两次下标运算，不加锁也不涉及引用计数。
+ */
+
+#ifndef __IM_IO_FD_TABLE_HPP__
+#define __IM_IO_FD_TABLE_HPP__
+
+#include <atomic>
+#include <cstddef>
+
+#include "base/noncopyable.hpp"
+#include "lock.hpp"
+
+namespace IM {
+/**
+     * @brief fd 下标分块表
+     * @details - 读（get）：无锁，块未分配时返回nullptr
+     *          - 写（at）：块未分配时在互斥锁内分配整块，之后同样无锁
+     *          - 元素一经分配直到表析构都不会移动或释放，返回的指针可长期持有
+     *          元素自身的并发控制由使用方负责。
+     * @tparam T 元素类型，需可默认构造
+     * @tparam ChunkBits 每块元素个数的对数，默认每块1024个
+     * @tparam MaxChunks 最大块数，默认可容纳 4M 个fd
+     */
+template <class T, size_t ChunkBits = 10, size_t MaxChunks = 4096>
+class FdTable : public Noncopyable {
+   public:
+    static constexpr size_t kChunkSize = size_t(1) << ChunkBits;
+    static constexpr size_t kCapacity = kChunkSize * MaxChunks;
+
+    FdTable() {
+        for (auto& c : m_chunks) {
+            c.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    ~FdTable() {
+        for (auto& c : m_chunks) {
+            delete[] c.load(std::memory_order_relaxed);
+        }
+    }
+
+    /**
+         * @brief 无锁查找
+         * @return 元素指针；fd越界或所在块尚未分配时返回nullptr
+         */
+    T* get(int fd) const {
+        if (fd < 0 || (size_t)fd >= kCapacity) {
+            return nullptr;
+        }
+        T* chunk = m_chunks[(size_t)fd >> ChunkBits].load(std::memory_order_acquire);
+        return chunk ? &chunk[(size_t)fd & (kChunkSize - 1)] : nullptr;
+    }
+
+    /**
+         * @brief 查找元素，所在块未分配时分配之
+         * @return 元素指针；fd越界时返回nullptr
+         */
+    T* at(int fd) {
+        T* rt = get(fd);
+        if (rt || fd < 0 || (size_t)fd >= kCapacity) {
+            return rt;
+        }
+        std::atomic<T*>& slot = m_chunks[(size_t)fd >> ChunkBits];
+        Mutex::Lock lock(m_mutex);
+        T* chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new T[kChunkSize];
+            slot.store(chunk, std::memory_order_release);
+        }
+        return &chunk[(size_t)fd & (kChunkSize - 1)];
+    }
+
+   private:
+    std::atomic<T*> m_chunks[MaxChunks];  ///< 块指针数组，只增不减
+    Mutex m_mutex;                        ///< 仅在分配新块时使用
+};
+}  // namespace IM
+
+#endif  // __IM_IO_FD_TABLE_HPP__
@@ -12,8 +12,13 @@
 #ifndef __IM_IO_IOMANAGER_HPP__
 #define __IM_IO_IOMANAGER_HPP__
 
+#include <sys/epoll.h>
+
+#include "ds/flat_hash_map.hpp"
+#include "fd_table.hpp"
 #include "scheduler.hpp"
 #include "timer.hpp"
+#include "uring.hpp"
 
 namespace IM {
 /**
@@ -21,6 +26,9 @@ namespace IM {
      * @details IOManager是一个基于epoll的I/O多路复用事件管理器，继承自Scheduler和TimerManager。
      *          它能够监听文件描述符上的读写事件，并在事件触发时自动调度相应的协程或回调函数执行。
      *          同时，它也具备定时器管理功能，可以调度定时任务。
+     *          分片模式下每个线程只等待自己的 epoll，fd 事件由注册它的线程处理。
+     *          io_uring 后端（配置 iomanager.backend=io_uring）下每个线程另有一个 io_uring 实例，
+     *          hook 的 socket IO 在 EAGAIN 时改为提交完成式请求，内核不支持时退回 epoll。
      */
 class IOManager : public Scheduler, public TimerManager {
    public:
@@ -38,6 +46,11 @@ class IOManager : public Scheduler, public TimerManager {
     };
 
    private:
+    /**
+         * @brief 在途的 io_uring 请求，位于等待它的协程栈上，完成前协程不会恢复
+         */
+    struct UringRequest;
+
     /**
          * @brief 文件描述符上下文结构体
          * @details 管理特定文件描述符上的事件信息，包括读写事件上下文和当前监听的事件类型
@@ -53,6 +66,7 @@ class IOManager : public Scheduler, public TimerManager {
             Scheduler* scheduler = nullptr;  /// 指定执行事件的调度器
             Coroutine::ptr coroutine;        /// 绑定到事件的协程对象
             std::function<void()> cb;        /// 事件触发时执行的回调函数
+            pid_t threadId = -1;             /// 事件触发后执行的线程，-1表示任意线程
         };
 
         /**
@@ -74,11 +88,65 @@ class IOManager : public Scheduler, public TimerManager {
              */
         void triggerEvent(Event event);
 
+        /**
+             * @brief 等待超时上下文
+             * @details 每个 fd 每个方向一个，定时器首次使用时创建，之后每次等待只重新 arm
+             */
+        struct Deadline {
+            Timer::ptr timer;                // 复用的超时定时器
+            uint64_t seq = 0;                // 启动序号，只由等待方修改
+            std::atomic<uint64_t> armed{0};  // 正在等待的序号，超时回调抢到后置 0
+        };
+
+        /**
+             * @brief 析构时释放复用的超时定时器
+             */
+        ~FdContext();
+
+        /**
+             * @brief 获取指定事件类型的超时上下文
+             * @param[in] event 事件类型（READ或WRITE）
+             */
+        Deadline& getDeadline(Event event) { return event == READ ? read_dl : write_dl; }
+
+        /**
+             * @brief 获取指定方向上在途的 io_uring 请求
+             * @param[in] event 事件类型（READ或WRITE）
+             */
+        UringRequest*& getUring(Event event) { return event == READ ? uring_read : uring_write; }
+
         int fd = 0;           /// 事件绑定的文件描述符
+        int epfd = -1;        /// 当前注册到的 epoll 实例，-1表示未注册
         EventContext read;    /// 读事件上下文
         EventContext write;   /// 写事件上下文
         Event events = NONE;  /// 当前监听的事件类型
         MutexType mutex;      /// 保护该上下文的互斥锁
+        Deadline read_dl;     /// 读等待超时
+        Deadline write_dl;    /// 写等待超时
+        UringRequest* uring_read = nullptr;   /// 在途的 io_uring 读请求
+        UringRequest* uring_write = nullptr;  /// 在途的 io_uring 写请求
+    };
+
+    /**
+         * @brief 线程唤醒器
+         * @details 每个调度线程一个。默认配置下（没有绑定线程的任务、非分片、epoll 后端）
+         *          空闲线程直接等待共享的 m_epfd，一个就绪事件只唤醒一个线程；唤醒器只在
+         *          首次出现线程绑定时启用：共享的 m_epfd 嵌套进各线程自己的 epoll（与 eventfd
+         *          一起），线程改为在自己的 epoll 上等待，从而既能收到共享事件，又能被定向唤醒。
+         *          绑定到该线程的任务所等待的 fd 也直接注册在这个 epoll 上，只由该线程处理。
+         *          分片模式下所有 fd 都注册在某个线程的 epoll 上，该 epoll 即为一个分片。
+         *          io_uring 后端下 ring 的 fd 也注册在这个 epoll 上，CQ 非空时唤醒该线程收割；
+         *          提交到 ring 上的请求以单调递增的 id 作为 user_data，完成与取消都按 id 查找，
+         *          不会因为等待对象所在的协程栈被复用而错配到新的请求。
+         */
+    struct ThreadWaker {
+        std::atomic<pid_t> threadId{-1};  /// 占用该唤醒器的线程ID
+        int epfd = -1;                    /// 线程自己的 epoll 实例
+        int eventFd = -1;                 /// 定向唤醒用的 eventfd
+        std::unique_ptr<Uring> ring;      /// 线程自己的 io_uring 实例，epoll 后端下为空
+        uint32_t ticks = 0;               /// 有待提交请求以来经过的调度节拍数，只由所属线程访问
+        uint64_t uringSeq = 0;            /// 最近一次分配的 io_uring 请求 id，只由所属线程访问
+        ds::FlatHashMap<uint64_t, UringRequest*> uringRequests;  /// 在途请求 id -> 请求，同上
     };
 
    public:
@@ -87,8 +155,11 @@ class IOManager : public Scheduler, public TimerManager {
          * @param[in] threads 线程数量
          * @param[in] use_caller 是否使用调用线程作为调度线程之一
          * @param[in] name 调度器名称
+         * @param[in] sharded 是否启用分片模式：每个线程一个 epoll，fd 注册时分配到其中一个，
+         *            线程之间不再争用同一个 epoll；关闭时 fd 默认注册在共享的 epoll 上
          */
-    IOManager(size_t threads = 1, bool use_caller = true, const std::string& name = "");
+    IOManager(size_t threads = 1, bool use_caller = true, const std::string& name = "",
+              bool sharded = false);
 
     /**
          * @brief 析构函数
@@ -104,6 +175,17 @@ class IOManager : public Scheduler, public TimerManager {
          */
     bool addEvent(int fd, Event event, std::function<void()> cb = nullptr);
 
+    /**
+         * @brief 以当前协程等待 fd 上的事件，可带超时
+         * @details 供 hook 的 IO 函数使用。超时定时器按 fd 复用，等待过程中不分配内存
+         *          （每个 fd 每个方向首次带超时等待时创建一次定时器）。
+         * @param[in] fd 文件描述符
+         * @param[in] event 事件类型
+         * @param[in] timeout 超时时间(毫秒)，~0ull 表示不超时
+         * @return int 事件就绪返回0，超时返回ETIMEDOUT（同时设置errno），注册事件失败返回-1
+         */
+    int waitEvent(int fd, Event event, uint64_t timeout);
+
     /**
          * @brief 删除事件监听
          * @param[in] fd 文件描述符
@@ -127,18 +209,49 @@ class IOManager : public Scheduler, public TimerManager {
          */
     bool cancelAll(int fd);
 
+    /**
+         * @brief 当前线程是否可以使用 io_uring 提交请求
+         */
+    bool isUring() const;
+
+    /**
+         * @brief 以当前协程提交一个 io_uring 请求并等待其完成
+         * @details 请求写入当前线程的 ring，在调度线程空闲或累计若干调度节拍后批量提交。
+         *          超时通过链接的 LINK_TIMEOUT 实现；cancelAll 会取消在途请求。
+         *          RECV 请求在有空闲注册缓冲区时由内核挑选缓冲区接收，完成后拷贝回原缓冲区。
+         * @param[in] fd 文件描述符
+         * @param[in] event 请求方向（READ或WRITE），同一方向同时只能有一个在途请求
+         * @param[in] sqe 已填好操作码与参数的提交项，user_data 与 flags 由本函数设置
+         * @param[in] timeout 超时时间(毫秒)，~0ull 表示不超时
+         * @param[out] res 完成结果，成功为非负值，失败为 -errno（同时设置 errno），超时为 -ETIMEDOUT
+         * @return bool 请求已提交并完成返回true；当前线程没有 ring 等情况下返回false，
+         *         调用方应退回 epoll 路径
+         */
+    bool uringWait(int fd, Event event, const io_uring_sqe& sqe, uint64_t timeout, int& res);
+
     /**
          * @brief 获取当前线程的IOManager实例
          * @return IOManager* 当前线程的IOManager实例指针
          */
     static IOManager* GetThis();
 
+    /**
+         * @brief 是否启用了分片模式
+         */
+    bool isSharded() const { return m_sharded; }
+
    protected:
     /**
          * @brief 唤醒空闲线程
          */
     void tickle() override;
 
+    /**
+         * @brief 定向唤醒指定线程
+         * @param[in] thread 目标线程ID
+         */
+    void tickle(pid_t thread) override;
+
     /**
          * @brief 判断调度器是否应该停止
          * @return bool true表示应该停止
@@ -156,10 +269,9 @@ class IOManager : public Scheduler, public TimerManager {
     void onTimerInsertedAtFront() override;
 
     /**
-         * @brief 调整文件描述符上下文数组大小
-         * @param[in] size 新的数组大小
+         * @brief 任务切出后，若 ring 中的请求已等待足够多的调度节拍则提交
          */
-    void contextResize(size_t size);
+    void afterTask() override;
 
     /**
          * @brief 带超时时间的停止判断函数
@@ -169,11 +281,76 @@ class IOManager : public Scheduler, public TimerManager {
     bool stopping(uint64_t& timeout);
 
    private:
+    /**
+         * @brief 为当前线程占用一个唤醒器
+         * @return ThreadWaker* 唤醒器，数量不足时返回nullptr（退化为直接等待 m_epfd）
+         */
+    ThreadWaker* claimWaker();
+
+    /**
+         * @brief 启用线程唤醒器：把共享的 m_epfd 嵌套进各线程的 epoll（幂等）
+         * @details 仍直接等待在 m_epfd 上的线程收不到定向唤醒，因此同时向 m_epfd 挂上常驻
+         *          可读的 m_switchFd（水平触发，依次唤醒所有等待者），最后一个离开直接等待的
+         *          线程将其摘除
+         */
+    void nestSharedEpoll();
+
+    /**
+         * @brief 没有线程直接等待 m_epfd 时摘除 m_switchFd
+         */
+    void disarmSwitch();
+
+    /**
+         * @brief 选择 fd 首次注册事件时使用的 epoll 实例
+         * @param[in] thread 等待该事件的任务所绑定的线程ID
+         * @return int 该线程自己的 epoll；未绑定线程时，分片模式下返回当前线程（或轮转选出的
+         *         线程）的 epoll，否则返回共享的 m_epfd；没有线程占用唤醒器时同样返回 m_epfd
+         */
+    int selectEpoll(pid_t thread);
+
+    /**
+         * @brief 处理一个就绪的 epoll 事件，触发对应 fd 上的读写事件
+         * @param[in] event epoll 返回的事件
+         */
+    void processEvent(epoll_event& event);
+
+    /**
+         * @brief 获取当前线程占用的本调度器唤醒器
+         * @return ThreadWaker* 当前线程不是本调度器的调度线程或尚未进入 idle 时返回nullptr
+         */
+    ThreadWaker* currentWaker() const;
+
+    /**
+         * @brief 提交当前线程 ring 中待提交的请求
+         */
+    void flushUring(ThreadWaker* waker);
+
+    /**
+         * @brief 收割当前线程 ring 中的完成项，恢复等待的协程
+         */
+    void reapUring(ThreadWaker* waker);
+
+    /**
+         * @brief 取消 fd 上指定方向的在途 io_uring 请求
+         * @pre 持有 fd_ctx->mutex
+         * @return bool 存在在途请求返回true
+         */
+    bool cancelUring(FdContext* fd_ctx, Event event);
+
     int m_epfd = 0;                                 /// epoll文件描述符
     int m_tickleFds[2];                             /// 用于唤醒epoll_wait的管道文件描述符
     std::atomic<size_t> m_pendingEventCount = {0};  /// 待处理的事件数量
-    RWMutexType m_mutex;                            /// 保护文件描述符上下文数组的读写锁
-    std::vector<FdContext*> m_fdContexts;           /// 文件描述符上下文数组
+    FdTable<FdContext> m_fdContexts;                /// 文件描述符上下文表（分块、只增、无锁读）
+    std::unique_ptr<ThreadWaker[]> m_wakers;        /// 各调度线程的唤醒器
+    size_t m_wakerCount = 0;                        /// 唤醒器数量，等于调度线程数
+    bool m_sharded = false;                         /// 是否启用分片模式
+    std::atomic<size_t> m_nextShard = {0};          /// 非调度线程注册 fd 时轮转选择的分片
+    bool m_uring = false;                           /// 是否启用 io_uring 后端
+    std::atomic<bool> m_nested = {false};           /// m_epfd 是否已嵌套进各线程 epoll
+    std::atomic<size_t> m_directWaiters = {0};      /// 直接等待 m_epfd 的调度线程数
+    int m_switchFd = -1;                            /// 切换到线程 epoll 时使用的 eventfd
+    bool m_switchArmed = false;                     /// m_switchFd 是否挂在 m_epfd 上
+    Mutex m_nestMutex;                              /// 保护嵌套与 m_switchFd 的挂载
 };
 }  // namespace IM
 
@@ -181,6 +181,8 @@ class RWMutex : public Noncopyable {
 
     void rdlock();
     void wrlock();
+    // 非阻塞获取写锁，成功返回 true
+    bool trywrlock();
     void unlock();
 
    private:
@@ -152,6 +152,20 @@ class Scheduler : public Noncopyable {
          */
     static Coroutine* GetMainCoroutine();
 
+    /**
+         * @brief 获取当前正在执行的任务所绑定的线程ID
+         * @details 以指定 tid 调度的任务在执行期间返回该 tid；IOManager 据此让等待 IO
+         *          的协程在事件就绪后仍回到原线程执行
+         * @return pid_t 绑定的线程ID，-1表示任务未绑定线程
+         */
+    static pid_t GetTaskThreadId();
+
+    /**
+         * @brief 获取常驻调度线程的线程ID列表
+         * @return std::vector<pid_t> 工作线程ID（不含 use_caller 模式下的调用线程）
+         */
+    std::vector<pid_t> getWorkerThreadIds() const;
+
     /**
          * @brief 启动调度器
          */
@@ -175,7 +189,9 @@ class Scheduler : public Noncopyable {
             MutexType::Lock lock(m_mutex);
             need_tickle = scheduleNolock(cb, tid);
         }
-        if (need_tickle) {
+        if ((pid_t)tid != -1) {
+            tickle((pid_t)tid);  // 指定了线程的任务只能由该线程执行，定向唤醒
+        } else if (need_tickle) {
             tickle();  // 唤醒工作线程
         }
     }
@@ -221,6 +237,13 @@ class Scheduler : public Noncopyable {
          */
     virtual void tickle();
 
+    /**
+         * @brief 唤醒指定线程
+         * @details 用于绑定了线程的任务，目标为当前线程时无需唤醒。默认实现退化为 tickle()
+         * @param thread 目标线程ID
+         */
+    virtual void tickle(pid_t thread);
+
     /**
          * @brief 判断调度器是否应该停止
          * @return bool true表示应该停止
@@ -232,6 +255,12 @@ class Scheduler : public Noncopyable {
          */
     virtual void idle();
 
+    /**
+         * @brief 每个任务（协程或回调）从调度线程上切出后调用
+         * @details 默认不做任何事。IOManager 的 io_uring 后端借此按调度节拍批量提交IO请求
+         */
+    virtual void afterTask() {}
+
     /**
          * @brief 线程运行函数
          */
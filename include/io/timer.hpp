@@ -7,6 +7,8 @@
  * 该模块实现了基于时间事件的定时器功能，支持一次性定时器和周期性定时器。
  * 定时器使用最小堆(std::set)进行管理，通过回调函数的方式处理超时事件。
  * Timer类表示单个定时器实例，TimerManager类负责管理多个定时器。
+ * 另支持可复用定时器（createTimer）：创建一次，之后反复 arm/disarm，
+ * 重新启动时复用原有的集合节点，不再分配内存，适合 hook IO 的超时控制。
  */
 
 #ifndef __IM_IO_TIMER_HPP__
@@ -65,6 +67,25 @@ class Timer : public std::enable_shared_from_this<Timer>, public Noncopyable {
          */
     bool reset(uint64_t ms, bool from_now);
 
+    /**
+         * @brief 启动（或重新启动）可复用定时器
+         * 
+         * 仅对 TimerManager::createTimer 创建的定时器有效。若定时器已在队列中则先移出，
+         * 再以当前时间加 ms 为到期时间放回；除首次启动外复用已有的集合节点，不分配内存。
+         * 
+         * @param ms 距到期的时间(毫秒)
+         * @param token 到期时原样传给回调，用于区分是哪一次启动
+         * @return bool 启动成功返回true，定时器已被cancel时返回false
+         */
+    bool arm(uint64_t ms, uint64_t token);
+
+    /**
+         * @brief 停止可复用定时器，保留回调与集合节点以便下次 arm
+         * 
+         * @return bool 定时器在队列中（尚未到期）返回true，否则返回false
+         */
+    bool disarm();
+
    private:
     /**
          * @brief 构造函数
@@ -121,6 +142,20 @@ class Timer : public std::enable_shared_from_this<Timer>, public Noncopyable {
              */
         bool operator()(const Timer::ptr& lhs, const Timer::ptr& rhs) const;
     };
+
+    using Set = std::set<Timer::ptr, Comparator>;
+
+    /// 可复用定时器的回调，参数为 arm 时传入的 token；为空表示普通定时器
+    std::function<void(uint64_t)> m_tokenCb;
+
+    /// 本次 arm 的 token
+    uint64_t m_token = 0;
+
+    /// 可复用定时器当前是否在队列中
+    bool m_armed = false;
+
+    /// 可复用定时器不在队列中时保存的集合节点，下次 arm 时直接放回
+    Set::node_type m_node;
 };
 
 /**
@@ -172,6 +207,17 @@ class TimerManager : public Noncopyable {
     Timer::ptr addConditionTimer(uint64_t ms, std::function<void()> cb,
                                  std::weak_ptr<void> weak_cond, bool recurring = false);
 
+    /**
+         * @brief 创建可复用定时器
+         * 
+         * 创建的定时器不在队列中，需调用 Timer::arm 启动；每次到期后回调一次，参数为该次
+         * arm 的 token，之后可再次 arm。节点由定时器自身持有，不再使用时须调用 cancel 释放。
+         * 
+         * @param cb 到期回调
+         * @return Timer::ptr 创建的定时器智能指针
+         */
+    Timer::ptr createTimer(std::function<void(uint64_t)> cb);
+
     /**
          * @brief 获取最近的定时器执行时间
          * 
@@ -214,6 +260,14 @@ class TimerManager : public Noncopyable {
     void addTimer(Timer::ptr val, RWMutexType::WriteLock& lock);
 
    private:
+    /**
+         * @brief 定时器已插入队列后的处理：必要时通知上层有新的最早定时器并释放写锁
+         * 
+         * @param it 新插入定时器的位置
+         * @param lock 写锁对象
+         */
+    void onTimerInserted(Timer::Set::iterator it, RWMutexType::WriteLock& lock);
+
     /**
          * @brief 检测系统时钟是否回退
          * 
@@ -229,7 +283,7 @@ class TimerManager : public Noncopyable {
     RWMutexType m_mutex;
 
     /// 定时器集合，按执行时间排序
-    std::set<Timer::ptr, Timer::Comparator> m_timers;
+    Timer::Set m_timers;
 
     /// 是否被"踢"过，用于避免频繁触发onTimerInsertedAtFront
     bool m_tickled = false;
@@ -0,0 +1,198 @@
+/**
+ * @file uring.hpp
+ * @brief io_uring 提交/完成队列的最小封装
+ * @author IM
+ *
+ * 该文件定义了Uring类，直接通过 io_uring_setup/io_uring_enter/io_uring_register 系统调用
+ * 建立一个 io_uring 实例并映射其提交队列(SQ)与完成队列(CQ)，不依赖 liburing。
+ * IOManager 在 io_uring 后端下为每个调度线程创建一个 Uring，用于完成式的 recv/send/accept/connect。
+ */
+
+#ifndef __IM_IO_URING_HPP__
+#define __IM_IO_URING_HPP__
+
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/noncopyable.hpp"
+#include "lock.hpp"
+
+namespace IM {
+/**
+     * @brief io_uring 实例
+     * @details - SQ 可由多个线程写入（持有 getMutex()），但只应由拥有该实例的线程调用 submit，
+     *            使内核中请求的所属任务始终是该线程
+     *          - CQ 只由拥有该实例的线程消费（reap），不加锁
+     *          - 可选向内核提供一组接收缓冲区（IORING_OP_PROVIDE_BUFFERS），供 RECV 按需挑选，
+     *            缓冲区的借还同样在 getMutex() 保护下进行
+     */
+class Uring : public Noncopyable {
+   public:
+    using MutexType = SpinLock;
+
+    /**
+         * @brief 检查当前内核是否支持 IOManager 所需的 io_uring 操作
+         * @details 探测 RECV/SEND/RECVMSG/SENDMSG/ACCEPT/CONNECT/LINK_TIMEOUT/ASYNC_CANCEL，
+         *          结果只探测一次
+         */
+    static bool IsSupported();
+
+    /**
+         * @brief 构造函数，创建 io_uring 实例并映射队列
+         * @param[in] entries 提交队列长度（向上取整为2的幂）
+         * @throw std::runtime_error 创建或映射失败
+         */
+    explicit Uring(uint32_t entries);
+
+    /**
+         * @brief 析构函数，解除映射并关闭实例
+         */
+    ~Uring();
+
+    /**
+         * @brief 获取 io_uring 实例的文件描述符，CQ 非空时可读，可注册到 epoll 中
+         */
+    int getFd() const { return m_fd; }
+
+    /**
+         * @brief 获取保护 SQ 与接收缓冲区的锁
+         */
+    MutexType& getMutex() { return m_mutex; }
+
+    /**
+         * @brief 预留 count 个连续的提交项
+         * @pre 持有 getMutex()
+         * @return 第一个提交项（已清零），SQ 空间不足时返回nullptr；
+         *         其余预留的提交项按顺序通过 nextSqe 依次取得
+         */
+    io_uring_sqe* getSqe(uint32_t count = 1);
+
+    /**
+         * @brief 获取 getSqe 预留的下一个提交项（已清零）
+         * @pre 持有 getMutex()，且此前 getSqe 预留的数量足够
+         */
+    io_uring_sqe* nextSqe();
+
+    /**
+         * @brief 已写入但尚未被内核消费的提交项数量
+         */
+    uint32_t pending() const;
+
+    /**
+         * @brief 把已写入的提交项一次性提交给内核
+         * @pre 持有 getMutex()，且在拥有该实例的线程上调用
+         * @return int 内核接收的提交项数量，失败返回 -errno
+         */
+    int submit();
+
+    /**
+         * @brief CQ 中是否有尚未消费的完成项
+         */
+    bool hasCompletions() const;
+
+    /**
+         * @brief 消费 CQ 中所有的完成项
+         * @param[in] cb 对每个完成项调用 cb(user_data, res, flags)
+         * @return size_t 消费的完成项数量
+         */
+    template <class F>
+    size_t reap(F cb) {
+        unsigned head = *m_cqHead;
+        unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        size_t n = 0;
+        for (; head != tail; ++head, ++n) {
+            const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+            uint64_t data = cqe.user_data;
+            int res = cqe.res;
+            uint32_t flags = cqe.flags;
+            // 先归还 CQ 槽位再回调，回调中可能唤醒协程
+            __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+            cb(data, res, flags);
+        }
+        return n;
+    }
+
+    /**
+         * @brief 向内核提供一组接收缓冲区（IORING_OP_PROVIDE_BUFFERS，缓冲组 kBufferGroup）
+         * @details RECV 带 IOSQE_BUFFER_SELECT 提交时，数据到达才从这组缓冲区中取一个，
+         *          挂起的读请求不再各自占用一块用户内存；用过的缓冲区由 releaseBuffer 重新提供
+         * @pre 尚未提交过其他请求
+         * @param[in] count 缓冲区个数
+         * @param[in] size 每个缓冲区大小(字节)
+         * @return bool 成功返回true；失败（内核不支持或内存不足）返回false，不影响普通操作
+         */
+    bool registerBuffers(uint32_t count, uint32_t size);
+
+    /**
+         * @brief 为一个即将提交的 RECV 预留缓冲区名额
+         * @pre 持有 getMutex()
+         * @return bool 有空闲缓冲区返回true，之后须以完成项的 flags 调用 releaseBuffer
+         */
+    bool acquireBuffer();
+
+    /**
+         * @brief 归还 acquireBuffer 预留的名额；完成项带有 IORING_CQE_F_BUFFER 时把该缓冲区重新提供给内核
+         * @pre 持有 getMutex()
+         * @param[in] cqe_flags 请求完成项的 flags
+         */
+    void releaseBuffer(uint32_t cqe_flags);
+
+    /**
+         * @brief 获取完成项所用缓冲区的地址
+         * @param[in] cqe_flags 带有 IORING_CQE_F_BUFFER 的完成项 flags
+         */
+    void* getBuffer(uint32_t cqe_flags) const {
+        return (char*)m_bufferMem + (size_t)(cqe_flags >> IORING_CQE_BUFFER_SHIFT) * m_bufferSize;
+    }
+
+    /**
+         * @brief 获取每个缓冲区的大小，未注册时为0
+         */
+    size_t getBufferSize() const { return m_bufferSize; }
+
+    static const uint16_t kBufferGroup = 0;  /// 接收缓冲区所在的缓冲组
+
+   private:
+    /**
+         * @brief 解除映射并关闭实例，析构与构造失败时共用
+         */
+    void release();
+
+    /**
+         * @brief 写入一个重新提供缓冲区的提交项，SQ 已满时记入 m_recycle 待下次提交时补上
+         */
+    void provideBuffer(uint16_t bid);
+
+    int m_fd = -1;                     /// io_uring 实例
+    MutexType m_mutex;                 /// 保护 SQ 写入与接收缓冲区环
+
+    void* m_sqRing = nullptr;          /// SQ 环映射
+    size_t m_sqRingSize = 0;           /// SQ 环映射大小
+    void* m_cqRing = nullptr;          /// CQ 环映射（单次映射时与 SQ 环相同）
+    size_t m_cqRingSize = 0;           /// CQ 环映射大小
+    io_uring_sqe* m_sqes = nullptr;    /// 提交项数组映射
+    size_t m_sqesSize = 0;             /// 提交项数组映射大小
+
+    unsigned* m_sqHead = nullptr;      /// 内核已消费到的 SQ 位置
+    unsigned* m_sqTail = nullptr;      /// 已发布给内核的 SQ 位置
+    unsigned m_sqMask = 0;             /// SQ 下标掩码
+    unsigned m_sqEntries = 0;          /// SQ 长度
+    unsigned m_sqeTail = 0;            /// 本地已写入到的 SQ 位置（submit 时发布）
+
+    unsigned* m_cqHead = nullptr;      /// 已消费到的 CQ 位置
+    unsigned* m_cqTail = nullptr;      /// 内核已写入到的 CQ 位置
+    unsigned m_cqMask = 0;             /// CQ 下标掩码
+    io_uring_cqe* m_cqes = nullptr;    /// 完成项数组
+
+    std::vector<uint16_t> m_recycle;    /// 因 SQ 已满尚未重新提供的缓冲区
+    uint32_t m_bufEntries = 0;          /// 缓冲区个数
+    uint32_t m_freeBuffers = 0;         /// 已提供给内核且未被预留的缓冲区个数
+    void* m_bufferMem = nullptr;        /// 缓冲区内存
+    size_t m_bufferSize = 0;            /// 每个缓冲区大小
+};
+}  // namespace IM
+
+#endif // __IM_IO_URING_HPP__
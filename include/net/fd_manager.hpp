@@ -12,16 +12,18 @@
  * 主要功能：
  * - 管理文件描述符的初始化状态、类型(socket或普通文件)、阻塞模式等属性
  * - 提供文件描述符超时时间的设置和获取
- * - 实现线程安全的文件描述符获取和删除操作
+ * - 实现线程安全的文件描述符获取和删除操作（按fd下标分块存放，读路径无锁）
  * - 提供RAII机制自动管理文件描述符生命周期
  */
 
 #ifndef __IM_NET_FD_MANAGER_HPP__
 #define __IM_NET_FD_MANAGER_HPP__
 
+#include <atomic>
+
+#include "io/fd_table.hpp"
 #include "io/iomanager.hpp"
 #include "io/lock.hpp"
-#include "memory"
 #include "base/noncopyable.hpp"
 #include "base/singleton.hpp"
 
@@ -29,17 +31,17 @@ namespace IM {
 /**
      * @brief 文件描述符上下文类
      * @details 用于存储和管理单个文件描述符的相关信息，
-     *          包括初始化状态、是否为socket、阻塞模式、超时时间等
+     *          包括初始化状态、是否为socket、阻塞模式、超时时间等。
+     *          对象内嵌在FdManager的分块表中，按fd复用，由FdManager负责启用与回收。
      */
-class FdCtx : public std::enable_shared_from_this<FdCtx> {
-   public:
-    using ptr = std::shared_ptr<FdCtx>;  ///< 智能指针类型定义
+class FdCtx {
+    friend class FdManager;
 
+   public:
     /**
-         * @brief 构造函数
-         * @param[in] fd 文件描述符
+         * @brief 构造函数，构造出的对象处于未启用状态
          */
-    FdCtx(int fd);
+    FdCtx();
 
     /**
          * @brief 析构函数
@@ -115,6 +117,14 @@ class FdCtx : public std::enable_shared_from_this<FdCtx> {
     uint64_t getTimeout(int type) const;
 
    private:
+    /**
+         * @brief 绑定到新的文件描述符并重新初始化
+         * @param[in] fd 文件描述符
+         */
+    void reset(int fd);
+
+   private:
+    std::atomic<bool> m_active;  // 是否已被FdManager启用（对应fd当前受管理）
     bool m_isInit : 1;        // 占用1个bit，表示对象是否已初始化
     bool m_isSocket : 1;      // 占用1个bit，表示是否为socket文件描述符
     bool m_sysNonBlock : 1;   // 占用1个bit，表示系统层面是否设置了非阻塞模式
@@ -127,12 +137,13 @@ class FdCtx : public std::enable_shared_from_this<FdCtx> {
 
 /**
      * @brief 文件描述符管理器类
-     * @details 全局管理所有文件描述符的上下文信息，提供线程安全的访问接口
+     * @details 全局管理所有文件描述符的上下文信息，提供线程安全的访问接口。
+     *          上下文按fd下标内嵌在分块表中：查询无锁、无引用计数，只有创建和删除加锁。
      */
 class FdManager {
    public:
     using ptr = std::shared_ptr<FdManager>;  ///< 智能指针类型定义
-    using RWMutexType = RWMutex;             ///< 读写锁类型定义
+    using MutexType = Mutex;                 ///< 互斥锁类型定义
 
     /**
          * @brief 构造函数
@@ -143,9 +154,10 @@ class FdManager {
          * @brief 获取文件描述符上下文
          * @param[in] fd 文件描述符
          * @param[in] auto_create 是否自动创建，默认为false
-         * @return 文件描述符上下文智能指针
+         * @return 文件描述符上下文，不存在时返回nullptr
+         * @note 返回的指针在进程生命周期内始终有效，但fd关闭后会被新打开的同号fd复用
          */
-    FdCtx::ptr get(int fd, bool auto_create = false);
+    FdCtx* get(int fd, bool auto_create = false);
 
     /**
          * @brief 删除文件描述符上下文
@@ -154,8 +166,8 @@ class FdManager {
     void del(int fd);
 
    private:
-    std::vector<FdCtx::ptr> m_fdCtxs;  ///< 文件描述符上下文容器
-    RWMutexType m_mutex;               ///< 读写锁，保护容器访问安全
+    FdTable<FdCtx> m_fdCtxs;  ///< 文件描述符上下文表
+    MutexType m_mutex;        ///< 保护上下文的启用与删除
 };
 
 using FdMgr = Singleton<FdManager>;  ///< 全局单例模式的文件描述符管理器
@@ -201,6 +201,13 @@ class Socket : public std::enable_shared_from_this<Socket>, Noncopyable {
         return setOption(level, option, &value, sizeof(T));
     }
 
+    /**
+         * @brief 开启 SO_REUSEPORT，允许多个 socket 监听同一地址，由内核分发新连接
+         * @return 是否设置成功
+         * @pre 必须在 bind 之前调用，socket 尚未创建时会先创建
+         */
+    bool setReusePort();
+
     /**
          * @brief 接收connect链接
          * @return 成功返回新连接的socket,失败返回nullptr
@@ -13,11 +13,14 @@
  * - SSL/TLS加密连接支持
  * - 可配置的超时时间和keepalive机制
  * - 灵活的工作线程模型
+ * - 可选 SO_REUSEPORT 多监听模式，由内核在多个线程间分发新连接
+ * - 可选连接线程亲和模式，每个连接固定在一个 IO 线程上处理
  */
 
 #ifndef __IM_NET_TCP_SERVER_HPP__
 #define __IM_NET_TCP_SERVER_HPP__
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
@@ -37,6 +40,8 @@ struct TcpServerConf {
 
     std::vector<std::string> address;         /// 监听地址列表
     int keepalive = 0;                        /// keepalive选项
+    int reuse_port = 0;                       /// 每个地址的 SO_REUSEPORT 监听数，0表示关闭
+    int affinity = 0;                         /// 是否将每个连接固定在一个 IO 线程上处理
     int timeout = 1000 * 2 * 60;              /// 超时时间(毫秒)，默认4分钟
     int ssl = 0;                              /// 是否启用SSL
     std::string id;                           /// 服务器唯一标识
@@ -61,8 +66,9 @@ struct TcpServerConf {
          * @return true表示相等
          */
     bool operator==(const TcpServerConf& oth) const {
-        return address == oth.address && keepalive == oth.keepalive && timeout == oth.timeout &&
-               name == oth.name && ssl == oth.ssl && cert_file == oth.cert_file &&
+        return address == oth.address && keepalive == oth.keepalive &&
+               reuse_port == oth.reuse_port && affinity == oth.affinity &&
+               timeout == oth.timeout && name == oth.name && ssl == oth.ssl && cert_file == oth.cert_file &&
                key_file == oth.key_file && accept_worker == oth.accept_worker &&
                io_worker == oth.io_worker && process_worker == oth.process_worker &&
                args == oth.args && id == oth.id && type == oth.type;
@@ -78,6 +84,8 @@ class LexicalCast<std::string, TcpServerConf> {
         conf.id = node["id"].as<std::string>(conf.id);
         conf.type = node["type"].as<std::string>(conf.type);
         conf.keepalive = node["keepalive"].as<int>(conf.keepalive);
+        conf.reuse_port = node["reuse_port"].as<int>(conf.reuse_port);
+        conf.affinity = node["affinity"].as<int>(conf.affinity);
         conf.timeout = node["timeout"].as<int>(conf.timeout);
         conf.name = node["name"].as<std::string>(conf.name);
         conf.ssl = node["ssl"].as<int>(conf.ssl);
@@ -106,6 +114,8 @@ class LexicalCast<TcpServerConf, std::string> {
         node["type"] = conf.type;
         node["name"] = conf.name;
         node["keepalive"] = conf.keepalive;
+        node["reuse_port"] = conf.reuse_port;
+        node["affinity"] = conf.affinity;
         node["timeout"] = conf.timeout;
         node["ssl"] = conf.ssl;
         node["cert_file"] = conf.cert_file;
@@ -141,6 +151,15 @@ class LexicalCast<TcpServerConf, std::string> {
      * 3. 启动服务器(start)
      * 4. 接受客户端连接并分发到工作协程
      * 5. 子类重写handleClient处理具体业务逻辑
+     *
+     * SO_REUSEPORT 模式(setReusePort(n), n > 0):
+     * 每个地址打开 n 个监听 socket，accept 循环直接运行在 io_worker 上，依次绑定到其不同线程；
+     * 新连接的 handleClient 留在接受它的线程上执行，不再经 accept_worker 跨线程转交。
+     *
+     * 线程亲和模式(setAffinity(true)):
+     * accept_worker 接受的新连接按轮转绑定到 io_worker 的某个线程，之后该连接的协程
+     * 只在这个线程上运行，其 fd 事件也注册在该线程自己的 epoll 上，不再在线程间迁移。
+     * SO_REUSEPORT 模式下连接本就留在接受线程上，效果相同。
      */
 class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
    public:
@@ -216,6 +235,30 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
          */
     void setRecvTimeout(uint64_t v);
 
+    /**
+         * @brief 设置每个地址的 SO_REUSEPORT 监听 socket 数量
+         * @param[in] v 监听数量，0表示关闭（单监听 socket，由 accept_worker 接受连接）
+         * @pre 必须在 bind 之前调用
+         */
+    void setReusePort(uint32_t v);
+
+    /**
+         * @brief 获取每个地址的 SO_REUSEPORT 监听 socket 数量，0表示未开启
+         */
+    uint32_t getReusePort() const;
+
+    /**
+         * @brief 设置是否将每个连接固定在一个 IO 线程上处理
+         * @param[in] v true表示开启线程亲和模式
+         * @pre 必须在 start 之前调用
+         */
+    void setAffinity(bool v);
+
+    /**
+         * @brief 是否开启了线程亲和模式
+         */
+    bool getAffinity() const;
+
     /**
          * @brief 设置服务器名称
          * @param[in] v 服务器名称
@@ -283,6 +326,10 @@ class TcpServer : public std::enable_shared_from_this<TcpServer>, Noncopyable {
     std::string m_type = "tcp";        /// 服务器类型
     bool m_isRun;                      /// 服务是否运行
     bool m_ssl = false;                /// 是否启用SSL
+    uint32_t m_reusePort = 0;          /// 每个地址的 SO_REUSEPORT 监听数，0表示关闭
+    bool m_affinity = false;           /// 是否将连接固定在 IO 线程上
+    std::vector<pid_t> m_ioThreads;    /// 亲和模式下轮转分配连接的 IO 线程
+    std::atomic<uint32_t> m_nextIoThread{0};  /// 下一个分配连接的 IO 线程下标
     TcpServerConf::ptr m_conf;         /// 服务器配置
 };
 }  // namespace IM
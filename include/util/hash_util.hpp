@@ -13,9 +13,15 @@ uint64_t murmur3_hash64(const char* str, const uint32_t& seed = 1060627423,
 uint32_t murmur3_hash(const void* str, const uint32_t& size, const uint32_t& seed = 1060627423);
 uint64_t murmur3_hash64(const void* str, const uint32_t& size, const uint32_t& seed = 1060627423,
                         const uint32_t& seed2 = 1050126127);
+/// MurmurHash3_x64_128，out[0]/out[1] 为结果的低/高 64 位
+void murmur3_hash128(const void* data, size_t size, uint32_t seed, uint64_t out[2]);
 uint32_t quick_hash(const char* str);
 uint32_t quick_hash(const void* str, uint32_t size);
 
+/// hex/base64 编解码使用的向量指令集："avx2"、"sse4.1" 或 "scalar"
+/// 首次调用时按 CPU 选择；环境变量 IM_HASH_SIMD=scalar|sse4.1 可限制最高级别
+const char* hash_simd_level();
+
 std::string base64decode(const std::string& src);
 std::string base64encode(const std::string& data);
 std::string base64encode(const void* data, size_t len);
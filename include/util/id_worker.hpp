@@ -4,14 +4,15 @@
 #include <atomic>
 #include <cstdint>
 #include <mutex>
+#include <string>
 
 namespace IM::util {
 
 // 轻量雪花ID生成器 (Twitter Snowflake 风格)
-// 注意：当前项目已改为使用数据库自增 ID，雪花ID生成器保留为可选/兼容实现。
+// 用途：服务端生成的消息ID（im_message.id）使用其有序 HEX 形式，见 NextHexId()。
 // 64-bit 格式（从高位到低位）：
 // 1 bit sign(0) | 41 bit timestamp(ms since epoch) | 10 bit worker id | 12 bit sequence
-// 可通过 IdWorker::Init(worker_id) 初始化 worker id，随后调用 NextId() 获取唯一 ID（如需恢复分布式ID，请在启动时初始化）。
+// 可通过 IdWorker::Init(worker_id) 初始化 worker id，随后调用 NextId() 获取唯一 ID（Application 启动时以 machine.code 初始化）。
 
 class IdWorker {
    public:
@@ -24,6 +25,11 @@ class IdWorker {
     // 生成下一个 ID（线程安全）
     uint64_t NextId();
 
+    // 生成 32 位小写 HEX 的有序ID（用于 im_message.id 等 CHAR(32) 主键）
+    // 前 16 位为定长雪花ID（字典序即时间序，InnoDB 插入落在 B+ 树最右侧叶子），
+    // 后 16 位为随机数，仅用于与前端生成的随机 HEX32 ID 共存时降低碰撞概率。
+    std::string NextHexId();
+
     // 当前 worker id
     uint16_t GetWorkerId() const { return worker_id_; }
 
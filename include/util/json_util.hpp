@@ -3,6 +3,7 @@
 
 #include <jsoncpp/json/json.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -34,6 +35,36 @@ class JsonUtil {
                             uint8_t default_value = 0);
     static bool FromString(Json::Value& json, const std::string& v);
     static std::string ToString(const Json::Value& json);
+
+    /**
+     * @brief 解析 JSON 文本
+     * @details 直接在输入上递归下降解析，不经过 istringstream 与 CharReaderBuilder；
+     *          不含转义的字符串直接从输入区间构造，含转义的在线程局部缓冲区中解码
+     * @param[out] json 解析结果，失败时内容未定义
+     * @param[in] data 输入起始地址
+     * @param[in] len 输入长度
+     * @return bool 输入是一个完整合法的 JSON 值时返回true
+     */
+    static bool Parse(Json::Value& json, const char* data, size_t len);
+    static bool Parse(Json::Value& json, const std::string& v) {
+        return Parse(json, v.data(), v.size());
+    }
+
+    /**
+     * @brief 把 JSON 值紧凑序列化并追加到 out
+     * @details 字符串按预计算的转义表写出，非 ASCII 字符原样输出 UTF-8
+     */
+    static void Write(const Json::Value& json, std::string& out);
+    static std::string Write(const Json::Value& json) {
+        std::string out;
+        Write(json, out);
+        return out;
+    }
+
+    /**
+     * @brief 把 [data, data + len) 作为带引号的 JSON 字符串追加到 out
+     */
+    static void WriteString(const char* data, size_t len, std::string& out);
 };
 
 }  // namespace IM
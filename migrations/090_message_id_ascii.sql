@@ -0,0 +1,33 @@
+-- 090_message_id_ascii.sql
+-- 消息ID列改为 ASCII 二进制排序规则
+-- 说明：
+-- - 消息ID 统一为 32 位 HEX（前端生成或服务端 IdWorker::NextHexId 生成的有序ID），
+--   无需 utf8mb4 多字节存储与 *_ai_ci 的排序规则比较；
+-- - 使用 ascii_bin 后主键/二级索引键定长 32 字节、按字节比较，有序ID 的字典序即时间序，
+--   插入落在聚簇索引最右侧叶子页，避免随机ID导致的页分裂；
+-- - 主表与所有引用 im_message.id 的附表需同时修改，外键列的字符集必须一致，
+--   因此在修改期间临时关闭外键检查。
+
+SET FOREIGN_KEY_CHECKS = 0;
+
+ALTER TABLE `im_message`
+  MODIFY `id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '消息ID（有序HEX32，无自增）',
+  MODIFY `quote_msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NULL COMMENT '被引用消息ID（用于回复/引用）';
+
+ALTER TABLE `im_message_forward_map`
+  MODIFY `forward_msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '转发生成的新消息ID（im_message.id）',
+  MODIFY `src_msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '被转发的原消息ID（im_message.id）';
+
+ALTER TABLE `im_message_read`
+  MODIFY `msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '消息ID（im_message.id）';
+
+ALTER TABLE `im_message_user_delete`
+  MODIFY `msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '消息ID（im_message.id）';
+
+ALTER TABLE `im_message_mention`
+  MODIFY `msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NOT NULL COMMENT '消息ID（im_message.id）';
+
+ALTER TABLE `im_talk_session`
+  MODIFY `last_msg_id` CHAR(32) CHARACTER SET ascii COLLATE ascii_bin NULL COMMENT '最后一条消息ID（im_message.id，字符串）';
+
+SET FOREIGN_KEY_CHECKS = 1;
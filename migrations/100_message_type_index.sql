@@ -0,0 +1,10 @@
+-- 100_message_type_index.sql
+-- 按消息类型分页的历史记录索引
+-- 说明：
+-- - LoadHistoryRecords 按 (talk_id, msg_type) 过滤并按 sequence 倒序做键集分页
+--   （WHERE talk_id=? AND msg_type=? AND sequence<? ORDER BY sequence DESC LIMIT ?），
+--   该索引使每一页都是一次有序的索引范围扫描，稀疏类型（文件、投票等）不再需要扫过整个会话；
+-- - 用户侧删除过滤（NOT EXISTS im_message_user_delete）按主键 (msg_id, user_id) 逐行探测。
+
+ALTER TABLE `im_message`
+  ADD KEY `idx_talk_type_seq_desc` (`talk_id`,`msg_type`,`sequence` DESC) COMMENT '按类型与序号倒序分页';
@@ -165,6 +165,25 @@ bool AuthApiModule::onServerReady() {
             return 0;
         });
 
+        /*退出登录接口*/
+        dispatch->addServlet("/api/v1/auth/logout", [](IM::http::HttpRequest::ptr req,
+                                                       IM::http::HttpResponse::ptr res,
+                                                       IM::http::HttpSession::ptr /*session*/) {
+            res->setHeader("Content-Type", "application/json");
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            /* 令牌在自然过期前不再通过校验 */
+            RevokeJwt(GetBearerToken(req));
+            res->setBody(Ok());
+            return 0;
+        });
+
         /*找回密码接口*/
         dispatch->addServlet("/api/v1/auth/forget", [](IM::http::HttpRequest::ptr req,
                                                        IM::http::HttpResponse::ptr res,
@@ -195,6 +214,8 @@ bool AuthApiModule::onServerReady() {
                 res->setBody(Error(forgetResult.code, forgetResult.err));
                 return 0;
             }
+            /* 重置密码前签发的令牌全部失效 */
+            RevokeUserJwts(forgetResult.data.id);
 
             res->setBody(Ok());
             return 0;
@@ -1,5 +1,7 @@
 #include "api/group_api_module.hpp"
 
+#include "app/group_membership_sync.hpp"
+#include "app/group_service.hpp"
 #include "base/macro.hpp"
 #include "common/common.hpp"
 #include "http/http_server.hpp"
@@ -11,9 +13,29 @@ namespace IM::api {
 
 static auto g_logger = IM_LOG_NAME("root");
 
+// 解析用户ID列表：支持数组 [1,2] 或逗号分隔字符串 "1,2"
+static void ParseUserIds(const Json::Value& v, std::vector<uint64_t>& out) {
+    if (v.isArray()) {
+        for (const auto& it : v) {
+            if (it.isUInt64()) {
+                out.push_back(it.asUInt64());
+            } else if (it.isString()) {
+                out.push_back(IM::TypeUtil::Atoi(it.asString()));
+            }
+        }
+    } else if (v.isString()) {
+        for (auto& s : IM::split(v.asString(), ',')) {
+            out.push_back(IM::TypeUtil::Atoi(s));
+        }
+    }
+}
+
 GroupApiModule::GroupApiModule() : Module("api.group", "0.1.0", "builtin") {}
 
 bool GroupApiModule::onServerReady() {
+    // 订阅其它节点的群成员变更通知（未配置 group.membership.sync_redis 时为空操作）
+    IM::app::GroupMembershipSyncMgr::GetInstance()->start();
+
     std::vector<IM::TcpServer::ptr> httpServers;
     if (!IM::Application::GetInstance()->getServer("http", httpServers)) {
         IM_LOG_WARN(g_logger) << "no http servers found when registering group routes";
@@ -127,11 +149,36 @@ bool GroupApiModule::onServerReady() {
             });
 
         // group main
+        /*设置/取消管理员*/
         dispatch->addServlet(
             "/api/v1/group/assign-admin",
-            [](IM::http::HttpRequest::ptr /*req*/, IM::http::HttpResponse::ptr res,
+            [](IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res,
                IM::http::HttpSession::ptr /*session*/) {
                 res->setHeader("Content-Type", "application/json");
+
+                uint64_t group_id = 0, user_id = 0;
+                uint8_t action = 0;
+                Json::Value body;
+                if (ParseBody(req->getBody(), body)) {
+                    group_id = IM::JsonUtil::GetUint64(body, "group_id");
+                    user_id = IM::JsonUtil::GetUint64(body, "user_id");
+                    action = IM::JsonUtil::GetUint8(body, "action");
+                }
+
+                auto uid_result = GetUidFromToken(req, res);
+                if (!uid_result.ok) {
+                    res->setStatus(ToHttpStatus(uid_result.code));
+                    res->setBody(Error(uid_result.code, uid_result.err));
+                    return 0;
+                }
+
+                auto result = IM::app::GroupService::AssignAdmin(uid_result.data, group_id,
+                                                                 user_id, action);
+                if (!result.ok) {
+                    res->setStatus(ToHttpStatus(result.code));
+                    res->setBody(Error(result.code, result.err));
+                    return 0;
+                }
                 res->setBody(Ok());
                 return 0;
             });
@@ -176,10 +223,33 @@ bool GroupApiModule::onServerReady() {
             res->setBody(Ok());
             return 0;
         });
-        dispatch->addServlet("/api/v1/group/invite", [](IM::http::HttpRequest::ptr /*req*/,
+        /*邀请好友入群*/
+        dispatch->addServlet("/api/v1/group/invite", [](IM::http::HttpRequest::ptr req,
                                                         IM::http::HttpResponse::ptr res,
                                                         IM::http::HttpSession::ptr /*session*/) {
             res->setHeader("Content-Type", "application/json");
+
+            uint64_t group_id = 0;
+            std::vector<uint64_t> user_ids;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                group_id = IM::JsonUtil::GetUint64(body, "group_id");
+                ParseUserIds(body["user_ids"], user_ids);
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result = IM::app::GroupService::InviteMembers(uid_result.data, group_id, user_ids);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
             res->setBody(Ok());
             return 0;
         });
@@ -202,17 +272,67 @@ bool GroupApiModule::onServerReady() {
                 res->setBody(Ok(d));
                 return 0;
             });
-        dispatch->addServlet("/api/v1/group/mute", [](IM::http::HttpRequest::ptr /*req*/,
+        /*全员禁言*/
+        dispatch->addServlet("/api/v1/group/mute", [](IM::http::HttpRequest::ptr req,
                                                       IM::http::HttpResponse::ptr res,
                                                       IM::http::HttpSession::ptr /*session*/) {
             res->setHeader("Content-Type", "application/json");
+
+            uint64_t group_id = 0;
+            uint8_t action = 0;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                group_id = IM::JsonUtil::GetUint64(body, "group_id");
+                action = IM::JsonUtil::GetUint8(body, "action");
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result = IM::app::GroupService::SetMute(uid_result.data, group_id, action);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
             res->setBody(Ok());
             return 0;
         });
-        dispatch->addServlet("/api/v1/group/no-speak", [](IM::http::HttpRequest::ptr /*req*/,
+        /*成员禁言*/
+        dispatch->addServlet("/api/v1/group/no-speak", [](IM::http::HttpRequest::ptr req,
                                                           IM::http::HttpResponse::ptr res,
                                                           IM::http::HttpSession::ptr /*session*/) {
             res->setHeader("Content-Type", "application/json");
+
+            uint64_t group_id = 0, user_id = 0;
+            uint8_t action = 0;
+            uint32_t duration = 0;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                group_id = IM::JsonUtil::GetUint64(body, "group_id");
+                user_id = IM::JsonUtil::GetUint64(body, "user_id");
+                action = IM::JsonUtil::GetUint8(body, "action");
+                duration = IM::JsonUtil::GetUint32(body, "duration");
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result = IM::app::GroupService::SetNoSpeak(uid_result.data, group_id, user_id,
+                                                            action, duration);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
             res->setBody(Ok());
             return 0;
         });
@@ -241,18 +361,63 @@ bool GroupApiModule::onServerReady() {
                 res->setBody(Ok());
                 return 0;
             });
+        /*移出群成员*/
         dispatch->addServlet(
             "/api/v1/group/remove-member",
-            [](IM::http::HttpRequest::ptr /*req*/, IM::http::HttpResponse::ptr res,
+            [](IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res,
                IM::http::HttpSession::ptr /*session*/) {
                 res->setHeader("Content-Type", "application/json");
+
+                uint64_t group_id = 0;
+                std::vector<uint64_t> user_ids;
+                Json::Value body;
+                if (ParseBody(req->getBody(), body)) {
+                    group_id = IM::JsonUtil::GetUint64(body, "group_id");
+                    ParseUserIds(body["members_ids"], user_ids);
+                }
+
+                auto uid_result = GetUidFromToken(req, res);
+                if (!uid_result.ok) {
+                    res->setStatus(ToHttpStatus(uid_result.code));
+                    res->setBody(Error(uid_result.code, uid_result.err));
+                    return 0;
+                }
+
+                auto result =
+                    IM::app::GroupService::RemoveMembers(uid_result.data, group_id, user_ids);
+                if (!result.ok) {
+                    res->setStatus(ToHttpStatus(result.code));
+                    res->setBody(Error(result.code, result.err));
+                    return 0;
+                }
                 res->setBody(Ok());
                 return 0;
             });
-        dispatch->addServlet("/api/v1/group/secede", [](IM::http::HttpRequest::ptr /*req*/,
+        /*退出群聊*/
+        dispatch->addServlet("/api/v1/group/secede", [](IM::http::HttpRequest::ptr req,
                                                         IM::http::HttpResponse::ptr res,
                                                         IM::http::HttpSession::ptr /*session*/) {
             res->setHeader("Content-Type", "application/json");
+
+            uint64_t group_id = 0;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                group_id = IM::JsonUtil::GetUint64(body, "group_id");
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result = IM::app::GroupService::Secede(uid_result.data, group_id);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
             res->setBody(Ok());
             return 0;
         });
@@ -1,6 +1,8 @@
 #include "api/message_api_module.hpp"
 
 #include "api/ws_gateway_module.hpp"
+#include "app/message_cache_sync.hpp"
+#include "app/message_envelope.hpp"
 #include "app/message_service.hpp"
 #include "base/macro.hpp"
 #include "common/common.hpp"
@@ -18,6 +20,9 @@ static auto g_logger = IM_LOG_NAME("root");
 MessageApiModule::MessageApiModule() : Module("api.message", "0.1.0", "builtin") {}
 
 bool MessageApiModule::onServerReady() {
+    // 订阅其它节点的最近消息缓存失效通知（未配置 message.recent_cache.sync_redis 时为空操作）
+    IM::app::MessageCacheSyncMgr::GetInstance()->start();
+
     std::vector<IM::TcpServer::ptr> httpServers;
     if (!IM::Application::GetInstance()->getServer("http", httpServers)) {
         IM_LOG_WARN(g_logger) << "no http servers found when registering message routes";
@@ -104,25 +109,10 @@ bool MessageApiModule::onServerReady() {
                 return 0;
             }
 
-            Json::Value root;
-            Json::Value items(Json::arrayValue);
-            for (auto& r : svc_ret.data) {
-                Json::Value it;
-                it["msg_id"] = r.msg_id;
-                it["sequence"] = r.sequence;
-                it["msg_type"] = r.msg_type;
-                it["from_id"] = r.from_id;
-                it["nickname"] = r.nickname;
-                it["avatar"] = r.avatar;
-                it["is_revoked"] = r.is_revoked;
-                it["status"] = r.status;
-                it["send_time"] = r.send_time;
-                it["extra"] = r.extra;
-                it["quote"] = r.quote;
-                items.append(it);
-            }
-            root["items"] = items;
-            res->setBody(Ok(root));
+            std::string out = "{\"items\":";
+            IM::app::MessageEnvelope::AppendList(svc_ret.data, out);
+            out.push_back('}');
+            res->setBody(out);
             return 0;
         });
 
@@ -157,26 +147,52 @@ bool MessageApiModule::onServerReady() {
                                      res->setBody(Error(svc_ret.code, svc_ret.err));
                                      return 0;
                                  }
-                                 Json::Value root;
-                                 Json::Value items(Json::arrayValue);
-                                 for (auto& r : svc_ret.data.items) {
-                                     Json::Value it;
-                                     it["msg_id"] = r.msg_id;
-                                     it["sequence"] = (Json::UInt64)r.sequence;
-                                     it["msg_type"] = r.msg_type;
-                                     it["from_id"] = (Json::UInt64)r.from_id;
-                                     it["nickname"] = r.nickname;
-                                     it["avatar"] = r.avatar;
-                                     it["is_revoked"] = r.is_revoked;
-                                    it["status"] = r.status;
-                                     it["send_time"] = r.send_time;
-                                     it["extra"] = r.extra;
-                                     it["quote"] = r.quote;
-                                     items.append(it);
+                                 std::string out = "{\"cursor\":" +
+                                                   std::to_string(svc_ret.data.cursor) +
+                                                   ",\"items\":";
+                                 IM::app::MessageEnvelope::AppendList(svc_ret.data.items, out);
+                                 out.push_back('}');
+                                 res->setBody(out);
+                                 return 0;
+                             });
+
+        // 会话内全文检索
+        dispatch->addServlet("/api/v1/message/search",
+                             [](IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res,
+                                IM::http::HttpSession::ptr) {
+                                 res->setHeader("Content-Type", "application/json");
+                                 Json::Value body;
+                                 uint8_t talk_mode = 0;
+                                 uint64_t to_from_id = 0;
+                                 uint64_t cursor = 0;
+                                 uint32_t limit = 0;
+                                 std::string keyword;
+                                 if (ParseBody(req->getBody(), body)) {
+                                     talk_mode = IM::JsonUtil::GetUint8(body, "talk_mode");
+                                     to_from_id = IM::JsonUtil::GetUint64(body, "to_from_id");
+                                     cursor = IM::JsonUtil::GetUint64(body, "cursor");
+                                     limit = IM::JsonUtil::GetUint32(body, "limit");
+                                     keyword = IM::JsonUtil::GetString(body, "keyword");
+                                 }
+                                 auto uid_ret = GetUidFromToken(req, res);
+                                 if (!uid_ret.ok) {
+                                     res->setStatus(ToHttpStatus(uid_ret.code));
+                                     res->setBody(Error(uid_ret.code, uid_ret.err));
+                                     return 0;
+                                 }
+                                 auto svc_ret = IM::app::MessageService::SearchMessages(
+                                     uid_ret.data, talk_mode, to_from_id, keyword, cursor, limit);
+                                 if (!svc_ret.ok) {
+                                     res->setStatus(ToHttpStatus(svc_ret.code));
+                                     res->setBody(Error(svc_ret.code, svc_ret.err));
+                                     return 0;
                                  }
-                                 root["items"] = items;
-                                 root["cursor"] = (Json::UInt64)svc_ret.data.cursor;
-                                 res->setBody(Ok(root));
+                                 std::string out = "{\"cursor\":" +
+                                                   std::to_string(svc_ret.data.cursor) +
+                                                   ",\"items\":";
+                                 IM::app::MessageEnvelope::AppendList(svc_ret.data.items, out);
+                                 out.push_back('}');
+                                 res->setBody(out);
                                  return 0;
                              });
 
@@ -213,26 +229,13 @@ bool MessageApiModule::onServerReady() {
                                      return 0;
                                  }
 
-                                 Json::Value root;
-                                 Json::Value items(Json::arrayValue);
-                                 for (auto& r : svc_ret.data.items) {
-                                     Json::Value it;
-                                     it["msg_id"] = r.msg_id;
-                                     it["sequence"] = r.sequence;
-                                     it["msg_type"] = r.msg_type;
-                                     it["from_id"] = r.from_id;
-                                     it["nickname"] = r.nickname;
-                                     it["avatar"] = r.avatar;
-                                     it["is_revoked"] = r.is_revoked;
-                                    it["status"] = r.status;
-                                     it["send_time"] = r.send_time;
-                                     it["extra"] = r.extra;
-                                     it["quote"] = r.quote;
-                                     items.append(it);
-                                 }
-                                 root["items"] = items;
-                                 root["cursor"] = svc_ret.data.cursor;
-                                 res->setBody(Ok(root));
+                                 // 首屏命中最近消息缓存时，记录直接复用消息信封，无需重新序列化
+                                 std::string out = "{\"cursor\":" +
+                                                   std::to_string(svc_ret.data.cursor) +
+                                                   ",\"items\":";
+                                 IM::app::MessageEnvelope::AppendList(svc_ret.data.items, out);
+                                 out.push_back('}');
+                                 res->setBody(out);
                                  return 0;
                              });
 
@@ -361,8 +364,7 @@ bool MessageApiModule::onServerReady() {
                     return 0;
                 }
             } else {
-                Json::StreamWriterBuilder wb;
-                extra = Json::writeString(wb, payload);
+                extra = IM::JsonUtil::Write(payload);
             }
 
             // 如果是转发并且包含目标 user_ids/group_ids，则对每个目标分发消息
@@ -388,8 +390,7 @@ bool MessageApiModule::onServerReady() {
 
                 auto send_to_target = [&](uint8_t target_mode, uint64_t target_id,
                                           const Json::Value& forward_payload) {
-                    Json::StreamWriterBuilder wb;
-                    std::string fextra = Json::writeString(wb, forward_payload);
+                    std::string fextra = IM::JsonUtil::Write(forward_payload);
                     // 不传 msg_id 保证每个目标生成独立 ID（也可以根据需求由前端传入）
                     auto r = IM::app::MessageService::SendMessage(
                         uid_ret.data, target_mode, target_id, msg_type, std::string(), fextra,
@@ -502,20 +503,9 @@ bool MessageApiModule::onServerReady() {
             // 这里返回的 JSON 结构和 WebSocket 推送保持一致，方便前端统一取用：
             //  - 前端在发送成功后可以直接用 REST 返回渲染出本端消息
             //  - WebSocket 推送用于通知对端/其它设备显示该消息
-            Json::Value root;
-            const auto& r = svc_ret.data;
-            root["msg_id"] = r.msg_id;
-            root["sequence"] = (Json::UInt64)r.sequence;
-            root["msg_type"] = r.msg_type;
-            root["from_id"] = (Json::UInt64)r.from_id;
-            root["nickname"] = r.nickname;
-            root["avatar"] = r.avatar;
-            root["is_revoked"] = r.is_revoked;
-            root["status"] = r.status;
-            root["send_time"] = r.send_time;
-            root["extra"] = r.extra;
-            root["quote"] = r.quote;
-            res->setBody(Ok(root));
+            std::string out;
+            IM::app::MessageEnvelope::Append(svc_ret.data, out);
+            res->setBody(out);
             return 0;
         });
 
@@ -0,0 +1,154 @@
+#include "api/upload_api_module.hpp"
+
+#include "app/upload_service.hpp"
+#include "base/macro.hpp"
+#include "common/common.hpp"
+#include "http/http_server.hpp"
+#include "http/http_servlet.hpp"
+#include "system/application.hpp"
+#include "util/util.hpp"
+
+namespace IM::api {
+
+static auto g_logger = IM_LOG_NAME("root");
+
+// 上传会话 -> 响应数据
+static Json::Value ToJson(const IM::app::UploadSession& s) {
+    Json::Value d;
+    d["upload_id"] = s.upload_id;
+    d["shard_size"] = s.shard_size;
+    d["shard_num"] = s.shard_num;
+    d["uploaded"] = Json::Value(Json::arrayValue);
+    for (auto index : s.uploaded) {
+        d["uploaded"].append(index);
+    }
+    d["is_finished"] = s.finished;
+    if (s.finished) {
+        d["sha256"] = s.sha256;
+    }
+    return d;
+}
+
+// 路径参数中的分片序号，非法时返回 UINT32_MAX 交由服务层拒绝
+static uint32_t ParseSplitIndex(const std::string& v) {
+    if (v.empty() || v.size() > 9 || v.find_first_not_of("0123456789") != std::string::npos) {
+        return UINT32_MAX;
+    }
+    return IM::TypeUtil::Atoi(v);
+}
+
+UploadApiModule::UploadApiModule() : Module("api.upload", "0.1.0", "builtin") {}
+
+bool UploadApiModule::onServerReady() {
+    std::vector<IM::TcpServer::ptr> httpServers;
+    if (!IM::Application::GetInstance()->getServer("http", httpServers)) {
+        IM_LOG_WARN(g_logger) << "no http servers found when registering upload routes";
+        return true;
+    }
+
+    // 过期上传会话的周期清理（幂等）
+    IM::app::UploadService::InitCleanupTimer();
+
+    for (auto& s : httpServers) {
+        auto http = std::dynamic_pointer_cast<IM::http::HttpServer>(s);
+        if (!http) continue;
+        auto dispatch = http->getServletDispatch();
+
+        /*创建分片上传会话*/
+        dispatch->addServlet("/api/v1/upload/init-multipart", [](IM::http::HttpRequest::ptr req,
+                                                                 IM::http::HttpResponse::ptr res,
+                                                                 IM::http::HttpSession::ptr) {
+            res->setHeader("Content-Type", "application/json");
+
+            std::string file_name;
+            uint64_t file_size = 0;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                file_name = IM::JsonUtil::GetString(body, "file_name");
+                file_size = IM::JsonUtil::GetUint64(body, "file_size");
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result =
+                IM::app::UploadService::InitMultipart(uid_result.data, file_name, file_size);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
+            res->setBody(Ok(ToJson(result.data)));
+            return 0;
+        });
+
+        /*查询已上传分片（断点续传）*/
+        dispatch->addServlet("/api/v1/upload/multipart/status", [](IM::http::HttpRequest::ptr req,
+                                                                   IM::http::HttpResponse::ptr res,
+                                                                   IM::http::HttpSession::ptr) {
+            res->setHeader("Content-Type", "application/json");
+
+            std::string upload_id;
+            Json::Value body;
+            if (ParseBody(req->getBody(), body)) {
+                upload_id = IM::JsonUtil::GetString(body, "upload_id");
+            }
+
+            auto uid_result = GetUidFromToken(req, res);
+            if (!uid_result.ok) {
+                res->setStatus(ToHttpStatus(uid_result.code));
+                res->setBody(Error(uid_result.code, uid_result.err));
+                return 0;
+            }
+
+            auto result = IM::app::UploadService::GetStatus(uid_result.data, upload_id);
+            if (!result.ok) {
+                res->setStatus(ToHttpStatus(result.code));
+                res->setBody(Error(result.code, result.err));
+                return 0;
+            }
+            res->setBody(Ok(ToJson(result.data)));
+            return 0;
+        });
+
+        /*上传分片：请求体为分片原始数据，流式写盘；可选 X-Content-SHA256 校验*/
+        dispatch->addRoute(
+            IM::http::HttpMethod::POST, "/api/v1/upload/multipart/:upload_id/:split_index",
+            std::make_shared<IM::http::FunctionServlet>(
+                [](IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res,
+                   IM::http::HttpSession::ptr session) {
+                    res->setHeader("Content-Type", "application/json");
+
+                    auto uid_result = GetUidFromToken(req, res);
+                    if (!uid_result.ok) {
+                        res->setStatus(ToHttpStatus(uid_result.code));
+                        res->setBody(Error(uid_result.code, uid_result.err));
+                        return 0;
+                    }
+
+                    auto reader = [session](int fd, uint64_t max_size,
+                                            const IM::app::UploadService::BodyObserver& observer) {
+                        return session->readBodyTo(fd, max_size, observer);
+                    };
+                    auto result = IM::app::UploadService::WritePart(
+                        uid_result.data, req->getParam("upload_id"),
+                        ParseSplitIndex(req->getParam("split_index")), reader,
+                        req->getHeader("X-Content-SHA256"));
+                    if (!result.ok) {
+                        res->setStatus(ToHttpStatus(result.code));
+                        res->setBody(Error(result.code, result.err));
+                        return 0;
+                    }
+                    res->setBody(Ok(ToJson(result.data)));
+                    return 0;
+                },
+                true));
+    }
+    return true;
+}
+
+}  // namespace IM::api
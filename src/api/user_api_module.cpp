@@ -177,6 +177,8 @@ bool UserApiModule::onServerReady() {
                 res->setBody(Error(result.code, result.err));
                 return 0;
             }
+            /* 修改密码前签发的令牌（包括本次请求所用的）全部失效，需重新登录 */
+            RevokeUserJwts(uid_result.data);
 
             res->setBody(Ok());
             return 0;
@@ -5,9 +5,11 @@
 #include <atomic>
 #include <unordered_map>
 
+#include "app/group_membership.hpp"
 #include "app/user_service.hpp"
 #include "base/macro.hpp"
 #include "common/common.hpp"
+#include "ds/roaring_bitmap.hpp"
 #include "http/ws_server.hpp"
 #include "http/ws_servlet.hpp"
 #include "http/ws_session.hpp"
@@ -58,15 +60,41 @@ struct ConnItem {
     std::weak_ptr<IM::http::WSSession> weak;
 };
 static std::unordered_map<void*, ConnItem> s_ws_conns;
+// 本节点在线用户（至少一个连接）：位图用于与群成员求交，计数表记录每个用户的连接数
+static IM::ds::RoaringBitmap s_online_uids;
+static std::unordered_map<uint64_t, uint32_t> s_online_conns;
+
+// 以下两个函数需在 s_ws_mutex 写锁内调用；uid 超出 uint32 的用户不进位图，群推送时不可达
+static void MarkOnline(uint64_t uid) {
+    if (++s_online_conns[uid] == 1 && uid <= UINT32_MAX) {
+        s_online_uids.set(static_cast<uint32_t>(uid), true);
+    }
+}
 
-// 发送下行统一封装：{"event":"...","payload":{...},"ackid":"..."}
-static void SendEvent(IM::http::WSSession::ptr session, const std::string& event,
-                      const Json::Value& payload, const std::string& ackid = "") {
+static void MarkOffline(uint64_t uid) {
+    auto it = s_online_conns.find(uid);
+    if (it == s_online_conns.end() || --it->second > 0) {
+        return;
+    }
+    s_online_conns.erase(it);
+    if (uid <= UINT32_MAX) {
+        s_online_uids.set(static_cast<uint32_t>(uid), false);
+    }
+}
+
+// 下行统一封装：{"event":"...","payload":{...},"ackid":"..."}
+static std::string EncodeEvent(const std::string& event, const Json::Value& payload,
+                               const std::string& ackid = "") {
     Json::Value root;
     root["event"] = event;
     root["payload"] = payload.isNull() ? Json::Value(Json::objectValue) : payload;
     if (!ackid.empty()) root["ackid"] = ackid;
-    session->sendMessage(IM::JsonUtil::ToString(root));
+    return IM::JsonUtil::ToString(root);
+}
+
+static void SendEvent(IM::http::WSSession::ptr session, const std::string& event,
+                      const Json::Value& payload, const std::string& ackid = "") {
+    session->sendMessage(EncodeEvent(event, payload, ackid));
 }
 
 // 根据 uid 收集当前在线的会话（强引用），避免长时间持锁
@@ -88,6 +116,45 @@ static std::vector<IM::http::WSSession::ptr> CollectSessions(uint64_t uid) {
     return out;
 }
 
+// 把已编码好的下行帧发给 uid 的所有在线连接
+static void SendFrameToUser(uint64_t uid, const std::string& frame) {
+    auto sessions = CollectSessions(uid);
+    for (auto& s : sessions) {
+        s->sendMessage(frame);
+    }
+}
+
+// 把已编码好的下行帧发给群内在本节点在线的成员：成员 ∩ 在线 后一次遍历会话表收集连接
+static void SendFrameToGroup(uint64_t group_id, const std::string& frame) {
+    IM::ds::RoaringBitmap targets;
+    std::string err;
+    if (!IM::app::GroupMembershipMgr::GetInstance()->getMembers(group_id, targets, &err)) {
+        IM_LOG_WARN(g_logger) << "SendFrameToGroup load members failed, group_id=" << group_id
+                              << ", err=" << err;
+        return;
+    }
+    std::vector<IM::http::WSSession::ptr> sessions;
+    {
+        IM::RWMutex::ReadLock lock(s_ws_mutex);
+        targets &= s_online_uids;
+        if (!targets.any()) {
+            return;
+        }
+        for (auto& kv : s_ws_conns) {
+            const auto& item = kv.second;
+            if (item.ctx.uid > UINT32_MAX || !targets.get(static_cast<uint32_t>(item.ctx.uid))) {
+                continue;
+            }
+            if (auto sp = item.weak.lock()) {
+                sessions.push_back(std::move(sp));
+            }
+        }
+    }
+    for (auto& s : sessions) {
+        s->sendMessage(frame);
+    }
+}
+
 bool WsGatewayModule::onServerReady() {
     std::vector<IM::TcpServer::ptr> wsServers;
     // 1. 获取所有已注册的WebSocket服务器实例
@@ -149,6 +216,7 @@ bool WsGatewayModule::onServerReady() {
                 item.ctx = ctx;
                 item.weak = session;
                 s_ws_conns[(void*)session.get()] = std::move(item);
+                MarkOnline(uid);
             }
 
             // 4) 发送欢迎包，event="connect"
@@ -185,7 +253,11 @@ bool WsGatewayModule::onServerReady() {
             // 移除会话表
             {
                 IM::RWMutex::WriteLock lock(s_ws_mutex);
-                s_ws_conns.erase((void*)session.get());
+                auto it = s_ws_conns.find((void*)session.get());
+                if (it != s_ws_conns.end()) {
+                    MarkOffline(it->second.ctx.uid);
+                    s_ws_conns.erase(it);
+                }
             }
             return 0;
         };
@@ -278,29 +350,38 @@ bool WsGatewayModule::onServerReady() {
 // ===== 主动推送接口实现 =====
 void WsGatewayModule::PushToUser(uint64_t uid, const std::string& event, const Json::Value& payload,
                                  const std::string& ackid) {
-    auto sessions = CollectSessions(uid);
-    for (auto& s : sessions) {
-        SendEvent(s, event, payload, ackid);
-    }
+    // 同一用户的多个连接共用一次编码结果
+    SendFrameToUser(uid, EncodeEvent(event, payload, ackid));
+}
+
+void WsGatewayModule::PushToGroup(uint64_t group_id, const std::string& event,
+                                  const Json::Value& payload) {
+    SendFrameToGroup(group_id, EncodeEvent(event, payload));
 }
 
 void WsGatewayModule::PushImMessage(uint8_t talk_mode, uint64_t to_from_id, uint64_t from_id,
-                                    const Json::Value& body) {
-    Json::Value payload;
-    payload["to_from_id"] = to_from_id;
-    payload["from_id"] = from_id;
-    payload["talk_mode"] = talk_mode;
-    payload["body"] = body;
+                                    const std::string& body) {
+    // 整帧只编码一次；body 为消息信封，原样嵌入，不再解析或重新序列化
+    std::string frame;
+    frame.reserve(body.size() + 96);
+    frame.append("{\"event\":\"im.message\",\"payload\":{\"body\":");
+    frame.append(body);
+    frame.append(",\"from_id\":");
+    frame.append(std::to_string(from_id));
+    frame.append(",\"talk_mode\":");
+    frame.append(std::to_string(talk_mode));
+    frame.append(",\"to_from_id\":");
+    frame.append(std::to_string(to_from_id));
+    frame.append("}}");
 
     if (talk_mode == 1) {
         // 单聊：推送给接收方和发送方
         // 不再在服务端做 ID 交换，统一推送标准 payload
-        PushToUser(to_from_id, "im.message", payload);
-        PushToUser(from_id, "im.message", payload);
+        SendFrameToUser(to_from_id, frame);
+        SendFrameToUser(from_id, frame);
     } else {
-        // 群聊：此处暂不实现广播，留待后续根据群成员在线表进行推送
-        // 可以至少给发送者做自我同步，避免多端不一致
-        PushToUser(from_id, "im.message", payload);
+        // 群聊：推送给本节点在线的群成员（含发送者的其它设备）
+        SendFrameToGroup(to_from_id, frame);
     }
 }
 
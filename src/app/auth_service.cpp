@@ -5,6 +5,7 @@
 #include "dao/user_auth_dao.hpp"
 #include "db/mysql.hpp"
 #include "base/macro.hpp"
+#include "io/cpu_pool.hpp"
 #include "util/password.hpp"
 #include "util/util.hpp"
 
@@ -12,15 +13,22 @@ namespace IM::app {
 
 static auto g_logger = IM_LOG_NAME("root");
 static constexpr const char* kDBName = "default";
+static constexpr const char* kCpuBusyErr = "服务繁忙，请稍后重试";
 
 UserResult AuthService::Authenticate(const std::string& mobile, const std::string& password,
                                      const std::string& platform) {
     UserResult result;
     std::string err;
 
-    // 密码解密
+    // 密码解密（RSA 私钥解密较重，交给 CPU 线程池执行，避免阻塞 IO 线程）
     std::string decrypted_pwd;
-    auto dec_res = IM::DecryptPassword(password, decrypted_pwd);
+    PasswordResult dec_res;
+    if (!IM::CpuPoolMgr::GetInstance()->await(
+            [&]() { dec_res = IM::DecryptPassword(password, decrypted_pwd); })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (!dec_res.ok) {
         result.code = dec_res.code;
         result.err = dec_res.err;
@@ -63,8 +71,15 @@ UserResult AuthService::Authenticate(const std::string& mobile, const std::strin
         return result;
     }
 
-    // 验证密码
-    if (!IM::util::Password::Verify(decrypted_pwd, ua.password_hash)) {
+    // 验证密码（PBKDF2）
+    bool verified = false;
+    if (!IM::CpuPoolMgr::GetInstance()->await(
+            [&]() { verified = IM::util::Password::Verify(decrypted_pwd, ua.password_hash); })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
+    if (!verified) {
         result.err = "手机号或密码错误";
         return result;
     }
@@ -120,17 +135,24 @@ UserResult AuthService::Register(const std::string& nickname, const std::string&
     UserResult result;
     std::string err;
 
-    // 密码解密
-    std::string decrypted_pwd;
-    auto dec_res = IM::DecryptPassword(password, decrypted_pwd);
+    // 密码解密并生成密码哈希，两步都在 CPU 线程池中完成
+    std::string decrypted_pwd, ph;
+    PasswordResult dec_res;
+    if (!IM::CpuPoolMgr::GetInstance()->await([&]() {
+            dec_res = IM::DecryptPassword(password, decrypted_pwd);
+            if (dec_res.ok) {
+                ph = IM::util::Password::Hash(decrypted_pwd);
+            }
+        })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (!dec_res.ok) {
         result.code = dec_res.code;
         result.err = dec_res.err;
         return result;
     }
-
-    // 生成密码哈希
-    auto ph = IM::util::Password::Hash(decrypted_pwd);
     if (ph.empty()) {
         result.err = "密码哈希生成失败";
         return result;
@@ -204,7 +226,13 @@ UserResult AuthService::Forget(const std::string& mobile, const std::string& new
 
     // 密码解密
     std::string decrypted_pwd;
-    auto dec_res = IM::DecryptPassword(new_password, decrypted_pwd);
+    PasswordResult dec_res;
+    if (!IM::CpuPoolMgr::GetInstance()->await(
+            [&]() { dec_res = IM::DecryptPassword(new_password, decrypted_pwd); })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (!dec_res.ok) {
         result.code = dec_res.code;
         result.err = dec_res.err;
@@ -221,7 +249,13 @@ UserResult AuthService::Forget(const std::string& mobile, const std::string& new
     }
 
     /*生成新密码哈希*/
-    auto password_hash = IM::util::Password::Hash(decrypted_pwd);
+    std::string password_hash;
+    if (!IM::CpuPoolMgr::GetInstance()->await(
+            [&]() { password_hash = IM::util::Password::Hash(decrypted_pwd); })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (password_hash.empty()) {
         result.err = "密码哈希生成失败";
         return result;
@@ -0,0 +1,180 @@
+#include "app/cache_sync.hpp"
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <memory>
+#include <random>
+
+#include "base/macro.hpp"
+#include "db/redis.hpp"
+#include "util/util.hpp"
+
+namespace IM::app {
+
+static auto g_logger = IM_LOG_NAME("root");
+
+namespace {
+
+constexpr int kPollMs = 500;
+constexpr int kRetryMs = 1000;
+
+typedef std::unique_ptr<redisContext, decltype(&redisFree)> ContextPtr;
+
+// 建立订阅连接：认证后 SUBSCRIBE，失败返回空
+ContextPtr Subscribe(const std::string& name, const std::map<std::string, std::string>& conf,
+                     const std::string& channel) {
+    ContextPtr c(nullptr, redisFree);
+    auto it = conf.find("host");
+    if (it == conf.end()) {
+        return c;
+    }
+    const std::string& host = it->second;
+    auto pos = host.find(':');
+    if (pos == std::string::npos) {
+        return c;
+    }
+    timeval tv = {1, 0};
+    c.reset(redisConnectWithTimeout(host.substr(0, pos).c_str(),
+                                    TypeUtil::Atoi(host.substr(pos + 1)), tv));
+    if (!c || c->err) {
+        IM_LOG_WARN(g_logger) << name << " connect failed, host=" << host
+                              << " err=" << (c ? c->errstr : "alloc");
+        c.reset();
+        return c;
+    }
+    it = conf.find("passwd");
+    if (it != conf.end() && !it->second.empty()) {
+        ReplyPtr r((redisReply*)redisCommand(c.get(), "AUTH %s", it->second.c_str()),
+                   freeReplyObject);
+        if (!r || r->type == REDIS_REPLY_ERROR) {
+            IM_LOG_WARN(g_logger) << name << " auth failed, host=" << host;
+            c.reset();
+            return c;
+        }
+    }
+    ReplyPtr r((redisReply*)redisCommand(c.get(), "SUBSCRIBE %s", channel.c_str()),
+               freeReplyObject);
+    if (!r || r->type != REDIS_REPLY_ARRAY) {
+        IM_LOG_WARN(g_logger) << name << " subscribe failed, channel=" << channel;
+        c.reset();
+    }
+    return c;
+}
+
+}  // namespace
+
+CacheSync::CacheSync(const std::string& name, const std::string& redis,
+                     const std::string& channel, MessageHandler on_message,
+                     std::function<void()> on_reset)
+    : m_name(name),
+      m_redis(redis),
+      m_channel(channel),
+      m_onMessage(std::move(on_message)),
+      m_onReset(std::move(on_reset)) {
+    std::random_device rd;
+    m_token = std::to_string(((uint64_t)rd() << 32) | rd());
+}
+
+CacheSync::~CacheSync() {
+    stop();
+}
+
+void CacheSync::start() {
+    if (!isEnabled() || m_started.exchange(true)) {
+        return;
+    }
+    m_thread = std::make_shared<Thread>(std::bind(&CacheSync::run, this), m_name);
+}
+
+void CacheSync::stop() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+    if (m_thread) {
+        m_thread->join();
+        m_thread.reset();
+    }
+}
+
+void CacheSync::publish(const std::string& key) {
+    if (!isEnabled()) {
+        return;
+    }
+    const std::string msg = m_token + ":" + key;
+    if (!RedisUtil::Cmd(m_redis, {"PUBLISH", m_channel, msg})) {
+        IM_LOG_WARN(g_logger) << m_name << " publish failed, key=" << key;
+    }
+}
+
+bool CacheSync::onMessage(const std::string& msg) {
+    auto pos = msg.find(':');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    if (msg.compare(0, pos, m_token) == 0) {
+        return true;
+    }
+    return m_onMessage(msg.substr(pos + 1));
+}
+
+void CacheSync::run() {
+    std::map<std::string, std::string> conf;
+    if (!RedisMgr::GetInstance()->getConfig(m_redis, conf)) {
+        IM_LOG_ERROR(g_logger) << m_name << " redis not configured, name=" << m_redis;
+        return;
+    }
+    bool first = true;
+    while (!m_stopping) {
+        if (!first) {
+            for (int ms = 0; ms < kRetryMs && !m_stopping; ms += kPollMs) {
+                usleep(kPollMs * 1000);
+            }
+        }
+        first = false;
+        ContextPtr c = Subscribe(m_name, conf, m_channel);
+        if (!c) {
+            continue;
+        }
+        // 订阅建立前（或断线期间）的通知可能已丢失
+        m_onReset();
+        IM_LOG_INFO(g_logger) << m_name << " subscribed, channel=" << m_channel;
+
+        while (!m_stopping) {
+            pollfd pfd = {c->fd, POLLIN, 0};
+            int rt = ::poll(&pfd, 1, kPollMs);
+            if (rt == 0 || (rt < 0 && errno == EINTR)) {
+                continue;
+            }
+            if (rt < 0 || redisBufferRead(c.get()) != REDIS_OK) {
+                break;
+            }
+            // 一次读取可能包含多条消息，全部取出后再等待可读
+            void* reply = nullptr;
+            int ok = REDIS_OK;
+            while ((ok = redisGetReplyFromReader(c.get(), &reply)) == REDIS_OK && reply) {
+                ReplyPtr r((redisReply*)reply, freeReplyObject);
+                reply = nullptr;
+                // ["message", channel, payload]
+                if (r->type != REDIS_REPLY_ARRAY || r->elements != 3 ||
+                    r->element[2]->type != REDIS_REPLY_STRING) {
+                    continue;
+                }
+                std::string msg(r->element[2]->str, r->element[2]->len);
+                if (!onMessage(msg)) {
+                    IM_LOG_WARN(g_logger) << m_name << " bad message: " << msg;
+                }
+            }
+            if (ok != REDIS_OK) {
+                break;
+            }
+        }
+        if (!m_stopping) {
+            IM_LOG_WARN(g_logger) << m_name << " connection lost, err="
+                                  << (c->err ? c->errstr : "closed");
+        }
+    }
+}
+
+}  // namespace IM::app
@@ -0,0 +1,406 @@
+#include "app/group_membership.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+
+namespace IM::app {
+
+static auto g_logger = IM_LOG_NAME("root");
+
+static auto g_membership_max_groups = IM::Config::Lookup<uint32_t>(
+    "group.membership.max_groups", 100000, "max groups cached in group membership per node");
+static auto g_membership_ttl = IM::Config::Lookup<uint32_t>(
+    "group.membership.ttl", 10, "group membership cache ttl in seconds (0 = never expire)");
+
+namespace {
+
+constexpr uint64_t kMaxBitmapUid = std::numeric_limits<uint32_t>::max();
+
+bool LoadFromDB(const uint64_t group_id, IM::dao::GroupState& state,
+                std::vector<IM::dao::GroupMemberItem>& members, std::string* err) {
+    std::string e;
+    if (!IM::dao::GroupDao::GetState(group_id, state, &e)) {
+        if (!e.empty()) {
+            if (err) *err = e;
+            return false;
+        }
+        state = IM::dao::GroupState();  // 群不存在
+        return true;
+    }
+    if (state.is_dismissed == 1) {
+        return true;
+    }
+    return IM::dao::GroupDao::ListMembers(group_id, members, err);
+}
+
+}  // namespace
+
+GroupMembership::GroupMembership()
+    : GroupMembership(Options{g_membership_max_groups->getValue(), g_membership_ttl->getValue()},
+                      LoadFromDB) {}
+
+GroupMembership::GroupMembership(const Options& opts, Loader loader)
+    : m_maxShardGroups(std::max<size_t>(opts.max_groups / kShardCount, 1)),
+      m_ttl(opts.ttl),
+      m_loader(std::move(loader)) {}
+
+void GroupMembership::erase(Shard& shard, const uint64_t group_id) {
+    auto it = shard.groups.find(group_id);
+    if (it == shard.groups.end()) {
+        return;
+    }
+    shard.lru.erase(it->second.lru);
+    shard.groups.erase(it);
+}
+
+void GroupMembership::expireMutes(Group& group, const std::time_t now) {
+    if (group.next_unmute == 0 || now < group.next_unmute) {
+        return;
+    }
+    group.next_unmute = 0;
+    for (auto it = group.mute_until.begin(); it != group.mute_until.end();) {
+        if (it->second <= now) {
+            group.muted.set(it->first, false);
+            it = group.mute_until.erase(it);
+            continue;
+        }
+        if (group.next_unmute == 0 || it->second < group.next_unmute) {
+            group.next_unmute = it->second;
+        }
+        ++it;
+    }
+}
+
+bool GroupMembership::build(const uint64_t group_id, Group& out, std::string* err) {
+    IM::dao::GroupState state;
+    std::vector<IM::dao::GroupMemberItem> items;
+    if (!m_loader(group_id, state, items, err)) {
+        return false;
+    }
+    if (state.id == 0 || state.is_dismissed == 1) {
+        out.exists = false;
+        return true;
+    }
+    out.exists = true;
+    out.leader_id = state.leader_id;
+    out.all_mute = state.is_mute == 1;
+
+    const std::time_t now = time(0);
+    std::vector<uint32_t> members;
+    std::vector<uint32_t> admins;
+    members.reserve(items.size());
+    for (auto& item : items) {
+        if (item.user_id > kMaxBitmapUid) {
+            if (err) *err = "user id out of bitmap range";
+            return false;
+        }
+        const uint32_t uid = static_cast<uint32_t>(item.user_id);
+        members.push_back(uid);
+        if (item.role >= kRoleAdmin || item.user_id == state.leader_id) {
+            admins.push_back(uid);
+        }
+        if (item.no_speak_until > now) {
+            out.muted.set(uid, true);
+            out.mute_until[uid] = item.no_speak_until;
+            if (out.next_unmute == 0 || item.no_speak_until < out.next_unmute) {
+                out.next_unmute = item.no_speak_until;
+            }
+        }
+    }
+    out.members.addMany(members.size(), members.data());
+    out.admins.addMany(admins.size(), admins.data());
+    // 用户ID多为连续自增，大群转为 run 容器可明显缩小内存并加快集合运算
+    out.members.runOptimize();
+    return true;
+}
+
+bool GroupMembership::with(const uint64_t group_id, const std::function<void(Group&)>& cb,
+                           std::string* err) {
+    Shard& shard = getShard(group_id);
+    const std::time_t now = time(0);
+    uint64_t token = 0;
+    {
+        Mutex::Lock lock(shard.mutex);
+        auto it = shard.groups.find(group_id);
+        if (it != shard.groups.end()) {
+            Group& group = it->second;
+            if (m_ttl == 0 || (uint64_t)now < group.loaded_at + m_ttl) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, group.lru);
+                expireMutes(group, now);
+                cb(group);
+                return true;
+            }
+            erase(shard, group_id);
+        }
+        token = ++m_tokenSeq;
+        shard.loading[group_id] = token;
+    }
+
+    Group loaded;
+    std::string lerr;
+    const bool ok = build(group_id, loaded, &lerr);
+    loaded.loaded_at = now;
+
+    Mutex::Lock lock(shard.mutex);
+    auto lt = shard.loading.find(group_id);
+    bool valid = false;
+    if (lt != shard.loading.end() && (lt->second == token || lt->second == 0)) {
+        valid = lt->second == token;
+        shard.loading.erase(lt);
+    }
+    if (!ok) {
+        IM_LOG_WARN(g_logger) << "GroupMembership load failed, group_id=" << group_id
+                              << ", err=" << lerr;
+        if (err) *err = lerr;
+        return false;
+    }
+    if (!valid) {
+        // 装载期间发生了变更或有更新的装载，结果仅供本次使用
+        cb(loaded);
+        return true;
+    }
+    erase(shard, group_id);
+    shard.lru.push_front(group_id);
+    loaded.lru = shard.lru.begin();
+    Group& group = shard.groups.emplace(group_id, std::move(loaded)).first->second;
+    while (shard.groups.size() > m_maxShardGroups) {
+        erase(shard, shard.lru.back());
+    }
+    cb(group);
+    return true;
+}
+
+bool GroupMembership::getRole(const uint64_t group_id, const uint64_t user_id, uint8_t& role,
+                              std::string* err) {
+    role = kRoleNone;
+    if (user_id > kMaxBitmapUid) {
+        return true;
+    }
+    const uint32_t uid = static_cast<uint32_t>(user_id);
+    return with(
+        group_id,
+        [&](Group& group) {
+            if (!group.exists || !group.members.get(uid)) {
+                return;
+            }
+            if (user_id == group.leader_id) {
+                role = kRoleLeader;
+            } else {
+                role = group.admins.get(uid) ? kRoleAdmin : kRoleMember;
+            }
+        },
+        err);
+}
+
+VoidResult GroupMembership::checkSpeak(const uint64_t group_id, const uint64_t user_id) {
+    VoidResult result;
+    bool exists = false, member = false, admin = false, muted = false, all_mute = false;
+    if (user_id <= kMaxBitmapUid) {
+        const uint32_t uid = static_cast<uint32_t>(user_id);
+        std::string err;
+        if (!with(
+                group_id,
+                [&](Group& group) {
+                    exists = group.exists;
+                    member = group.members.get(uid);
+                    admin = group.admins.get(uid);
+                    muted = group.muted.get(uid);
+                    all_mute = group.all_mute;
+                },
+                &err)) {
+            result.code = 500;
+            result.err = "群成员加载失败";
+            return result;
+        }
+    }
+    if (!exists) {
+        result.code = 404;
+        result.err = "群聊不存在或已解散";
+        return result;
+    }
+    if (!member) {
+        result.code = 403;
+        result.err = "非群成员，无法发言";
+        return result;
+    }
+    if (muted) {
+        result.code = 403;
+        result.err = "你已被禁言";
+        return result;
+    }
+    if (all_mute && !admin) {
+        result.code = 403;
+        result.err = "全员禁言中";
+        return result;
+    }
+    result.ok = true;
+    return result;
+}
+
+bool GroupMembership::getMembers(const uint64_t group_id, IM::ds::RoaringBitmap& out,
+                                 std::string* err) {
+    return with(
+        group_id,
+        [&](Group& group) {
+            out = group.exists ? group.members : IM::ds::RoaringBitmap();
+        },
+        err);
+}
+
+bool GroupMembership::getSpeakers(const uint64_t group_id, IM::ds::RoaringBitmap& out,
+                                  std::string* err) {
+    return with(
+        group_id,
+        [&](Group& group) {
+            if (!group.exists) {
+                out = IM::ds::RoaringBitmap();
+                return;
+            }
+            out = group.all_mute ? group.admins : group.members;
+            out -= group.muted;
+        },
+        err);
+}
+
+GroupMembership::Group* GroupMembership::prepareUpdate(Shard& shard, const uint64_t group_id) {
+    auto lt = shard.loading.find(group_id);
+    if (lt != shard.loading.end()) {
+        lt->second = 0;
+    }
+    auto it = shard.groups.find(group_id);
+    if (it == shard.groups.end()) {
+        return nullptr;
+    }
+    if (!it->second.exists) {
+        // 缓存的是“群不存在”，整体重新装载
+        erase(shard, group_id);
+        return nullptr;
+    }
+    return &it->second;
+}
+
+void GroupMembership::onJoin(const uint64_t group_id, const std::vector<uint64_t>& user_ids,
+                             const uint8_t role) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    Group* group = prepareUpdate(shard, group_id);
+    if (!group) {
+        return;
+    }
+    for (auto user_id : user_ids) {
+        if (user_id > kMaxBitmapUid) {
+            erase(shard, group_id);
+            return;
+        }
+        const uint32_t uid = static_cast<uint32_t>(user_id);
+        if (group->members.get(uid)) {
+            continue;  // 已在群内，保持原角色与禁言状态
+        }
+        group->members.set(uid, true);
+        if (role >= kRoleAdmin) {
+            group->admins.set(uid, true);
+        }
+    }
+}
+
+void GroupMembership::onLeave(const uint64_t group_id, const std::vector<uint64_t>& user_ids) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    Group* group = prepareUpdate(shard, group_id);
+    if (!group) {
+        return;
+    }
+    for (auto user_id : user_ids) {
+        if (user_id > kMaxBitmapUid) {
+            continue;
+        }
+        const uint32_t uid = static_cast<uint32_t>(user_id);
+        group->members.set(uid, false);
+        group->admins.set(uid, false);
+        group->muted.set(uid, false);
+        group->mute_until.erase(uid);
+    }
+}
+
+void GroupMembership::onRole(const uint64_t group_id, const uint64_t user_id,
+                             const uint8_t role) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    Group* group = prepareUpdate(shard, group_id);
+    if (!group || user_id > kMaxBitmapUid) {
+        return;
+    }
+    const uint32_t uid = static_cast<uint32_t>(user_id);
+    if (!group->members.get(uid)) {
+        return;
+    }
+    group->admins.set(uid, role >= kRoleAdmin);
+    if (role == kRoleLeader) {
+        group->leader_id = user_id;
+    }
+}
+
+void GroupMembership::onNoSpeak(const uint64_t group_id, const uint64_t user_id,
+                                const std::time_t until) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    Group* group = prepareUpdate(shard, group_id);
+    if (!group || user_id > kMaxBitmapUid) {
+        return;
+    }
+    const uint32_t uid = static_cast<uint32_t>(user_id);
+    if (until <= time(0)) {
+        group->muted.set(uid, false);
+        group->mute_until.erase(uid);
+        return;
+    }
+    if (!group->members.get(uid)) {
+        return;
+    }
+    group->muted.set(uid, true);
+    group->mute_until[uid] = until;
+    if (group->next_unmute == 0 || until < group->next_unmute) {
+        group->next_unmute = until;
+    }
+}
+
+void GroupMembership::onMute(const uint64_t group_id, const bool all_mute) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    Group* group = prepareUpdate(shard, group_id);
+    if (group) {
+        group->all_mute = all_mute;
+    }
+}
+
+void GroupMembership::invalidate(const uint64_t group_id) {
+    Shard& shard = getShard(group_id);
+    Mutex::Lock lock(shard.mutex);
+    prepareUpdate(shard, group_id);
+    erase(shard, group_id);
+}
+
+void GroupMembership::invalidateAll() {
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        for (auto& kv : shard.loading) {
+            kv.second = 0;
+        }
+        shard.groups.clear();
+        shard.lru.clear();
+    }
+}
+
+size_t GroupMembership::getGroupCount() {
+    size_t count = 0;
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        count += shard.groups.size();
+    }
+    return count;
+}
+
+}  // namespace IM::app
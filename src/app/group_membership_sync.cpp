@@ -0,0 +1,33 @@
+#include "app/group_membership_sync.hpp"
+
+#include "app/group_membership.hpp"
+#include "config/config.hpp"
+#include "util/util.hpp"
+
+namespace IM::app {
+
+static auto g_sync_redis = IM::Config::Lookup<std::string>(
+    "group.membership.sync_redis", "",
+    "redis.config name used to broadcast group membership invalidations (empty = off)");
+static auto g_sync_channel = IM::Config::Lookup<std::string>(
+    "group.membership.sync_channel", "im:group:membership",
+    "redis pub/sub channel for group membership invalidations");
+
+GroupMembershipSync::GroupMembershipSync()
+    : m_sync(
+          "group_sync", g_sync_redis->getValue(), g_sync_channel->getValue(),
+          [](const std::string& key) {
+              const uint64_t group_id = TypeUtil::Atoi(key);
+              if (group_id == 0) {
+                  return false;
+              }
+              GroupMembershipMgr::GetInstance()->invalidate(group_id);
+              return true;
+          },
+          []() { GroupMembershipMgr::GetInstance()->invalidateAll(); }) {}
+
+void GroupMembershipSync::publish(const uint64_t group_id) {
+    m_sync.publish(std::to_string(group_id));
+}
+
+}  // namespace IM::app
@@ -0,0 +1,448 @@
+#include "app/group_service.hpp"
+
+#include <algorithm>
+
+#include "app/group_membership.hpp"
+#include "app/group_membership_sync.hpp"
+#include "base/macro.hpp"
+#include "db/mysql.hpp"
+
+namespace IM::app {
+
+static auto g_logger = IM_LOG_NAME("root");
+static constexpr const char* kDBName = "default";
+// 长期禁言的到期时间（2100-01-01 00:00:00 UTC）
+static constexpr std::time_t kNoSpeakForever = 4102444800;
+
+// 事务内读取用户在群内的角色（加行锁）。权限相关的判断不读成员缓存：
+// 缓存可能尚未收到其它节点的变更，而管理操作要以数据库为准
+static bool GetRole(const MySQL::ptr& db, const uint64_t group_id, const uint64_t user_id,
+                    uint8_t& role, VoidResult& result) {
+    std::string err;
+    if (!IM::dao::GroupDao::GetRoleForUpdateWithConn(db, group_id, user_id, role, &err)) {
+        IM_LOG_ERROR(g_logger) << "GetRoleForUpdate failed, group_id=" << group_id
+                               << ", user_id=" << user_id << ", err=" << err;
+        result.code = 500;
+        result.err = "群成员查询失败";
+        return false;
+    }
+    return true;
+}
+
+// 读取操作者的角色，不是群成员时返回 403
+static bool GetOperatorRole(const MySQL::ptr& db, const uint64_t group_id,
+                            const uint64_t user_id, uint8_t& role, VoidResult& result) {
+    if (!GetRole(db, group_id, user_id, role, result)) {
+        return false;
+    }
+    if (role == GroupMembership::kRoleNone) {
+        result.code = 403;
+        result.err = "非群成员，无权操作";
+        return false;
+    }
+    return true;
+}
+
+// 开启事务，失败时填充 result
+static MySQLTransaction::ptr Begin(const char* op, const uint64_t group_id, const char* fail,
+                                   MySQL::ptr& db, VoidResult& result) {
+    auto trans = IM::MySQLMgr::GetInstance()->openTransaction(kDBName, false);
+    if (!trans) {
+        IM_LOG_ERROR(g_logger) << op << " openTransaction failed, group_id=" << group_id;
+        result.code = 500;
+        result.err = fail;
+        return nullptr;
+    }
+    db = trans->getMySQL();
+    if (!db) {
+        IM_LOG_ERROR(g_logger) << op << " get transaction connection failed, group_id="
+                               << group_id;
+        result.code = 500;
+        result.err = fail;
+        return nullptr;
+    }
+    return trans;
+}
+
+// 提交事务，失败时回滚并填充 result
+static bool Commit(const MySQLTransaction::ptr& trans, const MySQL::ptr& db, const char* op,
+                   const uint64_t group_id, const char* fail, VoidResult& result) {
+    if (trans->commit()) {
+        return true;
+    }
+    const auto commit_err = db->getErrStr();
+    trans->rollback();
+    IM_LOG_ERROR(g_logger) << op << " commit failed, group_id=" << group_id
+                           << ", err=" << commit_err;
+    result.code = 500;
+    result.err = fail;
+    return false;
+}
+
+VoidResult GroupService::InviteMembers(const uint64_t operator_id, const uint64_t group_id,
+                                       const std::vector<uint64_t>& user_ids) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "邀请入群失败";
+
+    std::vector<uint64_t> ids;
+    ids.reserve(user_ids.size());
+    for (auto id : user_ids) {
+        if (id != 0 && id != operator_id) {
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (ids.empty()) {
+        result.code = 400;
+        result.err = "请选择邀请的好友";
+        return result;
+    }
+
+    // 1. 开启事务：权限校验、成员写入与成员数更新保持一致
+    MySQL::ptr db;
+    auto trans = Begin("InviteMembers", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, operator_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+
+    // 2. 写入成员（已退出的成员恢复）
+    for (auto id : ids) {
+        if (!IM::dao::GroupDao::AddMemberWithConn(db, group_id, id, GroupMembership::kRoleMember,
+                                                  &err)) {
+            trans->rollback();
+            IM_LOG_ERROR(g_logger) << "InviteMembers AddMember failed, group_id=" << group_id
+                                   << ", user_id=" << id << ", err=" << err;
+            result.code = 500;
+            result.err = kFail;
+            return result;
+        }
+    }
+
+    // 3. 回写成员数
+    if (!IM::dao::GroupDao::RefreshMemberNumWithConn(db, group_id, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "InviteMembers RefreshMemberNum failed, group_id=" << group_id
+                               << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "InviteMembers", group_id, kFail, result)) {
+        return result;
+    }
+
+    // 4. 同步本节点成员缓存并通知其它节点
+    GroupMembershipMgr::GetInstance()->onJoin(group_id, ids);
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+VoidResult GroupService::Secede(const uint64_t user_id, const uint64_t group_id) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "退出群聊失败";
+
+    MySQL::ptr db;
+    auto trans = Begin("Secede", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, user_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (role == GroupMembership::kRoleLeader) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "群主不能退出群聊，请先转让群主";
+        return result;
+    }
+
+    if (!IM::dao::GroupDao::RemoveMemberWithConn(db, group_id, user_id, &err) ||
+        !IM::dao::GroupDao::RefreshMemberNumWithConn(db, group_id, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "Secede failed, group_id=" << group_id
+                               << ", user_id=" << user_id << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "Secede", group_id, kFail, result)) {
+        return result;
+    }
+
+    GroupMembershipMgr::GetInstance()->onLeave(group_id, {user_id});
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+VoidResult GroupService::RemoveMembers(const uint64_t operator_id, const uint64_t group_id,
+                                       const std::vector<uint64_t>& user_ids) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "移出群成员失败";
+
+    MySQL::ptr db;
+    auto trans = Begin("RemoveMembers", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, operator_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (role < GroupMembership::kRoleAdmin) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "仅管理员可移出成员";
+        return result;
+    }
+
+    // 只移出角色低于操作者的成员；不在群内的忽略
+    std::vector<uint64_t> ids;
+    for (auto id : user_ids) {
+        if (id == operator_id) {
+            continue;
+        }
+        uint8_t target_role = 0;
+        if (!GetRole(db, group_id, id, target_role, result)) {
+            trans->rollback();
+            return result;
+        }
+        if (target_role == GroupMembership::kRoleNone) {
+            continue;
+        }
+        if (target_role >= role) {
+            trans->rollback();
+            result.code = 403;
+            result.err = "无权移出管理员或群主";
+            return result;
+        }
+        ids.push_back(id);
+    }
+    if (ids.empty()) {
+        trans->rollback();
+        result.ok = true;
+        return result;
+    }
+
+    for (auto id : ids) {
+        if (!IM::dao::GroupDao::RemoveMemberWithConn(db, group_id, id, &err)) {
+            trans->rollback();
+            IM_LOG_ERROR(g_logger) << "RemoveMembers failed, group_id=" << group_id
+                                   << ", user_id=" << id << ", err=" << err;
+            result.code = 500;
+            result.err = kFail;
+            return result;
+        }
+    }
+    if (!IM::dao::GroupDao::RefreshMemberNumWithConn(db, group_id, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "RemoveMembers RefreshMemberNum failed, group_id=" << group_id
+                               << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "RemoveMembers", group_id, kFail, result)) {
+        return result;
+    }
+
+    GroupMembershipMgr::GetInstance()->onLeave(group_id, ids);
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+VoidResult GroupService::AssignAdmin(const uint64_t operator_id, const uint64_t group_id,
+                                     const uint64_t user_id, const uint8_t action) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "设置管理员失败";
+
+    if (action != 1 && action != 2) {
+        result.code = 400;
+        result.err = "参数错误";
+        return result;
+    }
+    MySQL::ptr db;
+    auto trans = Begin("AssignAdmin", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, operator_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (role != GroupMembership::kRoleLeader) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "仅群主可设置管理员";
+        return result;
+    }
+
+    uint8_t target_role = 0;
+    if (!GetRole(db, group_id, user_id, target_role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (target_role == GroupMembership::kRoleNone || target_role == GroupMembership::kRoleLeader) {
+        trans->rollback();
+        result.code = 400;
+        result.err = "只能对群成员设置管理员";
+        return result;
+    }
+
+    const uint8_t new_role =
+        action == 1 ? GroupMembership::kRoleAdmin : GroupMembership::kRoleMember;
+    if (!IM::dao::GroupDao::UpdateRoleWithConn(db, group_id, user_id, new_role, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "AssignAdmin UpdateRole failed, group_id=" << group_id
+                               << ", user_id=" << user_id << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "AssignAdmin", group_id, kFail, result)) {
+        return result;
+    }
+
+    GroupMembershipMgr::GetInstance()->onRole(group_id, user_id, new_role);
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+VoidResult GroupService::SetNoSpeak(const uint64_t operator_id, const uint64_t group_id,
+                                    const uint64_t user_id, const uint8_t action,
+                                    const uint32_t duration) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "设置禁言失败";
+
+    if (action != 1 && action != 2) {
+        result.code = 400;
+        result.err = "参数错误";
+        return result;
+    }
+    MySQL::ptr db;
+    auto trans = Begin("SetNoSpeak", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, operator_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (role < GroupMembership::kRoleAdmin) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "仅管理员可设置禁言";
+        return result;
+    }
+
+    uint8_t target_role = 0;
+    if (!GetRole(db, group_id, user_id, target_role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (target_role == GroupMembership::kRoleNone) {
+        trans->rollback();
+        result.code = 400;
+        result.err = "该用户不是群成员";
+        return result;
+    }
+    if (target_role >= role) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "无权禁言管理员或群主";
+        return result;
+    }
+
+    std::time_t until = 0;
+    if (action == 1) {
+        until = duration == 0 ? kNoSpeakForever : time(0) + duration;
+    }
+    if (!IM::dao::GroupDao::UpdateNoSpeakWithConn(db, group_id, user_id, until, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "SetNoSpeak failed, group_id=" << group_id
+                               << ", user_id=" << user_id << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "SetNoSpeak", group_id, kFail, result)) {
+        return result;
+    }
+
+    GroupMembershipMgr::GetInstance()->onNoSpeak(group_id, user_id, until);
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+VoidResult GroupService::SetMute(const uint64_t operator_id, const uint64_t group_id,
+                                 const uint8_t action) {
+    VoidResult result;
+    std::string err;
+    const char* kFail = "设置全员禁言失败";
+
+    if (action != 1 && action != 2) {
+        result.code = 400;
+        result.err = "参数错误";
+        return result;
+    }
+    MySQL::ptr db;
+    auto trans = Begin("SetMute", group_id, kFail, db, result);
+    if (!trans) {
+        return result;
+    }
+    uint8_t role = 0;
+    if (!GetOperatorRole(db, group_id, operator_id, role, result)) {
+        trans->rollback();
+        return result;
+    }
+    if (role < GroupMembership::kRoleAdmin) {
+        trans->rollback();
+        result.code = 403;
+        result.err = "仅管理员可设置全员禁言";
+        return result;
+    }
+
+    if (!IM::dao::GroupDao::UpdateMuteWithConn(db, group_id, action, &err)) {
+        trans->rollback();
+        IM_LOG_ERROR(g_logger) << "SetMute failed, group_id=" << group_id << ", err=" << err;
+        result.code = 500;
+        result.err = kFail;
+        return result;
+    }
+
+    if (!Commit(trans, db, "SetMute", group_id, kFail, result)) {
+        return result;
+    }
+
+    GroupMembershipMgr::GetInstance()->onMute(group_id, action == 1);
+    GroupMembershipSyncMgr::GetInstance()->publish(group_id);
+    result.ok = true;
+    return result;
+}
+
+}  // namespace IM::app
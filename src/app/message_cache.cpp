@@ -0,0 +1,337 @@
+#include "app/message_cache.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+#include "app/message_envelope.hpp"
+#include "config/config.hpp"
+
+namespace IM::app {
+
+static auto g_recent_cache_capacity = IM::Config::Lookup<uint32_t>(
+    "message.recent_cache.capacity", 50, "recent messages cached per talk (0 = disabled)");
+static auto g_recent_cache_max_records = IM::Config::Lookup<uint32_t>(
+    "message.recent_cache.max_records", 200000, "max cached message records per node");
+static auto g_recent_cache_ttl = IM::Config::Lookup<uint32_t>(
+    "message.recent_cache.ttl", 300, "recent message cache ttl per talk in seconds (0 = never)");
+
+RecentMessageCache::RecentMessageCache()
+    : RecentMessageCache(Options{g_recent_cache_capacity->getValue(),
+                                 g_recent_cache_max_records->getValue(),
+                                 g_recent_cache_ttl->getValue()}) {}
+
+RecentMessageCache::RecentMessageCache(const Options& opts)
+    : m_capacity(opts.capacity),
+      m_maxShardRecords(std::max<size_t>(opts.max_records / kShardCount, opts.capacity)),
+      m_ttl(opts.ttl) {}
+
+void RecentMessageCache::touch(Shard& shard, TalkRing& ring) {
+    shard.lru.splice(shard.lru.begin(), shard.lru, ring.lru);
+}
+
+void RecentMessageCache::erase(Shard& shard, const uint64_t talk_id) {
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    shard.records -= it->second.items.size();
+    shard.lru.erase(it->second.lru);
+    shard.talks.erase(it);
+}
+
+void RecentMessageCache::insert(Shard& shard, TalkRing& ring, Item&& item) {
+    const uint64_t seq = item.rec.sequence;
+    // 常见情况：新消息追加在尾部；并发提交可能乱序，按 sequence 定位插入
+    auto pos = ring.items.end();
+    while (pos != ring.items.begin() && std::prev(pos)->rec.sequence >= seq) {
+        --pos;
+    }
+    if (pos != ring.items.end() && pos->rec.sequence == seq) {
+        return;  // 已存在
+    }
+    if (ring.items.size() >= m_capacity) {
+        if (pos == ring.items.begin()) {
+            ring.complete = false;  // 比缓存中最旧的还旧，不再缓存
+            return;
+        }
+        ring.items.pop_front();
+        ring.complete = false;
+        --shard.records;
+        // pop_front 使 deque 迭代器失效，重新定位
+        pos = std::lower_bound(
+            ring.items.begin(), ring.items.end(), seq,
+            [](const Item& a, const uint64_t s) { return a.rec.sequence < s; });
+    }
+    ring.items.insert(pos, std::move(item));
+    ++shard.records;
+}
+
+void RecentMessageCache::prune(Shard& shard, const uint64_t keep_talk_id) {
+    while (shard.records > m_maxShardRecords && !shard.lru.empty()) {
+        uint64_t victim = shard.lru.back();
+        if (victim == keep_talk_id) {
+            if (shard.lru.size() == 1) {
+                break;
+            }
+            shard.lru.splice(shard.lru.begin(), shard.lru, std::prev(shard.lru.end()));
+            continue;
+        }
+        erase(shard, victim);
+    }
+}
+
+bool RecentMessageCache::getRecent(const uint64_t talk_id, const uint64_t user_id,
+                                   const size_t limit, std::vector<IM::dao::MessageRecord>& out) {
+    if (!isEnabled() || limit == 0) {
+        return false;
+    }
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end() || it->second.loading) {
+        return false;
+    }
+    auto& ring = it->second;
+    if (m_ttl != 0 && time(0) >= ring.loaded_at + (std::time_t)m_ttl) {
+        erase(shard, talk_id);
+        return false;
+    }
+    touch(shard, ring);
+
+    out.clear();
+    for (auto rit = ring.items.rbegin(); rit != ring.items.rend() && out.size() < limit; ++rit) {
+        if (user_id != 0 &&
+            std::binary_search(rit->deleted_by.begin(), rit->deleted_by.end(), user_id)) {
+            continue;
+        }
+        out.push_back(rit->rec);
+    }
+    // 可见条数不足一页时，只有在缓存覆盖了整个会话的情况下结果才是精确的
+    if (out.size() < limit && !ring.complete) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+uint64_t RecentMessageCache::beginLoad(const uint64_t talk_id) {
+    if (!isEnabled()) {
+        return 0;
+    }
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    if (shard.talks.count(talk_id)) {
+        return 0;
+    }
+    auto& ring = shard.talks[talk_id];
+    ring.loading = true;
+    ring.token = ++m_tokenSeq;
+    ring.loaded_at = time(0);
+    shard.lru.push_front(talk_id);
+    ring.lru = shard.lru.begin();
+    return ring.token;
+}
+
+void RecentMessageCache::finishLoad(const uint64_t talk_id, const uint64_t token,
+                                    std::vector<Item>&& items, bool complete) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end() || it->second.token != token || !it->second.loading) {
+        return;
+    }
+    auto& ring = it->second;
+    if (ring.dirty) {
+        erase(shard, talk_id);
+        return;
+    }
+    // 回源期间 onSend 追加的新消息已在 items 中，按 sequence 合并去重
+    ring.loading = false;
+    ring.complete = complete;
+    for (auto& i : items) {
+        std::sort(i.deleted_by.begin(), i.deleted_by.end());
+        insert(shard, ring, std::move(i));
+    }
+    prune(shard, talk_id);
+}
+
+void RecentMessageCache::abortLoad(const uint64_t talk_id, const uint64_t token) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it != shard.talks.end() && it->second.token == token && it->second.loading) {
+        erase(shard, talk_id);
+    }
+}
+
+void RecentMessageCache::onSend(const uint64_t talk_id, const IM::dao::MessageRecord& rec,
+                                const uint64_t deleted_by) {
+    if (!isEnabled()) {
+        return;
+    }
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    Item item;
+    item.rec = rec;
+    if (deleted_by) {
+        item.deleted_by.push_back(deleted_by);
+    }
+    insert(shard, it->second, std::move(item));
+    prune(shard, talk_id);
+}
+
+void RecentMessageCache::onRevoke(const uint64_t talk_id, const std::string& msg_id) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    auto& ring = it->second;
+    if (ring.loading) {
+        ring.dirty = true;
+    }
+    auto pos = std::find_if(ring.items.begin(), ring.items.end(),
+                            [&msg_id](const Item& i) { return i.rec.msg_id == msg_id; });
+    if (pos != ring.items.end()) {
+        ring.items.erase(pos);
+        --shard.records;
+    }
+}
+
+void RecentMessageCache::onUserDelete(const uint64_t talk_id, const uint64_t user_id,
+                                      const std::vector<std::string>& msg_ids) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    auto& ring = it->second;
+    if (ring.loading) {
+        ring.dirty = true;
+    }
+    for (auto& i : ring.items) {
+        if (std::find(msg_ids.begin(), msg_ids.end(), i.rec.msg_id) == msg_ids.end()) {
+            continue;
+        }
+        auto pos = std::lower_bound(i.deleted_by.begin(), i.deleted_by.end(), user_id);
+        if (pos == i.deleted_by.end() || *pos != user_id) {
+            i.deleted_by.insert(pos, user_id);
+        }
+    }
+}
+
+void RecentMessageCache::onStatus(const uint64_t talk_id, const std::string& msg_id,
+                                  const uint8_t status) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    auto& ring = it->second;
+    if (ring.loading) {
+        ring.dirty = true;
+    }
+    for (auto& i : ring.items) {
+        if (i.rec.msg_id == msg_id) {
+            i.rec.status = status;
+            if (i.rec.json) {
+                MessageEnvelope::Build(i.rec);  // 信封随字段更新，旧信封由持有者继续安全读取
+            }
+            break;
+        }
+    }
+}
+
+void RecentMessageCache::onProfile(const uint64_t user_id, const std::string& nickname,
+                                   const std::string& avatar) {
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        for (auto& kv : shard.talks) {
+            auto& ring = kv.second;
+            if (ring.loading) {
+                ring.dirty = true;  // 回源可能读到修改前的资料
+            }
+            for (auto& i : ring.items) {
+                if (i.rec.from_id != user_id) {
+                    continue;
+                }
+                i.rec.nickname = nickname;
+                i.rec.avatar = avatar;
+                if (i.rec.json) {
+                    MessageEnvelope::Build(i.rec);
+                }
+            }
+        }
+    }
+}
+
+void RecentMessageCache::invalidate(const uint64_t talk_id) {
+    auto& shard = getShard(talk_id);
+    Mutex::Lock lock(shard.mutex);
+    auto it = shard.talks.find(talk_id);
+    if (it == shard.talks.end()) {
+        return;
+    }
+    if (it->second.loading) {
+        it->second.dirty = true;
+        return;
+    }
+    erase(shard, talk_id);
+}
+
+void RecentMessageCache::invalidateSender(const uint64_t user_id) {
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        for (auto it = shard.talks.begin(); it != shard.talks.end();) {
+            auto& ring = it->second;
+            if (ring.loading) {
+                ring.dirty = true;
+                ++it;
+                continue;
+            }
+            bool found = std::any_of(ring.items.begin(), ring.items.end(),
+                                     [user_id](const Item& i) { return i.rec.from_id == user_id; });
+            if (!found) {
+                ++it;
+                continue;
+            }
+            shard.records -= ring.items.size();
+            shard.lru.erase(ring.lru);
+            it = shard.talks.erase(it);
+        }
+    }
+}
+
+void RecentMessageCache::invalidateAll() {
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        for (auto it = shard.talks.begin(); it != shard.talks.end();) {
+            if (it->second.loading) {
+                it->second.dirty = true;
+                ++it;
+                continue;
+            }
+            shard.records -= it->second.items.size();
+            shard.lru.erase(it->second.lru);
+            it = shard.talks.erase(it);
+        }
+    }
+}
+
+size_t RecentMessageCache::getRecordCount() {
+    size_t total = 0;
+    for (auto& shard : m_shards) {
+        Mutex::Lock lock(shard.mutex);
+        total += shard.records;
+    }
+    return total;
+}
+
+}  // namespace IM::app
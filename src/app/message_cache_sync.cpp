@@ -0,0 +1,45 @@
+#include "app/message_cache_sync.hpp"
+
+#include "app/message_cache.hpp"
+#include "config/config.hpp"
+#include "util/util.hpp"
+
+namespace IM::app {
+
+static auto g_sync_redis = IM::Config::Lookup<std::string>(
+    "message.recent_cache.sync_redis", "",
+    "redis.config name used to broadcast recent message cache invalidations (empty = off)");
+static auto g_sync_channel = IM::Config::Lookup<std::string>(
+    "message.recent_cache.sync_channel", "im:message:recent",
+    "redis pub/sub channel for recent message cache invalidations");
+
+MessageCacheSync::MessageCacheSync()
+    : m_sync(
+          "message_sync", g_sync_redis->getValue(), g_sync_channel->getValue(),
+          [](const std::string& key) {
+              if (!key.empty() && key[0] == 'u') {
+                  const uint64_t user_id = TypeUtil::Atoi(key.substr(1));
+                  if (user_id == 0) {
+                      return false;
+                  }
+                  RecentMessageCacheMgr::GetInstance()->invalidateSender(user_id);
+                  return true;
+              }
+              const uint64_t talk_id = TypeUtil::Atoi(key);
+              if (talk_id == 0) {
+                  return false;
+              }
+              RecentMessageCacheMgr::GetInstance()->invalidate(talk_id);
+              return true;
+          },
+          []() { RecentMessageCacheMgr::GetInstance()->invalidateAll(); }) {}
+
+void MessageCacheSync::publish(const uint64_t talk_id) {
+    m_sync.publish(std::to_string(talk_id));
+}
+
+void MessageCacheSync::publishSender(const uint64_t user_id) {
+    m_sync.publish("u" + std::to_string(user_id));
+}
+
+}  // namespace IM::app
@@ -0,0 +1,79 @@
+#include "app/message_envelope.hpp"
+
+#include "util/json_util.hpp"
+
+namespace IM::app {
+
+namespace {
+void AppendKey(std::string& out, const char* key) {
+    out.push_back('"');
+    out.append(key);
+    out.append("\":");
+}
+
+void AppendString(std::string& out, const char* key, const std::string& v) {
+    AppendKey(out, key);
+    IM::JsonUtil::WriteString(v.data(), v.size(), out);
+}
+
+void AppendUint(std::string& out, const char* key, const uint64_t v) {
+    AppendKey(out, key);
+    out.append(std::to_string(v));
+}
+}  // namespace
+
+void MessageEnvelope::Encode(const IM::dao::MessageRecord& rec, std::string& out) {
+    out.push_back('{');
+    AppendString(out, "msg_id", rec.msg_id);
+    out.push_back(',');
+    AppendUint(out, "sequence", rec.sequence);
+    out.push_back(',');
+    AppendUint(out, "msg_type", rec.msg_type);
+    out.push_back(',');
+    AppendUint(out, "from_id", rec.from_id);
+    out.push_back(',');
+    AppendString(out, "nickname", rec.nickname);
+    out.push_back(',');
+    AppendString(out, "avatar", rec.avatar);
+    out.push_back(',');
+    AppendUint(out, "is_revoked", rec.is_revoked);
+    out.push_back(',');
+    AppendUint(out, "status", rec.status);
+    out.push_back(',');
+    AppendString(out, "send_time", rec.send_time);
+    out.push_back(',');
+    AppendString(out, "extra", rec.extra);
+    out.push_back(',');
+    AppendString(out, "quote", rec.quote);
+    out.push_back('}');
+}
+
+void MessageEnvelope::Build(IM::dao::MessageRecord& rec) {
+    auto json = std::make_shared<std::string>();
+    json->reserve(160 + rec.nickname.size() + rec.avatar.size() + rec.extra.size() +
+                  rec.quote.size());
+    Encode(rec, *json);
+    rec.json = std::move(json);
+}
+
+void MessageEnvelope::Append(const IM::dao::MessageRecord& rec, std::string& out) {
+    if (rec.json) {
+        out.append(*rec.json);
+    } else {
+        Encode(rec, out);
+    }
+}
+
+void MessageEnvelope::AppendList(const std::vector<IM::dao::MessageRecord>& recs,
+                                 std::string& out) {
+    out.push_back('[');
+    for (size_t i = 0; i < recs.size(); ++i) {
+        if (i) {
+            out.push_back(',');
+        }
+        Append(recs[i], out);
+    }
+    out.push_back(']');
+}
+
+}  // namespace IM::app
@@ -0,0 +1,1214 @@
+#include "app/message_search.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <queue>
+#include <string_view>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+#include "system/env.hpp"
+#include "util/util.hpp"
+
+namespace IM::app {
+
+static auto g_logger = IM_LOG_NAME("root");
+
+static auto g_search_enabled = IM::Config::Lookup<bool>(
+    "message.search.enabled", true, "enable local message full-text search index");
+static auto g_search_dir = IM::Config::Lookup<std::string>(
+    "message.search.dir", "data/message_search",
+    "message search index dir (relative to work path)");
+static auto g_search_flush_docs = IM::Config::Lookup<uint32_t>(
+    "message.search.flush_docs", 50000, "messages buffered in memory before flushing a segment");
+static auto g_search_merge_segments = IM::Config::Lookup<uint32_t>(
+    "message.search.merge_segments", 8,
+    "merge all segments when segment count reaches this value (0 = off)");
+
+namespace {
+
+constexpr uint32_t kSegmentMagic = 0x4d534547;  // "MSEG"
+constexpr uint32_t kSegmentVersion = 1;
+constexpr size_t kFooterSize = 48;
+constexpr uint32_t kTombMagic = 0x4d54424d;  // "MTBM"
+constexpr uint32_t kSyncedMagic = 0x4d53594e;  // "MSYN"
+constexpr size_t kWalHeaderSize = 1 + 8 + 4 + 4;
+constexpr size_t kMaxWordBytes = 32;
+constexpr size_t kWriteBufferSize = 1 << 20;
+
+enum CharClass { kSep, kWord, kCjk };
+
+uint32_t DecodeUtf8(const unsigned char*& p, const unsigned char* end) {
+    uint32_t c = *p;
+    size_t n = c < 0x80 ? 1 : (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xe ? 3 : (c >> 3) == 0x1e ? 4 : 0;
+    if (n == 0 || p + n > end) {
+        ++p;
+        return 0xfffd;
+    }
+    if (n == 1) {
+        ++p;
+        return c;
+    }
+    c &= (0xff >> (n + 1));
+    for (size_t i = 1; i < n; ++i) {
+        if ((p[i] & 0xc0) != 0x80) {
+            ++p;
+            return 0xfffd;
+        }
+        c = (c << 6) | (p[i] & 0x3f);
+    }
+    p += n;
+    return c;
+}
+
+// 字符分类；ASCII 字母转小写、全角 ASCII 转半角（cp 原地修改）
+CharClass Classify(uint32_t& cp) {
+    if (cp >= 0xff01 && cp <= 0xff5e) {
+        cp -= 0xfee0;
+    }
+    if (cp < 0x80) {
+        if (cp >= 'A' && cp <= 'Z') {
+            cp += 'a' - 'A';
+            return kWord;
+        }
+        return ((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9')) ? kWord : kSep;
+    }
+    if ((cp >= 0x4e00 && cp <= 0x9fff) || (cp >= 0x3400 && cp <= 0x4dbf) ||
+        (cp >= 0xf900 && cp <= 0xfaff) || (cp >= 0x20000 && cp <= 0x3ffff) ||
+        (cp >= 0x3040 && cp <= 0x30ff) || (cp >= 0xac00 && cp <= 0xd7af)) {
+        return kCjk;
+    }
+    if (cp < 0xc0 || cp == 0xd7 || cp == 0xf7 || (cp >= 0x2000 && cp <= 0x2bff) ||
+        (cp >= 0x3000 && cp <= 0x303f) || (cp >= 0xe000 && cp <= 0xf8ff) ||
+        (cp >= 0xfe00 && cp <= 0xfe4f) || (cp >= 0xff00 && cp <= 0xffff) ||
+        (cp >= 0x1f000 && cp <= 0x1faff)) {
+        return kSep;
+    }
+    return kWord;
+}
+
+void PutU32(std::string& out, uint32_t v) { out.append(reinterpret_cast<const char*>(&v), 4); }
+void PutU64(std::string& out, uint64_t v) { out.append(reinterpret_cast<const char*>(&v), 8); }
+uint32_t GetU32(const char* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+uint64_t GetU64(const char* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+bool WriteAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool PreadAll(int fd, char* buf, size_t len, off_t off) {
+    while (len > 0) {
+        ssize_t n = ::pread(fd, buf, len, off);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+        off += n;
+    }
+    return true;
+}
+
+bool ReadFile(const std::string& path, std::string& out) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    bool ok = size >= 0;
+    if (ok) {
+        out.resize(size);
+        ok = PreadAll(fd, &out[0], size, 0);
+    }
+    ::close(fd);
+    return ok;
+}
+
+// 写临时文件 -> fsync -> rename，保证目标文件要么是旧版本要么是完整的新版本
+class AtomicFileWriter {
+   public:
+    explicit AtomicFileWriter(const std::string& path) : m_path(path), m_tmp(path + ".tmp") {
+        m_fd = ::open(m_tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        m_buf.reserve(kWriteBufferSize);
+    }
+    ~AtomicFileWriter() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            ::unlink(m_tmp.c_str());
+        }
+    }
+
+    bool isOpen() const { return m_fd >= 0; }
+    uint64_t offset() const { return m_offset + m_buf.size(); }
+    std::string& buffer() { return m_buf; }
+
+    bool maybeFlush() {
+        if (m_buf.size() < kWriteBufferSize) {
+            return true;
+        }
+        return flushBuffer();
+    }
+
+    bool commit() {
+        if (m_fd < 0 || !flushBuffer() || ::fsync(m_fd) != 0) {
+            return false;
+        }
+        ::close(m_fd);
+        m_fd = -1;
+        return ::rename(m_tmp.c_str(), m_path.c_str()) == 0;
+    }
+
+   private:
+    bool flushBuffer() {
+        if (m_fd < 0 || !WriteAll(m_fd, m_buf.data(), m_buf.size())) {
+            return false;
+        }
+        m_offset += m_buf.size();
+        m_buf.clear();
+        return true;
+    }
+
+   private:
+    std::string m_path;
+    std::string m_tmp;
+    int m_fd = -1;
+    uint64_t m_offset = 0;
+    std::string m_buf;
+};
+
+// 段文件写入：posting 区依次追加，结束时写词典、会话表与 footer
+//   词典项:   [u8 term_len][term][u32 posting_rel]（会话内按词升序；posting_rel 为相对会话 posting
+//            起点的偏移，posting 与词典项一一对应且连续存放）
+//   会话表项: [u64 talk_id][u64 dict_offset][u64 posting_offset][u64 posting_size][u32 term_count]
+//   footer:   [u64 dict_offset][u64 talk_offset][u64 term_count][u64 doc_count]
+//             [u32 talk_count][u32 reserved][u32 version][u32 magic]
+class SegmentWriter {
+   public:
+    explicit SegmentWriter(const std::string& path) : m_file(path) {}
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    bool add(const uint64_t talk_id, std::string_view term, const IM::ds::RoaringBitmap& bm) {
+        if (!beginTerm(talk_id, term)) {
+            return false;
+        }
+        bm.writeTo(m_file.buffer());
+        return m_file.maybeFlush();
+    }
+
+    // 直接拷贝已序列化的 posting（合并时无需改写的词）
+    bool addRaw(const uint64_t talk_id, std::string_view term, std::string_view posting) {
+        if (!beginTerm(talk_id, term)) {
+            return false;
+        }
+        m_file.buffer().append(posting.data(), posting.size());
+        return m_file.maybeFlush();
+    }
+
+    uint64_t getTermCount() const { return m_terms; }
+
+    bool finish(const uint64_t doc_count) {
+        uint64_t dict_off = m_file.offset();
+        if (!m_talks.empty()) {
+            m_talks.back().posting_size = dict_off - m_talks.back().posting_offset;
+        }
+        std::string& buf = m_file.buffer();
+        buf.append(m_dict);
+        uint64_t talk_off = m_file.offset();
+        for (auto& t : m_talks) {
+            PutU64(buf, t.talk_id);
+            PutU64(buf, t.dict_offset);
+            PutU64(buf, t.posting_offset);
+            PutU64(buf, t.posting_size);
+            PutU32(buf, t.count);
+        }
+        PutU64(buf, dict_off);
+        PutU64(buf, talk_off);
+        PutU64(buf, m_terms);
+        PutU64(buf, doc_count);
+        PutU32(buf, static_cast<uint32_t>(m_talks.size()));
+        PutU32(buf, 0);
+        PutU32(buf, kSegmentVersion);
+        PutU32(buf, kSegmentMagic);
+        return m_dict.size() <= UINT32_MAX && m_file.commit();
+    }
+
+   private:
+    struct TalkBlock {
+        uint64_t talk_id;
+        uint64_t dict_offset;
+        uint64_t posting_offset;
+        uint64_t posting_size;
+        uint32_t count;
+    };
+
+    bool beginTerm(const uint64_t talk_id, std::string_view term) {
+        const uint64_t off = m_file.offset();
+        if (m_talks.empty() || m_talks.back().talk_id != talk_id) {
+            if (!m_talks.empty()) {
+                m_talks.back().posting_size = off - m_talks.back().posting_offset;
+            }
+            m_talks.push_back(TalkBlock{talk_id, m_dict.size(), off, 0, 0});
+        }
+        const uint64_t rel = off - m_talks.back().posting_offset;
+        if (rel > UINT32_MAX) {
+            return false;
+        }
+        m_dict.push_back(static_cast<char>(term.size()));
+        m_dict.append(term.data(), term.size());
+        PutU32(m_dict, static_cast<uint32_t>(rel));
+        ++m_talks.back().count;
+        ++m_terms;
+        return true;
+    }
+
+   private:
+    AtomicFileWriter m_file;
+    std::string m_dict;
+    std::vector<TalkBlock> m_talks;
+    uint64_t m_terms = 0;
+};
+
+bool ParseFileId(const std::string& path, const char* prefix, const char* suffix, uint64_t& id) {
+    auto pos = path.rfind('/');
+    std::string name = pos == std::string::npos ? path : path.substr(pos + 1);
+    size_t plen = strlen(prefix), slen = strlen(suffix);
+    if (name.size() <= plen + slen || name.compare(0, plen, prefix) != 0 ||
+        name.compare(name.size() - slen, slen, suffix) != 0) {
+        return false;
+    }
+    std::string digits = name.substr(plen, name.size() - plen - slen);
+    if (digits.find_first_not_of("0123456789") != std::string::npos) {
+        return false;
+    }
+    id = std::stoull(digits);
+    return true;
+}
+
+}  // namespace
+
+// 只读段：整个文件 mmap，加载时只为词典建立偏移索引（每个词 4 字节），查询为两次二分查找
+class MessageSearchIndex::Segment {
+   public:
+    typedef std::shared_ptr<Segment> ptr;
+
+    static ptr Open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        struct stat st;
+        void* addr = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(kFooterSize)) {
+            addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return nullptr;
+        }
+        ptr seg(new Segment(path, static_cast<const char*>(addr), st.st_size));
+        if (!seg->load()) {
+            return nullptr;
+        }
+        return seg;
+    }
+
+    ~Segment() { ::munmap(const_cast<char*>(m_data), m_size); }
+
+    const std::string& getPath() const { return m_path; }
+    uint64_t getDocCount() const { return m_docs; }
+    uint64_t getTermCount() const { return m_terms.size(); }
+    size_t getTalkCount() const { return m_talks.size(); }
+    uint64_t talkId(const size_t t) const { return m_talks[t].talk_id; }
+    // 会话 t 的词在全局序号中的范围 [begin, end)
+    size_t termBegin(const size_t t) const { return m_talks[t].first; }
+    size_t termEnd(const size_t t) const { return m_talks[t].first + m_talks[t].count; }
+
+    std::string_view term(const size_t i) const {
+        const char* p = m_dict + m_terms[i];
+        return std::string_view(p + 1, static_cast<unsigned char>(*p));
+    }
+
+    std::string_view posting(const size_t t, const size_t i) const {
+        const TalkEntry& e = m_talks[t];
+        uint64_t begin = postingRel(i);
+        uint64_t end = i + 1 < e.first + e.count ? postingRel(i + 1) : e.posting_size;
+        return std::string_view(m_data + e.posting_offset + begin, end - begin);
+    }
+
+    bool read(const size_t t, const size_t i, IM::ds::RoaringBitmap& out) const {
+        std::string_view p = posting(t, i);
+        return out.readFrom(p.data(), p.size());
+    }
+
+    bool get(const uint64_t talk_id, std::string_view t, IM::ds::RoaringBitmap& out) const {
+        auto ti = std::lower_bound(
+            m_talks.begin(), m_talks.end(), talk_id,
+            [](const TalkEntry& e, const uint64_t v) { return e.talk_id < v; });
+        if (ti == m_talks.end() || ti->talk_id != talk_id) {
+            return false;
+        }
+        size_t lo = ti->first, hi = ti->first + ti->count;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (term(mid) < t) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == ti->first + ti->count || term(lo) != t) {
+            return false;
+        }
+        return read(ti - m_talks.begin(), lo, out);
+    }
+
+   private:
+    struct TalkEntry {
+        uint64_t talk_id;
+        uint64_t posting_offset;
+        uint64_t posting_size;
+        uint32_t first;
+        uint32_t count;
+    };
+
+    Segment(const std::string& path, const char* data, const size_t size)
+        : m_path(path), m_data(data), m_size(size) {}
+
+    uint32_t postingRel(const size_t i) const {
+        const char* p = m_dict + m_terms[i];
+        return GetU32(p + 1 + static_cast<unsigned char>(*p));
+    }
+
+    bool load() {
+        const char* footer = m_data + m_size - kFooterSize;
+        uint64_t dict_off = GetU64(footer);
+        uint64_t talk_off = GetU64(footer + 8);
+        uint64_t terms = GetU64(footer + 16);
+        m_docs = GetU64(footer + 24);
+        uint32_t talks = GetU32(footer + 32);
+        if (GetU32(footer + 44) != kSegmentMagic || GetU32(footer + 40) != kSegmentVersion ||
+            dict_off > talk_off || talk_off > m_size - kFooterSize ||
+            (m_size - kFooterSize - talk_off) != static_cast<uint64_t>(talks) * kTalkEntrySize ||
+            talk_off - dict_off > UINT32_MAX || terms > UINT32_MAX) {
+            return false;
+        }
+        m_dict = m_data + dict_off;
+        const uint64_t dict_size = talk_off - dict_off;
+        m_talks.reserve(talks);
+        m_terms.reserve(terms);
+        uint64_t pos = 0;
+        uint64_t post = 0;
+        for (uint32_t i = 0; i < talks; ++i) {
+            const char* p = m_data + talk_off + i * kTalkEntrySize;
+            TalkEntry e{GetU64(p), GetU64(p + 16), GetU64(p + 24),
+                        static_cast<uint32_t>(m_terms.size()), GetU32(p + 32)};
+            if ((!m_talks.empty() && m_talks.back().talk_id >= e.talk_id) || e.count == 0 ||
+                GetU64(p + 8) != pos || e.posting_offset != post) {
+                return false;
+            }
+            uint32_t last_rel = 0;
+            for (uint32_t j = 0; j < e.count; ++j) {
+                if (pos + 1 > dict_size ||
+                    pos + 1 + static_cast<unsigned char>(m_dict[pos]) + 4 > dict_size) {
+                    return false;
+                }
+                m_terms.push_back(static_cast<uint32_t>(pos));
+                pos += 1 + static_cast<unsigned char>(m_dict[pos]);
+                uint32_t rel = GetU32(m_dict + pos);
+                if (rel < last_rel || rel > e.posting_size) {
+                    return false;
+                }
+                last_rel = rel;
+                pos += 4;
+            }
+            post += e.posting_size;
+            m_talks.push_back(e);
+        }
+        return m_terms.size() == terms && pos == dict_size && post == dict_off;
+    }
+
+   private:
+    static constexpr size_t kTalkEntrySize = 36;
+
+    std::string m_path;
+    const char* m_data;
+    size_t m_size;
+    const char* m_dict = nullptr;
+    uint64_t m_docs = 0;
+    std::vector<TalkEntry> m_talks;
+    std::vector<uint32_t> m_terms;  // 各词典项在词典区内的偏移
+};
+
+MessageSearchIndex::MessageSearchIndex() {
+    if (!g_search_enabled->getValue()) {
+        return;
+    }
+    m_opts.dir = EnvMgr::GetInstance()->getAbsoluteWorkPath(g_search_dir->getValue());
+    m_opts.flush_docs = g_search_flush_docs->getValue();
+    m_opts.merge_segments = g_search_merge_segments->getValue();
+    init();
+}
+
+MessageSearchIndex::MessageSearchIndex(const Options& opts) : m_opts(opts) {
+    init();
+}
+
+MessageSearchIndex::~MessageSearchIndex() {
+    stop();
+    if (m_walFd >= 0) {
+        ::close(m_walFd);
+    }
+}
+
+void MessageSearchIndex::init() {
+    if (m_opts.flush_docs == 0) {
+        m_opts.flush_docs = 1;
+    }
+    if (!FSUtil::Mkdir(m_opts.dir)) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex mkdir failed, dir=" << m_opts.dir
+                               << " errno=" << errno;
+        return;
+    }
+    m_mem = std::make_shared<MemTable>();
+
+    std::vector<std::string> files;
+    FSUtil::ListAllFile(files, m_opts.dir, "");
+    std::vector<std::pair<uint64_t, std::string>> segs, wals;
+    for (auto& f : files) {
+        uint64_t id = 0;
+        if (f.size() > 4 && f.compare(f.size() - 4, 4, ".tmp") == 0) {
+            ::unlink(f.c_str());  // 未完成的写入
+        } else if (ParseFileId(f, "seg-", ".idx", id)) {
+            segs.emplace_back(id, f);
+        } else if (ParseFileId(f, "wal-", ".log", id)) {
+            wals.emplace_back(id, f);
+        }
+    }
+    std::sort(segs.begin(), segs.end());
+    std::sort(wals.begin(), wals.end());
+
+    for (auto& s : segs) {
+        m_nextSegId = std::max(m_nextSegId, s.first + 1);
+        auto seg = Segment::Open(s.second);
+        if (!seg) {
+            IM_LOG_ERROR(g_logger) << "MessageSearchIndex skip corrupt segment " << s.second;
+            continue;
+        }
+        m_segments.push_back(seg);
+    }
+    loadTombstones();
+    loadSynced();
+    for (auto& w : wals) {
+        m_nextWalId = std::max(m_nextWalId, w.first + 1);
+        if (!replayWal(w.second)) {
+            IM_LOG_WARN(g_logger) << "MessageSearchIndex wal truncated, path=" << w.second;
+        }
+        m_mem->wals.push_back(w.second);
+    }
+    if (!openWal()) {
+        return;
+    }
+    m_enabled = true;
+    m_thread = std::make_shared<Thread>(std::bind(&MessageSearchIndex::run, this), "msg_search");
+    IM_LOG_INFO(g_logger) << "MessageSearchIndex opened, dir=" << m_opts.dir
+                          << " segments=" << m_segments.size() << " replayed_docs=" << m_mem->docs;
+}
+
+void MessageSearchIndex::Tokenize(const std::string& text, std::vector<std::string>& terms,
+                                  bool for_query) {
+    terms.clear();
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(text.data());
+    const unsigned char* end = p + text.size();
+    std::string word;
+    bool word_full = false;
+    std::vector<size_t> cjk;  // 当前 CJK 串各字符起始偏移（末尾追加结束偏移）
+
+    auto flush_word = [&]() {
+        if (!word.empty()) {
+            terms.push_back(word);
+            word.clear();
+        }
+        word_full = false;
+    };
+    auto flush_cjk = [&](size_t end_off) {
+        if (cjk.empty()) {
+            return;
+        }
+        size_t n = cjk.size();
+        cjk.push_back(end_off);
+        if (!for_query || n == 1) {
+            for (size_t i = 0; i < n; ++i) {
+                terms.emplace_back(text, cjk[i], cjk[i + 1] - cjk[i]);
+            }
+        }
+        for (size_t i = 0; i + 1 < n; ++i) {
+            terms.emplace_back(text, cjk[i], cjk[i + 2] - cjk[i]);
+        }
+        cjk.clear();
+    };
+
+    while (p < end) {
+        const unsigned char* start = p;
+        size_t off = start - reinterpret_cast<const unsigned char*>(text.data());
+        uint32_t cp = DecodeUtf8(p, end);
+        CharClass cls = Classify(cp);
+        if (cls != kCjk) {
+            flush_cjk(off);
+        }
+        if (cls != kWord) {
+            flush_word();
+        }
+        if (cls == kCjk) {
+            cjk.push_back(off);
+        } else if (cls == kWord && !word_full) {
+            // 超长词截断（按字符边界）
+            size_t n = cp < 0x80 ? 1 : static_cast<size_t>(p - start);
+            if (word.size() + n > kMaxWordBytes) {
+                word_full = true;
+            } else if (cp < 0x80) {
+                word.push_back(static_cast<char>(cp));
+            } else {
+                word.append(reinterpret_cast<const char*>(start), n);
+            }
+        }
+    }
+    flush_cjk(text.size());
+    flush_word();
+
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+}
+
+bool MessageSearchIndex::openWal() {
+    if (m_walFd >= 0) {
+        ::close(m_walFd);
+    }
+    m_walPath = m_opts.dir + "/wal-" + std::to_string(m_nextWalId++) + ".log";
+    m_walFd = ::open(m_walPath.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (m_walFd < 0) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex open wal failed, path=" << m_walPath
+                               << " errno=" << errno;
+        return false;
+    }
+    return true;
+}
+
+// WAL 记录: [u8 type][u64 talk_id][u32 sequence][u32 len][text]
+// type: 'A' 索引 / 'R' 撤回 / 'S' 覆盖水位（无 text）
+void MessageSearchIndex::appendWal(const char type, const uint64_t talk_id,
+                                   const uint32_t sequence, const std::string& text) {
+    std::string rec;
+    rec.reserve(kWalHeaderSize + text.size());
+    rec.push_back(type);
+    PutU64(rec, talk_id);
+    PutU32(rec, sequence);
+    PutU32(rec, static_cast<uint32_t>(text.size()));
+    rec.append(text);
+    if (m_walFd < 0 || !WriteAll(m_walFd, rec.data(), rec.size())) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex append wal failed, path=" << m_walPath
+                               << " errno=" << errno;
+    }
+}
+
+bool MessageSearchIndex::replayWal(const std::string& path) {
+    std::string data;
+    if (!ReadFile(path, data)) {
+        return false;
+    }
+    std::vector<std::string> terms;
+    size_t pos = 0;
+    while (pos + kWalHeaderSize <= data.size()) {
+        const char* p = data.data() + pos;
+        char type = p[0];
+        uint64_t talk_id = GetU64(p + 1);
+        uint32_t seq = GetU32(p + 9);
+        uint32_t len = GetU32(p + 13);
+        if (pos + kWalHeaderSize + len > data.size()) {
+            break;
+        }
+        if (type == 'A') {
+            Tokenize(std::string(p + kWalHeaderSize, len), terms);
+            applyAdd(*m_mem, talk_id, seq, terms);
+        } else if (type == 'R') {
+            applyRemove(talk_id, seq);
+        } else if (type == 'S') {
+            auto& synced = m_synced[talk_id];
+            synced = std::max(synced, seq);
+        } else {
+            return false;
+        }
+        pos += kWalHeaderSize + len;
+    }
+    return pos == data.size();
+}
+
+void MessageSearchIndex::applyAdd(MemTable& mem, const uint64_t talk_id, const uint32_t sequence,
+                                  const std::vector<std::string>& terms) {
+    auto& talk = mem.talks[talk_id];
+    for (auto& t : terms) {
+        talk[t].push_back(sequence);
+    }
+    ++mem.docs;
+}
+
+void MessageSearchIndex::applyRemove(const uint64_t talk_id, const uint32_t sequence) {
+    m_tombs[talk_id].set(sequence, true);
+    ++m_mem->removes;
+}
+
+bool MessageSearchIndex::add(const uint64_t talk_id, const uint64_t sequence,
+                             const std::string& text) {
+    if (!m_enabled || sequence > UINT32_MAX) {
+        return false;
+    }
+    std::vector<std::string> terms;
+    Tokenize(text, terms);
+    if (terms.empty()) {
+        return false;
+    }
+    bool notify = false;
+    {
+        RWMutex::WriteLock lock(m_mutex);
+        appendWal('A', talk_id, static_cast<uint32_t>(sequence), text);
+        applyAdd(*m_mem, talk_id, static_cast<uint32_t>(sequence), terms);
+        if (m_mem->docs >= m_opts.flush_docs && !m_flushPending.exchange(true)) {
+            notify = true;
+        }
+    }
+    if (notify) {
+        m_sem.notify();
+    }
+    return true;
+}
+
+void MessageSearchIndex::remove(const uint64_t talk_id, const uint64_t sequence) {
+    if (!m_enabled || sequence > UINT32_MAX) {
+        return;
+    }
+    RWMutex::WriteLock lock(m_mutex);
+    appendWal('R', talk_id, static_cast<uint32_t>(sequence), std::string());
+    applyRemove(talk_id, static_cast<uint32_t>(sequence));
+}
+
+uint64_t MessageSearchIndex::getSynced(const uint64_t talk_id) {
+    RWMutex::ReadLock lock(m_mutex);
+    auto it = m_synced.find(talk_id);
+    return it == m_synced.end() ? 0 : it->second;
+}
+
+bool MessageSearchIndex::advanceSynced(const uint64_t talk_id, const uint64_t from,
+                                       const uint64_t to) {
+    if (!m_enabled || to <= from || to > UINT32_MAX) {
+        return false;
+    }
+    RWMutex::WriteLock lock(m_mutex);
+    auto& synced = m_synced[talk_id];
+    if (synced != from) {
+        return false;
+    }
+    synced = static_cast<uint32_t>(to);
+    appendWal('S', talk_id, synced, std::string());
+    return true;
+}
+
+void MessageSearchIndex::search(const uint64_t talk_id, const std::vector<std::string>& terms,
+                                const uint64_t before, const size_t limit,
+                                std::vector<uint64_t>& out) {
+    out.clear();
+    if (!m_enabled || terms.empty() || limit == 0) {
+        return;
+    }
+
+    // 同一条消息的全部词只会出现在同一个数据源（内存表或某个段）里：
+    // 各数据源内部对词求交，数据源之间求并
+    IM::ds::RoaringBitmap result;
+    IM::ds::RoaringBitmap tomb;
+    std::vector<Segment::ptr> segs;
+    auto and_mem = [&](const MemTable& mem) {
+        auto ti = mem.talks.find(talk_id);
+        if (ti == mem.talks.end()) {
+            return;
+        }
+        IM::ds::RoaringBitmap acc;
+        for (size_t i = 0; i < terms.size(); ++i) {
+            auto it = ti->second.find(terms[i]);
+            if (it == ti->second.end()) {
+                return;
+            }
+            IM::ds::RoaringBitmap bm;
+            bm.addMany(it->second.size(), it->second.data());
+            if (i == 0) {
+                acc = bm;
+            } else {
+                acc &= bm;
+            }
+            if (!acc.any()) {
+                return;
+            }
+        }
+        result |= acc;
+    };
+    {
+        RWMutex::ReadLock lock(m_mutex);
+        and_mem(*m_mem);
+        if (m_imm) {
+            and_mem(*m_imm);
+        }
+        segs = m_segments;
+        auto it = m_tombs.find(talk_id);
+        if (it != m_tombs.end()) {
+            tomb |= it->second;
+        }
+        it = m_sealedTombs.find(talk_id);
+        if (it != m_sealedTombs.end()) {
+            tomb |= it->second;
+        }
+    }
+
+    // 段只读，查询不需要持锁
+    for (auto& seg : segs) {
+        IM::ds::RoaringBitmap acc;
+        bool hit = true;
+        for (size_t i = 0; i < terms.size() && hit; ++i) {
+            IM::ds::RoaringBitmap bm;
+            if (!seg->get(talk_id, terms[i], bm)) {
+                hit = false;
+            } else if (i == 0) {
+                acc = bm;
+            } else {
+                acc &= bm;
+                hit = acc.any();
+            }
+        }
+        if (hit) {
+            result |= acc;
+        }
+    }
+
+    result -= tomb;
+    if (before > 0 && before <= UINT32_MAX) {
+        result &= IM::ds::RoaringBitmap(static_cast<uint32_t>(before));
+    }
+    out.reserve(std::min<size_t>(limit, result.getCount()));
+    result.rforeach([&](uint32_t seq) {
+        out.push_back(seq);
+        return out.size() < limit;
+    });
+}
+
+std::string MessageSearchIndex::segmentPath(const uint64_t id) const {
+    return m_opts.dir + "/seg-" + std::to_string(id) + ".idx";
+}
+
+bool MessageSearchIndex::flush() {
+    if (!m_enabled) {
+        return false;
+    }
+    Mutex::Lock lock(m_flushMutex);
+    if (!doFlush()) {
+        return false;
+    }
+    if (m_opts.merge_segments > 0 && getSegmentCount() >= m_opts.merge_segments) {
+        return doMerge();
+    }
+    return true;
+}
+
+bool MessageSearchIndex::merge() {
+    if (!m_enabled) {
+        return false;
+    }
+    Mutex::Lock lock(m_flushMutex);
+    return doMerge();
+}
+
+bool MessageSearchIndex::doFlush() {
+    MemTable::ptr imm;
+    TombMap tombs;
+    SyncedMap synced;
+    uint64_t seg_id = 0;
+    {
+        RWMutex::WriteLock lock(m_mutex);
+        if (m_mem->docs == 0 && m_mem->removes == 0) {
+            return true;
+        }
+        // 冻结内存表并切换 WAL；冻结前的撤回转入 sealed，落盘时一并扣除
+        for (auto& kv : m_tombs) {
+            m_sealedTombs[kv.first] |= kv.second;
+        }
+        m_tombs.clear();
+        tombs = m_sealedTombs;
+        // 冻结时的水位只覆盖冻结内容和已有段，段落盘后才能随 WAL 删除一起持久化
+        synced = m_synced;
+        m_mem->wals.push_back(m_walPath);
+        m_imm = m_mem;
+        imm = m_imm;
+        m_mem = std::make_shared<MemTable>();
+        openWal();
+        seg_id = m_nextSegId++;
+    }
+
+    Segment::ptr seg;
+    bool ok = true;
+    if (!imm->talks.empty()) {
+        std::vector<uint64_t> talk_ids;
+        talk_ids.reserve(imm->talks.size());
+        for (auto& kv : imm->talks) {
+            talk_ids.push_back(kv.first);
+        }
+        std::sort(talk_ids.begin(), talk_ids.end());
+
+        const std::string path = segmentPath(seg_id);
+        SegmentWriter writer(path);
+        ok = writer.isOpen();
+        std::vector<const MemTable::TermMap::value_type*> sorted;
+        for (size_t t = 0; ok && t < talk_ids.size(); ++t) {
+            const uint64_t talk_id = talk_ids[t];
+            auto& term_map = imm->talks.find(talk_id)->second;
+            auto tomb_it = tombs.find(talk_id);
+            const IM::ds::RoaringBitmap* tomb = tomb_it == tombs.end() ? nullptr : &tomb_it->second;
+            sorted.clear();
+            for (auto& kv : term_map) {
+                sorted.push_back(&kv);
+            }
+            std::sort(sorted.begin(), sorted.end(),
+                      [](const auto* a, const auto* b) { return a->first < b->first; });
+            for (size_t i = 0; ok && i < sorted.size(); ++i) {
+                IM::ds::RoaringBitmap bm;
+                bm.addMany(sorted[i]->second.size(), sorted[i]->second.data());
+                if (tomb) {
+                    bm -= *tomb;
+                    if (!bm.any()) {
+                        continue;
+                    }
+                }
+                bm.runOptimize();
+                ok = writer.add(talk_id, sorted[i]->first, bm);
+            }
+        }
+        if (ok && writer.getTermCount() > 0) {
+            ok = writer.finish(imm->docs) && (seg = Segment::Open(path)) != nullptr;
+        }
+    }
+
+    if (!ok) {
+        // 落盘失败：内容并回可写内存表，WAL 保留，等待下次重试
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex flush segment failed, id=" << seg_id
+                               << " errno=" << errno;
+        RWMutex::WriteLock lock(m_mutex);
+        for (auto& talk : imm->talks) {
+            auto& dst_talk = m_mem->talks[talk.first];
+            for (auto& kv : talk.second) {
+                auto& dst = dst_talk[kv.first];
+                dst.insert(dst.end(), kv.second.begin(), kv.second.end());
+            }
+        }
+        m_mem->docs += imm->docs;
+        m_mem->removes += imm->removes;
+        m_mem->wals.insert(m_mem->wals.begin(), imm->wals.begin(), imm->wals.end());
+        m_imm.reset();
+        return false;
+    }
+
+    {
+        RWMutex::WriteLock lock(m_mutex);
+        if (seg) {
+            m_segments.push_back(seg);
+        }
+        m_imm.reset();
+    }
+    // tombstone 与水位先落盘，再删除已经落盘的 WAL（其中的撤回和水位记录依赖它们保存）
+    if (!saveTombstones() || !saveSynced(synced)) {
+        return false;
+    }
+    for (auto& w : imm->wals) {
+        ::unlink(w.c_str());
+    }
+    IM_LOG_INFO(g_logger) << "MessageSearchIndex flushed segment id=" << seg_id
+                          << " docs=" << imm->docs << " terms=" << (seg ? seg->getTermCount() : 0);
+    return true;
+}
+
+bool MessageSearchIndex::doMerge() {
+    std::vector<Segment::ptr> segs;
+    TombMap tombs;
+    uint64_t seg_id = 0;
+    {
+        RWMutex::WriteLock lock(m_mutex);
+        if (m_segments.empty() || (m_segments.size() == 1 && m_sealedTombs.empty())) {
+            return true;
+        }
+        segs = m_segments;
+        tombs = m_sealedTombs;
+        seg_id = m_nextSegId++;
+    }
+
+    // k 路归并：各段均按 (talk_id, 词) 升序，同一词的 posting 求并后扣除 tombstone；
+    // 只出现在一个段且会话无 tombstone 的 posting 原样拷贝
+    struct Cursor {
+        size_t seg;
+        size_t talk;
+        size_t term;
+    };
+    auto talk_of = [&segs](const Cursor& c) { return segs[c.seg]->talkId(c.talk); };
+    auto term_of = [&segs](const Cursor& c) { return segs[c.seg]->term(c.term); };
+    auto greater = [&](const Cursor& a, const Cursor& b) {
+        uint64_t ta = talk_of(a), tb = talk_of(b);
+        return ta != tb ? ta > tb : term_of(a) > term_of(b);
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(greater)> heap(greater);
+    auto advance = [&](Cursor c) {
+        auto& s = segs[c.seg];
+        if (++c.term == s->termEnd(c.talk)) {
+            if (++c.talk == s->getTalkCount()) {
+                return;
+            }
+            c.term = s->termBegin(c.talk);
+        }
+        heap.push(c);
+    };
+    uint64_t docs = 0;
+    for (size_t i = 0; i < segs.size(); ++i) {
+        docs += segs[i]->getDocCount();
+        if (segs[i]->getTalkCount() > 0) {
+            heap.push(Cursor{i, 0, segs[i]->termBegin(0)});
+        }
+    }
+
+    const std::string path = segmentPath(seg_id);
+    SegmentWriter writer(path);
+    bool ok = writer.isOpen();
+    std::vector<Cursor> group;
+    uint64_t cur_talk = 0;
+    const IM::ds::RoaringBitmap* cur_tomb = nullptr;
+    bool first = true;
+    while (ok && !heap.empty()) {
+        const Cursor top = heap.top();
+        const uint64_t talk_id = talk_of(top);
+        const std::string_view term = term_of(top);
+        group.clear();
+        while (!heap.empty() && talk_of(heap.top()) == talk_id && term_of(heap.top()) == term) {
+            group.push_back(heap.top());
+            heap.pop();
+        }
+        if (first || talk_id != cur_talk) {
+            auto it = tombs.find(talk_id);
+            cur_tomb = it == tombs.end() ? nullptr : &it->second;
+            cur_talk = talk_id;
+            first = false;
+        }
+        if (group.size() == 1 && !cur_tomb) {
+            ok = writer.addRaw(talk_id, term, segs[top.seg]->posting(top.talk, top.term));
+        } else {
+            IM::ds::RoaringBitmap acc;
+            for (auto& c : group) {
+                IM::ds::RoaringBitmap bm;
+                if (!segs[c.seg]->read(c.talk, c.term, bm)) {
+                    ok = false;
+                    break;
+                }
+                acc |= bm;
+            }
+            if (cur_tomb) {
+                acc -= *cur_tomb;
+            }
+            if (ok && acc.any()) {
+                acc.runOptimize();
+                ok = writer.add(talk_id, term, acc);
+            }
+        }
+        for (auto& c : group) {
+            advance(c);
+        }
+    }
+    Segment::ptr seg;
+    if (ok && writer.getTermCount() > 0) {
+        ok = writer.finish(docs) && (seg = Segment::Open(path)) != nullptr;
+    }
+    if (!ok) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex merge failed, id=" << seg_id
+                               << " errno=" << errno;
+        return false;
+    }
+
+    {
+        RWMutex::WriteLock lock(m_mutex);
+        // 落盘与合并由 m_flushMutex 串行化，期间段列表不会变化
+        m_segments.clear();
+        if (seg) {
+            m_segments.push_back(seg);
+        }
+        // 参与合并的 sealed tombstone 已从所有段中物理清除
+        for (auto& kv : tombs) {
+            auto it = m_sealedTombs.find(kv.first);
+            if (it == m_sealedTombs.end()) {
+                continue;
+            }
+            it->second -= kv.second;
+            if (!it->second.any()) {
+                m_sealedTombs.erase(it);
+            }
+        }
+    }
+    // 旧段文件可直接删除：进行中的查询持有映射，unlink 后仍可读取
+    for (auto& s : segs) {
+        ::unlink(s->getPath().c_str());
+    }
+    IM_LOG_INFO(g_logger) << "MessageSearchIndex merged " << segs.size()
+                          << " segments into id=" << seg_id << " docs=" << docs
+                          << " terms=" << (seg ? seg->getTermCount() : 0);
+    return saveTombstones();
+}
+
+// tombstones.dat: [u32 magic][u64 count] + count * ([u64 talk_id][u32 size][bitmap])
+bool MessageSearchIndex::saveTombstones() {
+    TombMap all;
+    {
+        RWMutex::ReadLock lock(m_mutex);
+        all = m_sealedTombs;
+        for (auto& kv : m_tombs) {
+            all[kv.first] |= kv.second;
+        }
+    }
+    AtomicFileWriter file(m_opts.dir + "/tombstones.dat");
+    std::string& buf = file.buffer();
+    PutU32(buf, kTombMagic);
+    PutU64(buf, all.size());
+    for (auto& kv : all) {
+        PutU64(buf, kv.first);
+        size_t pos = buf.size();
+        PutU32(buf, 0);
+        kv.second.writeTo(buf);
+        uint32_t size = static_cast<uint32_t>(buf.size() - pos - 4);
+        memcpy(&buf[pos], &size, 4);
+        if (!file.maybeFlush()) {
+            break;
+        }
+    }
+    if (!file.commit()) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex save tombstones failed, errno=" << errno;
+        return false;
+    }
+    return true;
+}
+
+bool MessageSearchIndex::loadTombstones() {
+    std::string data;
+    if (!ReadFile(m_opts.dir + "/tombstones.dat", data)) {
+        return true;  // 不存在
+    }
+    if (data.size() < 12 || GetU32(data.data()) != kTombMagic) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex tombstones.dat corrupt";
+        return false;
+    }
+    uint64_t count = GetU64(data.data() + 4);
+    size_t pos = 12;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (pos + 12 > data.size()) return false;
+        uint64_t talk_id = GetU64(data.data() + pos);
+        uint32_t size = GetU32(data.data() + pos + 8);
+        pos += 12;
+        if (pos + size > data.size()) return false;
+        IM::ds::RoaringBitmap bm;
+        if (!bm.readFrom(data.data() + pos, size)) return false;
+        m_sealedTombs[talk_id] = bm;
+        pos += size;
+    }
+    return true;
+}
+
+// synced.dat: [u32 magic][u64 count] + count * ([u64 talk_id][u32 sequence])
+bool MessageSearchIndex::saveSynced(const SyncedMap& synced) {
+    AtomicFileWriter file(m_opts.dir + "/synced.dat");
+    std::string& buf = file.buffer();
+    PutU32(buf, kSyncedMagic);
+    PutU64(buf, synced.size());
+    for (auto& kv : synced) {
+        PutU64(buf, kv.first);
+        PutU32(buf, kv.second);
+        if (!file.maybeFlush()) {
+            break;
+        }
+    }
+    if (!file.commit()) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex save synced failed, errno=" << errno;
+        return false;
+    }
+    return true;
+}
+
+bool MessageSearchIndex::loadSynced() {
+    std::string data;
+    if (!ReadFile(m_opts.dir + "/synced.dat", data)) {
+        return true;  // 不存在
+    }
+    if (data.size() < 12 || GetU32(data.data()) != kSyncedMagic) {
+        IM_LOG_ERROR(g_logger) << "MessageSearchIndex synced.dat corrupt";
+        return false;
+    }
+    uint64_t count = GetU64(data.data() + 4);
+    if (count > (data.size() - 12) / 12) {
+        return false;
+    }
+    for (size_t pos = 12; count > 0; --count, pos += 12) {
+        m_synced[GetU64(data.data() + pos)] = GetU32(data.data() + pos + 8);
+    }
+    return true;
+}
+
+void MessageSearchIndex::run() {
+    while (true) {
+        m_sem.wait();
+        if (m_stopping) {
+            break;
+        }
+        flush();
+        m_flushPending = false;
+    }
+}
+
+void MessageSearchIndex::stop() {
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+    m_sem.notify();
+    if (m_thread) {
+        m_thread->join();
+        m_thread.reset();
+    }
+}
+
+size_t MessageSearchIndex::getSegmentCount() {
+    RWMutex::ReadLock lock(m_mutex);
+    return m_segments.size();
+}
+
+size_t MessageSearchIndex::getMemDocCount() {
+    RWMutex::ReadLock lock(m_mutex);
+    return m_mem ? m_mem->docs + (m_imm ? m_imm->docs : 0) : 0;
+}
+
+}  // namespace IM::app
@@ -2,13 +2,19 @@
 
 #include <algorithm>
 #include <iomanip>
-#include <sstream>
+#include <unordered_map>
 
 #include "api/ws_gateway_module.hpp"
+#include "app/group_membership.hpp"
+#include "app/message_cache.hpp"
+#include "app/message_cache_sync.hpp"
+#include "app/message_envelope.hpp"
+#include "app/message_search.hpp"
 #include "app/talk_service.hpp"
 #include "base/macro.hpp"
 #include "common/message_preview_map.hpp"
 #include "common/message_type_map.hpp"
+#include "config/config.hpp"
 #include "dao/contact_dao.hpp"
 #include "dao/message_dao.hpp"
 #include "dao/message_forward_map_dao.hpp"
@@ -20,12 +26,18 @@
 #include "dao/talk_session_dao.hpp"
 #include "dao/user_dao.hpp"
 #include "util/hash_util.hpp"
+#include "util/id_worker.hpp"
+#include "util/json_util.hpp"
 
 namespace IM::app {
 
 static auto g_logger = IM_LOG_NAME("root");
 static constexpr const char* kDBName = "default";
 
+static auto g_search_catchup_limit = IM::Config::Lookup<uint32_t>(
+    "message.search.catchup_limit", 500,
+    "max messages indexed inline per search before falling back to a database query");
+
 // 内部辅助函数：统一获取 talk_id
 static bool GetTalkId(const uint64_t current_user_id, const uint8_t talk_mode,
                       const uint64_t to_from_id, uint64_t& talk_id, std::string& err) {
@@ -76,15 +88,8 @@ bool MessageService::buildRecord(const IM::dao::Message& msg, IM::dao::MessageRe
     if (msg.msg_type == 1) {
         extraJson["content"] = msg.content_text;
     } else {
-        if (!msg.extra.empty()) {
-            Json::CharReaderBuilder rb;
-            std::string errs;
-            std::istringstream in(msg.extra);
-            if (Json::parseFromStream(rb, in, &extraJson, &errs)) {
-                // parsed ok
-            } else {
-                extraJson = Json::objectValue;  // 保持空对象
-            }
+        if (!msg.extra.empty() && !IM::JsonUtil::Parse(extraJson, msg.extra)) {
+            extraJson = Json::objectValue;  // 保持空对象
         }
     }
     // 补齐 mentions
@@ -97,8 +102,7 @@ bool MessageService::buildRecord(const IM::dao::Message& msg, IM::dao::MessageRe
             extraJson["mentions"] = arr;
         }
     }
-    Json::StreamWriterBuilder wb;
-    out.extra = Json::writeString(wb, extraJson);
+    out.extra = IM::JsonUtil::Write(extraJson);
 
     // 加载用户信息（昵称/头像）
     IM::dao::UserInfo ui;
@@ -121,13 +125,59 @@ bool MessageService::buildRecord(const IM::dao::Message& msg, IM::dao::MessageRe
             qjson["quote_id"] = quoted.id;
             qjson["from_id"] = (Json::UInt64)quoted.sender_id;
             qjson["content"] = quoted.content_text;  // 仅文本简化
-            Json::StreamWriterBuilder wbq;
-            out.quote = Json::writeString(wbq, qjson);
+            out.quote = IM::JsonUtil::Write(qjson);
         }
     }
     return true;
 }
 
+bool MessageService::fillRecentCache(const uint64_t talk_id) {
+    auto cache = RecentMessageCacheMgr::GetInstance();
+    const uint64_t token = cache->beginLoad(talk_id);
+    if (token == 0) {
+        return false;
+    }
+
+    // 回源不带用户过滤：缓存为整个会话共享，用户侧删除记录随条目保存
+    std::string err;
+    std::vector<IM::dao::Message> msgs;
+    const size_t capacity = cache->getCapacity();
+    if (!IM::dao::MessageDao::ListRecentDescWithFilter(talk_id, /*anchor_seq=*/0, capacity,
+                                                        /*user_id=*/0, /*msg_type=*/0, msgs,
+                                                        &err)) {
+        IM_LOG_WARN(g_logger) << "fillRecentCache ListRecentDescWithFilter failed, talk_id="
+                              << talk_id << ", err=" << err;
+        cache->abortLoad(talk_id, token);
+        return false;
+    }
+
+    std::vector<std::string> ids;
+    ids.reserve(msgs.size());
+    for (auto& m : msgs) ids.push_back(m.id);
+    std::vector<std::pair<std::string, uint64_t>> deletes;
+    if (!IM::dao::MessageUserDeleteDao::ListByMsgIds(ids, deletes, &err)) {
+        IM_LOG_WARN(g_logger) << "fillRecentCache ListByMsgIds failed, talk_id=" << talk_id
+                              << ", err=" << err;
+        cache->abortLoad(talk_id, token);
+        return false;
+    }
+    std::unordered_map<std::string, std::vector<uint64_t>> deleted_by;
+    for (auto& d : deletes) deleted_by[d.first].push_back(d.second);
+
+    // msgs 为 sequence 降序，缓存按升序保存
+    std::vector<RecentMessageCache::Item> items(msgs.size());
+    for (size_t i = 0; i < msgs.size(); ++i) {
+        auto& m = msgs[msgs.size() - 1 - i];
+        std::string rerr;
+        buildRecord(m, items[i].rec, &rerr);
+        MessageEnvelope::Build(items[i].rec);
+        auto it = deleted_by.find(m.id);
+        if (it != deleted_by.end()) items[i].deleted_by = std::move(it->second);
+    }
+    cache->finishLoad(talk_id, token, std::move(items), msgs.size() < capacity);
+    return true;
+}
+
 MessageRecordPageResult MessageService::LoadRecords(const uint64_t current_user_id,
                                                     const uint8_t talk_mode,
                                                     const uint64_t to_from_id, uint64_t cursor,
@@ -154,6 +204,20 @@ MessageRecordPageResult MessageService::LoadRecords(const uint64_t current_user_
         return result;
     }
 
+    // 首屏优先走最近消息缓存（未命中时回源装载一次再读）
+    if (cursor == 0) {
+        auto cache = RecentMessageCacheMgr::GetInstance();
+        IM::dao::MessagePage page;
+        if (cache->getRecent(talk_id, current_user_id, limit, page.items) ||
+            (fillRecentCache(talk_id) &&
+             cache->getRecent(talk_id, current_user_id, limit, page.items))) {
+            page.cursor = page.items.empty() ? cursor : page.items.back().sequence;
+            result.data = std::move(page);
+            result.ok = true;
+            return result;
+        }
+    }
+
     std::vector<IM::dao::Message> msgs;
     // 使用带过滤的查询，过滤掉已被当前用户删除的消息（im_message_user_delete）
     if (!IM::dao::MessageDao::ListRecentDescWithFilter(talk_id, cursor, limit,
@@ -211,23 +275,23 @@ MessageRecordPageResult MessageService::LoadHistoryRecords(const uint64_t curren
         return result;
     }
 
-    // 先取一页，再过滤类型（简单实现；可优化为 SQL 条件）
+    // 类型过滤与用户侧删除过滤都下推到 SQL：由 idx_talk_type_seq_desc 做键集分页，
+    // 每页恰好 limit 条（不足说明已到头），cursor 为本页最小 sequence
     std::vector<IM::dao::Message> msgs;
-    if (!IM::dao::MessageDao::ListRecentDesc(talk_id, cursor, limit * 3, msgs,
-                                              &err)) {  // 加大抓取保证过滤后足够
+    if (!IM::dao::MessageDao::ListRecentDescWithFilter(talk_id, cursor, limit, current_user_id,
+                                                        msg_type, msgs, &err)) {
         result.code = 500;
         result.err = "加载消息失败";
         return result;
     }
 
     IM::dao::MessagePage page;
+    page.items.reserve(msgs.size());
     for (auto& m : msgs) {
-        if (msg_type != 0 && m.msg_type != msg_type) continue;
         IM::dao::MessageRecord rec;
         std::string rerr;
         buildRecord(m, rec, &rerr);
         page.items.push_back(std::move(rec));
-        if (page.items.size() >= limit) break;
     }
     if (!page.items.empty()) {
         page.cursor = page.items.back().sequence;
@@ -239,6 +303,156 @@ MessageRecordPageResult MessageService::LoadHistoryRecords(const uint64_t curren
     return result;
 }
 
+// ASCII 不区分大小写的子串匹配（与检索分词的大小写折叠一致）
+static bool ContainsIgnoreCase(const std::string& text, const std::string& lower_kw) {
+    auto it = std::search(text.begin(), text.end(), lower_kw.begin(), lower_kw.end(),
+                          [](char a, char b) {
+                              return (a >= 'A' && a <= 'Z' ? a + ('a' - 'A') : a) == b;
+                          });
+    return it != text.end();
+}
+
+// 把覆盖水位之后的消息补入检索索引：本节点只索引自己发送的消息，其他节点发送的消息和
+// 启用索引前的历史都需要补录。sequence 在发送事务内按会话串行分配，提交顺序与 sequence 一致，
+// 水位不会越过尚未提交的消息。缺口超过 catchup_limit 条时只补录一批并返回 false，
+// 本次查询改走数据库；之后的查询继续推进，直到索引完整覆盖该会话。
+static bool CatchUpSearchIndex(MessageSearchIndex* index, const uint64_t talk_id) {
+    const size_t limit = g_search_catchup_limit->getValue();
+    const uint64_t synced = index->getSynced(talk_id);
+    std::vector<IM::dao::Message> msgs;
+    std::string err;
+    if (!IM::dao::MessageDao::ListAfterAsc(talk_id, synced, limit + 1, msgs, &err)) {
+        IM_LOG_WARN(g_logger) << "CatchUpSearchIndex ListAfterAsc failed, talk_id=" << talk_id
+                              << " err=" << err;
+        return false;
+    }
+    if (msgs.empty()) {
+        return true;
+    }
+    const bool complete = msgs.size() <= limit;
+    if (!complete) {
+        msgs.resize(limit);
+    }
+    if (msgs.empty()) {
+        return false;
+    }
+    for (auto& m : msgs) {
+        if (m.is_revoked != 1 && !m.content_text.empty()) {
+            index->add(talk_id, m.sequence, m.content_text);
+        }
+    }
+    // 并发补录时只有一方能推进水位，另一方重复写入的 posting 在查询与落盘时去重
+    index->advanceSynced(talk_id, synced, msgs.back().sequence);
+    return complete && index->getSynced(talk_id) >= msgs.back().sequence;
+}
+
+MessageRecordPageResult MessageService::SearchMessages(const uint64_t current_user_id,
+                                                       const uint8_t talk_mode,
+                                                       const uint64_t to_from_id,
+                                                       const std::string& keyword,
+                                                       uint64_t cursor, uint32_t limit) {
+    MessageRecordPageResult result;
+    std::string err;
+    if (limit == 0)
+        limit = 30;
+    else if (limit > 100)
+        limit = 100;
+
+    auto index = MessageSearchIndexMgr::GetInstance();
+    std::vector<std::string> terms;
+    if (keyword.size() <= 256) {
+        MessageSearchIndex::Tokenize(keyword, terms, /*for_query=*/true);
+    }
+    if (terms.empty()) {
+        result.code = 400;
+        result.err = "搜索关键词无效";
+        return result;
+    }
+    std::string lower_kw = keyword;
+    for (auto& c : lower_kw) {
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+    }
+
+    uint64_t talk_id = 0;
+    if (!GetTalkId(current_user_id, talk_mode, to_from_id, talk_id, err)) {
+        if (err == "非法会话类型") {
+            result.code = 400;
+            result.err = err;
+            return result;
+        }
+        result.ok = true;
+        return result;
+    }
+
+    IM::dao::MessagePage page;
+    page.cursor = cursor;
+    std::vector<IM::dao::Message> msgs;
+    if (!index->isEnabled() || !CatchUpSearchIndex(index, talk_id)) {
+        // 索引未启用或未覆盖该会话：直接在数据库中检索
+        if (!IM::dao::MessageDao::SearchByKeyword(talk_id, keyword, cursor, limit,
+                                                  current_user_id, msgs, &err)) {
+            IM_LOG_WARN(g_logger) << "SearchMessages SearchByKeyword failed, talk_id=" << talk_id
+                                  << " err=" << err;
+            result.code = 500;
+            result.err = "搜索消息失败";
+            return result;
+        }
+        for (auto& m : msgs) {
+            IM::dao::MessageRecord rec;
+            std::string rerr;
+            buildRecord(m, rec, &rerr);
+            page.items.push_back(std::move(rec));
+            page.cursor = m.sequence;
+        }
+        result.data = std::move(page);
+        result.ok = true;
+        return result;
+    }
+
+    // 索引候选按 sequence 降序分批回表：撤回/本人删除在 SQL 中过滤，关键词在内存中校验
+    const size_t batch = limit * 2;
+    const size_t max_examined = limit * 10;
+    size_t examined = 0;
+    std::vector<uint64_t> seqs;
+    while (page.items.size() < limit && examined < max_examined) {
+        index->search(talk_id, terms, page.cursor, batch, seqs);
+        if (seqs.empty()) {
+            break;
+        }
+        if (!IM::dao::MessageDao::ListBySequences(talk_id, seqs, current_user_id, msgs, &err)) {
+            IM_LOG_WARN(g_logger) << "SearchMessages ListBySequences failed, talk_id=" << talk_id
+                                  << " err=" << err;
+            result.code = 500;
+            result.err = "搜索消息失败";
+            return result;
+        }
+        size_t mi = 0;
+        for (auto seq : seqs) {
+            ++examined;
+            page.cursor = seq;
+            while (mi < msgs.size() && msgs[mi].sequence > seq) {
+                ++mi;
+            }
+            if (mi < msgs.size() && msgs[mi].sequence == seq &&
+                ContainsIgnoreCase(msgs[mi].content_text, lower_kw)) {
+                IM::dao::MessageRecord rec;
+                std::string rerr;
+                buildRecord(msgs[mi], rec, &rerr);
+                page.items.push_back(std::move(rec));
+                if (page.items.size() >= limit) {
+                    break;
+                }
+            }
+        }
+        if (seqs.size() < batch) {
+            break;  // 候选已取尽
+        }
+    }
+    result.data = std::move(page);
+    result.ok = true;
+    return result;
+}
+
 MessageRecordListResult MessageService::LoadForwardRecords(
     const uint64_t current_user_id, const uint8_t talk_mode,
     const std::vector<std::string>& msg_ids) {
@@ -388,6 +602,8 @@ VoidResult MessageService::DeleteMessages(const uint64_t current_user_id, const
         result.err = "数据库事务提交失败";
         return result;
     }
+    RecentMessageCacheMgr::GetInstance()->onUserDelete(talk_id, current_user_id, msg_ids);
+    MessageCacheSyncMgr::GetInstance()->publish(talk_id);
 
     // 8. 通知客户端更新消息预览
     if (!digest.empty()) {
@@ -495,6 +711,8 @@ VoidResult MessageService::DeleteAllMessagesInTalkForUser(const uint64_t current
         result.err = "删除消息失败";
         return result;
     }
+    RecentMessageCacheMgr::GetInstance()->invalidate(talk_id);
+    MessageCacheSyncMgr::GetInstance()->publish(talk_id);
 
     // 8. 向客户端推送更新消息预览
     Json::Value payload;
@@ -566,6 +784,8 @@ VoidResult MessageService::ClearTalkRecords(const uint64_t current_user_id, cons
         result.err = "事务提交失败";
         return result;
     }
+    RecentMessageCacheMgr::GetInstance()->invalidate(talk_id);
+    MessageCacheSyncMgr::GetInstance()->publish(talk_id);
 
     result.ok = true;
     return result;
@@ -714,6 +934,9 @@ VoidResult MessageService::RevokeMessage(const uint64_t current_user_id, const u
         result.err = "数据库事务提交失败";
         return result;
     }
+    RecentMessageCacheMgr::GetInstance()->onRevoke(talk_id, msg_id);
+    MessageCacheSyncMgr::GetInstance()->publish(talk_id);
+    MessageSearchIndexMgr::GetInstance()->remove(talk_id, message.sequence);
 
     // 7. 通知客户端更新消息预览
     int index = 0;
@@ -750,16 +973,20 @@ VoidResult MessageService::RevokeMessage(const uint64_t current_user_id, const u
 
     // 8. 广播撤回事件给会话中的在线用户，方便他们更新对端消息状态
     try {
-        std::vector<uint64_t> talk_users;
-        std::string lerr;
-        if (IM::dao::TalkSessionDAO::listUsersByTalkId(talk_id, talk_users, &lerr)) {
-            Json::Value ev;
-            ev["talk_mode"] = talk_mode;
-            ev["to_from_id"] = (Json::UInt64)to_from_id;
-            ev["from_id"] = (Json::UInt64)message.sender_id;
-            ev["msg_id"] = msg_id;
-            for (auto uid : talk_users) {
-                IM::api::WsGatewayModule::PushToUser(uid, "im.message.revoke", ev);
+        Json::Value ev;
+        ev["talk_mode"] = talk_mode;
+        ev["to_from_id"] = (Json::UInt64)to_from_id;
+        ev["from_id"] = (Json::UInt64)message.sender_id;
+        ev["msg_id"] = msg_id;
+        if (talk_mode == 2) {
+            IM::api::WsGatewayModule::PushToGroup(to_from_id, "im.message.revoke", ev);
+        } else {
+            std::vector<uint64_t> talk_users;
+            std::string lerr;
+            if (IM::dao::TalkSessionDAO::listUsersByTalkId(talk_id, talk_users, &lerr)) {
+                for (auto uid : talk_users) {
+                    IM::api::WsGatewayModule::PushToUser(uid, "im.message.revoke", ev);
+                }
             }
         }
     } catch (const std::exception& ex) {
@@ -819,6 +1046,8 @@ VoidResult MessageService::UpdateMessageStatus(const uint64_t current_user_id,
         result.err = "事务提交失败";
         return result;
     }
+    RecentMessageCacheMgr::GetInstance()->onStatus(m.talk_id, msg_id, status);
+    MessageCacheSyncMgr::GetInstance()->publish(m.talk_id);
 
     // 广播状态更新事件给会话内在线用户
     try {
@@ -834,11 +1063,15 @@ VoidResult MessageService::UpdateMessageStatus(const uint64_t current_user_id,
             }
             ev["msg_id"] = msg_id;
             ev["status"] = (Json::UInt)status;
-            std::vector<uint64_t> talk_users;
-            std::string lerr;
-            if (IM::dao::TalkSessionDAO::listUsersByTalkId(mm.talk_id, talk_users, &lerr)) {
-                for (auto uid : talk_users) {
-                    IM::api::WsGatewayModule::PushToUser(uid, "im.message.update", ev);
+            if (mm.talk_mode == 2) {
+                IM::api::WsGatewayModule::PushToGroup(mm.group_id, "im.message.update", ev);
+            } else {
+                std::vector<uint64_t> talk_users;
+                std::string lerr;
+                if (IM::dao::TalkSessionDAO::listUsersByTalkId(mm.talk_id, talk_users, &lerr)) {
+                    for (auto uid : talk_users) {
+                        IM::api::WsGatewayModule::PushToUser(uid, "im.message.update", ev);
+                    }
                 }
             }
         }
@@ -856,6 +1089,16 @@ MessageRecordResult MessageService::SendMessage(
     MessageRecordResult result;
     std::string err;
 
+    // 群聊发言权限：成员、禁言、全员禁言均直接读群成员缓存，不查库
+    if (talk_mode == 2) {
+        auto perm = GroupMembershipMgr::GetInstance()->checkSpeak(to_from_id, current_user_id);
+        if (!perm.ok) {
+            result.code = perm.code;
+            result.err = perm.err;
+            return result;
+        }
+    }
+
     // 1. 开启事务。
     auto trans = IM::MySQLMgr::GetInstance()->openTransaction(kDBName, false);
     if (!trans) {
@@ -889,7 +1132,7 @@ MessageRecordResult MessageService::SendMessage(
             }
         }
     } else if (talk_mode == 2) {
-        // 群聊不存在则创建会话（不校验群合法性，这里假设外层已校验）
+        // 群聊不存在则创建会话（群存在与发言权限已在入口处校验）
         if (!IM::dao::TalkDao::findOrCreateGroupTalk(db, to_from_id, talk_id, &err)) {
             if (!err.empty()) {
                 trans->rollback();
@@ -966,20 +1209,12 @@ MessageRecordResult MessageService::SendMessage(
         m.status = 3;  // failed due to invalid recipient
         try {
             Json::Value extraRoot;
-            if (!m.extra.empty()) {
-                Json::CharReaderBuilder rbd;
-                std::string errs;
-                std::istringstream in(m.extra);
-                if (!Json::parseFromStream(rbd, in, &extraRoot, &errs)) {
-                    extraRoot = Json::objectValue;
-                }
-            } else {
+            if (m.extra.empty() || !IM::JsonUtil::Parse(extraRoot, m.extra)) {
                 extraRoot = Json::objectValue;
             }
             extraRoot["invalid"] = true;
             extraRoot["invalid_reason"] = "not_friend";
-            Json::StreamWriterBuilder wbd;
-            m.extra = Json::writeString(wbd, extraRoot);
+            m.extra = IM::JsonUtil::Write(extraRoot);
         } catch (...) {
             // ignore
         }
@@ -987,11 +1222,8 @@ MessageRecordResult MessageService::SendMessage(
     // 若为转发：在服务器端补充 preview records（方便前端短缩显示）
     if (m.msg_type == static_cast<uint16_t>(IM::common::MessageType::Forward) &&
         !m.extra.empty()) {
-        Json::CharReaderBuilder rb;
         Json::Value payload;
-        std::string errs;
-        std::istringstream in(m.extra);
-        if (Json::parseFromStream(rb, in, &payload, &errs)) {
+        if (IM::JsonUtil::Parse(payload, m.extra)) {
             std::vector<std::string> src_ids;
             if (payload.isMember("msg_ids") && payload["msg_ids"].isArray()) {
                 for (auto& v : payload["msg_ids"]) {
@@ -1026,8 +1258,7 @@ MessageRecordResult MessageService::SendMessage(
                         arr.append(it);
                     }
                     payload["records"] = arr;
-                    Json::StreamWriterBuilder wb;
-                    m.extra = Json::writeString(wb, payload);
+                    m.extra = IM::JsonUtil::Write(payload);
                 } else {
                     IM_LOG_WARN(g_logger)
                         << "MessageDao::GetByIds failed when build preview records: " << err;
@@ -1039,10 +1270,11 @@ MessageRecordResult MessageService::SendMessage(
     m.is_revoked = 2;  // 正常
     m.revoke_by = 0;
     m.revoke_time = 0;
-    // 使用前端传入的消息ID；若为空则服务端生成一个16进制32位随机字符串
+    // 使用前端传入的消息ID；若为空则服务端生成一个 32 位 HEX 的有序ID
+    // 说明：im_message.id 为聚簇主键，随机ID会导致插入落在随机页上引发页分裂，
+    // 有序ID（雪花ID前缀）保证顺序追加写入。
     if (msg_id.empty()) {
-        // 随机生成 32 长度 hex id
-        m.id = IM::random_string(32, "0123456789abcdef");
+        m.id = IM::util::IdWorker::GetInstance().NextHexId();
     } else {
         m.id = msg_id;
     }
@@ -1076,11 +1308,8 @@ MessageRecordResult MessageService::SendMessage(
     if (m.msg_type == static_cast<uint16_t>(IM::common::MessageType::Forward) &&
         !m.extra.empty()) {
         // extra 在 API 层已被写成 JSON 字符串
-        Json::CharReaderBuilder rb;
         Json::Value payload;
-        std::string errs;
-        std::istringstream in(m.extra);
-        if (Json::parseFromStream(rb, in, &payload, &errs)) {
+        if (IM::JsonUtil::Parse(payload, m.extra)) {
             std::vector<std::string> src_ids;
             if (payload.isMember("msg_ids") && payload["msg_ids"].isArray()) {
                 for (auto& v : payload["msg_ids"]) {
@@ -1112,7 +1341,7 @@ MessageRecordResult MessageService::SendMessage(
                 }
             }
         } else {
-            IM_LOG_WARN(g_logger) << "Parse forward extra payload failed: " << errs;
+            IM_LOG_WARN(g_logger) << "Parse forward extra payload failed, msg_id=" << m.id;
         }
     }
 
@@ -1243,14 +1472,8 @@ MessageRecordResult MessageService::SendMessage(
             // is updated to indicate invalid and msg_text set to failure message.
             IM::api::WsGatewayModule::PushToUser(current_user_id, "im.session.update", payload);
         } else {
-            // 群聊：查出本群拥有会话快照的用户，并逐个推送
-            std::vector<uint64_t> talk_users;
-            std::string lerr;
-            if (IM::dao::TalkSessionDAO::listUsersByTalkId(talk_id, talk_users, &lerr)) {
-                for (auto uid : talk_users) {
-                    IM::api::WsGatewayModule::PushToUser(uid, "im.session.update", payload);
-                }
-            }
+            // 群聊：推送给本节点在线的群成员（成员取自内存位图，不再逐条查询会话表）
+            IM::api::WsGatewayModule::PushToGroup(to_from_id, "im.session.update", payload);
         }
     }
 
@@ -1287,69 +1510,45 @@ MessageRecordResult MessageService::SendMessage(
     if (mark_invalid_message) {
         try {
             Json::Value extraRoot;
-            if (!rec.extra.empty()) {
-                Json::CharReaderBuilder rb2;
-                std::string errs2;
-                std::istringstream in2(rec.extra);
-                if (!Json::parseFromStream(rb2, in2, &extraRoot, &errs2)) {
-                    extraRoot = Json::objectValue;
-                }
-            } else {
+            if (rec.extra.empty() || !IM::JsonUtil::Parse(extraRoot, rec.extra)) {
                 extraRoot = Json::objectValue;
             }
             extraRoot["invalid"] = true;
             extraRoot["invalid_reason"] = "not_friend";
-            Json::StreamWriterBuilder wb2;
-            rec.extra = Json::writeString(wb2, extraRoot);
+            rec.extra = IM::JsonUtil::Write(extraRoot);
         } catch (...) {
             // 忽略解析错误，保持原样
         }
     }
 
+    // 记录定稿，构建一次消息信封：REST 响应、缓存与推送都复用这段 JSON，不再各自序列化
+    MessageEnvelope::Build(rec);
+
+    // 追加到最近消息缓存；失效消息对接收者不可见
+    RecentMessageCacheMgr::GetInstance()->onSend(talk_id, rec,
+                                                 mark_invalid_message ? to_from_id : 0);
+    MessageCacheSyncMgr::GetInstance()->publish(talk_id);
+
+    // 文本内容写入全文检索索引（失效消息对接收者的不可见由检索回表时的删除过滤保证）
+    auto index = MessageSearchIndexMgr::GetInstance();
+    if (!m.content_text.empty()) {
+        index->add(talk_id, m.sequence, m.content_text);
+    }
+    // 紧接水位的消息直接推进覆盖水位，查询时无需再补录
+    index->advanceSynced(talk_id, m.sequence - 1, m.sequence);
+
     // 主动推送给对端（以及发送者其它设备），前端监听事件: im.message
     // 说明：PushImMessage 将把消息广播到对应频道（单聊/群），并且以同一结构发送
     // 到所有在线设备。这样前端可以在接收到 `im.message` 时，直接把 payload 插入本地会话视图。
-    Json::Value body_json;
-    body_json["msg_id"] = rec.msg_id;
-    body_json["sequence"] = (Json::UInt64)rec.sequence;
-    body_json["msg_type"] = rec.msg_type;
-    body_json["from_id"] = (Json::UInt64)rec.from_id;
-    body_json["nickname"] = rec.nickname;
-    body_json["avatar"] = rec.avatar;
-    body_json["is_revoked"] = rec.is_revoked;
-    body_json["send_time"] = rec.send_time;
-
-    // 为失效消息在 extra 中插入标记（JSON 字符串需解析再写回）
-    try {
-        Json::Value extraRoot;
-        Json::CharReaderBuilder rb;
-        std::string errs;
-        std::istringstream in(rec.extra);
-        if (!rec.extra.empty() && Json::parseFromStream(rb, in, &extraRoot, &errs)) {
-            if (mark_invalid_message) {
-                extraRoot["invalid"] = true;
-                extraRoot["invalid_reason"] = "not_friend";
-            }
-        } else if (mark_invalid_message) {
-            extraRoot["invalid"] = true;
-            extraRoot["invalid_reason"] = "not_friend";
-        }
-        Json::StreamWriterBuilder wb;
-        body_json["extra"] = Json::writeString(wb, extraRoot);
-    } catch (...) {
-        body_json["extra"] = rec.extra;  // 回退
-    }
-    body_json["status"] = (Json::UInt)rec.status;
-    body_json["quote"] = rec.quote;
-
+    // 推送的 body 即消息信封（失效标记已在 rec.extra 中），与 REST 返回一致。
     // 单聊仅在允许投递时才发送给接收者
     if (talk_mode == 1) {
         if (deliver_to_receiver) {
             // 正常投递
-            IM::api::WsGatewayModule::PushImMessage(talk_mode, to_from_id, rec.from_id, body_json);
+            IM::api::WsGatewayModule::PushImMessage(talk_mode, to_from_id, rec.from_id, *rec.json);
         }
     } else {
-        IM::api::WsGatewayModule::PushImMessage(talk_mode, to_from_id, rec.from_id, body_json);
+        IM::api::WsGatewayModule::PushImMessage(talk_mode, to_from_id, rec.from_id, *rec.json);
     }
 
     result.data = std::move(rec);
@@ -0,0 +1,558 @@
+#include "app/upload_service.hpp"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <openssl/evp.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <set>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+#include "io/cpu_pool.hpp"
+#include "io/iomanager.hpp"
+#include "io/lock.hpp"
+#include "system/env.hpp"
+#include "util/hash_util.hpp"
+#include "util/json_util.hpp"
+#include "util/util.hpp"
+
+namespace IM::app {
+
+static auto g_logger = IM_LOG_NAME("root");
+
+static auto g_upload_dir = IM::Config::Lookup<std::string>(
+    "upload.dir", "data/uploads", "multipart upload dir (relative to work path)");
+static auto g_upload_shard_size = IM::Config::Lookup<uint32_t>(
+    "upload.shard_size", 5 * 1024 * 1024, "multipart upload shard size in bytes");
+static auto g_upload_max_file_size = IM::Config::Lookup<uint64_t>(
+    "upload.max_file_size", 2ull * 1024 * 1024 * 1024, "max size of a multipart upload file");
+static auto g_upload_max_sessions = IM::Config::Lookup<uint32_t>(
+    "upload.max_sessions_per_user", 10,
+    "max unfinished multipart upload sessions per user (0 = unlimited)");
+static auto g_upload_session_ttl = IM::Config::Lookup<uint32_t>(
+    "upload.session_ttl", 86400, "seconds without writes before an unfinished upload expires");
+static auto g_upload_cleanup_interval = IM::Config::Lookup<uint32_t>(
+    "upload.cleanup_interval", 3600, "expired upload sweep interval in seconds");
+
+static IM::Timer::ptr g_cleanup_timer;
+
+static constexpr const char* kCpuBusyErr = "服务繁忙，请稍后重试";
+
+namespace {
+// 合并分片时的固定缓冲区大小
+constexpr size_t kMergeBufferSize = 256 * 1024;
+
+// 正在合并的上传会话，防止最后两个分片并发到达时重复合并
+IM::Mutex s_merge_mutex;
+std::set<std::string> s_merging;
+
+// 各用户未完成的上传会话（用于会话数上限），首次使用时从上传目录加载
+IM::Mutex s_active_mutex;
+bool s_active_loaded = false;
+std::map<uint64_t, std::set<std::string>> s_active;
+
+// 防止清理耗时超过周期时重复执行
+std::atomic<bool> s_sweeping{false};
+
+// SHA-256 增量计算
+class Sha256 {
+   public:
+    Sha256() : m_ctx(EVP_MD_CTX_new()) { EVP_DigestInit_ex(m_ctx, EVP_sha256(), nullptr); }
+    ~Sha256() { EVP_MD_CTX_free(m_ctx); }
+    void update(const char* data, size_t len) { EVP_DigestUpdate(m_ctx, data, len); }
+    std::string hex() {
+        unsigned char md[EVP_MAX_MD_SIZE];
+        unsigned int len = 0;
+        EVP_DigestFinal_ex(m_ctx, md, &len);
+        return IM::hexstring_from_data(md, len);
+    }
+
+   private:
+    EVP_MD_CTX* m_ctx;
+};
+
+std::string UploadDir() {
+    return IM::EnvMgr::GetInstance()->getAbsoluteWorkPath(g_upload_dir->getValue());
+}
+
+// upload_id 由服务端生成（HEX），拒绝其它字符避免路径穿越
+bool ValidUploadId(const std::string& id) {
+    if (id.empty() || id.size() > 32) {
+        return false;
+    }
+    for (char c : id) {
+        if (!isxdigit((unsigned char)c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string SessionDir(const std::string& upload_id) {
+    return UploadDir() + "/" + upload_id;
+}
+
+// 上传目录下的全部会话ID
+std::vector<std::string> ListSessions() {
+    std::vector<std::string> ids;
+    DIR* dir = ::opendir(UploadDir().c_str());
+    if (!dir) {
+        return ids;
+    }
+    struct dirent* dp = nullptr;
+    while ((dp = ::readdir(dir)) != nullptr) {
+        if (ValidUploadId(dp->d_name)) {
+            ids.push_back(dp->d_name);
+        }
+    }
+    ::closedir(dir);
+    return ids;
+}
+
+std::string PartPath(const std::string& upload_id, const uint32_t index) {
+    return SessionDir(upload_id) + "/" + std::to_string(index) + ".part";
+}
+
+uint64_t PartSize(const UploadSession& s, const uint32_t index) {
+    if (index + 1 < s.shard_num) {
+        return s.shard_size;
+    }
+    return s.file_size - (uint64_t)s.shard_size * (s.shard_num - 1);
+}
+
+bool SaveMeta(const UploadSession& s) {
+    Json::Value v;
+    v["user_id"] = (Json::UInt64)s.user_id;
+    v["file_name"] = s.file_name;
+    v["file_size"] = (Json::UInt64)s.file_size;
+    v["shard_size"] = s.shard_size;
+    v["shard_num"] = s.shard_num;
+    v["finished"] = s.finished;
+    v["sha256"] = s.sha256;
+    // 先写临时文件再 rename，保证 meta 不会被读到半截
+    const std::string path = SessionDir(s.upload_id) + "/meta.json";
+    std::ofstream ofs;
+    if (!IM::FSUtil::OpenForWrite(ofs, path + ".tmp", std::ios::trunc)) {
+        return false;
+    }
+    ofs << IM::JsonUtil::ToString(v);
+    ofs.close();
+    return ofs.good() && ::rename((path + ".tmp").c_str(), path.c_str()) == 0;
+}
+
+bool LoadMeta(const std::string& upload_id, UploadSession& s) {
+    std::ifstream ifs;
+    if (!IM::FSUtil::OpenForRead(ifs, SessionDir(upload_id) + "/meta.json", std::ios::in)) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    Json::Value v;
+    if (!IM::JsonUtil::FromString(v, data)) {
+        return false;
+    }
+    s.upload_id = upload_id;
+    s.user_id = IM::JsonUtil::GetUint64(v, "user_id");
+    s.file_name = IM::JsonUtil::GetString(v, "file_name");
+    s.file_size = IM::JsonUtil::GetUint64(v, "file_size");
+    s.shard_size = IM::JsonUtil::GetUint32(v, "shard_size");
+    s.shard_num = IM::JsonUtil::GetUint32(v, "shard_num");
+    s.finished = v.isMember("finished") && v["finished"].asBool();
+    s.sha256 = IM::JsonUtil::GetString(v, "sha256");
+    if (s.finished) {
+        s.path = SessionDir(upload_id) + "/file";
+    }
+    return s.shard_size > 0 && s.shard_num > 0;
+}
+
+// 收集已完整上传的分片（大小与预期一致）
+void ListUploaded(UploadSession& s) {
+    s.uploaded.clear();
+    if (s.finished) {
+        for (uint32_t i = 0; i < s.shard_num; ++i) {
+            s.uploaded.push_back(i);
+        }
+        return;
+    }
+    struct stat st;
+    for (uint32_t i = 0; i < s.shard_num; ++i) {
+        if (::stat(PartPath(s.upload_id, i).c_str(), &st) == 0 &&
+            (uint64_t)st.st_size == PartSize(s, i)) {
+            s.uploaded.push_back(i);
+        }
+    }
+}
+
+// 加载会话并校验归属
+bool LoadOwned(const uint64_t user_id, const std::string& upload_id, UploadSession& s,
+               UploadSessionResult& result) {
+    if (!ValidUploadId(upload_id) || !LoadMeta(upload_id, s)) {
+        result.code = 404;
+        result.err = "上传会话不存在";
+        return false;
+    }
+    if (s.user_id != user_id) {
+        result.code = 403;
+        result.err = "无权访问该上传会话";
+        return false;
+    }
+    return true;
+}
+
+// 首次使用时扫描上传目录重建 s_active（磁盘扫描放到 CpuPool 执行）
+bool EnsureActiveLoaded() {
+    {
+        IM::Mutex::Lock lock(s_active_mutex);
+        if (s_active_loaded) {
+            return true;
+        }
+    }
+    return IM::CpuPoolMgr::GetInstance()->await([]() {
+        std::map<uint64_t, std::set<std::string>> active;
+        for (auto& id : ListSessions()) {
+            UploadSession s;
+            if (LoadMeta(id, s) && !s.finished) {
+                active[s.user_id].insert(id);
+            }
+        }
+        IM::Mutex::Lock lock(s_active_mutex);
+        if (!s_active_loaded) {
+            // 扫描期间新建的会话已记入 s_active，合并而不是覆盖
+            for (auto& it : active) {
+                s_active[it.first].insert(it.second.begin(), it.second.end());
+            }
+            s_active_loaded = true;
+        }
+    });
+}
+
+void DropActive(const uint64_t user_id, const std::string& upload_id) {
+    IM::Mutex::Lock lock(s_active_mutex);
+    auto it = s_active.find(user_id);
+    if (it == s_active.end()) {
+        return;
+    }
+    it->second.erase(upload_id);
+    if (it->second.empty()) {
+        s_active.erase(it);
+    }
+}
+
+// 按序合并全部分片，边拷贝边计算整个文件的 SHA-256
+bool Merge(UploadSession& s, std::string* err) {
+    const std::string dir = SessionDir(s.upload_id);
+    const std::string tmp = dir + "/file.tmp";
+    int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        *err = std::string("open merge file failed: ") + strerror(errno);
+        return false;
+    }
+    std::unique_ptr<char[]> buf(new char[kMergeBufferSize]);
+    Sha256 sha;
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < s.shard_num; ++i) {
+        int in = ::open(PartPath(s.upload_id, i).c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            *err = "open part " + std::to_string(i) + " failed: " + strerror(errno);
+            ok = false;
+            break;
+        }
+        while (true) {
+            ssize_t n = ::read(in, buf.get(), kMergeBufferSize);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                *err = std::string("read part failed: ") + strerror(errno);
+                ok = false;
+                break;
+            }
+            if (n == 0) {
+                break;
+            }
+            sha.update(buf.get(), n);
+            const char* p = buf.get();
+            while (n > 0) {
+                ssize_t w = ::write(out, p, n);
+                if (w < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (w <= 0) {
+                    *err = std::string("write merge file failed: ") + strerror(errno);
+                    ok = false;
+                    break;
+                }
+                p += w;
+                n -= w;
+            }
+            if (!ok) {
+                break;
+            }
+        }
+        ::close(in);
+    }
+    if (::close(out) != 0 && ok) {
+        *err = std::string("close merge file failed: ") + strerror(errno);
+        ok = false;
+    }
+    if (!ok || ::rename(tmp.c_str(), (dir + "/file").c_str()) != 0) {
+        if (ok) *err = std::string("rename merge file failed: ") + strerror(errno);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    s.finished = true;
+    s.sha256 = sha.hex();
+    s.path = dir + "/file";
+    if (!SaveMeta(s)) {
+        *err = "save upload meta failed";
+        return false;
+    }
+    for (uint32_t i = 0; i < s.shard_num; ++i) {
+        ::unlink(PartPath(s.upload_id, i).c_str());
+    }
+    return true;
+}
+}  // namespace
+
+UploadSessionResult UploadService::InitMultipart(const uint64_t user_id,
+                                                 const std::string& file_name,
+                                                 const uint64_t file_size) {
+    UploadSessionResult result;
+    if (file_name.empty() || file_size == 0) {
+        result.code = 400;
+        result.err = "文件名或文件大小无效";
+        return result;
+    }
+    if (file_size > g_upload_max_file_size->getValue()) {
+        result.code = 413;
+        result.err = "文件过大";
+        return result;
+    }
+
+    if (!EnsureActiveLoaded()) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
+
+    UploadSession s;
+    s.upload_id = IM::util::IdWorker::GetInstance().NextHexId();
+    s.user_id = user_id;
+    s.file_name = file_name;
+    s.file_size = file_size;
+    s.shard_size = std::max<uint32_t>(g_upload_shard_size->getValue(), 1);
+    s.shard_num = (file_size + s.shard_size - 1) / s.shard_size;
+    {
+        // 先占位再落盘，避免并发创建突破上限
+        IM::Mutex::Lock lock(s_active_mutex);
+        auto& ids = s_active[user_id];
+        const uint32_t max_sessions = g_upload_max_sessions->getValue();
+        if (max_sessions && ids.size() >= max_sessions) {
+            result.code = 429;
+            result.err = "未完成的上传任务过多";
+            return result;
+        }
+        ids.insert(s.upload_id);
+    }
+    if (!IM::FSUtil::Mkdir(SessionDir(s.upload_id)) || !SaveMeta(s)) {
+        IM_LOG_ERROR(g_logger) << "InitMultipart create session failed, upload_id=" << s.upload_id
+                               << " errno=" << errno << " errstr=" << strerror(errno);
+        DropActive(user_id, s.upload_id);
+        result.code = 500;
+        result.err = "创建上传会话失败";
+        return result;
+    }
+    result.data = std::move(s);
+    result.ok = true;
+    return result;
+}
+
+UploadSessionResult UploadService::GetStatus(const uint64_t user_id, const std::string& upload_id) {
+    UploadSessionResult result;
+    UploadSession s;
+    if (!LoadOwned(user_id, upload_id, s, result)) {
+        return result;
+    }
+    ListUploaded(s);
+    result.data = std::move(s);
+    result.ok = true;
+    return result;
+}
+
+UploadSessionResult UploadService::WritePart(const uint64_t user_id, const std::string& upload_id,
+                                             const uint32_t split_index, const BodyReader& reader,
+                                             const std::string& expect_sha256) {
+    UploadSessionResult result;
+    UploadSession s;
+    if (!LoadOwned(user_id, upload_id, s, result)) {
+        return result;
+    }
+    if (s.finished) {
+        ListUploaded(s);
+        result.data = std::move(s);
+        result.ok = true;
+        return result;
+    }
+    if (split_index >= s.shard_num) {
+        result.code = 400;
+        result.err = "分片序号无效";
+        return result;
+    }
+
+    // 写入唯一的临时文件，完整且校验通过后 rename 为 .part（同一分片重传时后到者覆盖）
+    const uint64_t expect_size = PartSize(s, split_index);
+    const std::string part = PartPath(upload_id, split_index);
+    const std::string tmp = part + "." + IM::util::IdWorker::GetInstance().NextHexId() + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        IM_LOG_ERROR(g_logger) << "WritePart open failed, file=" << tmp << " errno=" << errno
+                               << " errstr=" << strerror(errno);
+        result.code = 500;
+        result.err = "写入分片失败";
+        return result;
+    }
+    std::unique_ptr<Sha256> sha;
+    BodyObserver observer;
+    if (!expect_sha256.empty()) {
+        sha.reset(new Sha256);
+        observer = [&sha](const char* data, size_t len) { sha->update(data, len); };
+    }
+    int64_t n = reader(fd, expect_size, observer);
+    bool closed = ::close(fd) == 0;
+    if (n != (int64_t)expect_size || !closed) {
+        ::unlink(tmp.c_str());
+        result.code = n == -1 ? 500 : 400;
+        result.err = n == -1 ? "写入分片失败" : "分片大小不匹配";
+        return result;
+    }
+    if (sha && strcasecmp(sha->hex().c_str(), expect_sha256.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        result.code = 400;
+        result.err = "分片校验失败";
+        return result;
+    }
+    if (::rename(tmp.c_str(), part.c_str()) != 0) {
+        ::unlink(tmp.c_str());
+        result.code = 500;
+        result.err = "写入分片失败";
+        return result;
+    }
+
+    ListUploaded(s);
+    if (s.uploaded.size() == s.shard_num) {
+        {
+            IM::Mutex::Lock lock(s_merge_mutex);
+            if (!s_merging.insert(upload_id).second) {
+                // 其它请求正在合并，本次只返回进度
+                result.data = std::move(s);
+                result.ok = true;
+                return result;
+            }
+        }
+        // 合并是整文件的阻塞读写加 SHA-256，交给 CpuPool 执行，完成后恢复当前协程
+        std::string err;
+        bool merged = false;
+        bool queued = IM::CpuPoolMgr::GetInstance()->await([&]() { merged = Merge(s, &err); });
+        {
+            IM::Mutex::Lock lock(s_merge_mutex);
+            s_merging.erase(upload_id);
+        }
+        if (!queued) {
+            result.code = 429;
+            result.err = kCpuBusyErr;
+            return result;
+        }
+        if (!merged) {
+            IM_LOG_ERROR(g_logger) << "WritePart merge failed, upload_id=" << upload_id
+                                   << " err=" << err;
+            result.code = 500;
+            result.err = "合并文件失败";
+            return result;
+        }
+        DropActive(user_id, upload_id);
+    }
+    result.data = std::move(s);
+    result.ok = true;
+    return result;
+}
+
+size_t UploadService::CleanupExpired() {
+    // 会话目录的 mtime 即最后一次写入时间：每次写分片都会在目录中创建并 rename 临时文件
+    const time_t deadline = time(0) - g_upload_session_ttl->getValue();
+    size_t removed = 0;
+    for (auto& id : ListSessions()) {
+        {
+            IM::Mutex::Lock lock(s_merge_mutex);
+            if (s_merging.count(id)) {
+                continue;
+            }
+        }
+        const std::string dir = SessionDir(id);
+        UploadSession s;
+        const bool has_meta = LoadMeta(id, s);
+        struct stat st;
+        if (has_meta && s.finished) {
+            // 合并后删除分片失败、或中断的上传留下的文件
+            std::vector<std::string> files;
+            IM::FSUtil::ListAllFile(files, dir, "");
+            for (auto& f : files) {
+                if (!IM::StringUtil::EndsWith(f, ".part") && !IM::StringUtil::EndsWith(f, ".tmp")) {
+                    continue;
+                }
+                if (::stat(f.c_str(), &st) == 0 && st.st_mtime < deadline) {
+                    ::unlink(f.c_str());
+                }
+            }
+            continue;
+        }
+        // 没有 meta 的目录是创建中途失败的会话，同样按 mtime 过期
+        if (::stat(dir.c_str(), &st) != 0 || st.st_mtime >= deadline) {
+            continue;
+        }
+        if (!IM::FSUtil::Rm(dir)) {
+            IM_LOG_WARN(g_logger) << "CleanupExpired remove failed, upload_id=" << id
+                                  << " errno=" << errno << " errstr=" << strerror(errno);
+            continue;
+        }
+        if (has_meta) {
+            DropActive(s.user_id, id);
+        }
+        ++removed;
+    }
+    return removed;
+}
+
+void UploadService::InitCleanupTimer() {
+    if (g_cleanup_timer) {
+        return;
+    }
+    g_cleanup_timer = IM::IOManager::GetThis()->addTimer(
+        g_upload_cleanup_interval->getValue() * 1000ull,
+        []() {
+            if (s_sweeping.exchange(true)) {
+                return;
+            }
+            // 删除目录是阻塞的磁盘操作，不在定时器所在的 IOManager 线程上执行
+            bool ok = IM::CpuPoolMgr::GetInstance()->submit([]() {
+                size_t n = CleanupExpired();
+                if (n) {
+                    IM_LOG_INFO(g_logger) << "CleanupExpired removed " << n << " upload sessions";
+                }
+                s_sweeping = false;
+            });
+            if (!ok) {
+                s_sweeping = false;
+            }
+        },
+        true);
+}
+
+}  // namespace IM::app
@@ -1,16 +1,21 @@
 #include "app/user_service.hpp"
 
+#include "app/message_cache.hpp"
+#include "app/message_cache_sync.hpp"
 #include "common/common.hpp"
 #include "other/crypto_module.hpp"
 #include "dao/user_auth_dao.hpp"
 #include "dao/user_dao.hpp"
 #include "base/macro.hpp"
+#include "io/cpu_pool.hpp"
 #include "util/hash_util.hpp"
 #include "util/password.hpp"
 
 namespace IM::app {
 
 static auto g_logger = IM_LOG_NAME("root");
+static constexpr const char* kCpuBusyErr = "服务繁忙，请稍后重试";
+
 UserResult UserService::LoadUserInfo(const uint64_t uid) {
     UserResult result;
     std::string err;
@@ -41,6 +46,9 @@ VoidResult UserService::UpdateUserInfo(const uint64_t uid, const std::string& ni
         result.err = "更新用户信息失败";
         return result;
     }
+    // 缓存的最近消息（及其信封）带有发送者昵称/头像
+    RecentMessageCacheMgr::GetInstance()->onProfile(uid, nickname, avatar);
+    MessageCacheSyncMgr::GetInstance()->publishSender(uid);
 
     result.ok = true;
     return result;
@@ -53,7 +61,13 @@ VoidResult UserService::UpdateMobile(const uint64_t uid, const std::string& pass
 
     // 解密前端传入的登录密码
     std::string decrypted_password;
-    auto dec_res = IM::DecryptPassword(password, decrypted_password);
+    PasswordResult dec_res;
+    if (!IM::CpuPoolMgr::GetInstance()->await(
+            [&]() { dec_res = IM::DecryptPassword(password, decrypted_password); })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (!dec_res.ok) {
         result.code = dec_res.code;
         result.err = dec_res.err;
@@ -84,7 +98,15 @@ VoidResult UserService::UpdateMobile(const uint64_t uid, const std::string& pass
         }
     }
 
-    if (!IM::util::Password::Verify(decrypted_password, ua.password_hash)) {
+    bool verified = false;
+    if (!IM::CpuPoolMgr::GetInstance()->await([&]() {
+            verified = IM::util::Password::Verify(decrypted_password, ua.password_hash);
+        })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
+    if (!verified) {
         result.code = 403;
         result.err = "密码错误";
         return result;
@@ -125,15 +147,24 @@ VoidResult UserService::UpdatePassword(const uint64_t uid, const std::string& ol
     VoidResult result;
     std::string err;
 
-    // 1、密码解密
+    // 1、密码解密（在 CPU 线程池中执行）
     std::string decrypted_old, decrypted_new;
-    auto dec_old_res = IM::DecryptPassword(old_password, decrypted_old);
+    PasswordResult dec_old_res, dec_new_res;
+    if (!IM::CpuPoolMgr::GetInstance()->await([&]() {
+            dec_old_res = IM::DecryptPassword(old_password, decrypted_old);
+            if (dec_old_res.ok) {
+                dec_new_res = IM::DecryptPassword(new_password, decrypted_new);
+            }
+        })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
     if (!dec_old_res.ok) {
         result.code = dec_old_res.code;
         result.err = dec_old_res.err;
         return result;
     }
-    auto dec_new_res = IM::DecryptPassword(new_password, decrypted_new);
     if (!dec_new_res.ok) {
         result.code = dec_new_res.code;
         result.err = dec_new_res.err;
@@ -151,14 +182,26 @@ VoidResult UserService::UpdatePassword(const uint64_t uid, const std::string& ol
             return result;
         }
     }
-    if (!IM::util::Password::Verify(decrypted_old, ua.password_hash)) {
+    // 旧密码校验通过后顺带生成新密码哈希，只需进出线程池一次
+    bool verified = false;
+    std::string new_password_hash;
+    if (!IM::CpuPoolMgr::GetInstance()->await([&]() {
+            verified = IM::util::Password::Verify(decrypted_old, ua.password_hash);
+            if (verified) {
+                new_password_hash = IM::util::Password::Hash(decrypted_new);
+            }
+        })) {
+        result.code = 429;
+        result.err = kCpuBusyErr;
+        return result;
+    }
+    if (!verified) {
         result.code = 403;
         result.err = "旧密码错误";
         return result;
     }
 
-    // 3、生成新密码哈希
-    auto new_password_hash = IM::util::Password::Hash(decrypted_new);
+    // 3、检查新密码哈希
     if (new_password_hash.empty()) {
         if (!err.empty()) {
             IM_LOG_ERROR(g_logger) << "UpdatePasswordHash Hash failed, uid=" << uid;
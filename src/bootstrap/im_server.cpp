@@ -7,6 +7,7 @@
 #include "api/message_api_module.hpp"
 #include "api/organize_api_module.hpp"
 #include "api/talk_api_module.hpp"
+#include "api/upload_api_module.hpp"
 #include "api/user_api_module.hpp"
 #include "api/ws_gateway_module.hpp"
 #include "base/macro.hpp"
@@ -51,6 +52,8 @@ int main(int argc, char** argv) {
     IM::ModuleMgr::GetInstance()->add(std::make_shared<IM::api::TalkApiModule>());
     // 用户模块占位
     IM::ModuleMgr::GetInstance()->add(std::make_shared<IM::api::UserApiModule>());
+    // 分片上传模块
+    IM::ModuleMgr::GetInstance()->add(std::make_shared<IM::api::UploadApiModule>());
     // WebSocket 网关模块
     IM::ModuleMgr::GetInstance()->add(std::make_shared<IM::api::WsGatewayModule>());
 
@@ -2,11 +2,21 @@
 
 #include <jwt-cpp/jwt.h>
 
+#include <deque>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "base/macro.hpp"
 #include "config/config.hpp"
+#include "io/lock.hpp"
 #include "net/tcp_server.hpp"
 #include "other/crypto_module.hpp"
+#include "util/hash_util.hpp"
 #include "util/json_util.hpp"
+#include "util/time_util.hpp"
 
 namespace IM {
 
@@ -18,6 +28,251 @@ static auto g_jwt_secret = IM::Config::Lookup<std::string>(
 // JWT签发者
 static auto g_jwt_issuer =
     IM::Config::Lookup<std::string>("auth.jwt.issuer", std::string("auth-service"), "jwt issuer");
+// JWT有效期（与签发时一致，用于判断用户级撤销记录何时可以丢弃）
+static auto g_jwt_expires_in =
+    IM::Config::Lookup<uint32_t>("auth.jwt.expires_in", 3600, "jwt expires in seconds");
+// 已验签JWT缓存容量
+static auto g_jwt_cache_capacity = IM::Config::Lookup<uint32_t>(
+    "auth.jwt.cache_capacity", 65536, "verified jwt cache capacity per node (0 = disabled)");
+
+namespace {
+
+enum class JwtState { OK, INVALID, EXPIRED };
+
+// 已验签 JWT 缓存：按令牌哈希分片，保存首次校验通过后的 (uid, exp)，
+// 之后同一令牌的校验只需一次哈希查找，省去 decode + HMAC + stoull。
+// - 条目按令牌自身的 exp 失效（读取时判断）；每个表配一个按 exp 排序的小顶堆，
+//   写入时只弹出已过期的堆顶，不再整表扫描；
+// - 撤销（登出）的令牌记录在 revoked 表中直到其过期，本节点上不再通过校验；
+// - 修改/找回密码后该用户在此之前签发的令牌全部失效（按 iat 判断），记录保留一个令牌有效期；
+// - 签名密钥或签发者变更时清空缓存。
+class JwtCache {
+   public:
+    struct Entry {
+        std::string token;  // 哈希冲突时用原文比对
+        std::string uid;
+        uint64_t uid_num = 0;
+        uint64_t iat = 0;  // 签发时间（秒）
+        uint64_t exp = 0;  // 过期时间（秒）
+    };
+
+    enum Lookup { MISS, HIT, REVOKED };
+
+    JwtCache() {
+        uint32_t capacity = g_jwt_cache_capacity->getValue();
+        m_shardCapacity = capacity ? std::max<size_t>(capacity / kShardCount, 1) : 0;
+        auto on_change = [this](const std::string&, const std::string&) { clear(); };
+        g_jwt_secret->addListener(on_change);
+        g_jwt_issuer->addListener(on_change);
+    }
+
+    Lookup get(const std::string& token, const uint64_t hash, Entry& out) {
+        auto& shard = m_shards[hash % kShardCount];
+        RWMutex::ReadLock lock(shard.mutex);
+        auto it = shard.revoked.find(hash);
+        if (it != shard.revoked.end() && it->second.token == token) {
+            return REVOKED;
+        }
+        it = shard.verified.find(hash);
+        if (it == shard.verified.end() || it->second.token != token) {
+            return MISS;
+        }
+        out = it->second;
+        return HIT;
+    }
+
+    void put(const uint64_t hash, Entry&& e, const uint64_t now) {
+        if (!m_shardCapacity) {
+            return;
+        }
+        auto& shard = m_shards[hash % kShardCount];
+        RWMutex::WriteLock lock(shard.mutex);
+        auto it = shard.revoked.find(hash);
+        if (it != shard.revoked.end() && it->second.token == e.token) {
+            return;
+        }
+        if (shard.verified.size() >= m_shardCapacity) {
+            shard.verified.expire(now);
+            if (shard.verified.size() >= m_shardCapacity) {
+                shard.verified.erase(shard.verified.begin()->first);
+            }
+        }
+        shard.verified.put(hash, std::move(e));
+    }
+
+    void revoke(const uint64_t hash, Entry&& e, const uint64_t now) {
+        auto& shard = m_shards[hash % kShardCount];
+        RWMutex::WriteLock lock(shard.mutex);
+        shard.verified.erase(hash);
+        if (e.exp < now) {
+            return;  // 已过期的令牌本来就无法通过校验
+        }
+        shard.revoked.expire(now);
+        shard.revoked.put(hash, std::move(e));
+    }
+
+    // 使 uid 在 now（含）之前签发的令牌全部失效
+    void revokeUser(const uint64_t uid, const uint64_t now) {
+        RWMutex::WriteLock lock(m_userMutex);
+        expireUsers(now);
+        m_userCutoff[uid] = now;
+        m_userQueue.emplace_back(now, uid);
+    }
+
+    bool isUserRevoked(const uint64_t uid, const uint64_t iat) {
+        RWMutex::ReadLock lock(m_userMutex);
+        if (m_userCutoff.empty()) {
+            return false;
+        }
+        auto it = m_userCutoff.find(uid);
+        return it != m_userCutoff.end() && iat <= it->second;
+    }
+
+    void clear() {
+        for (auto& shard : m_shards) {
+            RWMutex::WriteLock lock(shard.mutex);
+            shard.verified.clear();
+        }
+    }
+
+   private:
+    // 令牌哈希 -> 条目，附带按 exp 排序的小顶堆。被覆盖或淘汰的条目在堆中留有过时的
+    // 记录，弹出时与表中 exp 比对后丢弃；过时记录过多时按表重建堆
+    class EntryMap {
+       public:
+        typedef std::unordered_map<uint64_t, Entry> Map;
+
+        size_t size() const { return m_map.size(); }
+        Map::iterator begin() { return m_map.begin(); }
+        Map::iterator end() { return m_map.end(); }
+        Map::iterator find(const uint64_t hash) { return m_map.find(hash); }
+        void erase(const uint64_t hash) { m_map.erase(hash); }
+        void clear() {
+            m_map.clear();
+            m_queue = Queue();
+        }
+
+        void put(const uint64_t hash, Entry&& e) {
+            m_queue.emplace(e.exp, hash);
+            m_map[hash] = std::move(e);
+            if (m_queue.size() > 2 * m_map.size() + 64) {
+                Queue rebuilt;
+                for (auto& kv : m_map) {
+                    rebuilt.emplace(kv.second.exp, kv.first);
+                }
+                m_queue.swap(rebuilt);
+            }
+        }
+
+        // 删除 exp < now 的条目
+        void expire(const uint64_t now) {
+            while (!m_queue.empty() && m_queue.top().first < now) {
+                auto it = m_map.find(m_queue.top().second);
+                if (it != m_map.end() && it->second.exp < now) {
+                    m_map.erase(it);
+                }
+                m_queue.pop();
+            }
+        }
+
+       private:
+        typedef std::pair<uint64_t, uint64_t> Expiry;  // (exp, hash)
+        typedef std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> Queue;
+
+        Map m_map;
+        Queue m_queue;
+    };
+
+    // 丢弃签发于其前的令牌都已过期的用户级撤销记录
+    void expireUsers(const uint64_t now) {
+        const uint64_t lifetime = g_jwt_expires_in->getValue();
+        while (!m_userQueue.empty() && m_userQueue.front().first + lifetime < now) {
+            auto it = m_userCutoff.find(m_userQueue.front().second);
+            if (it != m_userCutoff.end() && it->second == m_userQueue.front().first) {
+                m_userCutoff.erase(it);
+            }
+            m_userQueue.pop_front();
+        }
+    }
+
+    struct Shard {
+        RWMutex mutex;
+        EntryMap verified;
+        EntryMap revoked;
+    };
+
+    static constexpr size_t kShardCount = 16;
+    Shard m_shards[kShardCount];
+    size_t m_shardCapacity;
+    RWMutex m_userMutex;
+    std::unordered_map<uint64_t, uint64_t> m_userCutoff;      // uid -> 撤销时间
+    std::deque<std::pair<uint64_t, uint64_t>> m_userQueue;  // (撤销时间, uid)，按时间递增
+};
+
+JwtCache& GetJwtCache() {
+    static JwtCache s_cache;
+    return s_cache;
+}
+
+uint64_t JwtHash(const std::string& token) {
+    return murmur3_hash64(token.data(), token.size());
+}
+
+// 单次 decode 完成验签、签发者与过期检查，通过后写入缓存
+JwtState CheckJwt(const std::string& token, JwtCache::Entry& out) {
+    const uint64_t now = TimeUtil::NowToS();
+    const uint64_t hash = JwtHash(token);
+    auto& cache = GetJwtCache();
+    switch (cache.get(token, hash, out)) {
+        case JwtCache::HIT:
+            if (out.exp < now) {
+                return JwtState::EXPIRED;
+            }
+            return cache.isUserRevoked(out.uid_num, out.iat) ? JwtState::INVALID : JwtState::OK;
+        case JwtCache::REVOKED:
+            return JwtState::INVALID;
+        default:
+            break;
+    }
+
+    try {
+        auto dec = jwt::decode(token);
+        if (!dec.has_expires_at()) {
+            IM_LOG_WARN(g_logger) << "jwt verify failed: missing exp";
+            return JwtState::INVALID;
+        }
+        out.exp = std::chrono::duration_cast<std::chrono::seconds>(
+                      dec.get_expires_at().time_since_epoch())
+                      .count();
+        if (out.exp < now) {
+            return JwtState::EXPIRED;
+        }
+        auto verifier = jwt::verify()
+                            .allow_algorithm(jwt::algorithm::hs256{g_jwt_secret->getValue()})
+                            .with_issuer(g_jwt_issuer->getValue());
+        verifier.verify(dec);
+        out.uid = dec.has_payload_claim("uid") ? dec.get_payload_claim("uid").as_string() : "";
+        if (dec.has_issued_at()) {
+            out.iat = std::chrono::duration_cast<std::chrono::seconds>(
+                          dec.get_issued_at().time_since_epoch())
+                          .count();
+        }
+    } catch (const std::exception& e) {
+        IM_LOG_WARN(g_logger) << "jwt verify failed: " << e.what();
+        return JwtState::INVALID;
+    }
+
+    try {
+        out.uid_num = out.uid.empty() ? 0 : std::stoull(out.uid);
+    } catch (...) {
+        out.uid_num = 0;
+    }
+    out.token = token;
+    cache.put(hash, JwtCache::Entry(out), now);
+    return cache.isUserRevoked(out.uid_num, out.iat) ? JwtState::INVALID : JwtState::OK;
+}
+
+}  // namespace
 
 std::string Ok(const Json::Value& data) {
     return IM::JsonUtil::ToString(data);
@@ -68,27 +323,39 @@ TokenResult SignJwt(const std::string& uid, uint32_t expires_in) {
  * @return 验证成功返回true，否则返回false
  * 
  * 该函数使用HS256算法和预设的密钥来验证JWT令牌，
- * 同时检查签发者信息是否匹配。如果令牌有效且包含
- * uid声明，则将其写入out_uid参数中。
+ * 同时检查签发者与过期时间。校验结果按令牌缓存，
+ * 同一令牌再次校验时直接命中缓存。
  */
 bool VerifyJwt(const std::string& token, std::string* out_uid) {
+    JwtCache::Entry e;
+    if (CheckJwt(token, e) != JwtState::OK) {
+        return false;
+    }
+    if (out_uid) {
+        *out_uid = e.uid;
+    }
+    return true;
+}
+
+void RevokeJwt(const std::string& token) {
+    JwtCache::Entry e;
     try {
         auto dec = jwt::decode(token);
-        auto verifier = jwt::verify()
-                            .allow_algorithm(jwt::algorithm::hs256{g_jwt_secret->getValue()})
-                            .with_issuer(g_jwt_issuer->getValue());
-        verifier.verify(dec);
-        if (out_uid) {
-            if (dec.has_payload_claim("uid")) {
-                *out_uid = dec.get_payload_claim("uid").as_string();
-            } else {
-                *out_uid = "";
-            }
+        if (dec.has_expires_at()) {
+            e.exp = std::chrono::duration_cast<std::chrono::seconds>(
+                        dec.get_expires_at().time_since_epoch())
+                        .count();
         }
-        return true;
-    } catch (const std::exception& e) {
-        IM_LOG_WARN(g_logger) << "jwt verify failed: " << e.what();
-        return false;
+    } catch (const std::exception& ex) {
+        IM_LOG_WARN(g_logger) << "jwt decode failed: " << ex.what();
+    }
+    e.token = token;
+    GetJwtCache().revoke(JwtHash(token), std::move(e), TimeUtil::NowToS());
+}
+
+void RevokeUserJwts(const uint64_t uid) {
+    if (uid != 0) {
+        GetJwtCache().revokeUser(uid, TimeUtil::NowToS());
     }
 }
 
@@ -105,42 +372,46 @@ bool IsJwtExpired(const std::string& token) {
     return false;
 }
 
-UidResult GetUidFromToken(IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res) {
-    UidResult result;
-
-    // 从请求头中提取 Token
+std::string GetBearerToken(IM::http::HttpRequest::ptr req) {
     std::string header = req->getHeader("Authorization", "");
-    std::string token;
     // 兼容 "Bearer <token>" 格式；严格校验前缀与长度，避免 substr 越界
     const std::string kBearer = "Bearer ";
     if (!header.empty() && header.rfind(kBearer, 0) == 0 && header.size() > kBearer.size()) {
-        token = header.substr(kBearer.size());
-    } else if (!header.empty() && header.find(' ') == std::string::npos) {
+        return header.substr(kBearer.size());
+    }
+    if (!header.empty() && header.find(' ') == std::string::npos) {
         // 兼容直接传裸 token 的情况（无前缀）
-        token = header;
+        return header;
     }
+    return std::string();
+}
+
+UidResult GetUidFromToken(IM::http::HttpRequest::ptr req, IM::http::HttpResponse::ptr res) {
+    UidResult result;
+
+    // 从请求头中提取 Token
+    const std::string token = GetBearerToken(req);
     if (token.empty()) {
         result.code = 401;
         result.err = "未提供访问令牌！";
         return result;
     }
 
-    // 验证 Token 的签名是否有效并提取用户 ID
-    std::string uid_str;
-    if (!VerifyJwt(token, &uid_str)) {
+    // 验证 Token（签名、签发者、过期时间）并提取用户 ID
+    JwtCache::Entry e;
+    auto state = CheckJwt(token, e);
+    if (state == JwtState::EXPIRED) {
         result.code = 401;
-        result.err = "无效的访问令牌！";
+        result.err = "访问令牌已过期！";
         return result;
     }
-
-    // 检查 Token 是否已过期
-    if (IsJwtExpired(token)) {
+    if (state != JwtState::OK || e.uid_num == 0) {
         result.code = 401;
-        result.err = "访问令牌已过期！";
+        result.err = "无效的访问令牌！";
         return result;
     }
 
-    result.data = std::stoull(uid_str);
+    result.data = e.uid_num;
     result.ok = true;
     return result;
 }
@@ -0,0 +1,251 @@
+#include "dao/group_dao.hpp"
+
+namespace IM::dao {
+
+static constexpr const char* kDBName = "default";
+
+bool GroupDao::GetState(const uint64_t group_id, GroupState& out, std::string* err) {
+    auto db = IM::MySQLMgr::GetInstance()->get(kDBName);
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql = "SELECT id, leader_id, is_mute, is_dismissed FROM im_group WHERE id = ?";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, group_id);
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    if (!res->next()) {
+        return false;
+    }
+    out.id = res->getUint64(0);
+    out.leader_id = res->getUint64(1);
+    out.is_mute = res->getUint8(2);
+    out.is_dismissed = res->getUint8(3);
+    return true;
+}
+
+bool GroupDao::ListMembers(const uint64_t group_id, std::vector<GroupMemberItem>& out,
+                           std::string* err) {
+    out.clear();
+    auto db = IM::MySQLMgr::GetInstance()->get(kDBName);
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    // 走 uk_group_user(group_id, user_id)
+    const char* sql =
+        "SELECT user_id, role, no_speak_until FROM im_group_member "
+        "WHERE group_id = ? AND deleted_at IS NULL";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, group_id);
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    while (res->next()) {
+        GroupMemberItem item;
+        item.user_id = res->getUint64(0);
+        item.role = res->getUint8(1);
+        item.no_speak_until = res->isNull(2) ? 0 : res->getTime(2);
+        out.push_back(item);
+    }
+    return true;
+}
+
+bool GroupDao::GetRoleForUpdateWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                        const uint64_t group_id, const uint64_t user_id,
+                                        uint8_t& role, std::string* err) {
+    role = 0;
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    // 群行与成员行一起加锁，并发的角色/成员变更在事务内串行
+    const char* sql =
+        "SELECT g.leader_id, g.is_dismissed, m.role FROM im_group g "
+        "LEFT JOIN im_group_member m ON m.group_id = g.id AND m.user_id = ? "
+        "AND m.deleted_at IS NULL WHERE g.id = ? FOR UPDATE";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, user_id);
+    stmt->bindUint64(2, group_id);
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    if (!res->next() || res->getUint8(1) == 1 || res->isNull(2)) {
+        return true;
+    }
+    role = res->getUint64(0) == user_id ? 3 : res->getUint8(2);
+    return true;
+}
+
+bool GroupDao::AddMemberWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                 const uint64_t user_id, const uint8_t role, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    // 重新入群视为新成员：清空群名片与禁言
+    const char* sql =
+        "INSERT INTO im_group_member (group_id, user_id, role, joined_at, created_at, updated_at) "
+        "VALUES (?, ?, ?, NOW(), NOW(), NOW()) "
+        "ON DUPLICATE KEY UPDATE "
+        "role = IF(deleted_at IS NULL, role, VALUES(role)), "
+        "visit_card = IF(deleted_at IS NULL, visit_card, NULL), "
+        "no_speak_until = IF(deleted_at IS NULL, no_speak_until, NULL), "
+        "joined_at = IF(deleted_at IS NULL, joined_at, NOW()), "
+        "updated_at = NOW(), deleted_at = NULL";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, group_id);
+    stmt->bindUint64(2, user_id);
+    stmt->bindUint8(3, role);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+bool GroupDao::RemoveMemberWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                    const uint64_t user_id, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql =
+        "UPDATE im_group_member SET deleted_at = NOW(), updated_at = NOW() "
+        "WHERE group_id = ? AND user_id = ? AND deleted_at IS NULL";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, group_id);
+    stmt->bindUint64(2, user_id);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+bool GroupDao::RefreshMemberNumWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                        const uint64_t group_id, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql =
+        "UPDATE im_group SET member_num = (SELECT COUNT(*) FROM im_group_member "
+        "WHERE group_id = ? AND deleted_at IS NULL), updated_at = NOW() WHERE id = ?";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint64(1, group_id);
+    stmt->bindUint64(2, group_id);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+bool GroupDao::UpdateRoleWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                  const uint64_t user_id, const uint8_t role, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql =
+        "UPDATE im_group_member SET role = ?, updated_at = NOW() "
+        "WHERE group_id = ? AND user_id = ? AND deleted_at IS NULL";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint8(1, role);
+    stmt->bindUint64(2, group_id);
+    stmt->bindUint64(3, user_id);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+bool GroupDao::UpdateNoSpeakWithConn(const std::shared_ptr<IM::MySQL>& db,
+                                     const uint64_t group_id, const uint64_t user_id,
+                                     const std::time_t until, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql =
+        "UPDATE im_group_member SET no_speak_until = ?, updated_at = NOW() "
+        "WHERE group_id = ? AND user_id = ? AND deleted_at IS NULL";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    if (until == 0) {
+        stmt->bindNull(1);
+    } else {
+        stmt->bindTime(1, until);
+    }
+    stmt->bindUint64(2, group_id);
+    stmt->bindUint64(3, user_id);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+bool GroupDao::UpdateMuteWithConn(const std::shared_ptr<IM::MySQL>& db, const uint64_t group_id,
+                                  const uint8_t is_mute, std::string* err) {
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    const char* sql = "UPDATE im_group SET is_mute = ?, updated_at = NOW() WHERE id = ?";
+    auto stmt = db->prepare(sql);
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    stmt->bindUint8(1, is_mute);
+    stmt->bindUint64(2, group_id);
+    if (stmt->execute() != 0) {
+        if (err) *err = stmt->getErrStr();
+        return false;
+    }
+    return true;
+}
+
+}  // namespace IM::dao
@@ -270,6 +270,155 @@ bool MessageDao::ListRecentDescWithFilter(const std::shared_ptr<IM::MySQL>& db,
     return true;
 }
 
+bool MessageDao::ListBySequences(const uint64_t talk_id, const std::vector<uint64_t>& sequences,
+                                 const uint64_t user_id, std::vector<Message>& out,
+                                 std::string* err) {
+    out.clear();
+    if (sequences.empty()) {
+        return true;
+    }
+    auto db = IM::MySQLMgr::GetInstance()->get(kDBName);
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    // 走 (talk_id, sequence) 唯一索引的点查
+    std::ostringstream oss;
+    oss << "SELECT " << kSelectCols << " FROM im_message m WHERE talk_id=? AND sequence IN (";
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        if (i) oss << ",";
+        oss << "?";
+    }
+    oss << ") AND m.is_revoked=2";
+    if (user_id != 0) {
+        oss << " AND NOT EXISTS(SELECT 1 FROM im_message_user_delete d WHERE d.msg_id=m.id AND "
+               "d.user_id=?)";
+    }
+    oss << " ORDER BY sequence DESC";
+
+    auto stmt = db->prepare(oss.str().c_str());
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    int cur = 1;
+    stmt->bindUint64(cur++, talk_id);
+    for (auto seq : sequences) {
+        stmt->bindUint64(cur++, seq);
+    }
+    if (user_id != 0) {
+        stmt->bindUint64(cur++, user_id);
+    }
+
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    while (res->next()) {
+        Message m;
+        m.id = res->getString(0);
+        m.talk_id = res->getUint64(1);
+        m.sequence = res->getUint64(2);
+        m.talk_mode = res->getUint8(3);
+        m.msg_type = res->getUint16(4);
+        m.sender_id = res->getUint64(5);
+        m.receiver_id = res->isNull(6) ? 0 : res->getUint64(6);
+        m.group_id = res->isNull(7) ? 0 : res->getUint64(7);
+        m.content_text = res->isNull(8) ? std::string() : res->getString(8);
+        m.extra = res->isNull(9) ? std::string() : res->getString(9);
+        m.quote_msg_id = res->isNull(10) ? std::string() : res->getString(10);
+        m.is_revoked = res->getUint8(11);
+        m.status = res->getUint8(12);
+        m.revoke_by = res->isNull(13) ? 0 : res->getUint64(13);
+        m.revoke_time = res->isNull(14) ? 0 : res->getTime(14);
+        m.created_at = res->getTime(15);
+        m.updated_at = res->getTime(16);
+        out.push_back(std::move(m));
+    }
+    return true;
+}
+
+bool MessageDao::SearchByKeyword(const uint64_t talk_id, const std::string& keyword,
+                                 const uint64_t anchor_seq, const size_t limit,
+                                 const uint64_t user_id, std::vector<Message>& out,
+                                 std::string* err) {
+    out.clear();
+    if (keyword.empty() || limit == 0) {
+        return true;
+    }
+    auto db = IM::MySQLMgr::GetInstance()->get(kDBName);
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    // 关键词按字面匹配：转义 LIKE 通配符
+    std::string pattern = "%";
+    for (char c : keyword) {
+        if (c == '%' || c == '_' || c == '\\') {
+            pattern.push_back('\\');
+        }
+        pattern.push_back(c);
+    }
+    pattern.push_back('%');
+
+    std::ostringstream oss;
+    oss << "SELECT " << kSelectCols << " FROM im_message m WHERE talk_id=?";
+    if (anchor_seq > 0) {
+        oss << " AND sequence<?";
+    }
+    oss << " AND m.is_revoked=2 AND m.content_text LIKE ?";
+    if (user_id != 0) {
+        oss << " AND NOT EXISTS(SELECT 1 FROM im_message_user_delete d WHERE d.msg_id=m.id AND "
+               "d.user_id=?)";
+    }
+    oss << " ORDER BY sequence DESC LIMIT ?";
+
+    auto stmt = db->prepare(oss.str().c_str());
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    int cur = 1;
+    stmt->bindUint64(cur++, talk_id);
+    if (anchor_seq > 0) {
+        stmt->bindUint64(cur++, anchor_seq);
+    }
+    stmt->bindString(cur++, pattern);
+    if (user_id != 0) {
+        stmt->bindUint64(cur++, user_id);
+    }
+    stmt->bindInt32(cur++, static_cast<int32_t>(limit));
+
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    while (res->next()) {
+        Message m;
+        m.id = res->getString(0);
+        m.talk_id = res->getUint64(1);
+        m.sequence = res->getUint64(2);
+        m.talk_mode = res->getUint8(3);
+        m.msg_type = res->getUint16(4);
+        m.sender_id = res->getUint64(5);
+        m.receiver_id = res->isNull(6) ? 0 : res->getUint64(6);
+        m.group_id = res->isNull(7) ? 0 : res->getUint64(7);
+        m.content_text = res->isNull(8) ? std::string() : res->getString(8);
+        m.extra = res->isNull(9) ? std::string() : res->getString(9);
+        m.quote_msg_id = res->isNull(10) ? std::string() : res->getString(10);
+        m.is_revoked = res->getUint8(11);
+        m.status = res->getUint8(12);
+        m.revoke_by = res->isNull(13) ? 0 : res->getUint64(13);
+        m.revoke_time = res->isNull(14) ? 0 : res->getTime(14);
+        m.created_at = res->getTime(15);
+        m.updated_at = res->getTime(16);
+        out.push_back(std::move(m));
+    }
+    return true;
+}
+
 // ListAllIdsByTalkId removed — replaced by MessageUserDeleteDao::MarkAllMessagesDeletedByUserInTalk
 
 bool MessageDao::GetByIds(const std::vector<std::string>& ids, std::vector<Message>& out,
@@ -1,5 +1,7 @@
 #include "dao/message_user_delete_dao.hpp"
 
+#include <sstream>
+
 #include "db/mysql.hpp"
 
 namespace IM::dao {
@@ -54,4 +56,40 @@ bool MessageUserDeleteDao::MarkAllMessagesDeletedByUserInTalk(const std::shared_
     }
     return true;
 }
+
+bool MessageUserDeleteDao::ListByMsgIds(const std::vector<std::string>& msg_ids,
+                                        std::vector<std::pair<std::string, uint64_t>>& out,
+                                        std::string* err) {
+    out.clear();
+    if (msg_ids.empty()) return true;
+    auto db = IM::MySQLMgr::GetInstance()->get(kDBName);
+    if (!db) {
+        if (err) *err = "get mysql connection failed";
+        return false;
+    }
+    std::ostringstream oss;
+    oss << "SELECT msg_id,user_id FROM im_message_user_delete WHERE msg_id IN (";
+    for (size_t i = 0; i < msg_ids.size(); ++i) {
+        if (i) oss << ",";
+        oss << "?";
+    }
+    oss << ")";
+    auto stmt = db->prepare(oss.str());
+    if (!stmt) {
+        if (err) *err = "prepare sql failed";
+        return false;
+    }
+    for (size_t i = 0; i < msg_ids.size(); ++i) {
+        stmt->bindString(static_cast<int>(i + 1), msg_ids[i]);
+    }
+    auto res = stmt->query();
+    if (!res) {
+        if (err) *err = "query failed";
+        return false;
+    }
+    while (res->next()) {
+        out.emplace_back(res->getString(0), res->getUint64(1));
+    }
+    return true;
+}
 }  // namespace IM::dao
@@ -0,0 +1,413 @@
+#include "db/co_redis.hpp"
+
+#include "base/macro.hpp"
+#include "net/address.hpp"
+#include "util/time_util.hpp"
+#include "util/util.hpp"
+
+namespace IM {
+static Logger::ptr g_logger = IM_LOG_NAME("system");
+
+static const std::string s_co_multi_cmd = "*1\r\n$5\r\nMULTI\r\n";
+static const std::string s_co_exec_cmd = "*1\r\n$4\r\nEXEC\r\n";
+// 连接失败后的重试间隔，避免 Redis 不可用时每个请求都等待一次连接超时
+static const uint64_t kReconnectIntervalMs = 1000;
+
+CoRedis::CoRedis(const std::map<std::string, std::string>& conf)
+    : m_port(0),
+      m_connectMs(50),
+      m_cmdTimeoutMs(0),
+      m_nextConnectTime(0),
+      m_writing(false),
+      m_connSem(1) {
+    m_type = IRedis::CO_REDIS;
+    auto it = conf.find("host");
+    std::string tmp = it == conf.end() ? "" : it->second;
+    auto pos = tmp.find(":");
+    m_host = tmp.substr(0, pos);
+    if (pos != std::string::npos) {
+        m_port = TypeUtil::Atoi(tmp.substr(pos + 1));
+    }
+    m_passwd = GetParamValue<std::string>(conf, "passwd");
+    m_logEnable = GetParamValue(conf, "log_enable", 1);
+    m_connectMs = GetParamValue<uint64_t>(conf, "timeout_connect", 50);
+    tmp = GetParamValue<std::string>(conf, "timeout_com");
+    if (tmp.empty()) {
+        tmp = GetParamValue<std::string>(conf, "timeout");
+    }
+    m_cmdTimeoutMs = TypeUtil::Atoi(tmp);
+}
+
+CoRedis::~CoRedis() {
+    MutexType::Lock lock(m_mutex);
+    if (m_sock) {
+        m_sock->close();
+    }
+}
+
+bool CoRedis::isConnected() {
+    MutexType::Lock lock(m_mutex);
+    return m_sock != nullptr;
+}
+
+void CoRedis::Wake(Waiter::ptr w, int state) {
+    int s = w->state.load();
+    while (s == RUNNING || s == PARKED) {
+        if (w->state.compare_exchange_weak(s, state)) {
+            if (s == PARKED) {
+                w->scheduler->schedule(w->fiber);
+            }
+            return;
+        }
+    }
+}
+
+ReplyPtr CoRedis::cmd(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    ReplyPtr rt = cmd(fmt, ap);
+    va_end(ap);
+    return rt;
+}
+
+ReplyPtr CoRedis::cmd(const char* fmt, va_list ap) {
+    char* buf = nullptr;
+    int len = redisvFormatCommand(&buf, fmt, ap);
+    if (len == -1 || !buf) {
+        IM_LOG_ERROR(g_logger) << "redis fmt error: " << fmt;
+        return nullptr;
+    }
+    std::string data(buf, len);
+    free(buf);
+
+    std::vector<ReplyPtr> replies;
+    if (!request(data, 1, replies)) {
+        return nullptr;
+    }
+    return checkReply(replies[0], fmt);
+}
+
+ReplyPtr CoRedis::cmd(const std::vector<std::string>& argv) {
+    std::vector<const char*> args;
+    std::vector<size_t> args_len;
+    for (auto& i : argv) {
+        args.push_back(i.c_str());
+        args_len.push_back(i.size());
+    }
+    char* buf = nullptr;
+    int len = redisFormatCommandArgv(&buf, argv.size(), &(args[0]), &(args_len[0]));
+    if (len == -1 || !buf) {
+        IM_LOG_ERROR(g_logger) << "redis fmt error";
+        return nullptr;
+    }
+    std::string data(buf, len);
+    free(buf);
+
+    std::vector<ReplyPtr> replies;
+    if (!request(data, 1, replies)) {
+        return nullptr;
+    }
+    return checkReply(replies[0], argv.empty() ? "" : argv[0].c_str());
+}
+
+ReplyPtr CoRedis::checkReply(ReplyPtr r, const char* what) {
+    if (r && r->type == REDIS_REPLY_ERROR) {
+        if (m_logEnable) {
+            IM_LOG_ERROR(g_logger) << "redis cmd error: (" << what << ")(" << m_host << ":"
+                                    << m_port << ")(" << m_name << "): " << r->str;
+        }
+        return nullptr;
+    }
+    return r;
+}
+
+bool CoRedis::pipeline(RedisBatch& batch) {
+    auto& replies = batch.getReplies();
+    replies.assign(batch.size(), nullptr);
+    if (batch.empty()) {
+        return true;
+    }
+    size_t total = batch.size();
+    size_t bytes = 0;
+    for (auto& i : batch.getCmds()) {
+        bytes += i.size();
+    }
+    std::string data;
+    data.reserve(bytes + s_co_multi_cmd.size() + s_co_exec_cmd.size());
+    if (batch.isTransaction()) {
+        data.append(s_co_multi_cmd);
+        total += 2;
+    }
+    for (auto& i : batch.getCmds()) {
+        data.append(i);
+    }
+    if (batch.isTransaction()) {
+        data.append(s_co_exec_cmd);
+    }
+
+    std::vector<ReplyPtr> rpys;
+    if (!request(data, total, rpys)) {
+        return false;
+    }
+    if (batch.isTransaction()) {
+        return batch.setExecReply(rpys.back());
+    }
+    replies.swap(rpys);
+    return true;
+}
+
+bool CoRedis::request(const std::string& data, size_t count, std::vector<ReplyPtr>& replies) {
+    if (!IOManager::GetThis()) {
+        IM_LOG_ERROR(g_logger) << "CoRedis must be used in IOManager coroutine (" << m_name
+                                << ")";
+        return false;
+    }
+    Socket::ptr sock = getConnection();
+    if (!sock) {
+        return false;
+    }
+    Waiter::ptr w(new Waiter);
+    w->scheduler = IOManager::GetThis();
+    w->fiber = Coroutine::GetThis();
+    w->replies.resize(count);
+
+    bool writer = false;
+    if (!submit(sock, data, count, w, writer)) {
+        return false;
+    }
+    if (writer) {
+        flush(sock);
+    }
+    if (!wait(w)) {
+        return false;
+    }
+    replies.swap(w->replies);
+    return true;
+}
+
+bool CoRedis::submit(Socket::ptr sock, const std::string& data, size_t count, Waiter::ptr w,
+                     bool& writer) {
+    MutexType::Lock lock(m_mutex);
+    if (m_sock != sock) {
+        return false;
+    }
+    // 等待者入队顺序与命令写入发送缓冲的顺序一致，回复据此按序分发
+    for (size_t i = 0; i < count; ++i) {
+        m_waiters.push_back(w);
+    }
+    m_sendBuf.append(data);
+    if (!m_writing) {
+        m_writing = true;
+        writer = true;
+    }
+    return true;
+}
+
+bool CoRedis::wait(Waiter::ptr w) {
+    IOManager* iom = IOManager::GetThis();
+    Timer::ptr timer;
+    if (m_cmdTimeoutMs) {
+        std::weak_ptr<Waiter> ww(w);
+        timer = iom->addTimer(m_cmdTimeoutMs, [ww]() {
+            auto t = ww.lock();
+            if (t) {
+                Wake(t, FAILED);
+            }
+        });
+    }
+    int s = RUNNING;
+    if (w->state.compare_exchange_strong(s, PARKED)) {
+        Coroutine::YieldToHold();
+    }
+    if (timer) {
+        timer->cancel();
+    }
+    if (w->state.load() != DONE) {
+        if (m_logEnable) {
+            IM_LOG_ERROR(g_logger) << "redis request fail: (" << m_host << ":" << m_port << ")("
+                                    << m_name << ") received " << w->received << "/"
+                                    << w->replies.size();
+        }
+        return false;
+    }
+    return true;
+}
+
+Socket::ptr CoRedis::getConnection() {
+    {
+        MutexType::Lock lock(m_mutex);
+        if (m_sock) {
+            return m_sock;
+        }
+    }
+
+    m_connSem.wait();
+    Socket::ptr sock;
+    {
+        MutexType::Lock lock(m_mutex);
+        sock = m_sock;
+    }
+    if (sock || TimeUtil::NowToMS() < m_nextConnectTime) {
+        m_connSem.notify();
+        return sock;
+    }
+
+    sock = connect();
+    if (!sock) {
+        m_nextConnectTime = TimeUtil::NowToMS() + kReconnectIntervalMs;
+        m_connSem.notify();
+        return nullptr;
+    }
+
+    // AUTH 与连接同时登记，保证排在其它协程的命令之前
+    Waiter::ptr auth;
+    {
+        MutexType::Lock lock(m_mutex);
+        m_sock = sock;
+        m_sendBuf.clear();
+        m_writing = false;
+        if (!m_passwd.empty()) {
+            const char* args[] = {"AUTH", m_passwd.c_str()};
+            size_t args_len[] = {4, m_passwd.size()};
+            char* buf = nullptr;
+            int len = redisFormatCommandArgv(&buf, 2, args, args_len);
+            if (len > 0 && buf) {
+                auth.reset(new Waiter);
+                auth->scheduler = IOManager::GetThis();
+                auth->fiber = Coroutine::GetThis();
+                auth->replies.resize(1);
+                m_sendBuf.append(buf, len);
+                m_waiters.push_back(auth);
+                m_writing = true;
+            }
+            free(buf);
+        }
+    }
+    IOManager::GetThis()->schedule(std::bind(&CoRedis::readLoop, this, sock));
+    m_connSem.notify();
+
+    if (auth) {
+        flush(sock);
+        auto r = wait(auth) ? auth->replies[0] : nullptr;
+        if (!r || r->type != REDIS_REPLY_STATUS || !r->str || strcmp(r->str, "OK") != 0) {
+            IM_LOG_ERROR(g_logger) << "auth error:(" << m_host << ":" << m_port << ", " << m_name
+                                    << ")" << (r && r->str ? r->str : "");
+            onError(sock, "auth fail");
+            return nullptr;
+        }
+    }
+    IM_LOG_INFO(g_logger) << "CoRedis connect " << m_host << ":" << m_port << " success";
+    return sock;
+}
+
+Socket::ptr CoRedis::connect() {
+    auto addr = Address::LookupAnyIpAddress(m_host);
+    if (!addr) {
+        IM_LOG_ERROR(g_logger) << "CoRedis lookup host fail: " << m_host;
+        return nullptr;
+    }
+    addr->setPort(m_port);
+    auto sock = Socket::CreateTCP(addr);
+    if (!sock->connect(addr, m_connectMs)) {
+        IM_LOG_ERROR(g_logger) << "CoRedis connect " << m_host << ":" << m_port
+                                << " fail, errno=" << errno << " " << strerror(errno);
+        return nullptr;
+    }
+    return sock;
+}
+
+void CoRedis::flush(Socket::ptr sock) {
+    std::string buf;
+    while (true) {
+        {
+            MutexType::Lock lock(m_mutex);
+            if (m_sock != sock) {
+                // 连接已失效，m_writing 已由 onError 复位
+                return;
+            }
+            if (m_sendBuf.empty()) {
+                m_writing = false;
+                return;
+            }
+            buf.swap(m_sendBuf);
+        }
+        // 写的过程中其它协程追加的命令会在下一轮合并发送
+        size_t offset = 0;
+        while (offset < buf.size()) {
+            int n = sock->send(buf.data() + offset, buf.size() - offset);
+            if (n <= 0) {
+                onError(sock, "send error");
+                return;
+            }
+            offset += n;
+        }
+        buf.clear();
+    }
+}
+
+void CoRedis::readLoop(Socket::ptr sock) {
+    std::shared_ptr<redisReader> reader(redisReaderCreate(), redisReaderFree);
+    std::string buf(16 * 1024, '\0');
+    while (true) {
+        int n = sock->recv(&buf[0], buf.size());
+        if (n <= 0) {
+            onError(sock, n == 0 ? "closed by peer" : "recv error");
+            return;
+        }
+        if (redisReaderFeed(reader.get(), buf.data(), n) != REDIS_OK) {
+            onError(sock, "reader feed error");
+            return;
+        }
+        while (true) {
+            void* r = nullptr;
+            if (redisReaderGetReply(reader.get(), &r) != REDIS_OK) {
+                onError(sock, "protocol error");
+                return;
+            }
+            if (!r) {
+                break;
+            }
+            deliver(sock, ReplyPtr((redisReply*)r, freeReplyObject));
+        }
+    }
+}
+
+void CoRedis::deliver(Socket::ptr sock, ReplyPtr reply) {
+    Waiter::ptr w;
+    {
+        MutexType::Lock lock(m_mutex);
+        if (m_sock != sock || m_waiters.empty()) {
+            return;
+        }
+        w = m_waiters.front();
+        m_waiters.pop_front();
+    }
+    // 超时的等待者同样占位出队，迟到的回复直接丢弃
+    size_t idx = w->received++;
+    w->replies[idx] = reply;
+    if (w->received == w->replies.size()) {
+        Wake(w, DONE);
+    }
+}
+
+void CoRedis::onError(Socket::ptr sock, const char* reason) {
+    std::deque<Waiter::ptr> waiters;
+    {
+        MutexType::Lock lock(m_mutex);
+        if (m_sock != sock) {
+            return;
+        }
+        m_sock.reset();
+        m_sendBuf.clear();
+        m_writing = false;
+        m_waiters.swap(waiters);
+    }
+    IM_LOG_ERROR(g_logger) << "CoRedis (" << m_host << ":" << m_port << ")(" << m_name
+                            << ") connection broken: " << reason << ", pending=" << waiters.size();
+    sock->close();
+    for (auto& i : waiters) {
+        Wake(i, FAILED);
+    }
+}
+
+}  // namespace IM
@@ -1,7 +1,11 @@
 #include "db/mysql.hpp"
 
+#include <poll.h>
+
 #include "config/config.hpp"
 #include "base/macro.hpp"
+#include "io/iomanager.hpp"
+#include "net/hook.hpp"
 #include "util/string_util.hpp"
 #include "util/time_util.hpp"
 
@@ -48,7 +52,98 @@ struct MySQLThreadIniter {
 };
 }  // namespace
 
-static MYSQL* mysql_init(std::map<std::string, std::string>& params, const int& timeout) {
+// MySQL 8.0.16+ 提供 *_nonblocking 系列异步接口（MariaDB 客户端不提供）
+#if defined(MYSQL_VERSION_ID) && MYSQL_VERSION_ID >= 80016 && !defined(MARIADB_BASE_VERSION)
+#define IM_MYSQL_NONBLOCKING 1
+#endif
+
+#ifdef IM_MYSQL_NONBLOCKING
+/**
+ * @brief 当前上下文能否以协程方式等待 mysql socket
+ * @details 与 hook 的判断一致：只有在 IOManager 调度的协程中才让出，
+ *          其余场景（启动阶段、普通线程）退回阻塞接口。
+ */
+static bool mysql_can_yield() {
+    return IOManager::GetThis() != nullptr && is_hook_enable();
+}
+
+/**
+ * @brief 在协程中等待 mysql socket 就绪
+ * @details 异步接口返回 NET_ASYNC_NOT_READY 时不区分读写方向：
+ *          socket 不可写（连接建立中/发送缓冲区满）则等待 WRITE，否则等待服务端响应 READ。
+ * @return 0 就绪；ETIMEDOUT 超时；-1 注册事件失败
+ */
+static int mysql_wait_socket(int fd, uint64_t timeout_ms) {
+    IOManager* iom = IOManager::GetThis();
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    IOManager::Event event = ::poll(&pfd, 1, 0) == 0 ? IOManager::WRITE : IOManager::READ;
+
+    std::shared_ptr<int> cancelled(new int(0));
+    std::weak_ptr<int> wcancelled(cancelled);
+    Timer::ptr timer;
+    if (timeout_ms > 0) {
+        timer = iom->addConditionTimer(
+            timeout_ms,
+            [wcancelled, fd, iom, event]() {
+                auto c = wcancelled.lock();
+                if (!c || *c) {
+                    return;
+                }
+                *c = ETIMEDOUT;
+                iom->cancelEvent(fd, event);
+            },
+            wcancelled);
+    }
+    if (!iom->addEvent(fd, event)) {
+        IM_LOG_ERROR(g_logger) << "mysql addEvent(" << fd << ", " << event << ") error";
+        if (timer) {
+            timer->cancel();
+        }
+        return -1;
+    }
+    Coroutine::YieldToHold();
+    if (timer) {
+        timer->cancel();
+    }
+    return *cancelled;
+}
+
+/**
+ * @brief 驱动一次 mysql 异步调用直至完成
+ * @details 每次调用 fun 期间关闭 hook：libmysqlclient 自行处理非阻塞 socket 的 EAGAIN，
+ *          由本函数统一注册 epoll 事件并让出协程，避免 hook 层在 recv/send 内部重复挂起。
+ * @return 0 完成；1 mysql 报错（mysql_error 可读）；ETIMEDOUT/-1 等待失败，连接已不可用
+ */
+template <class Fun>
+static int mysql_async_run(MYSQL* mysql, uint64_t timeout_ms, Fun fun) {
+    while (true) {
+        bool hook = is_hook_enable();
+        set_hook_enable(false);
+        net_async_status status = fun();
+        set_hook_enable(hook);
+        if (status == NET_ASYNC_COMPLETE) {
+            return 0;
+        }
+        if (status == NET_ASYNC_ERROR) {
+            return 1;
+        }
+        int fd = mysql->net.fd;
+        if (fd < 0) {
+            return -1;
+        }
+        int rt = mysql_wait_socket(fd, timeout_ms);
+        if (rt != 0) {
+            return rt;
+        }
+    }
+}
+#endif
+
+static MYSQL* mysql_init(std::map<std::string, std::string>& params, const int& timeout,
+                         bool nonblock) {
     static thread_local MySQLThreadIniter s_thread_initer;
 
     MYSQL* mysql = ::mysql_init(nullptr);
@@ -68,6 +163,22 @@ static MYSQL* mysql_init(std::map<std::string, std::string>& params, const int&
     std::string passwd = GetParamValue<std::string>(params, "passwd");
     std::string dbname = GetParamValue<std::string>(params, "dbname");
 
+#ifdef IM_MYSQL_NONBLOCKING
+    if (nonblock && mysql_can_yield()) {
+        int rt = mysql_async_run(mysql, timeout > 0 ? timeout * 1000 : 0, [&]() {
+            return mysql_real_connect_nonblocking(mysql, host.c_str(), user.c_str(),
+                                                  passwd.c_str(), dbname.c_str(), port, NULL, 0);
+        });
+        if (rt != 0) {
+            IM_LOG_ERROR(g_logger) << "mysql_real_connect_nonblocking(" << host << ", " << port
+                                    << ", " << dbname << ") error: "
+                                    << (rt == 1 ? mysql_error(mysql) : strerror(rt > 0 ? rt : EIO));
+            mysql_close(mysql);
+            return nullptr;
+        }
+        return mysql;
+    }
+#endif
     if (mysql_real_connect(mysql, host.c_str(), user.c_str(), passwd.c_str(), dbname.c_str(), port,
                            NULL, 0) == nullptr) {
         IM_LOG_ERROR(g_logger) << "mysql_real_connect(" << host << ", " << port << ", " << dbname
@@ -79,14 +190,28 @@ static MYSQL* mysql_init(std::map<std::string, std::string>& params, const int&
 }
 
 MySQL::MySQL(const std::map<std::string, std::string>& args)
-    : m_params(args), m_lastUsedTime(0), m_hasError(false), m_poolSize(10) {}
+    : m_params(args),
+      m_lastUsedTime(0),
+      m_hasError(false),
+      m_poolSize(10),
+      m_nonblock(false),
+      m_queryTimeout(0) {
+    m_nonblock = GetParamValue(m_params, "nonblock", 0) != 0;
+    m_queryTimeout = GetParamValue<uint64_t>(m_params, "query_timeout", 0);
+#ifndef IM_MYSQL_NONBLOCKING
+    if (m_nonblock) {
+        IM_LOG_WARN(g_logger) << "mysql client has no nonblocking api, fallback to blocking mode";
+        m_nonblock = false;
+    }
+#endif
+}
 
 bool MySQL::connect() {
     if (m_mysql && !m_hasError) {
         return true;
     }
 
-    MYSQL* m = mysql_init(m_params, 0);
+    MYSQL* m = mysql_init(m_params, 0, m_nonblock);
     if (!m) {
         m_hasError = true;
         return false;
@@ -138,7 +263,7 @@ int MySQL::execute(const char* format, ...) {
 
 int MySQL::execute(const char* format, va_list ap) {
     m_cmd = StringUtil::Formatv(format, ap);
-    int r = ::mysql_query(m_mysql.get(), m_cmd.c_str());
+    int r = realQuery(m_cmd);
     if (r) {
         IM_LOG_ERROR(g_logger) << "cmd=" << cmd() << ", error: " << getErrStr();
         m_hasError = true;
@@ -150,7 +275,7 @@ int MySQL::execute(const char* format, va_list ap) {
 
 int MySQL::execute(const std::string& sql) {
     m_cmd = sql;
-    int r = ::mysql_query(m_mysql.get(), m_cmd.c_str());
+    int r = realQuery(m_cmd);
     if (r) {
         IM_LOG_ERROR(g_logger) << "cmd=" << cmd() << ", error: " << getErrStr();
         m_hasError = true;
@@ -175,30 +300,105 @@ uint64_t MySQL::getAffectedRows() {
     return mysql_affected_rows(m_mysql.get());
 }
 
-static MYSQL_RES* my_mysql_query(MYSQL* mysql, const char* sql) {
-    if (mysql == nullptr) {
-        IM_LOG_ERROR(g_logger) << "mysql_query mysql is null";
-        return nullptr;
+int MySQL::realQuery(const std::string& sql) {
+    if (!m_mysql) {
+        return -1;
+    }
+    MYSQL* mysql = m_mysql.get();
+#ifdef IM_MYSQL_NONBLOCKING
+    if (m_nonblock && mysql_can_yield()) {
+        int rt = mysql_async_run(mysql, m_queryTimeout, [&]() {
+            return mysql_real_query_nonblocking(mysql, sql.c_str(), sql.size());
+        });
+        if (rt < 0 || rt == ETIMEDOUT) {
+            onAsyncBroken(rt);
+        }
+        return rt;
     }
+#endif
+    return ::mysql_real_query(mysql, sql.c_str(), sql.size());
+}
 
-    if (sql == nullptr) {
-        IM_LOG_ERROR(g_logger) << "mysql_query sql is null";
+MYSQL_RES* MySQL::storeResult() {
+    if (!m_mysql) {
         return nullptr;
     }
+    MYSQL* mysql = m_mysql.get();
+#ifdef IM_MYSQL_NONBLOCKING
+    if (m_nonblock && mysql_can_yield()) {
+        MYSQL_RES* res = nullptr;
+        int rt = mysql_async_run(mysql, m_queryTimeout,
+                                 [&]() { return mysql_store_result_nonblocking(mysql, &res); });
+        if (rt < 0 || rt == ETIMEDOUT) {
+            onAsyncBroken(rt);
+            return nullptr;
+        }
+        return res;
+    }
+#endif
+    return mysql_store_result(mysql);
+}
+
+void MySQL::onAsyncBroken(int rt) {
+    // 等待超时或事件注册失败时连接停留在协议中途，无法继续复用：直接关闭，
+    // 下次从连接池取出时 ping 失败会重新建立连接
+    IM_LOG_ERROR(g_logger) << "mysql nonblocking cmd=" << cmd() << " abort: "
+                            << (rt == ETIMEDOUT ? "timeout" : "wait socket error");
+    m_mysql.reset();
+    m_hasError = true;
+}
 
-    if (::mysql_query(mysql, sql)) {
-        IM_LOG_ERROR(g_logger) << "mysql_query(" << sql << ") error:" << mysql_error(mysql);
+MYSQL_RES* MySQL::queryResult(const std::string& sql) {
+    if (realQuery(sql)) {
+        IM_LOG_ERROR(g_logger) << "mysql_query(" << sql << ") error:" << getErrStr();
         return nullptr;
     }
 
-    MYSQL_RES* res = mysql_store_result(mysql);
+    MYSQL_RES* res = storeResult();
     if (res == nullptr) {
-        IM_LOG_ERROR(g_logger) << "mysql_store_result() error:" << mysql_error(mysql);
+        IM_LOG_ERROR(g_logger) << "mysql_store_result() error:" << getErrStr();
     }
     return res;
 }
 
+/**
+ * @brief 扫描 SQL 中的 ? 占位符位置（跳过引号/反引号内的内容）
+ */
+static void mysql_scan_placeholders(const std::string& sql, std::vector<size_t>& out) {
+    char quote = 0;
+    for (size_t i = 0; i < sql.size(); ++i) {
+        char c = sql[i];
+        if (quote) {
+            if (c == '\\' && quote != '`') {
+                ++i;
+            } else if (c == quote) {
+                quote = 0;
+            }
+        } else if (c == '\'' || c == '"' || c == '`') {
+            quote = c;
+        } else if (c == '?') {
+            out.push_back(i);
+        }
+    }
+}
+
 MySQLStmt::ptr MySQLStmt::Create(MySQL::ptr db, const std::string& stmt) {
+    if (!db->getRaw()) {
+        return nullptr;
+    }
+    if (db->isNonBlock()) {
+        // libmysqlclient 没有预处理语句的异步接口：非阻塞连接上改为客户端参数替换，
+        // 经文本协议（mysql_real_query_nonblocking）执行，同时省去 prepare 的一次往返
+        MySQLStmt::ptr rt(new MySQLStmt(db, nullptr));
+        rt->m_sql = stmt;
+        mysql_scan_placeholders(stmt, rt->m_placeholders);
+        size_t count = rt->m_placeholders.size();
+        rt->m_binds.resize(count);
+        if (count) {
+            memset(&rt->m_binds[0], 0, sizeof(rt->m_binds[0]) * count);
+        }
+        return rt;
+    }
     auto st = mysql_stmt_init(db->getRaw().get());
     if (!st) {
         return nullptr;
@@ -301,10 +501,16 @@ int MySQLStmt::bind(int idx) {
 }
 
 int MySQLStmt::getErrno() {
+    if (!m_stmt) {
+        return m_mysql->getErrno();
+    }
     return mysql_stmt_errno(m_stmt);
 }
 
 std::string MySQLStmt::getErrStr() {
+    if (!m_stmt) {
+        return m_mysql->getErrStr();
+    }
     const char* e = mysql_stmt_error(m_stmt);
     if (e) {
         return e;
@@ -465,16 +671,116 @@ int MySQLStmt::bindTime(int idx, const time_t& value) {
     return bindString(idx, TimeUtil::TimeToStr(value));
 }
 
+bool MySQLStmt::render(std::string& out) {
+    auto raw = m_mysql->getRaw();
+    if (!raw) {
+        return false;
+    }
+    out.clear();
+    out.reserve(m_sql.size() + m_placeholders.size() * 16);
+    size_t last = 0;
+    char buf[64];
+    for (size_t i = 0; i < m_placeholders.size(); ++i) {
+        out.append(m_sql, last, m_placeholders[i] - last);
+        last = m_placeholders[i] + 1;
+
+        const MYSQL_BIND& b = m_binds[i];
+        switch (b.buffer_type) {
+#define XX(type, stype, utype)                                       \
+    case type:                                                       \
+        if (b.is_unsigned) {                                         \
+            utype v;                                                 \
+            memcpy(&v, b.buffer, sizeof(v));                         \
+            out += std::to_string(v);                                \
+        } else {                                                     \
+            stype v;                                                 \
+            memcpy(&v, b.buffer, sizeof(v));                         \
+            out += std::to_string(v);                                \
+        }                                                            \
+        break;
+            XX(MYSQL_TYPE_TINY, int8_t, uint8_t);
+            XX(MYSQL_TYPE_SHORT, int16_t, uint16_t);
+            XX(MYSQL_TYPE_LONG, int32_t, uint32_t);
+            XX(MYSQL_TYPE_LONGLONG, int64_t, uint64_t);
+#undef XX
+            case MYSQL_TYPE_FLOAT: {
+                float v;
+                memcpy(&v, b.buffer, sizeof(v));
+                snprintf(buf, sizeof(buf), "%.9g", v);
+                out += buf;
+                break;
+            }
+            case MYSQL_TYPE_DOUBLE: {
+                double v;
+                memcpy(&v, b.buffer, sizeof(v));
+                snprintf(buf, sizeof(buf), "%.17g", v);
+                out += buf;
+                break;
+            }
+            case MYSQL_TYPE_STRING: {
+                size_t pos = out.size();
+                out.resize(pos + b.buffer_length * 2 + 3);
+                out[pos] = '\'';
+                unsigned long n = mysql_real_escape_string(
+                    raw.get(), &out[pos + 1], (const char*)b.buffer, b.buffer_length);
+                if (n == (unsigned long)-1) {
+                    return false;
+                }
+                out.resize(pos + 1 + n);
+                out += '\'';
+                break;
+            }
+            case MYSQL_TYPE_BLOB: {
+                // 二进制数据用十六进制字面量，避免转义问题
+                static const char* s_hex = "0123456789ABCDEF";
+                out += "X'";
+                const unsigned char* p = (const unsigned char*)b.buffer;
+                for (unsigned long k = 0; k < b.buffer_length; ++k) {
+                    out += s_hex[p[k] >> 4];
+                    out += s_hex[p[k] & 0x0F];
+                }
+                out += '\'';
+                break;
+            }
+            default:
+                // MYSQL_TYPE_NULL 及未绑定的参数
+                out += "NULL";
+                break;
+        }
+    }
+    out.append(m_sql, last, std::string::npos);
+    return true;
+}
+
 int MySQLStmt::execute() {
+    if (!m_stmt) {
+        std::string sql;
+        if (!render(sql)) {
+            IM_LOG_ERROR(g_logger) << "stmt=" << m_sql << " render error";
+            return -1;
+        }
+        return m_mysql->execute(sql);
+    }
     mysql_stmt_bind_param(m_stmt, &m_binds[0]);
     return mysql_stmt_execute(m_stmt);
 }
 
 int64_t MySQLStmt::getLastInsertId() {
+    if (!m_stmt) {
+        return m_mysql->getInsertId();
+    }
     return mysql_stmt_insert_id(m_stmt);
 }
 
 ISQLData::ptr MySQLStmt::query() {
+    if (!m_stmt) {
+        std::string sql;
+        if (!render(sql)) {
+            IM_LOG_ERROR(g_logger) << "stmt=" << m_sql << " render error";
+            return nullptr;
+        }
+        return m_mysql->query(sql);
+    }
     mysql_stmt_bind_param(m_stmt, &m_binds[0]);
     return MySQLStmtRes::Create(shared_from_this());
 }
@@ -806,7 +1112,7 @@ ISQLData::ptr MySQL::query(const char* format, ...) {
 
 ISQLData::ptr MySQL::query(const char* format, va_list ap) {
     m_cmd = StringUtil::Formatv(format, ap);
-    MYSQL_RES* res = my_mysql_query(m_mysql.get(), m_cmd.c_str());
+    MYSQL_RES* res = queryResult(m_cmd);
     if (!res) {
         m_hasError = true;
         return nullptr;
@@ -818,7 +1124,7 @@ ISQLData::ptr MySQL::query(const char* format, va_list ap) {
 
 ISQLData::ptr MySQL::query(const std::string& sql) {
     m_cmd = sql;
-    MYSQL_RES* res = my_mysql_query(m_mysql.get(), m_cmd.c_str());
+    MYSQL_RES* res = queryResult(m_cmd);
     if (!res) {
         m_hasError = true;
         return nullptr;
@@ -1,6 +1,7 @@
 #include "db/redis.hpp"
 
 #include "config/config.hpp"
+#include "db/co_redis.hpp"
 #include "util/hash_util.hpp"
 #include "base/macro.hpp"
 
@@ -50,6 +51,135 @@ redisReply* RedisReplyClone(redisReply* r) {
     return c;
 }
 
+// MULTI / EXEC 的 RESP 编码
+static const std::string s_multi_cmd = "*1\r\n$5\r\nMULTI\r\n";
+static const std::string s_exec_cmd = "*1\r\n$4\r\nEXEC\r\n";
+
+int RedisBatch::add(const char* fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int rt = add(fmt, ap);
+    va_end(ap);
+    return rt;
+}
+
+int RedisBatch::add(const char* fmt, va_list ap) {
+    char* buf = nullptr;
+    int len = redisvFormatCommand(&buf, fmt, ap);
+    if (len == -1 || !buf) {
+        IM_LOG_ERROR(g_logger) << "redis fmt error: " << fmt;
+        return -1;
+    }
+    m_cmds.emplace_back(buf, len);
+    free(buf);
+    return m_cmds.size() - 1;
+}
+
+int RedisBatch::add(const std::vector<std::string>& argv) {
+    std::vector<const char*> args;
+    std::vector<size_t> args_len;
+    for (auto& i : argv) {
+        args.push_back(i.c_str());
+        args_len.push_back(i.size());
+    }
+    char* buf = nullptr;
+    int len = redisFormatCommandArgv(&buf, argv.size(), &(args[0]), &(args_len[0]));
+    if (len == -1 || !buf) {
+        IM_LOG_ERROR(g_logger) << "redis fmt error";
+        return -1;
+    }
+    m_cmds.emplace_back(buf, len);
+    free(buf);
+    return m_cmds.size() - 1;
+}
+
+void RedisBatch::clear() {
+    m_cmds.clear();
+    m_replies.clear();
+}
+
+ReplyPtr RedisBatch::getReply(size_t idx) const {
+    return idx < m_replies.size() ? m_replies[idx] : nullptr;
+}
+
+bool RedisBatch::isOk(size_t idx) const {
+    auto r = getReply(idx);
+    return r && r->type != REDIS_REPLY_ERROR;
+}
+
+int64_t RedisBatch::getInteger(size_t idx, int64_t def) const {
+    auto r = getReply(idx);
+    if (!r) {
+        return def;
+    }
+    if (r->type == REDIS_REPLY_INTEGER) {
+        return r->integer;
+    }
+    if (r->type == REDIS_REPLY_STRING && r->str) {
+        return TypeUtil::Atoi(r->str);
+    }
+    return def;
+}
+
+std::string RedisBatch::getString(size_t idx, const std::string& def) const {
+    auto r = getReply(idx);
+    if (!r) {
+        return def;
+    }
+    switch (r->type) {
+        case REDIS_REPLY_STRING:
+        case REDIS_REPLY_STATUS:
+            return r->str ? std::string(r->str, r->len) : def;
+        case REDIS_REPLY_INTEGER:
+            return std::to_string(r->integer);
+        default:
+            return def;
+    }
+}
+
+bool RedisBatch::getArray(size_t idx, std::vector<std::string>& out) const {
+    auto r = getReply(idx);
+    if (!r || r->type != REDIS_REPLY_ARRAY) {
+        return false;
+    }
+    out.clear();
+    out.reserve(r->elements);
+    for (size_t i = 0; i < r->elements; ++i) {
+        redisReply* e = r->element[i];
+        if (e->type == REDIS_REPLY_INTEGER) {
+            out.push_back(std::to_string(e->integer));
+        } else if (e->str) {
+            out.emplace_back(e->str, e->len);
+        } else {
+            out.emplace_back();
+        }
+    }
+    return true;
+}
+
+size_t RedisBatch::getFailedCount() const {
+    size_t n = m_cmds.size() > m_replies.size() ? m_cmds.size() - m_replies.size() : 0;
+    for (auto& i : m_replies) {
+        if (!i || i->type == REDIS_REPLY_ERROR) {
+            ++n;
+        }
+    }
+    return n;
+}
+
+bool RedisBatch::setExecReply(ReplyPtr exec) {
+    m_replies.assign(m_cmds.size(), nullptr);
+    if (!exec || exec->type != REDIS_REPLY_ARRAY || exec->elements != m_cmds.size()) {
+        // EXEC 返回 nil（WATCH 失效）或 EXECABORT 错误
+        return false;
+    }
+    for (size_t i = 0; i < exec->elements; ++i) {
+        // 子回复由 EXEC 回复统一持有
+        m_replies[i] = ReplyPtr(exec, exec->element[i]);
+    }
+    return true;
+}
+
 Redis::Redis() {
     m_type = IRedis::REDIS;
 }
@@ -224,6 +354,53 @@ int Redis::appendCmd(const std::vector<std::string>& argv) {
     return redisAppendCommandArgv(m_context.get(), argv.size(), &v[0], &l[0]);
 }
 
+bool Redis::pipeline(RedisBatch& batch) {
+    auto& replies = batch.getReplies();
+    replies.assign(batch.size(), nullptr);
+    if (batch.empty()) {
+        return true;
+    }
+    if (!m_context) {
+        return false;
+    }
+    redisContext* c = m_context.get();
+    // 命令先写入输出缓冲区，第一次 redisGetReply 时一并写出
+    size_t total = batch.size();
+    if (batch.isTransaction()) {
+        redisAppendFormattedCommand(c, s_multi_cmd.c_str(), s_multi_cmd.size());
+        total += 2;
+    }
+    for (auto& i : batch.getCmds()) {
+        if (redisAppendFormattedCommand(c, i.c_str(), i.size()) != REDIS_OK) {
+            IM_LOG_ERROR(g_logger) << "redisAppendFormattedCommand error: (" << m_host << ":"
+                                    << m_port << ")(" << m_name << ")";
+            return false;
+        }
+    }
+    if (batch.isTransaction()) {
+        redisAppendFormattedCommand(c, s_exec_cmd.c_str(), s_exec_cmd.size());
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < total; ++i) {
+        redisReply* r = nullptr;
+        if (redisGetReply(c, (void**)&r) != REDIS_OK) {
+            if (m_logEnable) {
+                IM_LOG_ERROR(g_logger) << "redis pipeline getReply error: (" << m_host << ":"
+                                        << m_port << ")(" << m_name << ") " << c->errstr;
+            }
+            return false;
+        }
+        ReplyPtr rt(r, freeReplyObject);
+        if (!batch.isTransaction()) {
+            replies[i] = rt;
+        } else if (i + 1 == total) {
+            ok = batch.setExecReply(rt);
+        }
+    }
+    return ok;
+}
+
 RedisCluster::RedisCluster() {
     m_type = IRedis::REDIS_CLUSTER;
 }
@@ -391,6 +568,163 @@ int RedisCluster::appendCmd(const std::vector<std::string>& argv) {
     return redisClusterAppendCommandArgv(m_context.get(), argv.size(), &v[0], &l[0]);
 }
 
+bool RedisCluster::pipeline(RedisBatch& batch) {
+    auto& replies = batch.getReplies();
+    replies.assign(batch.size(), nullptr);
+    if (batch.empty()) {
+        return true;
+    }
+    if (!m_context) {
+        return false;
+    }
+    if (batch.isTransaction()) {
+        IM_LOG_ERROR(g_logger) << "redis cluster pipeline not support MULTI (" << m_host << ")("
+                                << m_name << ")";
+        return false;
+    }
+    redisClusterContext* cc = m_context.get();
+    // hiredis-vip 按 key 计算 slot，把命令分发到对应节点的连接上，每个节点一次 pipeline
+    for (auto& i : batch.getCmds()) {
+        if (redisClusterAppendFormattedCommand(cc, const_cast<char*>(i.c_str()), i.size()) !=
+            REDIS_OK) {
+            IM_LOG_ERROR(g_logger) << "redisClusterAppendFormattedCommand error: (" << m_host
+                                    << ")(" << m_name << ") " << cc->errstr;
+            redisClusterReset(cc);
+            return false;
+        }
+    }
+    bool ok = true;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        redisReply* r = nullptr;
+        if (redisClusterGetReply(cc, (void**)&r) != REDIS_OK) {
+            if (m_logEnable) {
+                IM_LOG_ERROR(g_logger) << "redis cluster pipeline getReply error: (" << m_host
+                                        << ")(" << m_name << ") " << cc->errstr;
+            }
+            ok = false;
+            break;
+        }
+        replies[i].reset(r, freeReplyObject);
+    }
+    redisClusterReset(cc);
+    return ok;
+}
+
+/**
+ * @brief Fox 系列的一次批量请求（只在 FoxThread 上访问）
+ * @details 所有命令回调结束（pending 归零）后释放；超时后调用方已被唤醒，
+ *          迟到的回调只做计数，不再访问调用方的 batch。
+ */
+struct FoxRedisBatchCtx {
+    RedisBatch* batch = nullptr;  // 调用方持有，done 之前有效
+    bool* result = nullptr;       // 调用方栈上的返回值，done 之前有效
+    Scheduler* scheduler = nullptr;
+    Coroutine::ptr fiber;
+    std::vector<ReplyPtr> replies;  // 事务模式下包含 MULTI/QUEUED/EXEC 的回复
+    event* ev = nullptr;
+    size_t pending = 0;
+    bool done = false;
+    bool failed = false;
+    bool logEnable = true;
+    std::string name;
+};
+
+struct FoxRedisBatchItem {
+    FoxRedisBatchCtx* bctx;
+    size_t idx;
+};
+
+// 整批完成或超时：回填调用方的 batch 并唤醒协程
+static void fox_batch_finish(FoxRedisBatchCtx* bctx) {
+    if (bctx->done) {
+        return;
+    }
+    bctx->done = true;
+    if (bctx->ev) {
+        evtimer_del(bctx->ev);
+        event_free(bctx->ev);
+        bctx->ev = nullptr;
+    }
+    bool ok = !bctx->failed && bctx->pending == 0;
+    auto& batch = *bctx->batch;
+    if (batch.isTransaction()) {
+        ok = batch.setExecReply(bctx->replies.empty() ? nullptr : bctx->replies.back()) && ok;
+    } else {
+        batch.getReplies() = bctx->replies;
+    }
+    *bctx->result = ok;
+    if (bctx->fiber) {
+        bctx->scheduler->schedule(&bctx->fiber);
+    }
+}
+
+static void fox_batch_timeout_cb(int fd, short event, void* d) {
+    FoxRedisBatchCtx* bctx = static_cast<FoxRedisBatchCtx*>(d);
+    if (bctx->logEnable) {
+        IM_LOG_INFO(g_logger) << "redis pipeline (" << bctx->name << ") reach timeout, "
+                               << bctx->pending << " replies pending";
+    }
+    fox_batch_finish(bctx);
+}
+
+static void fox_batch_reply(FoxRedisBatchItem* item, int err, const char* errstr,
+                            redisReply* reply) {
+    FoxRedisBatchCtx* bctx = item->bctx;
+    size_t idx = item->idx;
+    delete item;
+
+    if (err || !reply) {
+        if (bctx->logEnable) {
+            IM_LOG_ERROR(g_logger) << "redis pipeline (" << bctx->name << ") cmd #" << idx
+                                    << " error: (" << err << ") " << (errstr ? errstr : "NULL");
+        }
+        bctx->failed = true;
+    } else if (!bctx->done) {
+        bctx->replies[idx].reset(RedisReplyClone(reply), freeReplyObject);
+    }
+    if (--bctx->pending == 0) {
+        fox_batch_finish(bctx);
+        delete bctx;
+    }
+}
+
+// 在 FoxThread 上发起整批命令；send 负责发送单条 RESP 命令
+template <class Send>
+static void fox_batch_send(FoxRedisBatchCtx* bctx, event_base* base,
+                           const struct timeval& timeout, Send send) {
+    auto& cmds = bctx->batch->getCmds();
+    bool trans = bctx->batch->isTransaction();
+    size_t total = cmds.size() + (trans ? 2 : 0);
+    bctx->replies.assign(total, nullptr);
+    if (timeout.tv_sec || timeout.tv_usec) {
+        bctx->ev = evtimer_new(base, fox_batch_timeout_cb, bctx);
+        evtimer_add(bctx->ev, &timeout);
+    }
+    for (size_t i = 0; i < total; ++i) {
+        const std::string* cmd = nullptr;
+        if (!trans) {
+            cmd = &cmds[i];
+        } else if (i == 0) {
+            cmd = &s_multi_cmd;
+        } else if (i + 1 == total) {
+            cmd = &s_exec_cmd;
+        } else {
+            cmd = &cmds[i - 1];
+        }
+        FoxRedisBatchItem* item = new FoxRedisBatchItem{bctx, i};
+        if (send(*cmd, item)) {
+            ++bctx->pending;
+        } else {
+            delete item;
+            bctx->failed = true;
+        }
+    }
+    if (bctx->pending == 0) {
+        fox_batch_finish(bctx);
+        delete bctx;
+    }
+}
+
 FoxRedis::FoxRedis(FoxThread* thr, const std::map<std::string, std::string>& conf)
     : m_thread(thr), m_status(UNCONNECTED), m_event(nullptr) {
     m_type = IRedis::FOX_REDIS;
@@ -697,6 +1031,47 @@ void FoxRedis::pcmd(FCtx* fctx) {
     }
 }
 
+bool FoxRedis::pipeline(RedisBatch& batch) {
+    batch.getReplies().assign(batch.size(), nullptr);
+    if (batch.empty()) {
+        return true;
+    }
+    bool ok = false;
+    FoxRedisBatchCtx* bctx = new FoxRedisBatchCtx;
+    bctx->batch = &batch;
+    bctx->result = &ok;
+    bctx->logEnable = m_logEnable;
+    bctx->name = m_name;
+    bctx->scheduler = Scheduler::GetThis();
+    bctx->fiber = Coroutine::GetThis();
+
+    // 整批只切换一次线程
+    m_thread->dispatch(std::bind(&FoxRedis::pbatch, this, bctx));
+    Coroutine::YieldToHold();
+    return ok;
+}
+
+void FoxRedis::pbatch(FoxRedisBatchCtx* bctx) {
+    if (m_status == UNCONNECTED) {
+        IM_LOG_INFO(g_logger) << "redis (" << m_host << ":" << m_port << ") unconnected pipeline";
+        init();
+        bctx->failed = true;
+        fox_batch_finish(bctx);
+        delete bctx;
+        return;
+    }
+    fox_batch_send(bctx, m_thread->getBase(), m_cmdTimeout,
+                   [this](const std::string& cmd, FoxRedisBatchItem* item) {
+                       return redisAsyncFormattedCommand(m_context.get(), BatchCmdCb, item,
+                                                         cmd.c_str(), cmd.size()) == REDIS_OK;
+                   });
+}
+
+void FoxRedis::BatchCmdCb(redisAsyncContext* ac, void* r, void* privdata) {
+    fox_batch_reply(static_cast<FoxRedisBatchItem*>(privdata), ac->err, ac->errstr,
+                    static_cast<redisReply*>(r));
+}
+
 FoxRedis::~FoxRedis() {
     if (m_event) {
         evtimer_del(m_event);
@@ -1047,6 +1422,53 @@ void FoxRedisCluster::pcmd(FCtx* fctx) {
     }
 }
 
+bool FoxRedisCluster::pipeline(RedisBatch& batch) {
+    batch.getReplies().assign(batch.size(), nullptr);
+    if (batch.empty()) {
+        return true;
+    }
+    if (batch.isTransaction()) {
+        IM_LOG_ERROR(g_logger) << "redis cluster pipeline not support MULTI (" << m_host << ")("
+                                << m_name << ")";
+        return false;
+    }
+    bool ok = false;
+    FoxRedisBatchCtx* bctx = new FoxRedisBatchCtx;
+    bctx->batch = &batch;
+    bctx->result = &ok;
+    bctx->logEnable = m_logEnable;
+    bctx->name = m_name;
+    bctx->scheduler = Scheduler::GetThis();
+    bctx->fiber = Coroutine::GetThis();
+
+    m_thread->dispatch(std::bind(&FoxRedisCluster::pbatch, this, bctx));
+    Coroutine::YieldToHold();
+    return ok;
+}
+
+void FoxRedisCluster::pbatch(FoxRedisBatchCtx* bctx) {
+    if (m_status != CONNECTED) {
+        IM_LOG_INFO(g_logger) << "redis (" << m_host << ") unconnected pipeline";
+        init();
+        bctx->failed = true;
+        fox_batch_finish(bctx);
+        delete bctx;
+        return;
+    }
+    // hiredis-vip 按 slot 路由到各节点的异步连接
+    fox_batch_send(bctx, m_thread->getBase(), m_cmdTimeout,
+                   [this](const std::string& cmd, FoxRedisBatchItem* item) {
+                       return redisClusterAsyncFormattedCommand(
+                                  m_context.get(), BatchCmdCb, item,
+                                  const_cast<char*>(cmd.c_str()), cmd.size()) == REDIS_OK;
+                   });
+}
+
+void FoxRedisCluster::BatchCmdCb(redisClusterAsyncContext* ac, void* r, void* privdata) {
+    fox_batch_reply(static_cast<FoxRedisBatchItem*>(privdata), ac->err, ac->errstr,
+                    static_cast<redisReply*>(r));
+}
+
 FoxRedisCluster::~FoxRedisCluster() {
     if (m_event) {
         evtimer_del(m_event);
@@ -1165,7 +1587,9 @@ IRedis::ptr RedisManager::get(const std::string& name) {
     }
     auto r = it->second.front();
     it->second.pop_front();
-    if (r->getType() == IRedis::FOX_REDIS || r->getType() == IRedis::FOX_REDIS_CLUSTER) {
+    // 异步/协程客户端在连接上多路复用，不独占
+    if (r->getType() == IRedis::FOX_REDIS || r->getType() == IRedis::FOX_REDIS_CLUSTER ||
+        r->getType() == IRedis::CO_REDIS) {
         it->second.push_back(r);
         return std::shared_ptr<IRedis>(r, nop<IRedis>);
     }
@@ -1185,6 +1609,17 @@ IRedis::ptr RedisManager::get(const std::string& name) {
         r, std::bind(&RedisManager::freeRedis, this, std::placeholders::_1));
 }
 
+bool RedisManager::getConfig(const std::string& name,
+                             std::map<std::string, std::string>& out) {
+    RWMutex::ReadLock lock(m_mutex);
+    auto it = m_config.find(name);
+    if (it == m_config.end()) {
+        return false;
+    }
+    out = it->second;
+    return true;
+}
+
 void RedisManager::freeRedis(IRedis* r) {
     RWMutex::WriteLock lock(m_mutex);
     m_datas[r->getName()].push_back(r);
@@ -1218,6 +1653,13 @@ void RedisManager::init() {
                 RWMutex::WriteLock lock(m_mutex);
                 m_datas[i.first].push_back(rds);
                 Atomic::addFetch(done, 1);
+            } else if (type == "co_redis") {
+                // 首次在协程中使用时才建立连接（需要 IOManager）
+                CoRedis* rds(new CoRedis(i.second));
+                rds->setName(i.first);
+                RWMutex::WriteLock lock(m_mutex);
+                m_datas[i.first].push_back(rds);
+                Atomic::addFetch(done, 1);
             } else if (type == "fox_redis") {
                 auto conf = i.second;
                 auto name = i.first;
@@ -1314,4 +1756,13 @@ ReplyPtr RedisUtil::TryCmd(const std::string& name, uint32_t count,
     return nullptr;
 }
 
-}  // namespace IM
\ No newline at end of file
+bool RedisUtil::Pipeline(const std::string& name, RedisBatch& batch) {
+    auto rds = RedisMgr::GetInstance()->get(name);
+    if (!rds) {
+        batch.getReplies().assign(batch.size(), nullptr);
+        return false;
+    }
+    return rds->pipeline(batch);
+}
+
+}  // namespace IM
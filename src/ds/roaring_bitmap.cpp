@@ -43,6 +43,38 @@ bool RoaringBitmap::readFrom(ByteArray::ptr ba) {
     return false;
 }
 
+void RoaringBitmap::writeTo(std::string& out) const {
+    size_t size = m_bitmap.getSizeInBytes(false);
+    size_t pos = out.size();
+    out.resize(pos + size);
+    m_bitmap.write(&out[pos], false);
+}
+
+bool RoaringBitmap::readFrom(const char* data, size_t size) {
+    // 紧凑格式首字节为类型：uint32 数组 / portable 容器，先校验长度再解析
+    try {
+        if (size >= 5 && data[0] == SERIALIZATION_ARRAY_UINT32) {
+            uint32_t card;
+            memcpy(&card, data + 1, sizeof(card));
+            if (size != 5 + (size_t)card * sizeof(uint32_t)) {
+                return false;
+            }
+            m_bitmap = Roaring::read(data, false);
+            return true;
+        }
+        if (size >= 1 && data[0] == SERIALIZATION_CONTAINER) {
+            m_bitmap = Roaring::readSafe(data + 1, size - 1);
+            return true;
+        }
+    } catch (...) {
+    }
+    return false;
+}
+
+bool RoaringBitmap::runOptimize() {
+    return m_bitmap.runOptimize();
+}
+
 RoaringBitmap& RoaringBitmap::operator=(const RoaringBitmap& b) {
     if (this == &b) {
         return *this;
@@ -166,6 +198,10 @@ void RoaringBitmap::set(uint32_t from, uint32_t size, bool v) {
     m_bitmap.addRange(from, from + size);
 }
 
+void RoaringBitmap::addMany(size_t n, const uint32_t* vals) {
+    m_bitmap.addMany(n, vals);
+}
+
 bool RoaringBitmap::get(uint32_t from, uint32_t size, bool v) const {
     return false;
 }
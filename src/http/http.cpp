@@ -1,5 +1,7 @@
 #include "http/http.hpp"
 
+#include <unistd.h>
+
 namespace IM::http {
 /**
      * @brief 将字符串表示的HTTP方法转换为HttpMethod枚举值
@@ -306,6 +308,12 @@ void HttpRequest::initBodyParam() {}
 
 void HttpRequest::initCookies() {}
 
+HttpFile::~HttpFile() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
 HttpResponse::HttpResponse(uint8_t version, bool close)
     : m_status(HttpStatus::OK), m_version(version), m_close(close), m_websocket(false) {}
 
@@ -333,6 +341,11 @@ void HttpResponse::setVersion(uint8_t v) {
 void HttpResponse::setBody(const std::string& v) {
     m_body = v;
 }
+void HttpResponse::setFileBody(HttpFile::ptr file, uint64_t offset, uint64_t length) {
+    m_file = std::move(file);
+    m_fileOffset = offset;
+    m_fileLength = length;
+}
 void HttpResponse::setReason(const std::string& v) {
     m_reason = v;
 }
@@ -409,8 +422,11 @@ std::ostream& HttpResponse::dump(std::ostream& os) const {
         os << "connection: " << (m_close ? "close" : "keep-alive") << "\r\n";
     }
 
-    // 如果有响应体，则输出Content-Length头和响应体，否则只输出结尾CRLF
-    if (!m_body.empty()) {
+    // 文件响应体只输出头部，数据由 HttpSession 直接从文件发送
+    if (m_file) {
+        os << "content-length: " << m_fileLength << "\r\n\r\n";
+    } else if (!m_body.empty()) {
+        // 如果有响应体，则输出Content-Length头和响应体，否则只输出结尾CRLF
         os << "content-length: " << m_body.size() << "\r\n\r\n" << m_body;
     } else {
         os << "\r\n";
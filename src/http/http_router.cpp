@@ -0,0 +1,266 @@
+#include "http/http_router.hpp"
+
+#include <fnmatch.h>
+
+#include "base/macro.hpp"
+
+namespace IM::http {
+
+static auto g_logger = IM_LOG_NAME("system");
+
+struct HttpRouter::Target {
+    Servlet::ptr servlet;          // 固定 servlet（HoldServletCreator）在构建时直接取出
+    IServletCreator::ptr creator;  // 需要每次创建的 servlet
+
+    bool empty() const { return !servlet && !creator; }
+};
+
+struct HttpRouter::Handlers {
+    Target any;                                        // 不区分方法
+    std::vector<std::pair<HttpMethod, Target>> methods;  // 按方法注册
+};
+
+struct HttpRouter::Node {
+    std::string prefix;                          // 压缩后的静态前缀
+    std::string indices;                         // 各静态子节点 prefix 的首字符
+    std::vector<std::unique_ptr<Node>> children;  // 静态子节点，与 indices 一一对应
+    std::unique_ptr<Node> param;                 // 路径参数子节点
+    std::string param_name;                      // 路径参数名（param 非空时有效）
+    std::unique_ptr<Handlers> leaf;              // 路径恰好在此结束
+    std::unique_ptr<Handlers> catch_all;         // 前缀通配：匹配剩余任意字符
+};
+
+namespace {
+
+bool IsPrefixGlob(const std::string& pattern) {
+    return !pattern.empty() && pattern.find_first_of("*?[\\") == pattern.size() - 1 &&
+           pattern.back() == '*';
+}
+
+}  // namespace
+
+HttpRouter::Node* HttpRouter::InsertStatic(Node* node, std::string s) {
+    while (!s.empty()) {
+        size_t idx = node->indices.find(s[0]);
+        if (idx == std::string::npos) {
+            auto child = std::make_unique<Node>();
+            child->prefix = s;
+            node->indices.push_back(s[0]);
+            node->children.push_back(std::move(child));
+            return node->children.back().get();
+        }
+
+        Node* child = node->children[idx].get();
+        size_t l = 0;
+        while (l < s.size() && l < child->prefix.size() && s[l] == child->prefix[l]) {
+            ++l;
+        }
+        if (l < child->prefix.size()) {
+            // 公共前缀短于子节点前缀：拆出中间节点
+            auto mid = std::make_unique<Node>();
+            mid->prefix = child->prefix.substr(0, l);
+            child->prefix = child->prefix.substr(l);
+            mid->indices.push_back(child->prefix[0]);
+            mid->children.push_back(std::move(node->children[idx]));
+            node->children[idx] = std::move(mid);
+            child = node->children[idx].get();
+        }
+        s = s.substr(l);
+        node = child;
+    }
+    return node;
+}
+
+HttpRouter::HttpRouter(const std::vector<Route>& routes) : m_root(std::make_unique<Node>()) {
+    for (auto& r : routes) {
+        if (insert(r)) {
+            ++m_size;
+        }
+    }
+}
+
+HttpRouter::~HttpRouter() {}
+
+bool HttpRouter::insert(const Route& r) {
+    if (!r.creator || r.pattern.empty()) {
+        return false;
+    }
+
+    std::unique_ptr<Handlers>* slot = nullptr;
+    if (r.glob && IsPrefixGlob(r.pattern)) {
+        Node* node = InsertStatic(m_root.get(), r.pattern.substr(0, r.pattern.size() - 1));
+        slot = &node->catch_all;
+    } else if (r.glob) {
+        for (auto& i : m_globs) {
+            if (i.first == r.pattern) {
+                slot = &i.second;
+                break;
+            }
+        }
+        if (!slot) {
+            m_globs.emplace_back(r.pattern, nullptr);
+            slot = &m_globs.back().second;
+        }
+    } else {
+        // 按 "/:name" 切分静态段与参数段
+        bool has_param = false;
+        Node* node = m_root.get();
+        size_t pos = 0;
+        while (pos < r.pattern.size()) {
+            size_t p = r.pattern.find("/:", pos);
+            if (p == std::string::npos) {
+                node = InsertStatic(node, r.pattern.substr(pos));
+                break;
+            }
+            node = InsertStatic(node, r.pattern.substr(pos, p + 1 - pos));
+            size_t end = r.pattern.find('/', p + 1);
+            if (end == std::string::npos) {
+                end = r.pattern.size();
+            }
+            std::string name = r.pattern.substr(p + 2, end - p - 2);
+            if (name.empty()) {
+                IM_LOG_ERROR(g_logger) << "route " << r.pattern << " has empty param name";
+                return false;
+            }
+            if (!node->param) {
+                node->param = std::make_unique<Node>();
+                node->param_name = name;
+            } else if (node->param_name != name) {
+                IM_LOG_ERROR(g_logger) << "route " << r.pattern << " param :" << name
+                                       << " conflicts with :" << node->param_name;
+                return false;
+            }
+            node = node->param.get();
+            pos = end;
+            has_param = true;
+        }
+        slot = &node->leaf;
+        if (!*slot) {
+            slot->reset(new Handlers);
+        }
+        if (!has_param) {
+            m_statics[r.pattern] = slot->get();
+        }
+    }
+
+    if (!*slot) {
+        slot->reset(new Handlers);
+    }
+    Target t;
+    if (std::dynamic_pointer_cast<HoldServletCreator>(r.creator)) {
+        t.servlet = r.creator->get();
+    } else {
+        t.creator = r.creator;
+    }
+
+    Handlers& h = **slot;
+    if (r.method == HttpMethod::INVALID_METHOD) {
+        h.any = t;
+        return true;
+    }
+    for (auto& m : h.methods) {
+        if (m.first == r.method) {
+            m.second = t;
+            return true;
+        }
+    }
+    h.methods.emplace_back(r.method, t);
+    return true;
+}
+
+Servlet::ptr HttpRouter::Resolve(const Target& t) {
+    return t.servlet ? t.servlet : t.creator->get();
+}
+
+const HttpRouter::Handlers* HttpRouter::find(const Node* node, const std::string& path,
+                                             size_t pos, ParamList* params) const {
+    if (pos == path.size()) {
+        if (node->leaf) {
+            return node->leaf.get();
+        }
+    } else {
+        size_t idx = node->indices.find(path[pos]);
+        if (idx != std::string::npos) {
+            const Node* child = node->children[idx].get();
+            if (path.compare(pos, child->prefix.size(), child->prefix) == 0) {
+                auto h = find(child, path, pos + child->prefix.size(), params);
+                if (h) {
+                    return h;
+                }
+            }
+        }
+        if (node->param) {
+            size_t end = path.find('/', pos);
+            if (end == std::string::npos) {
+                end = path.size();
+            }
+            if (end > pos) {
+                size_t n = params ? params->size() : 0;
+                if (params) {
+                    params->emplace_back(node->param_name, path.substr(pos, end - pos));
+                }
+                auto h = find(node->param.get(), path, end, params);
+                if (h) {
+                    return h;
+                }
+                if (params) {
+                    params->resize(n);
+                }
+            }
+        }
+    }
+    return node->catch_all.get();
+}
+
+HttpRouter::Result HttpRouter::select(const Handlers* h, HttpMethod method) const {
+    Result rt;
+    if (method != HttpMethod::INVALID_METHOD) {
+        for (auto& m : h->methods) {
+            if (m.first == method) {
+                rt.servlet = Resolve(m.second);
+                return rt;
+            }
+        }
+    }
+    if (!h->any.empty()) {
+        rt.servlet = Resolve(h->any);
+        return rt;
+    }
+    rt.method_not_allowed = !h->methods.empty();
+    return rt;
+}
+
+HttpRouter::Result HttpRouter::match(HttpMethod method, const std::string& path,
+                                     ParamList* params) const {
+    auto it = m_statics.find(path);
+    if (it != m_statics.end()) {
+        auto rt = select(it->second, method);
+        if (rt.servlet || rt.method_not_allowed) {
+            return rt;
+        }
+    }
+
+    size_t n = params ? params->size() : 0;
+    auto h = find(m_root.get(), path, 0, params);
+    if (h) {
+        auto rt = select(h, method);
+        if (rt.servlet || rt.method_not_allowed) {
+            return rt;
+        }
+        if (params) {
+            params->resize(n);
+        }
+    }
+
+    for (auto& i : m_globs) {
+        if (!fnmatch(i.first.c_str(), path.c_str(), 0)) {
+            auto rt = select(i.second.get(), method);
+            if (rt.servlet || rt.method_not_allowed) {
+                return rt;
+            }
+        }
+    }
+    return Result();
+}
+
+}  // namespace IM::http
@@ -2,12 +2,26 @@
 
 #include "http/servlets/config_servlet.hpp"
 #include "base/macro.hpp"
+#include "config/config.hpp"
+#include "http/servlets/static_file_servlet.hpp"
 #include "http/servlets/status_servlet.hpp"
+#include "system/env.hpp"
 
 namespace IM::http {
 
 static auto g_logger = IM_LOG_NAME("system");
 
+static auto g_static_root = IM::Config::Lookup<std::string>(
+    "http.static.root", "", "static file root dir (relative to work path, empty = disabled)");
+static auto g_static_prefix = IM::Config::Lookup<std::string>(
+    "http.static.prefix", "/static/", "url prefix of static files");
+static auto g_static_max_age = IM::Config::Lookup<uint32_t>(
+    "http.static.max_age", 86400, "Cache-Control max-age of static files in seconds");
+static auto g_static_cache_size = IM::Config::Lookup<uint32_t>(
+    "http.static.cache_size", 4096, "max cached open static files");
+static auto g_static_stat_ttl = IM::Config::Lookup<uint32_t>(
+    "http.static.stat_ttl", 2000, "static file stat revalidate interval in ms");
+
 HttpServer::HttpServer(bool keepalive, IOManager* worker, IOManager* io_worker,
                        IOManager* accept_worker)
     : TcpServer(worker, io_worker, accept_worker), m_isKeepalive(keepalive) {
@@ -16,6 +30,17 @@ HttpServer::HttpServer(bool keepalive, IOManager* worker, IOManager* io_worker,
     m_type = "http";
     m_dispatch->addServlet("/_/status", Servlet::ptr(new StatusServlet));
     m_dispatch->addServlet("/_/config", Servlet::ptr(new ConfigServlet));
+
+    // 静态文件（头像、表情、上传的媒体等）
+    if (!g_static_root->getValue().empty()) {
+        StaticFileServlet::Options opts;
+        opts.root = EnvMgr::GetInstance()->getAbsoluteWorkPath(g_static_root->getValue());
+        opts.prefix = g_static_prefix->getValue();
+        opts.max_age = g_static_max_age->getValue();
+        opts.cache_size = g_static_cache_size->getValue();
+        opts.stat_ttl = g_static_stat_ttl->getValue();
+        m_dispatch->addGlobServlet(opts.prefix + "*", std::make_shared<StaticFileServlet>(opts));
+    }
 }
 
 void HttpServer::setName(const std::string& v) {
@@ -28,9 +53,9 @@ void HttpServer::handleClient(Socket::ptr client) {
     /* 创建 HTTP 会话 */
     HttpSession::ptr session(new HttpSession(client));
     do {
-        /* 接收 HTTP 请求 */
+        /* 接收 HTTP 请求头 */
         IM_LOG_DEBUG(g_logger) << "waiting for http request from " << *client;
-        auto req = session->recvRequest();
+        auto req = session->recvRequestHeader();
         if (!req) {
             IM_LOG_DEBUG(g_logger)
                 << "recv http request fail, errno=" << errno << " errstr=" << strerror(errno)
@@ -38,13 +63,37 @@ void HttpServer::handleClient(Socket::ptr client) {
             break;
         }
 
-        /* 处理 HTTP 请求 */
         HttpResponse::ptr rsp(
             new HttpResponse(req->getVersion(), req->isClose() || !m_isKeepalive));
         rsp->setHeader("Server", getName());
-        m_dispatch->handle(req, rsp, session);  // 路由分发
-        session->sendResponse(rsp);             // 发送响应数据
 
+        /* 路由匹配：流式 servlet 自行读取请求体，其余先把请求体读入内存 */
+        auto slt = m_dispatch->getMatchedServlet(req);
+        if (!slt->isStreaming()) {
+            bool too_large = false;
+            if (!session->recvBody(req, &too_large)) {
+                if (too_large) {
+                    rsp->setStatus(HttpStatus::PAYLOAD_TOO_LARGE);
+                    rsp->setClose(true);
+                    session->sendResponse(rsp);
+                }
+                IM_LOG_DEBUG(g_logger) << "recv http body fail, too_large=" << too_large
+                                       << " cliet:" << *client;
+                break;
+            }
+        }
+
+        /* 处理 HTTP 请求 */
+        slt->handle(req, rsp, session);  // 路由分发
+        /* 请求体未读完（流式 servlet 提前返回）时无法复用连接 */
+        if (!session->isBodyComplete()) {
+            rsp->setClose(true);
+        }
+        session->sendResponse(rsp);  // 发送响应数据
+
+        if (rsp->isClose()) {
+            break;
+        }
         /* 如果不是长连接或者客户端关闭，则关闭会话 */
         if (!m_isKeepalive || req->isClose()) {
             break;
@@ -1,38 +1,118 @@
 #include "http/http_servlet.hpp"
 
-#include <fnmatch.h>
+#include "http/http_router.hpp"
 
 namespace IM::http {
+static uint64_t NextDispatchId() {
+    static std::atomic<uint64_t> s_id{0};
+    return ++s_id;
+}
+
 Servlet::Servlet(const std::string& name) : m_name(name) {}
 Servlet::~Servlet() {}
-FunctionServlet::FunctionServlet(callback cb) : Servlet("FunctionServlet"), m_cb(cb) {}
+FunctionServlet::FunctionServlet(callback cb, bool streaming)
+    : Servlet("FunctionServlet"), m_cb(cb), m_streaming(streaming) {}
 
 int32_t FunctionServlet::handle(HttpRequest::ptr request, HttpResponse::ptr response,
                                 HttpSession::ptr session) {
     return m_cb(request, response, session);
 }
 
-ServletDispatch::ServletDispatch() : Servlet("ServletDispatch") {
+ServletDispatch::ServletDispatch() : Servlet("ServletDispatch"), m_id(NextDispatchId()) {
     m_default.reset(new NotFoundServlet("IM/1.0"));
+    m_methodNotAllowed = std::make_shared<FunctionServlet>(
+        [](HttpRequest::ptr request, HttpResponse::ptr response, HttpSession::ptr session) {
+            response->setStatus(HttpStatus::METHOD_NOT_ALLOWED);
+            response->setHeader("Content-Type", "application/json; charset=utf-8");
+            response->setBody("{\"code\":405,\"message\":\"method not allowed\"}");
+            return 0;
+        });
+    RWMutexType::WriteLock lock(m_mutex);
+    rebuild();
 }
 
 int32_t ServletDispatch::handle(HttpRequest::ptr request, http::HttpResponse::ptr response,
                                 HttpSession::ptr session) {
-    auto slt = getMatchedServlet(request->getPath());
+    auto slt = getMatchedServlet(request);
     if (slt) {
         slt->handle(request, response, session);
     }
     return 0;
 }
 
+void ServletDispatch::rebuild() {
+    std::vector<HttpRouter::Route> routes;
+    routes.reserve(m_datas.size() + m_methodDatas.size() + m_globs.size());
+    for (auto& i : m_datas) {
+        HttpRouter::Route r;
+        r.pattern = i.first;
+        r.creator = i.second;
+        routes.push_back(std::move(r));
+    }
+    for (auto& i : m_methodDatas) {
+        for (auto& m : i.second) {
+            HttpRouter::Route r;
+            r.pattern = i.first;
+            r.method = m.first;
+            r.creator = m.second;
+            routes.push_back(std::move(r));
+        }
+    }
+    for (auto& i : m_globs) {
+        HttpRouter::Route r;
+        r.pattern = i.first;
+        r.glob = true;
+        r.creator = i.second;
+        routes.push_back(std::move(r));
+    }
+    // 先替换路由表再递增版本号，读者看到新版本时一定能拿到新路由表
+    std::atomic_store(&m_router, std::shared_ptr<const HttpRouter>(new HttpRouter(routes)));
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+const HttpRouter* ServletDispatch::getRouter() {
+    struct Cached {
+        uint64_t id;
+        uint64_t version;
+        std::shared_ptr<const HttpRouter> router;
+    };
+    // 线程本地缓存：一个进程内分发器只有寥寥几个，线性查找比哈希更快
+    static thread_local std::vector<Cached> t_routers;
+    const uint64_t version = m_version.load(std::memory_order_acquire);
+    for (auto& c : t_routers) {
+        if (c.id == m_id) {
+            if (c.version != version) {
+                c.router = std::atomic_load(&m_router);
+                c.version = version;
+            }
+            return c.router.get();
+        }
+    }
+    t_routers.push_back(Cached{m_id, version, std::atomic_load(&m_router)});
+    return t_routers.back().router.get();
+}
+
 void ServletDispatch::addServlet(const std::string& uri, Servlet::ptr slt) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas[uri] = std::make_shared<HoldServletCreator>(slt);
+    rebuild();
 }
 
 void ServletDispatch::addServletCreator(const std::string& uri, IServletCreator::ptr creator) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas[uri] = creator;
+    rebuild();
+}
+
+void ServletDispatch::addRoute(HttpMethod method, const std::string& uri, Servlet::ptr slt) {
+    RWMutexType::WriteLock lock(m_mutex);
+    m_methodDatas[uri][method] = std::make_shared<HoldServletCreator>(slt);
+    rebuild();
+}
+
+void ServletDispatch::addRoute(HttpMethod method, const std::string& uri,
+                               FunctionServlet::callback cb) {
+    addRoute(method, uri, std::make_shared<FunctionServlet>(cb));
 }
 
 void ServletDispatch::addGlobServletCreator(const std::string& uri, IServletCreator::ptr creator) {
@@ -44,11 +124,13 @@ void ServletDispatch::addGlobServletCreator(const std::string& uri, IServletCrea
         }
     }
     m_globs.push_back(std::make_pair(uri, creator));
+    rebuild();
 }
 
 void ServletDispatch::addServlet(const std::string& uri, FunctionServlet::callback cb) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas[uri] = std::make_shared<HoldServletCreator>(std::make_shared<FunctionServlet>(cb));
+    rebuild();
 }
 
 void ServletDispatch::addGlobServlet(const std::string& uri, Servlet::ptr slt) {
@@ -60,6 +142,7 @@ void ServletDispatch::addGlobServlet(const std::string& uri, Servlet::ptr slt) {
         }
     }
     m_globs.push_back(std::make_pair(uri, std::make_shared<HoldServletCreator>(slt)));
+    rebuild();
 }
 
 void ServletDispatch::addGlobServlet(const std::string& uri, FunctionServlet::callback cb) {
@@ -69,6 +152,8 @@ void ServletDispatch::addGlobServlet(const std::string& uri, FunctionServlet::ca
 void ServletDispatch::delServlet(const std::string& uri) {
     RWMutexType::WriteLock lock(m_mutex);
     m_datas.erase(uri);
+    m_methodDatas.erase(uri);
+    rebuild();
 }
 
 void ServletDispatch::delGlobServlet(const std::string& uri) {
@@ -79,6 +164,7 @@ void ServletDispatch::delGlobServlet(const std::string& uri) {
             break;
         }
     }
+    rebuild();
 }
 
 Servlet::ptr ServletDispatch::getServlet(const std::string& uri) {
@@ -98,22 +184,23 @@ Servlet::ptr ServletDispatch::getGlobServlet(const std::string& uri) {
 }
 
 Servlet::ptr ServletDispatch::getMatchedServlet(const std::string& uri) {
-    RWMutexType::ReadLock lock(m_mutex);
-    // 精准匹配
-    auto mit = m_datas.find(uri);
-    if (mit != m_datas.end()) {
-        return mit->second->get();
+    auto rt = getRouter()->match(HttpMethod::INVALID_METHOD, uri);
+    if (rt.servlet) {
+        return std::move(rt.servlet);
     }
+    return m_default;
+}
 
-    // 模糊匹配
-    for (auto it = m_globs.begin(); it != m_globs.end(); ++it) {
-        if (!fnmatch(it->first.c_str(), uri.c_str(), 0)) {
-            return it->second->get();
+Servlet::ptr ServletDispatch::getMatchedServlet(HttpRequest::ptr request) {
+    HttpRouter::ParamList params;
+    auto rt = getRouter()->match(request->getMethod(), request->getPath(), &params);
+    if (rt.servlet) {
+        for (auto& i : params) {
+            request->setParam(i.first, i.second);
         }
+        return std::move(rt.servlet);
     }
-
-    // 返回默认值
-    return m_default;
+    return rt.method_not_allowed ? m_methodNotAllowed : m_default;
 }
 
 void ServletDispatch::listAllServletCreator(std::map<std::string, IServletCreator::ptr>& infos) {
@@ -1,16 +1,82 @@
 #include "http/http_session.hpp"
 
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/sendfile.h>
+#include <strings.h>
+#include <unistd.h>
+
 #include "http/http_parser.hpp"
+#include "io/iomanager.hpp"
+#include "net/fd_manager.hpp"
 
 namespace IM::http {
+
+namespace {
+// 请求体落盘/丢弃时的固定缓冲区大小
+constexpr size_t kBodyBufferSize = 64 * 1024;
+// splice 使用的管道容量
+constexpr int kSplicePipeSize = 1024 * 1024;
+// sendfile 单次发送的最大字节数
+constexpr size_t kSendFileChunk = 4 * 1024 * 1024;
+// TLS 发送文件时 pread 的缓冲区大小
+constexpr size_t kTlsFileBufferSize = 256 * 1024;
+// chunk 长度行、trailer 行的最大长度
+constexpr size_t kMaxChunkLine = 8 * 1024;
+
+bool WriteAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+// 等待 socket 可读/可写，超时取 SO_RCVTIMEO/SO_SNDTIMEO；在协程中挂起而不阻塞线程
+bool WaitEvent(int sock, IM::IOManager::Event event) {
+    uint64_t timeout = ~0ull;
+    if (auto ctx = IM::FdMgr::GetInstance()->get(sock)) {
+        timeout = ctx->getTimeout(event == IM::IOManager::READ ? SO_RCVTIMEO : SO_SNDTIMEO);
+    }
+    if (auto iom = IM::IOManager::GetThis()) {
+        return iom->waitEvent(sock, event, timeout) == 0;
+    }
+    struct pollfd pfd = {sock, (short)(event == IM::IOManager::READ ? POLLIN : POLLOUT), 0};
+    int rt = ::poll(&pfd, 1, timeout == ~0ull ? -1 : (int)timeout);
+    return rt > 0;
+}
+}  // namespace
+
 HttpSession::HttpSession(Socket::ptr sock, bool owner) : SocketStream(sock, owner) {}
 
+bool HttpSession::isSecure() const {
+    return std::dynamic_pointer_cast<SSLSocket>(m_socket) != nullptr;
+}
+
 HttpRequest::ptr HttpSession::recvRequest() {
+    auto req = recvRequestHeader();
+    if (!req) {
+        return nullptr;
+    }
+    if (!recvBody(req)) {
+        close();
+        return nullptr;
+    }
+    return req;
+}
+
+HttpRequest::ptr HttpSession::recvRequestHeader() {
     // 创建HTTP请求解析器实例，用于解析接收到的数据
     HttpRequestParser::ptr parser(new HttpRequestParser);
     // 获取HTTP请求缓冲区大小配置，用于控制每次读取数据的大小（防止恶意数据）
     uint64_t buff_size = HttpRequestParser::GetHttpRequestBufferSize();
-    // uint64_t buff_size = 100;
     // 分配缓冲区内存，使用智能指针管理内存自动释放
     std::shared_ptr<char> buffer(new char[buff_size], [](char* ptr) { delete[] ptr; });
     char* data = buffer.get();
@@ -28,7 +94,7 @@ HttpRequest::ptr HttpSession::recvRequest() {
 
         // 计算缓冲区中总的数据长度
         len += offset;
-        // 执行解析操作，返回已解析的数据长度
+        // 执行解析操作，返回已解析的数据长度（未解析的数据被前移到缓冲区开头）
         size_t nparse = parser->execute(data, len);
         // 如果解析过程中出现错误，则关闭会话并返回空指针
         if (parser->hasError()) {
@@ -45,79 +111,404 @@ HttpRequest::ptr HttpSession::recvRequest() {
         }
         // 如果解析完成（请求头解析完毕），则跳出循环
         if (parser->isFinished()) {
-            if (offset > 0) {
-                m_leftoverBuf.append(data + nparse, offset);
-            }
             break;
         }
     } while (true);
 
-    // 获取请求体长度
-    int64_t length = parser->getContentLength();
-    // 如果存在请求体数据
-    if (length > 0) {
-        // 创建存储请求体的字符串
-        std::string body;
-        body.resize(length);  // 调整字符串大小以容纳请求体数据
-
-        int len = 0;  // 已读取的请求体长度
-        // 如果请求体长度大于等于缓冲区中已有的数据量
-        if (length >= offset) {
-            // 将缓冲区中的数据复制到请求体中
-            memcpy(&body[0], data, offset);
-            len = offset;  // 更新已读取长度
+    // 请求头之后已读出的数据（请求体开头或下一个请求）放回缓冲区，由后续读取优先消费
+    if (offset > 0) {
+        m_leftoverBuf.insert(m_leftoverPos, data, offset);
+    }
+
+    auto req = parser->getData();
+    // 确定请求体格式：Transfer-Encoding: chunked 优先于 Content-Length
+    m_chunkStarted = false;
+    m_bodyLeft = 0;
+    m_bodyLength = 0;
+    m_bodyMode = BODY_NONE;
+    const std::string te = req->getHeader("Transfer-Encoding");
+    if (!te.empty()) {
+        if (strcasecmp(te.c_str(), "chunked") != 0) {
+            // 仅支持 chunked，其它编码无法确定请求体边界
+            close();
+            return nullptr;
+        }
+        m_bodyMode = BODY_CHUNKED;
+        m_bodyLength = -1;
+    } else {
+        uint64_t length = parser->getContentLength();
+        if (length > 0) {
+            m_bodyMode = BODY_LENGTH;
+            m_bodyLeft = length;
+            m_bodyLength = length;
+        }
+    }
+
+    // 初始化HTTP请求对象（解析请求头中的信息）
+    req->init();
+    return req;
+}
+
+bool HttpSession::recvBody(HttpRequest::ptr req, bool* too_large) {
+    if (too_large) *too_large = false;
+    if (m_bodyMode == BODY_NONE) {
+        return true;
+    }
+    const uint64_t max_size = HttpRequestParser::GetHttpRequestMaxBodySize();
+    std::string body;
+    if (m_bodyMode == BODY_LENGTH) {
+        if (m_bodyLeft > max_size) {
+            if (too_large) *too_large = true;
+            return false;
+        }
+        // 定长请求体一次分配，直接读入目标内存
+        body.resize(m_bodyLeft);
+        size_t len = 0;
+        while (len < body.size()) {
+            int rt = readBody(&body[len], body.size() - len);
+            if (rt <= 0) {
+                return false;
+            }
+            len += rt;
+        }
+    } else {
+        char buf[kMaxChunkLine];
+        while (true) {
+            int rt = readBody(buf, sizeof(buf));
+            if (rt < 0) {
+                return false;
+            }
+            if (rt == 0) {
+                break;
+            }
+            if (body.size() + rt > max_size) {
+                if (too_large) *too_large = true;
+                return false;
+            }
+            body.append(buf, rt);
+        }
+    }
+    req->setBody(body);
+    return true;
+}
+
+bool HttpSession::readLine(std::string& line, size_t max) {
+    while (true) {
+        size_t pos = m_leftoverBuf.find('\n', m_leftoverPos);
+        if (pos != std::string::npos) {
+            size_t end = pos;
+            if (end > m_leftoverPos && m_leftoverBuf[end - 1] == '\r') {
+                --end;
+            }
+            line.assign(m_leftoverBuf, m_leftoverPos, end - m_leftoverPos);
+            m_leftoverPos = pos + 1;
+            return true;
+        }
+        if (m_leftoverBuf.size() - m_leftoverPos > max) {
+            return false;
+        }
+        // 压缩已消费部分后从 socket 追加读取
+        m_leftoverBuf.erase(0, m_leftoverPos);
+        m_leftoverPos = 0;
+        char buf[4096];
+        int rt = SocketStream::read(buf, sizeof(buf));
+        if (rt <= 0) {
+            return false;
+        }
+        m_leftoverBuf.append(buf, rt);
+    }
+}
+
+bool HttpSession::nextChunk() {
+    std::string line;
+    // 上一块数据之后的 CRLF
+    if (m_chunkStarted && (!readLine(line, 2) || !line.empty())) {
+        return false;
+    }
+    m_chunkStarted = true;
+    if (!readLine(line, kMaxChunkLine)) {
+        return false;
+    }
+    // chunk-size [; chunk-ext]
+    uint64_t size = 0;
+    size_t digits = 0;
+    for (char c : line) {
+        int v;
+        if (c >= '0' && c <= '9') {
+            v = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            v = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            v = c - 'A' + 10;
+        } else if (c == ';' || c == ' ' || c == '\t') {
+            break;
         } else {
-            // 只复制需要的部分数据
-            memcpy(&body[0], data, length);
-            len = length;  // 更新已读取长度
+            return false;
         }
+        if (++digits > 15) {
+            return false;
+        }
+        size = (size << 4) | v;
+    }
+    if (digits == 0) {
+        return false;
+    }
+    if (size == 0) {
+        // 末块：消费 trailer 直到空行
+        do {
+            if (!readLine(line, kMaxChunkLine)) {
+                return false;
+            }
+        } while (!line.empty());
+        m_bodyMode = BODY_NONE;
+        return true;
+    }
+    m_bodyLeft = size;
+    return true;
+}
 
-        // 计算剩余需要读取的请求体长度
-        length -= offset;
-        // 如果还有剩余数据需要读取
-        if (length > 0) {
-            // 读取固定大小的数据到请求体剩余部分
-            if (readFixSize(&body[len], length) <= 0) {
-                // 如果读取失败，则关闭连接并返回空指针
-                close();
-                return nullptr;
+int HttpSession::readBody(void* buffer, size_t length) {
+    if (m_bodyMode == BODY_NONE || length == 0) {
+        return 0;
+    }
+    if (m_bodyMode == BODY_CHUNKED && m_bodyLeft == 0) {
+        if (!nextChunk()) {
+            return -1;
+        }
+        if (m_bodyMode == BODY_NONE) {
+            return 0;
+        }
+    }
+    int rt = read(buffer, std::min<uint64_t>(length, m_bodyLeft));
+    if (rt <= 0) {
+        // 请求体未读完连接就断开
+        return -1;
+    }
+    m_bodyLeft -= rt;
+    if (m_bodyMode == BODY_LENGTH && m_bodyLeft == 0) {
+        m_bodyMode = BODY_NONE;
+    }
+    return rt;
+}
+
+int64_t HttpSession::spliceBodyTo(int fd) {
+    int pipefd[2];
+    if (::pipe2(pipefd, O_CLOEXEC) != 0) {
+        return -3;
+    }
+    ::fcntl(pipefd[1], F_SETPIPE_SZ, kSplicePipeSize);
+    const int sock = getSocket()->getSocket();
+    int64_t total = 0;
+    int64_t rt = 0;
+    while (m_bodyLeft > 0) {
+        ssize_t n = ::splice(sock, nullptr, pipefd[1], nullptr,
+                             std::min<uint64_t>(m_bodyLeft, kSplicePipeSize),
+                             SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                if (!WaitEvent(sock, IM::IOManager::READ)) {
+                    rt = -1;
+                    break;
+                }
+                continue;
             }
+            // 首次即失败（如 socket 不支持 splice）时由调用方回退到缓冲区拷贝
+            rt = total == 0 ? -3 : -1;
+            break;
         }
-        // 设置解析得到的HTTP请求对象的请求体
-        parser->getData()->setBody(body);
+        if (n == 0) {
+            rt = -1;  // 对端关闭
+            break;
+        }
+        m_bodyLeft -= n;
+        // 管道中的数据全部搬到目标文件
+        ssize_t left = n;
+        while (left > 0) {
+            ssize_t m = ::splice(pipefd[0], nullptr, fd, nullptr, left, SPLICE_F_MOVE);
+            if (m < 0 && errno == EINTR) {
+                continue;
+            }
+            if (m <= 0) {
+                rt = -1;
+                break;
+            }
+            left -= m;
+        }
+        if (rt < 0) {
+            break;
+        }
+        total += n;
+    }
+    ::close(pipefd[0]);
+    ::close(pipefd[1]);
+    if (rt < 0) {
+        return rt;
     }
+    m_bodyMode = BODY_NONE;
+    return total;
+}
 
-    // 初始化HTTP请求对象（解析请求头中的信息）
-    parser->getData()->init();
-    // 返回解析得到的HTTP请求对象
-    return parser->getData();
+int64_t HttpSession::readBodyTo(int fd, uint64_t max_size, const BodyObserver& observer) {
+    if (m_bodyMode == BODY_LENGTH && m_bodyLeft > max_size) {
+        return -2;
+    }
+    int64_t total = 0;
+    // TLS 连接上的数据需经 SSL_read 解密，只有明文 socket 才能 splice
+    if (m_bodyMode == BODY_LENGTH && !observer && !isSecure()) {
+        // 先写出已缓冲的部分，其余交给 splice 在内核内从 socket 搬到文件
+        size_t buffered = std::min<uint64_t>(m_leftoverBuf.size() - m_leftoverPos, m_bodyLeft);
+        if (buffered > 0) {
+            if (!WriteAll(fd, m_leftoverBuf.data() + m_leftoverPos, buffered)) {
+                return -1;
+            }
+            m_leftoverPos += buffered;
+            m_bodyLeft -= buffered;
+            total += buffered;
+            if (m_bodyLeft == 0) {
+                m_bodyMode = BODY_NONE;
+                return total;
+            }
+        }
+        int64_t rt = spliceBodyTo(fd);
+        if (rt != -3) {
+            return rt < 0 ? rt : total + rt;
+        }
+    }
+
+    // 固定缓冲区拷贝：chunked 解码、需要观察数据或 splice 不可用时
+    std::unique_ptr<char[]> buf(new char[kBodyBufferSize]);
+    while (true) {
+        int rt = readBody(buf.get(), kBodyBufferSize);
+        if (rt < 0) {
+            return -1;
+        }
+        if (rt == 0) {
+            break;
+        }
+        if ((uint64_t)(total + rt) > max_size) {
+            return -2;
+        }
+        if (observer) {
+            observer(buf.get(), rt);
+        }
+        if (!WriteAll(fd, buf.get(), rt)) {
+            return -1;
+        }
+        total += rt;
+    }
+    return total;
+}
+
+bool HttpSession::discardBody(uint64_t max_size) {
+    uint64_t total = 0;
+    char buf[kMaxChunkLine];
+    while (m_bodyMode != BODY_NONE) {
+        if (m_bodyMode == BODY_LENGTH && total + m_bodyLeft > max_size) {
+            return false;
+        }
+        int rt = readBody(buf, sizeof(buf));
+        if (rt < 0) {
+            return false;
+        }
+        total += rt;
+        if (total > max_size) {
+            return false;
+        }
+    }
+    return true;
 }
 
 int HttpSession::sendResponse(HttpResponse::ptr rsp) {
     std::stringstream ss;
     ss << *rsp;
     std::string data = ss.str();
-    return writeFixSize(data.c_str(), data.size());
+    int rt = writeFixSize(data.c_str(), data.size());
+    if (rt <= 0 || !rsp->getFile() || rsp->getFileLength() == 0) {
+        return rt;
+    }
+    if (!sendFile(rsp->getFile()->getFd(), rsp->getFileOffset(), rsp->getFileLength())) {
+        return -1;
+    }
+    return data.size() + rsp->getFileLength();
+}
+
+bool HttpSession::sendFile(int fd, uint64_t offset, uint64_t length) {
+    if (isSecure()) {
+        // TLS 需在用户态加密：pread 到固定缓冲区后写出。不用 mmap：
+        // 发送期间文件被截断时访问映射区会触发 SIGBUS，pread 只会返回 0
+        std::string buf(std::min<uint64_t>(length, kTlsFileBufferSize), '\0');
+        while (length > 0) {
+            ssize_t n = ::pread(fd, &buf[0], std::min<uint64_t>(length, buf.size()), offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (n == 0) {
+                // 文件被截断
+                return false;
+            }
+            if (writeFixSize(buf.data(), n) <= 0) {
+                return false;
+            }
+            offset += n;
+            length -= n;
+        }
+        return true;
+    }
+
+    const int sock = getSocket()->getSocket();
+    off_t off = offset;
+    while (length > 0) {
+        ssize_t n = ::sendfile(sock, fd, &off, std::min<uint64_t>(length, kSendFileChunk));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN && WaitEvent(sock, IM::IOManager::WRITE)) {
+                continue;
+            }
+            return false;
+        }
+        if (n == 0) {
+            // 文件被截断
+            return false;
+        }
+        length -= n;
+    }
+    return true;
 }
 
 int HttpSession::read(void* buffer, size_t length) {
-    if (!m_leftoverBuf.empty()) {
-        size_t copy_len = std::min(length, m_leftoverBuf.size());
-        memcpy(buffer, m_leftoverBuf.data(), copy_len);
-        m_leftoverBuf = m_leftoverBuf.substr(copy_len);
+    if (m_leftoverPos < m_leftoverBuf.size()) {
+        size_t copy_len = std::min(length, m_leftoverBuf.size() - m_leftoverPos);
+        memcpy(buffer, m_leftoverBuf.data() + m_leftoverPos, copy_len);
+        m_leftoverPos += copy_len;
+        if (m_leftoverPos == m_leftoverBuf.size()) {
+            m_leftoverBuf.clear();
+            m_leftoverPos = 0;
+        }
         return copy_len;
     }
     return SocketStream::read(buffer, length);
 }
 
 int HttpSession::read(ByteArray::ptr ba, size_t length) {
-    if (!m_leftoverBuf.empty()) {
-        size_t copy_len = std::min(length, m_leftoverBuf.size());
-        ba->write(m_leftoverBuf.data(), copy_len);
-        m_leftoverBuf = m_leftoverBuf.substr(copy_len);
+    if (m_leftoverPos < m_leftoverBuf.size()) {
+        size_t copy_len = std::min(length, m_leftoverBuf.size() - m_leftoverPos);
+        ba->write(m_leftoverBuf.data() + m_leftoverPos, copy_len);
+        m_leftoverPos += copy_len;
+        if (m_leftoverPos == m_leftoverBuf.size()) {
+            m_leftoverBuf.clear();
+            m_leftoverPos = 0;
+        }
         return copy_len;
     }
     return SocketStream::read(ba, length);
 }
 
-}  // namespace IM::http
\ No newline at end of file
+}  // namespace IM::http
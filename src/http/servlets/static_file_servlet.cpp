@@ -0,0 +1,288 @@
+#include "http/servlets/static_file_servlet.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <unordered_map>
+
+#include "util/string_util.hpp"
+#include "util/time_util.hpp"
+#include "util/util.hpp"
+
+namespace IM::http {
+
+namespace {
+// HTTP 日期（RFC 7231 IMF-fixdate）
+std::string HttpDate(time_t t) {
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char buf[64];
+    strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    return buf;
+}
+
+bool ParseHttpDate(const std::string& v, time_t& t) {
+    struct tm tm = {};
+    const char* end = strptime(v.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    if (!end || *end != '\0') {
+        return false;
+    }
+    t = timegm(&tm);
+    return true;
+}
+
+const std::string& ContentType(const std::string& path) {
+    static const std::unordered_map<std::string, std::string> s_types = {
+        {"html", "text/html; charset=utf-8"},
+        {"htm", "text/html; charset=utf-8"},
+        {"css", "text/css; charset=utf-8"},
+        {"js", "application/javascript; charset=utf-8"},
+        {"json", "application/json; charset=utf-8"},
+        {"txt", "text/plain; charset=utf-8"},
+        {"xml", "application/xml"},
+        {"svg", "image/svg+xml"},
+        {"png", "image/png"},
+        {"jpg", "image/jpeg"},
+        {"jpeg", "image/jpeg"},
+        {"gif", "image/gif"},
+        {"webp", "image/webp"},
+        {"ico", "image/x-icon"},
+        {"mp3", "audio/mpeg"},
+        {"wav", "audio/wav"},
+        {"mp4", "video/mp4"},
+        {"webm", "video/webm"},
+        {"pdf", "application/pdf"},
+        {"zip", "application/zip"},
+        {"woff", "font/woff"},
+        {"woff2", "font/woff2"},
+        {"wasm", "application/wasm"},
+    };
+    static const std::string s_default = "application/octet-stream";
+    size_t dot = path.rfind('.');
+    size_t slash = path.rfind('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return s_default;
+    }
+    auto it = s_types.find(IM::ToLower(path.substr(dot + 1)));
+    return it == s_types.end() ? s_default : it->second;
+}
+
+// If-None-Match 是否命中（弱比较，支持列表与 *）
+bool EtagMatch(const std::string& header, const std::string& etag) {
+    if (header == "*") {
+        return true;
+    }
+    auto strip = [](std::string v) {
+        v = IM::StringUtil::Trim(v);
+        if (v.compare(0, 2, "W/") == 0) {
+            v = v.substr(2);
+        }
+        return v;
+    };
+    const std::string target = strip(etag);
+    for (auto& i : IM::split(header, ',')) {
+        if (strip(i) == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 解析单区间 Range；返回 0 无效（忽略 Range），1 有效，-1 无法满足（416）
+int ParseRange(const std::string& header, uint64_t size, uint64_t& start, uint64_t& end) {
+    if (header.compare(0, 6, "bytes=") != 0 || header.find(',') != std::string::npos) {
+        return 0;  // 多区间按整文件返回
+    }
+    std::string spec = IM::StringUtil::Trim(header.substr(6));
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return 0;
+    }
+    std::string first = spec.substr(0, dash);
+    std::string last = spec.substr(dash + 1);
+    auto is_num = [](const std::string& v) {
+        return !v.empty() && v.size() <= 19 &&
+               v.find_first_not_of("0123456789") == std::string::npos;
+    };
+    if (first.empty()) {
+        // bytes=-N：最后 N 字节
+        if (!is_num(last)) {
+            return 0;
+        }
+        uint64_t n = std::stoull(last);
+        if (n == 0 || size == 0) {
+            return -1;
+        }
+        start = size > n ? size - n : 0;
+        end = size - 1;
+        return 1;
+    }
+    if (!is_num(first) || (!last.empty() && !is_num(last))) {
+        return 0;
+    }
+    start = std::stoull(first);
+    end = last.empty() ? UINT64_MAX : std::stoull(last);
+    if (end < start) {
+        return 0;
+    }
+    if (start >= size) {
+        return -1;
+    }
+    end = std::min(end, size - 1);
+    return 1;
+}
+}  // namespace
+
+StaticFileServlet::StaticFileServlet(const Options& opts)
+    : Servlet("StaticFileServlet"),
+      m_opts(opts),
+      m_cache(16, opts.cache_size, opts.cache_size / 8) {
+    while (m_opts.root.size() > 1 && m_opts.root.back() == '/') {
+        m_opts.root.pop_back();
+    }
+}
+
+StaticFileServlet::Entry::ptr StaticFileServlet::lookup(const std::string& path) {
+    const uint64_t now = IM::TimeUtil::NowToMS();
+    Entry::ptr old;
+    if (m_cache.get(path, old) && now - old->checked_ms < m_opts.stat_ttl) {
+        return old;
+    }
+
+    auto e = std::make_shared<Entry>();
+    e->checked_ms = now;
+    struct stat st;
+    if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+        if (old && old->file && old->ino == st.st_ino && old->size == (uint64_t)st.st_size &&
+            old->mtime == st.st_mtime) {
+            // 文件未变化，沿用已打开的 fd
+            *e = *old;
+            e->checked_ms = now;
+        } else {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            // 以 fd 的 fstat 为准，避免 stat 与 open 之间文件被替换
+            if (fd >= 0 && ::fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                e->file = std::make_shared<HttpFile>(fd, st.st_size);
+                e->size = st.st_size;
+                e->mtime = st.st_mtime;
+                e->ino = st.st_ino;
+                std::stringstream ss;
+                ss << "\"" << std::hex << st.st_size << "-" << st.st_mtime << "\"";
+                e->etag = ss.str();
+                e->last_modified = HttpDate(st.st_mtime);
+            } else if (fd >= 0) {
+                ::close(fd);
+            }
+        }
+    }
+    // 不存在的文件同样缓存，stat_ttl 内不再重复 stat
+    m_cache.set(path, e, m_opts.stat_ttl);
+    return e;
+}
+
+int32_t StaticFileServlet::handle(HttpRequest::ptr request, HttpResponse::ptr response,
+                                  HttpSession::ptr session) {
+    const HttpMethod method = request->getMethod();
+    if (method != HttpMethod::GET && method != HttpMethod::HEAD) {
+        response->setStatus(HttpStatus::METHOD_NOT_ALLOWED);
+        response->setHeader("Allow", "GET, HEAD");
+        return 0;
+    }
+
+    // 去掉前缀并解码，拒绝 .. 与 NUL，防止越出根目录
+    std::string rel = request->getPath();
+    if (rel.compare(0, m_opts.prefix.size(), m_opts.prefix) == 0) {
+        rel = rel.substr(m_opts.prefix.size());
+    }
+    rel = IM::StringUtil::UrlDecode(rel, false);
+    if (rel.find('\0') != std::string::npos) {
+        response->setStatus(HttpStatus::BAD_REQUEST);
+        return 0;
+    }
+    for (auto& seg : IM::split(rel, '/')) {
+        if (seg == "..") {
+            response->setStatus(HttpStatus::FORBIDDEN);
+            return 0;
+        }
+    }
+    if (rel.empty() || rel.back() == '/') {
+        rel += m_opts.index;
+    }
+    const std::string path = m_opts.root + (rel[0] == '/' ? "" : "/") + rel;
+
+    auto entry = lookup(path);
+    if (!entry->file) {
+        response->setStatus(HttpStatus::NOT_FOUND);
+        return 0;
+    }
+
+    // 预压缩文件：客户端接受 gzip、非区间请求、且 .gz 不比原文件旧
+    Entry::ptr body = entry;
+    bool gzip = false;
+    const std::string range = request->getHeader("Range");
+    if (m_opts.gzip) {
+        response->setHeader("Vary", "Accept-Encoding");
+        if (range.empty() &&
+            request->getHeader("Accept-Encoding").find("gzip") != std::string::npos) {
+            auto gz = lookup(path + ".gz");
+            if (gz->file && gz->mtime >= entry->mtime) {
+                body = gz;
+                gzip = true;
+            }
+        }
+    }
+    const std::string etag =
+        gzip ? body->etag.substr(0, body->etag.size() - 1) + "-gz\"" : body->etag;
+
+    response->setHeader("ETag", etag);
+    response->setHeader("Last-Modified", entry->last_modified);
+    response->setHeader("Cache-Control", "public, max-age=" + std::to_string(m_opts.max_age));
+    response->setHeader("Accept-Ranges", "bytes");
+
+    // 条件请求：If-None-Match 优先于 If-Modified-Since
+    const std::string inm = request->getHeader("If-None-Match");
+    time_t since = 0;
+    if (!inm.empty() ? EtagMatch(inm, etag)
+                     : ParseHttpDate(request->getHeader("If-Modified-Since"), since) &&
+                           entry->mtime <= since) {
+        response->setStatus(HttpStatus::NOT_MODIFIED);
+        return 0;
+    }
+
+    response->setHeader("Content-Type", ContentType(path));
+    if (gzip) {
+        response->setHeader("Content-Encoding", "gzip");
+    }
+
+    uint64_t start = 0;
+    uint64_t length = body->size;
+    const std::string if_range = request->getHeader("If-Range");
+    if (!range.empty() &&
+        (if_range.empty() || if_range == etag || if_range == entry->last_modified)) {
+        uint64_t end = 0;
+        int rt = ParseRange(range, body->size, start, end);
+        if (rt < 0) {
+            response->setStatus(HttpStatus::RANGE_NOT_SATISFIABLE);
+            response->setHeader("Content-Range", "bytes */" + std::to_string(body->size));
+            return 0;
+        }
+        if (rt > 0) {
+            length = end - start + 1;
+            response->setStatus(HttpStatus::PARTIAL_CONTENT);
+            response->setHeader("Content-Range", "bytes " + std::to_string(start) + "-" +
+                                                     std::to_string(end) + "/" +
+                                                     std::to_string(body->size));
+        }
+    }
+
+    if (method == HttpMethod::HEAD) {
+        response->setHeader("Content-Length", std::to_string(length));
+        return 0;
+    }
+    response->setFileBody(body->file, start, length);
+    return 0;
+}
+
+}  // namespace IM::http
@@ -128,16 +128,26 @@ void Coroutine::reset(std::function<void()> cb) {
     m_state = State::INIT;
 }
 
-void Coroutine::swapIn() {
+Coroutine::State Coroutine::swapIn() {
     // 把当前运行协程设置为该子协程
     SetThis(this);
     IM_ASSERT(m_state != State::EXEC && m_state != State::TERM && m_state != State::EXCEPT);
     m_state = State::EXEC;
+    m_running.store(true, std::memory_order_relaxed);
 
     // 从主协程切换到当前线程（子协程）
     if (swapcontext(&Scheduler::GetMainCoroutine()->m_ctx, &m_ctx)) {
         IM_ASSERT2(false, "swapcontext");
     }
+    // 未经 YieldToHold/YieldToReady 直接切出的协程视为 HOLD
+    if (m_state == State::EXEC) {
+        m_state = State::HOLD;
+    }
+    // 状态须在清除运行标志前取出：此后其他线程可以恢复它并改写状态
+    const State state = m_state;
+    // 子协程已切出且上下文保存完毕，此后才允许其他线程恢复它
+    m_running.store(false, std::memory_order_release);
+    return state;
 }
 
 void Coroutine::swapOut() {
@@ -0,0 +1,164 @@
+#include "io/cpu_pool.hpp"
+
+#include <algorithm>
+#include <thread>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+#include "io/coroutine.hpp"
+#include "io/scheduler.hpp"
+
+namespace IM {
+
+static auto g_logger = IM_LOG_NAME("system");
+
+static auto g_cpu_pool_threads = Config::Lookup<uint32_t>(
+    "cpu_pool.threads", 0, "cpu offload pool thread count (0 = hardware concurrency)");
+static auto g_cpu_pool_max_queue = Config::Lookup<uint32_t>(
+    "cpu_pool.max_queue", 1024, "max queued cpu tasks before rejecting (0 = unlimited)");
+
+// 当前线程是否为 CpuPool 工作线程（池内再次 await 时直接执行，避免自己等自己）
+static thread_local bool t_in_cpu_pool = false;
+
+namespace {
+
+enum AwaitState { RUNNING = 0, PARKED = 1, DONE = 2 };
+
+struct AwaitCtx {
+    typedef std::shared_ptr<AwaitCtx> ptr;
+    Scheduler* scheduler = nullptr;
+    Coroutine::ptr fiber;
+    std::atomic<int> state{RUNNING};
+};
+
+void RunTask(const std::function<void()>& cb) {
+    try {
+        cb();
+    } catch (std::exception& ex) {
+        IM_LOG_ERROR(g_logger) << "CpuPool task exception: " << ex.what();
+    } catch (...) {
+        IM_LOG_ERROR(g_logger) << "CpuPool task unknown exception";
+    }
+}
+
+}  // namespace
+
+CpuPool::CpuPool()
+    : m_sem(0),
+      m_threadCount(g_cpu_pool_threads->getValue()),
+      m_maxQueue(g_cpu_pool_max_queue->getValue()),
+      m_started(false),
+      m_stopping(false) {
+    if (m_threadCount == 0) {
+        m_threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+CpuPool::~CpuPool() {
+    stop();
+}
+
+bool CpuPool::await(std::function<void()> cb) {
+    Scheduler* scheduler = Scheduler::GetThis();
+    if (!scheduler || t_in_cpu_pool) {
+        RunTask(cb);
+        return true;
+    }
+
+    auto ctx = std::make_shared<AwaitCtx>();
+    ctx->scheduler = scheduler;
+    ctx->fiber = Coroutine::GetThis();
+    bool ok = push([ctx, cb]() {
+        RunTask(cb);
+        int s = ctx->state.exchange(DONE);
+        if (s == PARKED) {
+            ctx->scheduler->schedule(ctx->fiber);
+        }
+    });
+    if (!ok) {
+        return false;
+    }
+
+    // 任务可能在让出之前就已完成，此时不再挂起
+    int s = RUNNING;
+    if (ctx->state.compare_exchange_strong(s, PARKED)) {
+        Coroutine::YieldToHold();
+    }
+    return true;
+}
+
+bool CpuPool::submit(std::function<void()> cb) {
+    return push([cb]() { RunTask(cb); });
+}
+
+bool CpuPool::push(std::function<void()>&& cb) {
+    {
+        MutexType::Lock lock(m_mutex);
+        if (m_stopping) {
+            return false;
+        }
+        if (m_maxQueue && m_tasks.size() >= m_maxQueue) {
+            ++m_rejected;
+            return false;
+        }
+        if (!m_started) {
+            start();
+        }
+        m_tasks.push_back(std::move(cb));
+        ++m_pending;
+    }
+    m_sem.notify();
+    return true;
+}
+
+void CpuPool::start() {
+    m_started = true;
+    m_threads.reserve(m_threadCount);
+    for (size_t i = 0; i < m_threadCount; ++i) {
+        m_threads.push_back(std::make_shared<Thread>(std::bind(&CpuPool::run, this),
+                                                     "cpu_pool_" + std::to_string(i)));
+    }
+    IM_LOG_INFO(g_logger) << "CpuPool started, threads=" << m_threadCount
+                          << " max_queue=" << m_maxQueue;
+}
+
+void CpuPool::stop() {
+    std::vector<Thread::ptr> threads;
+    {
+        MutexType::Lock lock(m_mutex);
+        if (m_stopping) {
+            return;
+        }
+        m_stopping = true;
+        threads.swap(m_threads);
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        m_sem.notify();
+    }
+    for (auto& t : threads) {
+        t->join();
+    }
+}
+
+void CpuPool::run() {
+    t_in_cpu_pool = true;
+    while (true) {
+        m_sem.wait();
+        std::function<void()> cb;
+        {
+            MutexType::Lock lock(m_mutex);
+            if (m_tasks.empty()) {
+                if (m_stopping) {
+                    return;
+                }
+                continue;
+            }
+            cb.swap(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        --m_pending;
+        cb();
+    }
+}
+
+}  // namespace IM
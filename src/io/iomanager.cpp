@@ -2,18 +2,54 @@
 
 #include <fcntl.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include <cerrno>
 
+#include "config/config.hpp"
 #include "net/fd_manager.hpp"
 #include "base/macro.hpp"
 
 namespace IM {
 static auto g_logger = IM_LOG_NAME("system");
 
-IOManager::IOManager(size_t threads, bool use_caller, const std::string& name)
-    : Scheduler(threads, use_caller, name) {
+static auto g_iomanager_backend = Config::Lookup<std::string>(
+    "iomanager.backend", "epoll", "iomanager io backend: epoll or io_uring");
+static auto g_uring_entries =
+    Config::Lookup<uint32_t>("iomanager.uring.entries", 256, "io_uring sq entries per thread");
+static auto g_uring_buffers = Config::Lookup<uint32_t>(
+    "iomanager.uring.buffers", 64, "io_uring registered recv buffers per thread, 0 to disable");
+static auto g_uring_buffer_size = Config::Lookup<uint32_t>(
+    "iomanager.uring.buffer_size", 16 * 1024, "io_uring registered recv buffer size");
+
+// 有待提交请求时，经过这么多个调度节拍仍未进入 idle 则强制提交
+static const uint32_t kUringFlushTicks = 8;
+// 待提交请求达到这个数量时立即提交
+static const uint32_t kUringFlushBatch = 32;
+
+// 当前线程占用的唤醒器（属于哪个 IOManager 由 currentWaker 判断）
+static thread_local void* t_waker = nullptr;
+
+struct IOManager::UringRequest {
+    Coroutine::ptr coroutine;     // 等待的协程
+    Scheduler* scheduler;         // 完成后调度协程的调度器
+    pid_t threadId;               // 协程绑定的线程，-1表示任意线程
+    FdContext* fdCtx;             // 所属 fd 上下文
+    Event event;                  // 请求方向
+    Uring* ring;                  // 提交到的 ring
+    uint64_t id = 0;              // ring 内的请求 id，user_data 为 id << 1（低位标记超时完成项）
+    int res = 0;                  // 请求的完成结果
+    int remaining = 1;            // 尚未收割的完成项数（带超时时为2）
+    bool timedOut = false;        // 链接的超时是否触发
+    uint32_t flags = 0;           // 请求完成项的 flags（含内核挑选的缓冲区）
+    bool selectBuffer = false;    // 是否由内核从注册的缓冲区中挑选接收缓冲区
+    void* dest = nullptr;         // 接收完成后拷贝的目标
+    __kernel_timespec ts = {};    // LINK_TIMEOUT 的超时时间，提交前须保持有效
+};
+
+IOManager::IOManager(size_t threads, bool use_caller, const std::string& name, bool sharded)
+    : Scheduler(threads, use_caller, name), m_sharded(sharded) {
     int saved_errno;
     // 创建 epoll 实例，用于监听文件描述符事件
     FileDescriptor epfd(epoll_create1(EPOLL_CLOEXEC));  // 避免在子进程中继承文件描述符
@@ -60,8 +96,77 @@ IOManager::IOManager(size_t threads, bool use_caller, const std::string& name)
     m_tickleFds[0] = pipe_read_fd.release();
     m_tickleFds[1] = pipe_write_fd.release();
 
-    // 初始化上下文存储容量，确保可以容纳足够的上下文对象
-    contextResize(64);
+    // 常驻可读的 eventfd，启用唤醒器时用于把直接等待 m_epfd 的线程全部唤醒
+    m_switchFd = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_switchFd < 0) {
+        saved_errno = errno;
+        IM_LOG_ERROR(g_logger) << "eventfd failed: " << strerror(saved_errno);
+        throw std::runtime_error("IOManager initialization failed");
+    }
+
+    // 为每个调度线程创建唤醒器：线程自己的 epoll 中注册 eventfd，
+    // 共享的 m_epfd 在首次需要定向唤醒时才嵌套进来（见 nestSharedEpoll）
+    m_wakerCount = threads;
+    m_wakers.reset(new ThreadWaker[threads]);
+    for (size_t i = 0; i < threads; ++i) {
+        FileDescriptor waker_epfd(epoll_create1(EPOLL_CLOEXEC));
+        FileDescriptor event_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        if (!waker_epfd.isValid() || !event_fd.isValid()) {
+            saved_errno = errno;
+            IM_LOG_ERROR(g_logger) << "create thread waker failed: " << strerror(saved_errno);
+            throw std::runtime_error("IOManager initialization failed");
+        }
+
+        // 线程 epoll 中还会注册绑定到该线程的 fd（data.ptr 为 FdContext），
+        // 因此 eventfd 与 m_epfd 用唤醒器自身和 this 作为标记加以区分
+        epoll_event wev = {};
+        wev.events = EPOLLIN;
+        wev.data.ptr = &m_wakers[i];
+        rt = epoll_ctl(waker_epfd.get(), EPOLL_CTL_ADD, event_fd.get(), &wev);
+        if (-1 == rt) {
+            saved_errno = errno;
+            IM_LOG_ERROR(g_logger) << "epoll_ctl failed: " << strerror(saved_errno);
+            throw std::runtime_error("IOManager initialization failed");
+        }
+        m_wakers[i].epfd = waker_epfd.release();
+        m_wakers[i].eventFd = event_fd.release();
+    }
+
+    // io_uring 后端：每个线程一个 ring，其 fd 注册到线程 epoll 中（data.ptr 为 ring 自身）
+    if (g_iomanager_backend->getValue() == "io_uring") {
+        if (!Uring::IsSupported()) {
+            IM_LOG_WARN(g_logger) << "name=" << getName()
+                                  << " io_uring not supported by kernel, fallback to epoll";
+        } else {
+            try {
+                for (size_t i = 0; i < threads; ++i) {
+                    std::unique_ptr<Uring> ring(new Uring(g_uring_entries->getValue()));
+                    ring->registerBuffers(g_uring_buffers->getValue(),
+                                          g_uring_buffer_size->getValue());
+                    epoll_event rev = {};
+                    rev.events = EPOLLIN;
+                    rev.data.ptr = ring.get();
+                    if (epoll_ctl(m_wakers[i].epfd, EPOLL_CTL_ADD, ring->getFd(), &rev)) {
+                        IM_LOG_ERROR(g_logger) << "epoll_ctl ring failed: " << strerror(errno);
+                        throw std::runtime_error("io_uring registration failed");
+                    }
+                    m_wakers[i].ring.swap(ring);
+                }
+                m_uring = true;
+            } catch (std::exception& e) {
+                IM_LOG_WARN(g_logger) << "name=" << getName() << " " << e.what()
+                                      << ", fallback to epoll";
+                for (size_t i = 0; i < threads; ++i) {
+                    m_wakers[i].ring.reset();
+                }
+            }
+        }
+    }
+
+    // 分片模式与 io_uring 后端下线程必须在自己的 epoll 上等待
+    if (m_sharded || m_uring) {
+        nestSharedEpoll();
+    }
 
     // 启动调度器，开始任务调度
     start();
@@ -74,12 +179,10 @@ IOManager::~IOManager() {
     close(m_epfd);
     close(m_tickleFds[0]);
     close(m_tickleFds[1]);
-
-    // 遍历并释放所有的 FdContext 对象
-    for (size_t i = 0; i < m_fdContexts.size(); ++i) {
-        if (m_fdContexts[i]) {
-            delete m_fdContexts[i];
-        }
+    close(m_switchFd);
+    for (size_t i = 0; i < m_wakerCount; ++i) {
+        close(m_wakers[i].epfd);
+        close(m_wakers[i].eventFd);
     }
 }
 
@@ -88,25 +191,17 @@ bool IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
     IM_ASSERT(event == READ || event == WRITE);
     IM_ASSERT(cb || Coroutine::GetThis());
 
-    FdContext* fd_ctx = nullptr;
-
     // ====================取出对应 fd 的上下文====================
-    RWMutexType::ReadLock lock(m_mutex);
-    if ((int)m_fdContexts.size() > fd)  // 空间够
-    {
-        fd_ctx = m_fdContexts[fd];
-        lock.unlock();
-    } else  // 空间不足，进行扩容，再取出对应fd上下文
-    {
-        lock.unlock();
-
-        RWMutexType::WriteLock lock2(m_mutex);
-        contextResize(fd * 1.5);
-        fd_ctx = m_fdContexts[fd];
+    // 所在块未分配时才会加锁分配整块，其余情况无锁
+    FdContext* fd_ctx = m_fdContexts.at(fd);
+    if (!fd_ctx) {
+        IM_LOG_ERROR(g_logger) << "addEvent: fd=" << fd << " out of range";
+        return false;
     }
 
     // ====================将事件注册到epoll实例中====================
     FdContext::MutexType::Lock lock2(fd_ctx->mutex);
+    fd_ctx->fd = fd;
     if (fd_ctx->events & event) {
         // 如果事件已经存在，则直接返回true，避免重复添加相同的事件类型
         IM_LOG_DEBUG(g_logger) << "addEvent assert fd=" << fd << " event=" << event
@@ -116,19 +211,26 @@ bool IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
 
     // 根据已有事件决定是新增还是修改 epoll 监控
     int op = fd_ctx->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (op == EPOLL_CTL_ADD) {
+        // 首次注册时选定 epoll 实例：绑定了线程的任务注册到该线程自己的 epoll 上
+        fd_ctx->epfd = selectEpoll(Scheduler::GetTaskThreadId());
+    }
     epoll_event ev = {};
     ev.events = fd_ctx->events | event | EPOLLET;  // 设置边缘触发模式
     ev.data.ptr = fd_ctx;
 
     int saved_errno;
     // 调用 epoll_ctl 更新事件监听
-    int rt = epoll_ctl(m_epfd, op, fd, &ev);
+    int rt = epoll_ctl(fd_ctx->epfd, op, fd, &ev);
     if (rt) {
         saved_errno = errno;
         // 如果 epoll_ctl 失败，记录错误日志并返回失败
-        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << m_epfd << ", " << op << ", " << fd << ", "
-                                << ev.events << "): " << rt << " (" << saved_errno << ") ("
-                                << strerror(saved_errno) << ")";
+        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << fd_ctx->epfd << ", " << op << ", " << fd
+                                << ", " << ev.events << "): " << rt << " (" << saved_errno
+                                << ") (" << strerror(saved_errno) << ")";
+        if (op == EPOLL_CTL_ADD) {
+            fd_ctx->epfd = -1;
+        }
         return false;
     }
 
@@ -149,6 +251,8 @@ bool IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
     }
 
     event_ctx.scheduler = Scheduler::GetThis();
+    // 绑定了线程的任务在事件就绪后回到原线程执行
+    event_ctx.threadId = Scheduler::GetTaskThreadId();
     if (cb) {
         // 如果提供了回调函数，则绑定到事件上下文中
         event_ctx.cb.swap(cb);
@@ -161,23 +265,259 @@ bool IOManager::addEvent(int fd, Event event, std::function<void()> cb) {
     return true;
 }
 
-bool IOManager::delEvent(int fd, Event event) {
-    IM_ASSERT(fd >= 0)
-    IM_ASSERT(event == READ || event == WRITE);
+int IOManager::waitEvent(int fd, Event event, uint64_t timeout) {
+    if (timeout == ~0ull) {
+        if (!addEvent(fd, event)) {
+            return -1;
+        }
+        Coroutine::YieldToHold();
+        return 0;
+    }
+
+    FdContext* fd_ctx = m_fdContexts.at(fd);
+    if (!fd_ctx) {
+        return -1;
+    }
+    FdContext::Deadline& dl = fd_ctx->getDeadline(event);
+    if (!dl.timer) {
+        dl.timer = createTimer([this, fd_ctx, fd, event](uint64_t token) {
+            // 序号不符说明该次等待已结束，属于过期回调
+            if (fd_ctx->getDeadline(event).armed.compare_exchange_strong(token, 0)) {
+                cancelEvent(fd, event);
+            }
+        });
+    }
+
+    uint64_t token = ++dl.seq;
+    dl.armed.store(token);
+    dl.timer->arm(timeout, token);
+    if (!addEvent(fd, event)) {
+        dl.timer->disarm();
+        dl.armed.store(0);
+        return -1;
+    }
+    // 定时器可能在 addEvent 之前就已到期，此时回调中的 cancelEvent 落空，需自行取消
+    if (dl.armed.load() != token) {
+        cancelEvent(fd, event);
+    }
+    Coroutine::YieldToHold();
+
+    dl.timer->disarm();
+    if (dl.armed.exchange(0) != token) {
+        // 协程可能已换到其他线程上恢复，errno 须在恢复后的线程上设置
+        errno = ETIMEDOUT;
+        return ETIMEDOUT;
+    }
+    return 0;
+}
+
+bool IOManager::isUring() const {
+    return m_uring && currentWaker();
+}
+
+bool IOManager::uringWait(int fd, Event event, const io_uring_sqe& sqe, uint64_t timeout,
+                          int& res) {
+    ThreadWaker* waker = currentWaker();
+    if (!waker || !waker->ring) {
+        return false;
+    }
+    FdContext* fd_ctx = m_fdContexts.at(fd);
+    if (!fd_ctx) {
+        return false;
+    }
+    Uring* ring = waker->ring.get();
+
+    UringRequest req;
+    req.coroutine = Coroutine::GetThis();
+    req.scheduler = Scheduler::GetThis();
+    req.threadId = Scheduler::GetTaskThreadId();
+    req.fdCtx = fd_ctx;
+    req.event = event;
+    req.ring = ring;
+    {
+        FdContext::MutexType::Lock lock(fd_ctx->mutex);
+        fd_ctx->fd = fd;
+        UringRequest*& slot = fd_ctx->getUring(event);
+        if (slot) {
+            IM_LOG_WARN(g_logger) << "uringWait fd=" << fd << " event=" << event
+                                  << " already has a request in flight";
+            return false;
+        }
+
+        Uring::MutexType::Lock lock2(ring->getMutex());
+        uint32_t count = timeout == ~0ull ? 1 : 2;
+        io_uring_sqe* s = ring->getSqe(count);
+        if (!s) {
+            // SQ 已满，先把已有请求提交给内核再取
+            ring->submit();
+            s = ring->getSqe(count);
+            if (!s) {
+                return false;
+            }
+        }
+        *s = sqe;
+        req.id = ++waker->uringSeq;
+        s->user_data = req.id << 1;
+        // 接收请求优先使用注册的缓冲区：数据到达时才占用，WebSocket 等长连接的挂起读不再各占一块内存
+        if (s->opcode == IORING_OP_RECV && s->len <= ring->getBufferSize() &&
+            ring->acquireBuffer()) {
+            req.selectBuffer = true;
+            req.dest = (void*)s->addr;
+            s->addr = 0;
+            s->flags |= IOSQE_BUFFER_SELECT;
+            s->buf_group = Uring::kBufferGroup;
+        }
+        if (timeout != ~0ull) {
+            s->flags |= IOSQE_IO_LINK;
+            req.ts.tv_sec = timeout / 1000;
+            req.ts.tv_nsec = (timeout % 1000) * 1000 * 1000;
+            io_uring_sqe* t = ring->nextSqe();
+            t->opcode = IORING_OP_LINK_TIMEOUT;
+            t->fd = -1;
+            t->addr = (uint64_t)&req.ts;
+            t->len = 1;
+            t->user_data = (req.id << 1) | 1;  // 低位标记超时完成项
+            req.remaining = 2;
+        }
+        slot = &req;
+        waker->uringRequests.set(req.id, &req);
+        ++m_pendingEventCount;
+        if (ring->pending() >= kUringFlushBatch) {
+            ring->submit();
+            waker->ticks = 0;
+        }
+    }
+
+    // 完成项只由本线程收割，因此让出之前请求不会完成
+    Coroutine::YieldToHold();
 
-    FdContext* fd_ctx = nullptr;
+    if (req.selectBuffer) {
+        if (req.res > 0 && (req.flags & IORING_CQE_F_BUFFER)) {
+            memcpy(req.dest, ring->getBuffer(req.flags), req.res);
+        }
+        Uring::MutexType::Lock lock(ring->getMutex());
+        ring->releaseBuffer(req.flags);
+        if (req.res == -ENOBUFS) {
+            // 缓冲区尚未重新提供给内核，让调用方退回 epoll 等待
+            req.res = -EAGAIN;
+        }
+    }
+    res = req.timedOut && req.res == -ECANCELED ? -ETIMEDOUT : req.res;
+    // 协程可能已在其他线程恢复，errno 须在这里（让出之后）设置，调用方缓存的 errno 地址可能属于原线程
+    if (res < 0) {
+        errno = -res;
+    }
+    return true;
+}
 
-    // ====================获取文件描述符对应的 FdContext====================
+IOManager::ThreadWaker* IOManager::currentWaker() const {
+    ThreadWaker* waker = (ThreadWaker*)t_waker;
+    if (waker >= m_wakers.get() && waker < m_wakers.get() + m_wakerCount) {
+        return waker;
+    }
+    return nullptr;
+}
+
+void IOManager::flushUring(ThreadWaker* waker) {
+    Uring::MutexType::Lock lock(waker->ring->getMutex());
+    if (waker->ring->pending()) {
+        waker->ring->submit();
+    }
+    waker->ticks = 0;
+}
+
+void IOManager::reapUring(ThreadWaker* waker) {
+    waker->ring->reap([this, waker](uint64_t data, int res, uint32_t flags) {
+        // user_data 为0的是取消请求自身的完成项
+        if (!data) {
+            return;
+        }
+        UringRequest** found = waker->uringRequests.find(data >> 1);
+        if (!found) {
+            IM_LOG_ERROR(g_logger) << "io_uring completion for unknown request id=" << (data >> 1);
+            return;
+        }
+        UringRequest* req = *found;
+        if (data & 1) {
+            req->timedOut = res == -ETIME;
+        } else {
+            req->res = res;
+            req->flags = flags;
+        }
+        if (--req->remaining) {
+            return;
+        }
+        waker->uringRequests.del(req->id);
+        {
+            FdContext::MutexType::Lock lock(req->fdCtx->mutex);
+            UringRequest*& slot = req->fdCtx->getUring(req->event);
+            if (slot == req) {
+                slot = nullptr;
+            }
+        }
+        --m_pendingEventCount;
+        // 调度之后协程可能立即在其他线程恢复并销毁 req，不能再访问它
+        Coroutine::ptr co;
+        co.swap(req->coroutine);
+        Scheduler* scheduler = req->scheduler;
+        pid_t thread = req->threadId;
+        scheduler->schedule(co, thread);
+    });
+}
+
+bool IOManager::cancelUring(FdContext* fd_ctx, Event event) {
+    UringRequest* req = fd_ctx->getUring(event);
+    if (!req) {
+        return false;
+    }
+    Uring* ring = req->ring;
     {
-        // 加读锁以保护 m_fdContexts 的并发访问
-        RWMutexType::ReadLock lock(m_mutex);
-        if ((int)m_fdContexts.size() <= fd) {
-            IM_LOG_ERROR(g_logger) << "delEvent: fd=" << fd
-                                    << " out of range, m_fdContexts.size()=" << m_fdContexts.size();
-            return false;  // 文件描述符超出范围，直接返回失败
+        Uring::MutexType::Lock lock(ring->getMutex());
+        io_uring_sqe* s = ring->getSqe();
+        if (!s) {
+            IM_LOG_ERROR(g_logger) << "cancel io_uring request fd=" << fd_ctx->fd
+                                   << " failed: sq full";
+            return true;
         }
+        s->opcode = IORING_OP_ASYNC_CANCEL;
+        s->fd = -1;
+        // 按 id 匹配：取消提交前请求可能已完成，协程栈上同一地址可能已是新的请求
+        s->addr = req->id << 1;
+    }
+    // 取消请求同样只由 ring 所属线程提交，定向唤醒它
+    for (size_t i = 0; i < m_wakerCount; ++i) {
+        if (m_wakers[i].ring.get() == ring) {
+            if (&m_wakers[i] == currentWaker()) {
+                flushUring(&m_wakers[i]);
+            } else {
+                uint64_t one = 1;
+                int rt = write(m_wakers[i].eventFd, &one, sizeof(one));
+                IM_ASSERT(rt == sizeof(one))
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+void IOManager::afterTask() {
+    if (!m_uring) {
+        return;
+    }
+    ThreadWaker* waker = currentWaker();
+    if (waker && waker->ring && waker->ring->pending() && ++waker->ticks >= kUringFlushTicks) {
+        flushUring(waker);
+    }
+}
+
+bool IOManager::delEvent(int fd, Event event) {
+    IM_ASSERT(fd >= 0)
+    IM_ASSERT(event == READ || event == WRITE);
 
-        fd_ctx = m_fdContexts[fd];
+    // 无锁取出上下文；所在块尚未分配说明该 fd 从未注册过事件
+    FdContext* fd_ctx = m_fdContexts.get(fd);
+    if (!fd_ctx) {
+        return false;
     }
 
     // ====================判断删除的事件是否存在====================
@@ -197,19 +537,22 @@ bool IOManager::delEvent(int fd, Event event) {
 
     int saved_errno;
     // 调用 epoll_ctl 更新事件监听
-    int rt = epoll_ctl(m_epfd, op, fd, &ev);
+    int rt = epoll_ctl(fd_ctx->epfd, op, fd, &ev);
     if (rt) {
         saved_errno = errno;
         // 如果 epoll_ctl 失败，记录错误日志并返回失败
-        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << m_epfd << ", " << op << ", " << fd << ", "
-                                << ev.events << "): " << rt << " (" << saved_errno << ") ("
-                                << strerror(saved_errno) << ")";
+        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << fd_ctx->epfd << ", " << op << ", " << fd
+                                << ", " << ev.events << "): " << rt << " (" << saved_errno
+                                << ") (" << strerror(saved_errno) << ")";
         return false;
     }
 
     // ====================更新上下文信息====================
     --m_pendingEventCount;        // 减少待处理事件计数
     fd_ctx->events = new_events;  // 更新文件描述符上下文中的事件集合
+    if (!new_events) {
+        fd_ctx->epfd = -1;  // 已从 epoll 中移除，下次注册时重新选择
+    }
 
     // 重置与目标事件相关的上下文
     FdContext::EventContext& event_ctx = fd_ctx->getContext(event);
@@ -221,17 +564,9 @@ bool IOManager::cancelEvent(int fd, Event event) {
     IM_ASSERT(fd >= 0)
     IM_ASSERT(event == READ || event == WRITE);
 
-    FdContext* fd_ctx = nullptr;
-    {
-        // 加读锁以保护m_fdContexts容器的并发访问
-        RWMutexType::ReadLock lock(m_mutex);
-        if ((int)m_fdContexts.size() <= fd) {
-            IM_LOG_ERROR(g_logger) << "cancelEvent: fd=" << fd
-                                    << " out of range, m_fdContexts.size()=" << m_fdContexts.size();
-            return false;  // 文件描述符超出范围，直接返回false
-        }
-
-        fd_ctx = m_fdContexts[fd];
+    FdContext* fd_ctx = m_fdContexts.get(fd);
+    if (!fd_ctx) {
+        return false;
     }
 
     // 对文件描述符上下文加锁，确保对其事件掩码的安全访问
@@ -249,14 +584,17 @@ bool IOManager::cancelEvent(int fd, Event event) {
 
     int saved_errno;
     // 使用epoll_ctl修改或删除事件监听
-    int rt = epoll_ctl(m_epfd, op, fd, &ev);
+    int rt = epoll_ctl(fd_ctx->epfd, op, fd, &ev);
     if (rt) {
         saved_errno = errno;
-        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << m_epfd << ", " << op << ", " << fd << ", "
-                                << ev.events << "): " << rt << " (" << saved_errno << ") ("
-                                << strerror(saved_errno) << ")";
+        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << fd_ctx->epfd << ", " << op << ", " << fd
+                                << ", " << ev.events << "): " << rt << " (" << saved_errno
+                                << ") (" << strerror(saved_errno) << ")";
         return false;  // epoll_ctl调用失败时记录错误日志并返回false
     }
+    if (!new_events) {
+        fd_ctx->epfd = -1;
+    }
 
     // 触发相关事件的回调函数，并减少待处理事件计数
     fd_ctx->triggerEvent(event);
@@ -268,23 +606,22 @@ bool IOManager::cancelEvent(int fd, Event event) {
 bool IOManager::cancelAll(int fd) {
     IM_ASSERT(fd >= 0)
 
-    FdContext* fd_ctx = nullptr;
-    {
-        RWMutexType::ReadLock lock(m_mutex);
-        // 检查 fd 是否在合法范围内
-        if ((int)m_fdContexts.size() <= fd) {
-            IM_LOG_ERROR(g_logger) << "cancelAll: fd=" << fd
-                                    << " out of range, m_fdContexts.size()=" << m_fdContexts.size();
-            return false;
-        }
-
-        fd_ctx = m_fdContexts[fd];
+    FdContext* fd_ctx = m_fdContexts.get(fd);
+    if (!fd_ctx) {
+        return false;
     }
 
     FdContext::MutexType::Lock lock2(fd_ctx->mutex);
-    // 如果 fd 上未注册任何事件，直接返回 false
+    // 取消在途的 io_uring 请求，等待的协程会以 -ECANCELED 恢复
+    bool cancelled = false;
+    if (m_uring) {
+        cancelled = cancelUring(fd_ctx, READ);
+        cancelled = cancelUring(fd_ctx, WRITE) || cancelled;
+    }
+
+    // 如果 fd 上未注册任何事件，直接返回
     if (!(fd_ctx->events)) {
-        return false;
+        return cancelled;
     }
 
     // 从 epoll 实例中删除该文件描述符的事件监听
@@ -294,14 +631,15 @@ bool IOManager::cancelAll(int fd) {
     ev.data.ptr = fd_ctx;
 
     int saved_errno;
-    int rt = epoll_ctl(m_epfd, op, fd, &ev);
+    int rt = epoll_ctl(fd_ctx->epfd, op, fd, &ev);
     if (rt) {
         saved_errno = errno;
-        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << m_epfd << ", " << op << ", " << fd << ", "
-                                << ev.events << "): " << rt << " (" << saved_errno << ") ("
-                                << strerror(saved_errno) << ")";
+        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << fd_ctx->epfd << ", " << op << ", " << fd
+                                << ", " << ev.events << "): " << rt << " (" << saved_errno
+                                << ") (" << strerror(saved_errno) << ")";
         return false;
     }
+    fd_ctx->epfd = -1;
 
     // 触发 READ 事件的回调函数（如果已注册）
     if (fd_ctx->events & Event::READ) {
@@ -334,6 +672,102 @@ void IOManager::tickle() {
     IM_ASSERT(rt == 1)
 }
 
+void IOManager::tickle(pid_t thread) {
+    if (thread == GetThreadId()) {
+        return;
+    }
+    // 目标线程可能正直接等待 m_epfd，eventfd 需先经嵌套才能唤醒它
+    nestSharedEpoll();
+    for (size_t i = 0; i < m_wakerCount; ++i) {
+        if (m_wakers[i].threadId.load(std::memory_order_acquire) == thread) {
+            uint64_t one = 1;
+            int rt = write(m_wakers[i].eventFd, &one, sizeof(one));
+            IM_ASSERT(rt == sizeof(one))
+            return;
+        }
+    }
+    // 目标线程尚未进入过 idle，它在首次等待前会重新扫描任务队列
+    tickle();
+}
+
+void IOManager::nestSharedEpoll() {
+    if (m_nested.load(std::memory_order_acquire)) {
+        return;
+    }
+    Mutex::Lock lock(m_nestMutex);
+    if (m_nested.load(std::memory_order_relaxed)) {
+        return;
+    }
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.ptr = this;
+    for (size_t i = 0; i < m_wakerCount; ++i) {
+        if (epoll_ctl(m_wakers[i].epfd, EPOLL_CTL_ADD, m_epfd, &ev)) {
+            IM_LOG_ERROR(g_logger) << "epoll_ctl nest m_epfd failed: " << strerror(errno);
+        }
+    }
+    // 与 idle 中先登记直接等待、再检查 m_nested 的顺序配对（均为 seq_cst）：
+    // 要么线程看到已嵌套而不再直接等待，要么这里看到它在等待并挂上 m_switchFd
+    m_nested.store(true);
+    if (m_directWaiters.load() > 0) {
+        ev.data.ptr = &m_switchFd;
+        if (epoll_ctl(m_epfd, EPOLL_CTL_ADD, m_switchFd, &ev) == 0) {
+            m_switchArmed = true;
+        } else {
+            IM_LOG_ERROR(g_logger) << "epoll_ctl switch fd failed: " << strerror(errno);
+        }
+    }
+    IM_LOG_DEBUG(g_logger) << "name=" << getName() << " thread wakers enabled";
+}
+
+void IOManager::disarmSwitch() {
+    Mutex::Lock lock(m_nestMutex);
+    if (m_switchArmed && m_directWaiters.load() == 0) {
+        epoll_ctl(m_epfd, EPOLL_CTL_DEL, m_switchFd, nullptr);
+        m_switchArmed = false;
+    }
+}
+
+IOManager::ThreadWaker* IOManager::claimWaker() {
+    pid_t tid = GetThreadId();
+    for (size_t i = 0; i < m_wakerCount; ++i) {
+        pid_t expected = -1;
+        if (m_wakers[i].threadId.compare_exchange_strong(expected, tid) || expected == tid) {
+            t_waker = &m_wakers[i];
+            return &m_wakers[i];
+        }
+    }
+    return nullptr;
+}
+
+int IOManager::selectEpoll(pid_t thread) {
+    if (thread == -1 && m_sharded) {
+        // 分片模式下未绑定的任务注册到当前线程的分片，事件就近在注册它的线程上处理
+        thread = GetThreadId();
+    }
+    if (thread != -1) {
+        for (size_t i = 0; i < m_wakerCount; ++i) {
+            if (m_wakers[i].threadId.load(std::memory_order_acquire) == thread) {
+                // 注册到线程 epoll 上的 fd 需要该线程在自己的 epoll 上等待
+                nestSharedEpoll();
+                return m_wakers[i].epfd;
+            }
+        }
+    }
+    if (m_sharded) {
+        // 当前线程不属于本调度器：轮转分配到一个已有线程占用的分片，
+        // 向其他线程的 epoll 注册 fd 会直接唤醒在其上等待的线程
+        size_t start = m_nextShard.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < m_wakerCount; ++i) {
+            ThreadWaker& waker = m_wakers[(start + i) % m_wakerCount];
+            if (waker.threadId.load(std::memory_order_acquire) != -1) {
+                return waker.epfd;
+            }
+        }
+    }
+    return m_epfd;
+}
+
 bool IOManager::stopping(uint64_t& timeout) {
     timeout = getNextTimer();
     // ~0ull表示没有定时器或者无限超时
@@ -353,6 +787,12 @@ void IOManager::idle() {
     epoll_event* events = new epoll_event[64]();
     std::shared_ptr<epoll_event> shared_event(events, [](epoll_event* ptr) { delete[] ptr; });
 
+    // 占用唤醒器后先不阻塞地返回一次调度循环，避免错过占用前定向调度给本线程的任务
+    ThreadWaker* waker = claimWaker();
+    bool rescan = waker != nullptr;
+    // 线程 epoll 报告 m_epfd 可读时，从共享 epoll 中取出就绪事件所用的缓冲区
+    std::vector<epoll_event> shared_events(waker ? 64 : 0);
+
     // 主空闲循环，持续运行直到满足停止条件
     while (true) {
         // ==========停止条件检查==========
@@ -374,8 +814,32 @@ void IOManager::idle() {
             } else {
                 next_timeout = MAX_TIMEOUT;
             }
-            // 等待 epoll 事件，超时时间为 next_timeout 毫秒，确保定时任务能够及时执行
-            rt = epoll_wait(m_epfd, events, 64, (int)next_timeout);
+            if (rescan) {
+                next_timeout = 0;
+                rescan = false;
+            }
+            if (waker && waker->ring) {
+                // 一个调度节拍内积累的 io_uring 请求在此一次性提交；已有完成项时不阻塞
+                flushUring(waker);
+                if (waker->ring->hasCompletions()) {
+                    next_timeout = 0;
+                }
+            }
+            // 等待 epoll 事件，超时时间为 next_timeout 毫秒，确保定时任务能够及时执行；
+            // 唤醒器启用后在自己的 epoll 上等待，否则直接等待共享的 m_epfd（每个事件只唤醒
+            // 一个线程）。直接等待前先登记再检查 m_nested，与 nestSharedEpoll 配对
+            bool direct = !waker;
+            if (waker && !m_nested.load()) {
+                ++m_directWaiters;
+                direct = !m_nested.load();
+                if (!direct && --m_directWaiters == 0) {
+                    disarmSwitch();
+                }
+            }
+            rt = epoll_wait(direct ? m_epfd : waker->epfd, events, 64, (int)next_timeout);
+            if (direct && waker && --m_directWaiters == 0 && m_nested.load()) {
+                disarmSwitch();
+            }
         } while (rt < 0 && errno == EINTR);
 
         // ==========处理到期定时器==========
@@ -390,67 +854,35 @@ void IOManager::idle() {
         // ==========处理 epoll 事件==========
         for (int i = 0; i < rt; ++i) {
             epoll_event& event = events[i];
-
-            // 如果事件来自用于唤醒调度器的管道，清空管道中的数据
-            if (event.data.fd == m_tickleFds[0]) {
-                uint8_t dummy;
-                while (read(m_tickleFds[0], &dummy, 1) == 1);
+            if (event.data.ptr == &m_switchFd) {
+                // 唤醒器已启用，回到循环开头改为在线程自己的 epoll 上等待
                 continue;
             }
-
-            // 获取与文件描述符关联的上下文对象
-            FdContext* fd_ctx = (FdContext*)event.data.ptr;
-            FdContext::MutexType::Lock lock(fd_ctx->mutex);
-
-            /*如果发生错误或挂起，启用读和写的监控，
-                保证即使在错误或挂起的情况下，
-                仍然能够处理 fd 上可能存在的未读或未写数据
-                */
-            if (event.events & (EPOLLERR | EPOLLHUP)) {
-                event.events |= (EPOLLIN | EPOLLOUT) & fd_ctx->events;
-            }
-
-            // 确定实际发生的事件类型（读/写）
-            int real_events = NONE;
-            if (event.events & EPOLLIN) {
-                real_events |= READ;
-            }
-            if (event.events & EPOLLOUT) {
-                real_events |= WRITE;
-            }
-
-            // 如果没有设置相关事件则跳过触发事件
-            if ((fd_ctx->events & real_events) == NONE) {
+            if (waker && event.data.ptr == waker) {
+                // 被定向唤醒，清空 eventfd 计数
+                uint64_t dummy;
+                while (read(waker->eventFd, &dummy, sizeof(dummy)) > 0);
                 continue;
             }
-
-            // 更新 epoll 监听事件：如果有剩余事件则修改(MOD)，否则删除(DEL)
-            int left_events = (fd_ctx->events & ~real_events);
-            int op = left_events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
-            event.events = left_events | EPOLLET;
-
-            // 更新 epoll 对该文件描述符的监听设置
-            int rt2 = epoll_ctl(m_epfd, op, fd_ctx->fd, &event);
-            if (rt2) {
-                int saved_errno = errno;
-                IM_LOG_ERROR(g_logger)
-                    << "epoll_ctl(" << m_epfd << ", " << op << ", " << fd_ctx->fd << ", "
-                    << event.events << "): " << rt2 << " (" << saved_errno << ") ("
-                    << strerror(saved_errno) << ")";
+            if (waker && waker->ring && event.data.ptr == waker->ring.get()) {
+                // io_uring 完成队列非空，收割完成项并恢复等待的协程
+                reapUring(waker);
                 continue;
             }
-
-            // 如果适用，则触发读事件回调
-            if (real_events & READ) {
-                fd_ctx->triggerEvent(READ);
-                --m_pendingEventCount;
-            }
-
-            // 如果适用，则触发写事件回调
-            if (real_events & WRITE) {
-                fd_ctx->triggerEvent(WRITE);
-                --m_pendingEventCount;
+            if (waker && event.data.ptr == this) {
+                // 共享 epoll 上有就绪事件，不阻塞地取出处理
+                int n = 0;
+                do {
+                    n = epoll_wait(m_epfd, shared_events.data(), 64, 0);
+                } while (n < 0 && errno == EINTR);
+                for (int j = 0; j < n; ++j) {
+                    if (shared_events[j].data.ptr != &m_switchFd) {
+                        processEvent(shared_events[j]);
+                    }
+                }
+                continue;
             }
+            processEvent(event);
         }
 
         // ==========协程切换==========
@@ -462,20 +894,81 @@ void IOManager::idle() {
     }
 }
 
+void IOManager::processEvent(epoll_event& event) {
+    // 如果事件来自用于唤醒调度器的管道，清空管道中的数据
+    if (event.data.fd == m_tickleFds[0]) {
+        uint8_t dummy;
+        while (read(m_tickleFds[0], &dummy, 1) == 1);
+        return;
+    }
+
+    // 获取与文件描述符关联的上下文对象
+    FdContext* fd_ctx = (FdContext*)event.data.ptr;
+    FdContext::MutexType::Lock lock(fd_ctx->mutex);
+
+    /*如果发生错误或挂起，启用读和写的监控，
+        保证即使在错误或挂起的情况下，
+        仍然能够处理 fd 上可能存在的未读或未写数据
+        */
+    if (event.events & (EPOLLERR | EPOLLHUP)) {
+        event.events |= (EPOLLIN | EPOLLOUT) & fd_ctx->events;
+    }
+
+    // 确定实际发生的事件类型（读/写）
+    int real_events = NONE;
+    if (event.events & EPOLLIN) {
+        real_events |= READ;
+    }
+    if (event.events & EPOLLOUT) {
+        real_events |= WRITE;
+    }
+
+    // 如果没有设置相关事件则跳过触发事件
+    if ((fd_ctx->events & real_events) == NONE) {
+        return;
+    }
+
+    // 更新 epoll 监听事件：如果有剩余事件则修改(MOD)，否则删除(DEL)
+    int left_events = (fd_ctx->events & ~real_events);
+    int op = left_events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL;
+    event.events = left_events | EPOLLET;
+
+    // 更新 epoll 对该文件描述符的监听设置
+    int rt = epoll_ctl(fd_ctx->epfd, op, fd_ctx->fd, &event);
+    if (rt) {
+        int saved_errno = errno;
+        IM_LOG_ERROR(g_logger) << "epoll_ctl(" << fd_ctx->epfd << ", " << op << ", "
+                                << fd_ctx->fd << ", " << event.events << "): " << rt << " ("
+                                << saved_errno << ") (" << strerror(saved_errno) << ")";
+        return;
+    }
+    if (!left_events) {
+        fd_ctx->epfd = -1;
+    }
+
+    // 如果适用，则触发读事件回调
+    if (real_events & READ) {
+        fd_ctx->triggerEvent(READ);
+        --m_pendingEventCount;
+    }
+
+    // 如果适用，则触发写事件回调
+    if (real_events & WRITE) {
+        fd_ctx->triggerEvent(WRITE);
+        --m_pendingEventCount;
+    }
+}
+
 void IOManager::onTimerInsertedAtFront() {
     tickle();
 }
 
-void IOManager::contextResize(size_t size) {
-    m_fdContexts.resize(size);
-
-    // 遍历数组，为未初始化的元素分配和设置文件描述符上下文
-    for (size_t i = 0; i < m_fdContexts.size(); ++i) {
-        if (!m_fdContexts[i])  // 如果当前索引的元素为空
-        {
-            m_fdContexts[i] = new FdContext;
-            m_fdContexts[i]->fd = i;  // 设置文件描述符
-        }
+IOManager::FdContext::~FdContext() {
+    if (read_dl.timer) {
+        read_dl.timer->cancel();
+    }
+    if (write_dl.timer) {
+        write_dl.timer->cancel();
     }
 }
 
@@ -497,6 +990,7 @@ void IOManager::FdContext::resetContext(EventContext& event) {
     event.scheduler = nullptr;  // 将调度器指针重置为 nullptr，表示该事件不再绑定到任何调度器。
     event.coroutine.reset();    // 重置协程上下文，释放与其关联的资源。
     event.cb = nullptr;         // 清空回调函数指针，确保不会保留任何旧的回调逻辑。
+    event.threadId = -1;        // 解除线程绑定
 }
 
 void IOManager::FdContext::triggerEvent(Event event) {
@@ -512,10 +1006,10 @@ void IOManager::FdContext::triggerEvent(Event event) {
     // 根据上下文内容调度回调函数或协程
     if (event_ctx.cb) {
         // 如果存在回调函数，则调度该回调
-        event_ctx.scheduler->schedule(event_ctx.cb);
+        event_ctx.scheduler->schedule(event_ctx.cb, event_ctx.threadId);
     } else {
         // 如果不存在回调函数，则调度协程
-        event_ctx.scheduler->schedule(event_ctx.coroutine);
+        event_ctx.scheduler->schedule(event_ctx.coroutine, event_ctx.threadId);
     }
 
     // 触发完成后必须清理上下文，避免后续 addEvent 命中断言
@@ -29,6 +29,9 @@ void RWMutex::rdlock() {
 void RWMutex::wrlock() {
     pthread_rwlock_wrlock(&m_mutex);
 }
+bool RWMutex::trywrlock() {
+    return pthread_rwlock_trywrlock(&m_mutex) == 0;
+}
 void RWMutex::unlock() {
     pthread_rwlock_unlock(&m_mutex);
 }
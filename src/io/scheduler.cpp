@@ -10,6 +10,8 @@ static auto g_logger = IM_LOG_NAME("system");
 static thread_local Scheduler* t_scheduler = nullptr;
 // 当前线程的协程对象
 static thread_local Coroutine* t_coroutine = nullptr;
+// 当前线程正在执行的任务所绑定的线程ID，-1表示未绑定
+static thread_local pid_t t_task_thread = -1;
 
 Scheduler::Scheduler(size_t threads, bool use_caller, const std::string& name) : m_name(name) {
     IM_ASSERT(threads > 0);
@@ -60,6 +62,20 @@ Coroutine* Scheduler::GetMainCoroutine() {
     return t_coroutine;
 }
 
+pid_t Scheduler::GetTaskThreadId() {
+    return t_task_thread;
+}
+
+std::vector<pid_t> Scheduler::getWorkerThreadIds() const {
+    std::vector<pid_t> ids;
+    for (auto id : m_threadIds) {
+        if (id != m_rootThreadId) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
 void Scheduler::start() {
     MutexType::Lock lock(m_mutex);
 
@@ -154,6 +170,10 @@ void Scheduler::tickle() {
     IM_LOG_INFO(g_logger) << "tickle";
 }
 
+void Scheduler::tickle(pid_t thread) {
+    tickle();
+}
+
 bool Scheduler::stopping() {
     MutexType::Lock lock(m_mutex);
     return m_autoStop && m_taskQueue.empty() && !m_isRunning && m_activeThreadCount == 0;
@@ -190,24 +210,25 @@ void Scheduler::run() {
     while (true) {
         // ==========任务获取阶段==========
         task.reset();            // 清除上一次循环中保存的任务，确保当前循环处理的是新任务
-        bool tickle_me = false;  // 是否需要通知其他线程
         bool is_active = false;  // 线程是否处于活动状态
         {
             // 加锁访问协程队列
             MutexType::Lock lock(m_mutex);
             auto it = m_taskQueue.begin();
             while (it != m_taskQueue.end()) {
-                // 当前任务指定了执行线程，且该线程不是当前线程，则跳过该任务，并标记为需要通知其他线程
+                // 当前任务指定了执行线程，且该线程不是当前线程，则跳过该任务
+                // （schedule 时已定向唤醒目标线程，这里不再转发 tickle，
+                //  否则共享 epoll 下被唤醒的往往还是刚让出的非目标线程）
                 if (it->threadId != -1 && it->threadId != GetThreadId()) {
                     ++it;
-                    tickle_me = true;
                     continue;
                 }
 
                 IM_ASSERT(it->coroutine || it->cb);
 
-                // 如果it中保存的是协程，并且正在执行中，则跳过
-                if (it->coroutine && it->coroutine->getState() == Coroutine::State::EXEC) {
+                // 如果it中保存的是协程，并且正在执行中（或还没从原线程切出完毕），则跳过
+                if (it->coroutine && (it->coroutine->getState() == Coroutine::State::EXEC ||
+                                      it->coroutine->isRunning())) {
                     ++it;
                     continue;
                 }
@@ -221,29 +242,23 @@ void Scheduler::run() {
             }
         }
 
-        // ==========跨线程通知阶段==========
-        // 如果有其他线程需要被唤醒，则触发tickle
-        if (tickle_me) {
-            tickle();
-        }
-
         // ==========任务处理阶段==========
         if (task.coroutine &&  // 协程类型任务
             task.coroutine->getState() != Coroutine::State::TERM &&
             task.coroutine->getState() != Coroutine::State::EXCEPT) {
             // 进入目标协程
-            task.coroutine->swapIn();
+            t_task_thread = task.threadId;
+            // swapIn 返回后协程可能已被其他线程恢复，只使用切出时的状态
+            const Coroutine::State state = task.coroutine->swapIn();
+            t_task_thread = -1;
             // 离开目标协程
             --m_activeThreadCount;
+            afterTask();
             // 如果协程状态为READY，说明协程主动让出了执行权，但仍需要继续执行，重新加入调度队列
-            if (task.coroutine->getState() == Coroutine::State::READY) {
-                schedule(task.coroutine);
-            }
-            // 如果协程未结束且无异常，设置为HOLD状态
-            else if (task.coroutine->getState() != Coroutine::State::TERM &&
-                     task.coroutine->getState() != Coroutine::State::EXCEPT) {
-                task.coroutine->setState(Coroutine::State::HOLD);
+            if (state == Coroutine::State::READY) {
+                schedule(task.coroutine, task.threadId);
             }
+            // HOLD 状态已由 swapIn 设置，等待事件或定时器重新调度；
             // 如果协程是终止状态（TERM）或异常状态（EXCEPT），结束该协程的任务
         } else if (task.cb)  // 回调函数类型任务
         {
@@ -254,21 +269,22 @@ void Scheduler::run() {
                 cb_coroutine.reset(new Coroutine(task.cb));
             }
             // 进入回调函数
-            cb_coroutine->swapIn();
+            t_task_thread = task.threadId;
+            const Coroutine::State state = cb_coroutine->swapIn();
+            t_task_thread = -1;
             // 离开回调函数
             --m_activeThreadCount;
+            afterTask();
 
             // 如果协程状态为READY，重新加入调度队列
-            if (cb_coroutine->getState() == Coroutine::State::READY) {
-                schedule(cb_coroutine);
+            if (state == Coroutine::State::READY) {
+                schedule(cb_coroutine, task.threadId);
                 cb_coroutine.reset();
-            } else if (cb_coroutine->getState() == Coroutine::State::TERM ||
-                       cb_coroutine->getState() == Coroutine::State::EXCEPT) {
+            } else if (state == Coroutine::State::TERM || state == Coroutine::State::EXCEPT) {
                 cb_coroutine->reset(nullptr);
             }
-            // 其他情况设置为HOLD状态并重置协程指针
+            // 其他情况（HOLD）协程已交给事件或定时器，重置协程指针
             else {
-                cb_coroutine->setState(Coroutine::State::HOLD);
                 cb_coroutine.reset();
             }
         }
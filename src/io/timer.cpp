@@ -14,7 +14,19 @@ Timer::Timer(uint64_t ms, std::function<void()> cb, bool recurring, TimerManager
 Timer::Timer(uint64_t next) : m_next(next) {}
 
 bool Timer::cancel() {
+    // 节点持有自身的引用，须在解锁后再析构
+    Set::node_type node;
     TimerManager::RWMutexType::WriteLock lock(m_manager->m_mutex);
+    if (m_tokenCb) {
+        m_tokenCb = nullptr;
+        node = std::move(m_node);
+        if (m_armed) {
+            m_armed = false;
+            m_manager->m_timers.erase(shared_from_this());
+            return true;
+        }
+        return false;
+    }
     if (m_cb) {
         // 取消回调函数
         m_cb = nullptr;
@@ -74,6 +86,36 @@ bool Timer::reset(uint64_t ms, bool from_now) {
     return true;
 }
 
+bool Timer::arm(uint64_t ms, uint64_t token) {
+    TimerManager::RWMutexType::WriteLock lock(m_manager->m_mutex);
+    if (!m_tokenCb) {
+        return false;
+    }
+    auto& timers = m_manager->m_timers;
+    if (m_armed) {
+        m_node = timers.extract(shared_from_this());
+    }
+    m_ms = ms;
+    m_next = TimeUtil::NowToMS() + ms;
+    m_token = token;
+    m_armed = true;
+    // 首次启动时插入新节点，之后复用保存的节点
+    auto it = m_node.empty() ? timers.insert(shared_from_this()).first
+                             : timers.insert(std::move(m_node)).position;
+    m_manager->onTimerInserted(it, lock);
+    return true;
+}
+
+bool Timer::disarm() {
+    TimerManager::RWMutexType::WriteLock lock(m_manager->m_mutex);
+    if (!m_armed) {
+        return false;
+    }
+    m_armed = false;
+    m_node = m_manager->m_timers.extract(shared_from_this());
+    return true;
+}
+
 bool Timer::Comparator::operator()(const Timer::ptr& lhs, const Timer::ptr& rhs) const {
     // 处理空指针情况
     if (!lhs && !rhs) {
@@ -123,6 +165,12 @@ Timer::ptr TimerManager::addConditionTimer(uint64_t ms, std::function<void()> cb
     return addTimer(ms, std::bind(&OnTimer, weak_cond, cb), recurring);
 }
 
+Timer::ptr TimerManager::createTimer(std::function<void(uint64_t)> cb) {
+    Timer::ptr timer(new Timer(0, nullptr, false, this));
+    timer->m_tokenCb.swap(cb);
+    return timer;
+}
+
 uint64_t TimerManager::getNextTimer() {
     RWMutex::ReadLock lock(m_mutex);
     m_tickled = false;
@@ -174,14 +222,27 @@ void TimerManager::listExpiredCb(std::vector<std::function<void()>>& cbs) {
         ++it;
     }
 
-    // 将已到期的定时器移到expired向量中
-    expired.insert(expired.begin(), m_timers.begin(), it);
-    m_timers.erase(m_timers.begin(), it);
+    // 将已到期的定时器移到expired向量中，可复用定时器保留其节点
+    while (m_timers.begin() != it) {
+        auto cur = m_timers.begin();
+        Timer::ptr timer = *cur;
+        if (timer->m_tokenCb) {
+            timer->m_armed = false;
+            timer->m_node = m_timers.extract(cur);
+        } else {
+            m_timers.erase(cur);
+        }
+        expired.push_back(std::move(timer));
+    }
 
     cbs.reserve(expired.size());
 
     // 处理所有已到期的定时器
     for (auto& timer : expired) {
+        if (timer->m_tokenCb) {
+            cbs.push_back(std::bind(timer->m_tokenCb, timer->m_token));
+            continue;
+        }
         cbs.push_back(timer->m_cb);
         if (timer->m_recurring) {
             // 对于重复执行的定时器，设置下次执行时间并重新插入队列
@@ -203,7 +264,10 @@ bool TimerManager::hasTimer() {
         将锁作为参数的目的：减小锁颗粒度
     */
 void TimerManager::addTimer(Timer::ptr val, RWMutexType::WriteLock& lock) {
-    auto it = m_timers.insert(val).first;
+    onTimerInserted(m_timers.insert(val).first, lock);
+}
+
+void TimerManager::onTimerInserted(Timer::Set::iterator it, RWMutexType::WriteLock& lock) {
     bool at_front = (it == m_timers.begin() && !m_tickled);
     if (at_front) {
         // 标记已通知上层
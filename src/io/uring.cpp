@@ -0,0 +1,270 @@
+#include "io/uring.hpp"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "base/macro.hpp"
+
+namespace IM {
+static auto g_logger = IM_LOG_NAME("system");
+
+static int uring_setup(unsigned entries, io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static bool ProbeUring() {
+    io_uring_params p = {};
+    int fd = uring_setup(4, &p);
+    if (fd < 0) {
+        IM_LOG_INFO(g_logger) << "io_uring_setup unavailable: " << strerror(errno);
+        return false;
+    }
+
+    static const int kRequiredOps[] = {
+        IORING_OP_RECV,    IORING_OP_SEND,    IORING_OP_RECVMSG,      IORING_OP_SENDMSG,
+        IORING_OP_ACCEPT,  IORING_OP_CONNECT, IORING_OP_LINK_TIMEOUT, IORING_OP_ASYNC_CANCEL,
+    };
+    const size_t ops = IORING_OP_LAST;
+    std::vector<char> mem(sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = (io_uring_probe*)mem.data();
+    bool ok = uring_register(fd, IORING_REGISTER_PROBE, probe, ops) == 0;
+    for (size_t i = 0; ok && i < sizeof(kRequiredOps) / sizeof(kRequiredOps[0]); ++i) {
+        int op = kRequiredOps[i];
+        ok = op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        if (!ok) {
+            IM_LOG_INFO(g_logger) << "io_uring op " << op << " not supported";
+        }
+    }
+    // 需要 NODROP 保证完成项不会因 CQ 溢出而丢失
+    ok = ok && (p.features & IORING_FEAT_NODROP);
+    close(fd);
+    return ok;
+}
+
+bool Uring::IsSupported() {
+    static const bool s_supported = ProbeUring();
+    return s_supported;
+}
+
+Uring::Uring(uint32_t entries) {
+    io_uring_params p = {};
+    m_fd = uring_setup(entries, &p);
+    if (m_fd < 0) {
+        IM_LOG_ERROR(g_logger) << "io_uring_setup failed: " << strerror(errno);
+        throw std::runtime_error("io_uring initialization failed");
+    }
+
+    m_sqRingSize = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    m_cqRingSize = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = p.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+
+    m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_fd, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED) {
+        m_sqRing = nullptr;
+    } else if (single_mmap) {
+        m_cqRing = m_sqRing;
+    } else {
+        m_cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_fd, IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED) {
+            m_cqRing = nullptr;
+        }
+    }
+    m_sqesSize = p.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = (io_uring_sqe*)mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED) {
+        m_sqes = nullptr;
+    }
+    if (!m_sqRing || !m_cqRing || !m_sqes) {
+        int saved_errno = errno;
+        release();
+        IM_LOG_ERROR(g_logger) << "io_uring mmap failed: " << strerror(saved_errno);
+        throw std::runtime_error("io_uring initialization failed");
+    }
+
+    char* sq = (char*)m_sqRing;
+    m_sqHead = (unsigned*)(sq + p.sq_off.head);
+    m_sqTail = (unsigned*)(sq + p.sq_off.tail);
+    m_sqMask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    m_sqEntries = *(unsigned*)(sq + p.sq_off.ring_entries);
+    m_sqeTail = *m_sqTail;
+    // SQ 数组固定为恒等映射，提交项按下标顺序使用
+    unsigned* array = (unsigned*)(sq + p.sq_off.array);
+    for (unsigned i = 0; i < m_sqEntries; ++i) {
+        array[i] = i;
+    }
+
+    char* cq = (char*)m_cqRing;
+    m_cqHead = (unsigned*)(cq + p.cq_off.head);
+    m_cqTail = (unsigned*)(cq + p.cq_off.tail);
+    m_cqMask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    m_cqes = (io_uring_cqe*)(cq + p.cq_off.cqes);
+}
+
+Uring::~Uring() {
+    release();
+}
+
+void Uring::release() {
+    if (m_sqes) {
+        munmap(m_sqes, m_sqesSize);
+        m_sqes = nullptr;
+    }
+    if (m_cqRing && m_cqRing != m_sqRing) {
+        munmap(m_cqRing, m_cqRingSize);
+    }
+    m_cqRing = nullptr;
+    if (m_sqRing) {
+        munmap(m_sqRing, m_sqRingSize);
+        m_sqRing = nullptr;
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    // 实例关闭后内核不再引用缓冲区，可以释放
+    if (m_bufferMem) {
+        munmap(m_bufferMem, m_bufEntries * m_bufferSize);
+        m_bufferMem = nullptr;
+    }
+}
+
+io_uring_sqe* Uring::getSqe(uint32_t count) {
+    unsigned head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    if (m_sqeTail + count - head > m_sqEntries) {
+        return nullptr;
+    }
+    return nextSqe();
+}
+
+io_uring_sqe* Uring::nextSqe() {
+    io_uring_sqe* sqe = &m_sqes[m_sqeTail & m_sqMask];
+    ++m_sqeTail;
+    memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+uint32_t Uring::pending() const {
+    return m_sqeTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+}
+
+int Uring::submit() {
+    // 先补上此前因 SQ 已满未能重新提供的缓冲区
+    std::vector<uint16_t> recycle;
+    recycle.swap(m_recycle);
+    for (uint16_t bid : recycle) {
+        provideBuffer(bid);
+    }
+    __atomic_store_n(m_sqTail, m_sqeTail, __ATOMIC_RELEASE);
+    // 内核尚未消费的提交项（包括上次提交时因资源不足而剩下的）都在这次一并提交
+    unsigned to_submit = m_sqeTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+    if (!to_submit) {
+        return 0;
+    }
+    int rt;
+    do {
+        rt = uring_enter(m_fd, to_submit, 0, 0);
+    } while (rt < 0 && errno == EINTR);
+    if (rt < 0) {
+        rt = -errno;
+        IM_LOG_ERROR(g_logger) << "io_uring_enter(" << m_fd << ", " << to_submit
+                               << ") failed: " << strerror(-rt);
+    }
+    return rt;
+}
+
+bool Uring::hasCompletions() const {
+    return *m_cqHead != __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+}
+
+bool Uring::registerBuffers(uint32_t count, uint32_t size) {
+    if (!count || !size || count > 65536) {
+        return false;
+    }
+    void* mem = mmap(nullptr, (size_t)count * size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        IM_LOG_WARN(g_logger) << "io_uring buffer mmap failed: " << strerror(errno);
+        return false;
+    }
+
+    // 一次提供全部缓冲区并同步等待结果；此时 CQ 中没有其他完成项
+    io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = (int)count;
+    sqe->addr = (uint64_t)mem;
+    sqe->len = size;
+    sqe->buf_group = kBufferGroup;
+    __atomic_store_n(m_sqTail, m_sqeTail, __ATOMIC_RELEASE);
+    int rt;
+    do {
+        rt = uring_enter(m_fd, 1, 1, IORING_ENTER_GETEVENTS);
+    } while (rt < 0 && errno == EINTR);
+    int res = rt < 0 ? -errno : 0;
+    reap([&res](uint64_t, int r, uint32_t) { res = res ? res : r; });
+    if (res < 0) {
+        IM_LOG_WARN(g_logger) << "io_uring provide " << count << "x" << size
+                              << " buffers failed: " << strerror(-res);
+        munmap(mem, (size_t)count * size);
+        return false;
+    }
+    m_bufEntries = count;
+    m_freeBuffers = count;
+    m_bufferMem = mem;
+    m_bufferSize = size;
+    return true;
+}
+
+bool Uring::acquireBuffer() {
+    if (!m_freeBuffers) {
+        return false;
+    }
+    --m_freeBuffers;
+    return true;
+}
+
+void Uring::releaseBuffer(uint32_t cqe_flags) {
+    if (!(cqe_flags & IORING_CQE_F_BUFFER)) {
+        // 请求没有取用缓冲区（出错、被取消或超时），只归还名额
+        ++m_freeBuffers;
+        return;
+    }
+    provideBuffer(cqe_flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+void Uring::provideBuffer(uint16_t bid) {
+    io_uring_sqe* sqe = getSqe();
+    if (!sqe) {
+        m_recycle.push_back(bid);
+        return;
+    }
+    // user_data 为0，完成项由 IOManager 忽略；在 SQ 中排在之后的 RECV 之前执行
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = 1;
+    sqe->addr = (uint64_t)getBuffer((uint32_t)bid << IORING_CQE_BUFFER_SHIFT);
+    sqe->len = m_bufferSize;
+    sqe->off = bid;
+    sqe->buf_group = kBufferGroup;
+    ++m_freeBuffers;
+}
+}  // namespace IM
@@ -59,13 +59,15 @@ bool WorkerManager::init(const std::map<std::string, std::map<std::string, std::
         std::string name = i.first;
         int32_t thread_num = GetParamValue(i.second, "thread_num", 1);
         int32_t worker_num = GetParamValue(i.second, "worker_num", 1);
+        bool sharded = GetParamValue(i.second, "sharded", 0);
 
         for (int32_t x = 0; x < worker_num; ++x) {
             Scheduler::ptr s;
             if (!x) {
-                s = std::make_shared<IOManager>(thread_num, false, name);
+                s = std::make_shared<IOManager>(thread_num, false, name, sharded);
             } else {
-                s = std::make_shared<IOManager>(thread_num, false, name + "-" + std::to_string(x));
+                s = std::make_shared<IOManager>(thread_num, false, name + "-" + std::to_string(x),
+                                                sharded);
             }
             add(s);
         }
@@ -7,15 +7,22 @@
 #include "net/hook.hpp"
 
 namespace IM {
-FdCtx::FdCtx(int fd)
-    : m_isInit(false),
+FdCtx::FdCtx()
+    : m_active(false),
+      m_isInit(false),
       m_isSocket(false),
       m_sysNonBlock(false),
       m_userNonBlock(false),
       m_isClosed(false),
-      m_fd(fd),
+      m_fd(-1),
       m_recvTimeout(-1),
-      m_sendTimeout(-1) {
+      m_sendTimeout(-1) {}
+
+void FdCtx::reset(int fd) {
+    m_fd = fd;
+    m_isInit = false;
+    m_isSocket = false;
+    m_sysNonBlock = false;
     init();
 }
 
@@ -116,41 +123,37 @@ uint64_t FdCtx::getTimeout(int type) const {
     return -1;
 }
 
-FdManager::FdManager() {
-    m_fdCtxs.resize(64);
-}
+FdManager::FdManager() {}
 
-FdCtx::ptr FdManager::get(int fd, bool auto_create) {
-    if (fd < 0) {
+FdCtx* FdManager::get(int fd, bool auto_create) {
+    // 快路径：无锁查表，已启用直接返回
+    FdCtx* ctx = auto_create ? m_fdCtxs.at(fd) : m_fdCtxs.get(fd);
+    if (!ctx || ctx->m_active.load(std::memory_order_acquire)) {
+        return ctx;
+    }
+    if (!auto_create) {
         return nullptr;
     }
 
-    RWMutexType::WriteLock lock(m_mutex);
-    if (fd >= (int)m_fdCtxs.size()) {
-        if (!auto_create) {
-            return nullptr;
-        }
-        m_fdCtxs.resize(fd * 1.5 + 1);  // 防止 fd 是0或1
-    } else {
-        if (m_fdCtxs[fd]) {
-            return m_fdCtxs[fd];
-        }
-        if (!auto_create) {
-            return nullptr;
-        }
+    MutexType::Lock lock(m_mutex);
+    if (!ctx->m_active.load(std::memory_order_relaxed)) {
+        ctx->reset(fd);
+        ctx->m_active.store(true, std::memory_order_release);
     }
-
-    FdCtx::ptr ctx = std::make_shared<FdCtx>(fd);
-    m_fdCtxs[fd] = ctx;
     return ctx;
 }
 
 void FdManager::del(int fd) {
-    RWMutexType::WriteLock lock(m_mutex);
-    if (fd < 0 || fd >= (int)m_fdCtxs.size()) {
+    FdCtx* ctx = m_fdCtxs.get(fd);
+    if (!ctx) {
         return;
     }
-    m_fdCtxs[fd].reset();
+    MutexType::Lock lock(m_mutex);
+    if (ctx->m_active.load(std::memory_order_relaxed)) {
+        // 标记关闭：仍在该 fd 上等待的协程醒来后可据此返回 EBADF
+        ctx->m_isClosed = true;
+        ctx->m_active.store(false, std::memory_order_release);
+    }
 }
 
 FileDescriptor::FileDescriptor(int fd) : m_fd(fd) {}
@@ -104,15 +104,40 @@ struct timer_info {
     int cancelled = 0;
 };
 
+/**
+     * @brief 在 io_uring 后端下以完成式请求代替 epoll 等待
+     * @param[in] prep 填写提交项的函数，返回false表示该调用形式不支持 io_uring
+     * @param[out] res 请求完成结果，失败为 -errno
+     * @return bool 请求已提交并完成返回true；未启用 io_uring 或不支持时返回false
+     */
+static bool uring_io(IOManager*, int, IOManager::Event, uint64_t, std::nullptr_t, int&) {
+    return false;
+}
+
+template <typename Prep>
+static bool uring_io(IOManager* iom, int fd, IOManager::Event event, uint64_t timeout,
+                     Prep& prep, int& res) {
+    if (!iom || !iom->isUring()) {
+        return false;
+    }
+    io_uring_sqe sqe = {};
+    if (!prep(sqe)) {
+        return false;
+    }
+    return iom->uringWait(fd, event, sqe, timeout, res);
+}
+
 /**
      * @brief 执行带有协程支持的IO操作
      * @tparam OriginFun 原始函数类型
+     * @tparam Prep 填写 io_uring 提交项的函数类型，不支持 io_uring 时为 std::nullptr_t
      * @tparam Args 函数参数包类型
      * @param fd 文件描述符
      * @param fun 原始系统调用函数指针
      * @param hook_fun_name 被hook的函数名称
      * @param event IO事件类型（READ/WRITE）
      * @param timeout_so 超时设置选项（SO_RCVTIMEO/SO_SNDTIMEO）
+     * @param prep 填写等价 io_uring 提交项的函数，io_uring 后端下阻塞时改为提交该请求
      * @param args 传递给原始函数的参数包
      * @return 返回IO操作结果，成功返回传输字节数，失败返回-1并设置errno
      *
@@ -120,19 +145,19 @@ struct timer_info {
      * 1. 检查hook是否启用，未启用则直接调用原始函数
      * 2. 获取文件描述符上下文信息
      * 3. 处理非阻塞IO操作
-     * 4. 在IO阻塞时将当前协程挂起，并注册相应的事件监听
+     * 4. 在IO阻塞时将当前协程挂起，并注册相应的事件监听（io_uring 后端下改为提交完成式请求）
      * 5. 支持超时控制
      */
-template <typename OriginFun, typename... Args>
+template <typename OriginFun, typename Prep, typename... Args>
 static ssize_t do_io(int fd, OriginFun fun, const char* hook_fun_name, uint32_t event,
-                     int timeout_so, Args&&... args) {
+                     int timeout_so, Prep prep, Args&&... args) {
     // ==========判断是否启用hook==========
     if (!is_hook_enable()) {
         return fun(fd, std::forward<Args>(args)...);
     }
 
     // ==========获取文件描述符上下文==========
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+    FdCtx* ctx = FdMgr::GetInstance()->get(fd);
     if (!ctx) {
         return fun(fd, std::forward<Args>(args)...);
     }
@@ -150,7 +175,6 @@ static ssize_t do_io(int fd, OriginFun fun, const char* hook_fun_name, uint32_t
 
     // 获取超时设置
     uint64_t timeout = ctx->getTimeout(timeout_so);
-    std::shared_ptr<timer_info> tinfo(new timer_info);
 
 // 重试标签，用于IO操作被中断或需要重试的情况
 retry:
@@ -163,51 +187,30 @@ retry:
 
     // 如果是因为缓冲区无数据/无法写入导致的阻塞
     if (n == -1 && errno == EAGAIN) {
-        IOManager* iom = IOManager::GetThis();
-        Timer::ptr timer;
-        std::weak_ptr<timer_info> winfo(tinfo);
-
-        if (timeout != (uint64_t)-1)  // 判断是否设置了超时时间
-        {
-            // 设置一个条件定时器来实现超时控制
-            timer = iom->addConditionTimer(
-                timeout,
-                [winfo, fd, iom, event]() {
-                    auto t = winfo.lock();
-                    // 如果转换失败或者cancelled已被设置，直接返回
-                    if (!t || t->cancelled) {
-                        return;
-                    }
-                    // 记录超时标准
-                    t->cancelled = ETIMEDOUT;
-                    // 通知 IOManager 取消对指定文件描述符上特定事件的监听
-                    iom->cancelEvent(fd, (IOManager::Event)event);
-                },
-                winfo);
+        // io_uring 后端：请求完成时 IO 已经做完，省去 epoll 注册、唤醒与重试
+        int res = 0;
+        if (uring_io(IOManager::GetThis(), fd, (IOManager::Event)event, timeout, prep, res) &&
+            res != -EAGAIN) {  // 内核未能就绪等待时返回 EAGAIN，退回 epoll 等待
+            if (res == -ECANCELED) {
+                // 被 cancelAll 唤醒，与 epoll 路径一样重新尝试
+                goto retry;
+            }
+            if (res < 0) {
+                // errno 已由 uringWait 在恢复后的线程上设置
+                return -1;
+            }
+            return res;
         }
 
-        // 添加IO事件监听
-        bool rt = iom->addEvent(fd, (IOManager::Event)event);
-        if (!rt) {
+        // 挂起当前协程等待事件就绪；超时定时器由 IOManager 按 fd 复用，不再逐次分配
+        int rt = IOManager::GetThis()->waitEvent(fd, (IOManager::Event)event, timeout);
+        if (rt < 0) {
             // 添加事件失败，记录日志并返回错误
             IM_LOG_ERROR(g_logger) << hook_fun_name << " addEvent (" << fd << ", " << event << ")";
-            if (timer) {
-                timer->cancel();
-            }
             return -1;
         }
-
-        // 成功添加事件，让出当前协程控制权
-        Coroutine::YieldToHold();
-
-        // 协程重新被调度时，首先取消定时器（因为不再需要超时控制）
-        if (timer) {
-            timer->cancel();
-        }
-
-        // 如果定时器触发（超时），设置错误码并返回
-        if (tinfo->cancelled) {
-            errno = tinfo->cancelled;
+        // 如果定时器触发（超时），errno 已由 waitEvent 设置为 ETIMEDOUT
+        if (rt == ETIMEDOUT) {
             return -1;
         }
         // 重新尝试IO操作
@@ -245,7 +248,9 @@ unsigned int sleep(unsigned int seconds) {
     }
 
     Coroutine::ptr co = Coroutine::GetThis();
-    io_manager->addTimer(seconds * 1000, [io_manager, co]() { io_manager->schedule(co); });
+    pid_t tid = Scheduler::GetTaskThreadId();
+    io_manager->addTimer(seconds * 1000,
+                         [io_manager, co, tid]() { io_manager->schedule(co, tid); });
     Coroutine::YieldToHold();
 
     return 0;
@@ -274,7 +279,8 @@ int usleep(useconds_t usec) {
     }
 
     Coroutine::ptr co = Coroutine::GetThis();
-    io_manager->addTimer(usec / 1000, [io_manager, co]() { io_manager->schedule(co); });
+    pid_t tid = Scheduler::GetTaskThreadId();
+    io_manager->addTimer(usec / 1000, [io_manager, co, tid]() { io_manager->schedule(co, tid); });
     Coroutine::YieldToHold();
 
     return 0;
@@ -307,7 +313,8 @@ int nanosleep(const struct timespec* req, struct timespec* rem) {
     Coroutine::ptr co = Coroutine::GetThis();
     // 将纳秒转换为毫秒
     uint64_t timeout_ms = req->tv_sec * 1000 + req->tv_nsec / 1000 / 1000;
-    io_manager->addTimer(timeout_ms, [io_manager, co]() { io_manager->schedule(co); });
+    pid_t tid = Scheduler::GetTaskThreadId();
+    io_manager->addTimer(timeout_ms, [io_manager, co, tid]() { io_manager->schedule(co, tid); });
     Coroutine::YieldToHold();
 
     return 0;
@@ -357,7 +364,7 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
     }
 
     // 获取文件描述符上下文
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+    FdCtx* ctx = FdMgr::GetInstance()->get(fd);
     if (!ctx || ctx->isClose()) {
         errno = EBADF;
         return -1;
@@ -373,6 +380,19 @@ int connect_with_timeout(int fd, const struct sockaddr* addr, socklen_t addrlen,
         return connect_f(fd, addr, addrlen);
     }
 
+    // io_uring 后端：直接提交 CONNECT 请求，完成时即为最终的连接结果
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_CONNECT;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)addr;
+        sqe.off = addrlen;
+        return true;
+    };
+    int res = 0;
+    if (uring_io(IOManager::GetThis(), fd, IOManager::WRITE, timeout_ms, prep, res)) {
+        return res < 0 ? -1 : 0;
+    }
+
     // 尝试连接
     int n = connect_f(fd, addr, addrlen);
     if (n == 0) {
@@ -473,7 +493,15 @@ int connect(int sockfd, const struct sockaddr* addr, socklen_t addrlen) {
          *          3. 支持超时控制，超时时间由SO_RCVTIMEO选项决定
          */
 int accept(int sockfd, struct sockaddr* addr, socklen_t* addrlen) {
-    int fd = do_io(sockfd, accept_f, "accept", IOManager::READ, SO_RCVTIMEO, addr, addrlen);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_ACCEPT;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)addr;
+        sqe.addr2 = (uint64_t)addrlen;
+        return true;
+    };
+    int fd =
+        do_io(sockfd, accept_f, "accept", IOManager::READ, SO_RCVTIMEO, prep, addr, addrlen);
     if (fd >= 0) {
         FdMgr::GetInstance()->get(fd, true);
     }
@@ -491,7 +519,15 @@ int accept(int sockfd, struct sockaddr* addr, socklen_t* addrlen) {
          *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
          */
 ssize_t read(int fd, void* buf, size_t count) {
-    return do_io(fd, read_f, "read", IOManager::READ, SO_RCVTIMEO, buf, count);
+    // do_io 只对 socket 走协程路径，按 RECV 提交（READ 对非阻塞 fd 会直接返回 EAGAIN）
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_RECV;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = count;
+        return true;
+    };
+    return do_io(fd, read_f, "read", IOManager::READ, SO_RCVTIMEO, prep, buf, count);
 }
 
 /**
@@ -505,7 +541,18 @@ ssize_t read(int fd, void* buf, size_t count) {
          *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
          */
 ssize_t readv(int fd, const struct iovec* iov, int iovcnt) {
-    return do_io(fd, readv_f, "readv", IOManager::READ, SO_RCVTIMEO, iov, iovcnt);
+    // 按 RECVMSG 提交，msghdr 在请求完成前一直有效
+    msghdr msg = {};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+    auto prep = [fd, &msg](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_RECVMSG;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)&msg;
+        sqe.len = 1;
+        return true;
+    };
+    return do_io(fd, readv_f, "readv", IOManager::READ, SO_RCVTIMEO, prep, iov, iovcnt);
 }
 
 /**
@@ -520,7 +567,15 @@ ssize_t readv(int fd, const struct iovec* iov, int iovcnt) {
          *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
          */
 ssize_t recv(int sockfd, void* buf, size_t len, int flags) {
-    return do_io(sockfd, recv_f, "recv", IOManager::READ, SO_RCVTIMEO, buf, len, flags);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_RECV;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = len;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, recv_f, "recv", IOManager::READ, SO_RCVTIMEO, prep, buf, len, flags);
 }
 
 /**
@@ -538,8 +593,20 @@ ssize_t recv(int sockfd, void* buf, size_t len, int flags) {
          */
 ssize_t recvfrom(int sockfd, void* buf, size_t len, int flags, struct sockaddr* src_addr,
                  socklen_t* addrlen) {
-    return do_io(sockfd, recvfrom_f, "recvfrom", IOManager::READ, SO_RCVTIMEO, buf, len, flags,
-                 src_addr, addrlen);
+    auto prep = [=](io_uring_sqe& sqe) {
+        // 需要返回对端地址时退回 epoll 路径
+        if (src_addr) {
+            return false;
+        }
+        sqe.opcode = IORING_OP_RECV;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = len;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, recvfrom_f, "recvfrom", IOManager::READ, SO_RCVTIMEO, prep, buf, len,
+                 flags, src_addr, addrlen);
 }
 
 /**
@@ -553,7 +620,15 @@ ssize_t recvfrom(int sockfd, void* buf, size_t len, int flags, struct sockaddr*
          *          超时时间由文件描述符的SO_RCVTIMEO选项决定。
          */
 ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags) {
-    return do_io(sockfd, recvmsg_f, "recvmsg", IOManager::READ, SO_RCVTIMEO, msg, flags);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_RECVMSG;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)msg;
+        sqe.len = 1;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, recvmsg_f, "recvmsg", IOManager::READ, SO_RCVTIMEO, prep, msg, flags);
 }
 
 /**
@@ -567,7 +642,14 @@ ssize_t recvmsg(int sockfd, struct msghdr* msg, int flags) {
          *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
          */
 ssize_t write(int fd, const void* buf, size_t count) {
-    return do_io(fd, write_f, "write", IOManager::WRITE, SO_SNDTIMEO, buf, count);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_SEND;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = count;
+        return true;
+    };
+    return do_io(fd, write_f, "write", IOManager::WRITE, SO_SNDTIMEO, prep, buf, count);
 }
 
 /**
@@ -581,7 +663,17 @@ ssize_t write(int fd, const void* buf, size_t count) {
          *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
          */
 ssize_t writev(int fd, const struct iovec* iov, int iovcnt) {
-    return do_io(fd, writev_f, "writev", IOManager::WRITE, SO_SNDTIMEO, iov, iovcnt);
+    msghdr msg = {};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = iovcnt;
+    auto prep = [fd, &msg](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_SENDMSG;
+        sqe.fd = fd;
+        sqe.addr = (uint64_t)&msg;
+        sqe.len = 1;
+        return true;
+    };
+    return do_io(fd, writev_f, "writev", IOManager::WRITE, SO_SNDTIMEO, prep, iov, iovcnt);
 }
 
 /**
@@ -596,7 +688,15 @@ ssize_t writev(int fd, const struct iovec* iov, int iovcnt) {
          *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
          */
 ssize_t send(int sockfd, const void* buf, size_t len, int flags) {
-    return do_io(sockfd, send_f, "send", IOManager::WRITE, SO_SNDTIMEO, buf, len, flags);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_SEND;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = len;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, send_f, "send", IOManager::WRITE, SO_SNDTIMEO, prep, buf, len, flags);
 }
 
 /**
@@ -614,7 +714,19 @@ ssize_t send(int sockfd, const void* buf, size_t len, int flags) {
          */
 ssize_t sendto(int sockfd, const void* buf, size_t len, int flags, const struct sockaddr* dest_addr,
                socklen_t addrlen) {
-    return do_io(sockfd, sendto_f, "sendto", IOManager::WRITE, SO_SNDTIMEO, buf, len, flags,
+    auto prep = [=](io_uring_sqe& sqe) {
+        // 指定目的地址时退回 epoll 路径
+        if (dest_addr) {
+            return false;
+        }
+        sqe.opcode = IORING_OP_SEND;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)buf;
+        sqe.len = len;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, sendto_f, "sendto", IOManager::WRITE, SO_SNDTIMEO, prep, buf, len, flags,
                  dest_addr, addrlen);
 }
 
@@ -629,7 +741,15 @@ ssize_t sendto(int sockfd, const void* buf, size_t len, int flags, const struct
          *          超时时间由文件描述符的SO_SNDTIMEO选项决定。
          */
 ssize_t sendmsg(int sockfd, const struct msghdr* msg, int flags) {
-    return do_io(sockfd, sendmsg_f, "sendmsg", IOManager::WRITE, SO_SNDTIMEO, msg, flags);
+    auto prep = [=](io_uring_sqe& sqe) {
+        sqe.opcode = IORING_OP_SENDMSG;
+        sqe.fd = sockfd;
+        sqe.addr = (uint64_t)msg;
+        sqe.len = 1;
+        sqe.msg_flags = flags;
+        return true;
+    };
+    return do_io(sockfd, sendmsg_f, "sendmsg", IOManager::WRITE, SO_SNDTIMEO, prep, msg, flags);
 }
 
 /**
@@ -646,7 +766,7 @@ int close(int fd) {
         return close_f(fd);
     }
 
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+    FdCtx* ctx = FdMgr::GetInstance()->get(fd);
     if (ctx) {
         auto iom = IOManager::GetThis();
         if (iom) {
@@ -684,7 +804,7 @@ int fcntl(int fd, int cmd, ...) {
         case F_SETFL: {
             int arg = va_arg(args, int);
             va_end(args);
-            FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+            FdCtx* ctx = FdMgr::GetInstance()->get(fd);
             if (!ctx || !ctx->isSocket() || ctx->isClose()) {
                 return fcntl_f(fd, cmd, arg);
             }
@@ -700,7 +820,7 @@ int fcntl(int fd, int cmd, ...) {
         case F_GETFL: {
             va_end(args);
             int arg = fcntl_f(fd, cmd);
-            FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+            FdCtx* ctx = FdMgr::GetInstance()->get(fd);
             if (!ctx || !ctx->isSocket() || ctx->isClose()) {
                 return arg;
             }
@@ -778,7 +898,7 @@ int ioctl(int fd, unsigned long request, ...) {
     // 处理FIONBIO命令，设置或清除套接字的非阻塞I/O模式
     if (FIONBIO == request) {
         bool user_nonblock = !!(*(int*)arg);
-        FdCtx::ptr ctx = FdMgr::GetInstance()->get(fd);
+        FdCtx* ctx = FdMgr::GetInstance()->get(fd);
         if (!ctx || !ctx->isSocket() || ctx->isClose()) {
             return ioctl_f(fd, request, arg);
         }
@@ -822,7 +942,7 @@ int setsockopt(int sockfd, int level, int optname, const void* optval, socklen_t
 
     if (level == SOL_SOCKET) {
         if (optname == SO_RCVTIMEO || optname == SO_SNDTIMEO) {
-            FdCtx::ptr ctx = FdMgr::GetInstance()->get(sockfd);
+            FdCtx* ctx = FdMgr::GetInstance()->get(sockfd);
             if (ctx) {
                 // 将传入的timeval结构体转换为毫秒数，并设置到上下文中的超时时间
                 const timeval* tv = (const timeval*)optval;
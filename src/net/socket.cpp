@@ -64,7 +64,7 @@ Socket::~Socket() {
 }
 
 int64_t Socket::getSendTimeout() {
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(m_sock);
+    FdCtx* ctx = FdMgr::GetInstance()->get(m_sock);
     if (ctx) {
         return ctx->getTimeout(SO_SNDTIMEO);
     }
@@ -77,7 +77,7 @@ void Socket::setSendTimeout(int64_t v) {
 }
 
 int64_t Socket::getRecvTimeout() {
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(m_sock);
+    FdCtx* ctx = FdMgr::GetInstance()->get(m_sock);
     if (ctx) {
         return ctx->getTimeout(SO_RCVTIMEO);
     }
@@ -129,6 +129,17 @@ Socket::ptr Socket::accept() {
     return nullptr;
 }
 
+bool Socket::setReusePort() {
+    if (!isValid()) {
+        newSock();
+        if (IM_UNLIKELY(!isValid())) {
+            return false;
+        }
+    }
+    int val = 1;
+    return setOption(SOL_SOCKET, SO_REUSEPORT, val);
+}
+
 bool Socket::bind(const Address::ptr addr) {
     if (!isValid()) {
         newSock();
@@ -224,7 +235,7 @@ bool Socket::listen(int backlog) {
 
 bool Socket::init(int sock) {
     // 在fd管理器中注册该套接字，方便统一管理
-    FdCtx::ptr ctx = FdMgr::GetInstance()->get(sock);
+    FdCtx* ctx = FdMgr::GetInstance()->get(sock);
     if (ctx && ctx->isSocket() && !ctx->isClose()) {
         // 初始化成员变量
         m_sock = sock;
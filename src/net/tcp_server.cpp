@@ -41,26 +41,40 @@ bool TcpServer::bind(const std::vector<Address::ptr>& addrs, std::vector<Address
                      bool ssl) {
     m_ssl = ssl;
     for (auto& addr : addrs) {
-        // 根据是否启用ssl加密创建 Socket
-        Socket::ptr sock = ssl ? SSLSocket::CreateTCP(addr) : Socket::CreateTCP(addr);
-
-        // 绑定地址
-        if (!sock->bind(addr)) {
-            IM_LOG_ERROR(g_logger) << "bind fail errno=" << errno << " errstr=" << strerror(errno)
-                                    << " addr=[" << addr->toString() << "]";
-            fails.push_back(addr);
-            continue;
-        }
+        // SO_REUSEPORT 模式下同一地址打开多个监听 socket（Unix 域地址不支持）
+        bool reuse_port = m_reusePort && !std::dynamic_pointer_cast<UnixAddress>(addr);
+        size_t count = reuse_port ? m_reusePort : 1;
+        for (size_t n = 0; n < count; ++n) {
+            // 根据是否启用ssl加密创建 Socket
+            Socket::ptr sock = ssl ? SSLSocket::CreateTCP(addr) : Socket::CreateTCP(addr);
+
+            if (reuse_port && !sock->setReusePort()) {
+                IM_LOG_ERROR(g_logger) << "set SO_REUSEPORT fail errno=" << errno
+                                       << " errstr=" << strerror(errno) << " addr=["
+                                       << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
 
-        // 开启监听
-        if (!sock->listen()) {
-            IM_LOG_ERROR(g_logger)
-                << "listen fail errno=" << errno << " errstr=" << strerror(errno) << " addr=["
-                << addr->toString() << "]";
-            fails.push_back(addr);
-            continue;
+            // 绑定地址
+            if (!sock->bind(addr)) {
+                IM_LOG_ERROR(g_logger) << "bind fail errno=" << errno
+                                       << " errstr=" << strerror(errno) << " addr=["
+                                       << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
+
+            // 开启监听
+            if (!sock->listen()) {
+                IM_LOG_ERROR(g_logger)
+                    << "listen fail errno=" << errno << " errstr=" << strerror(errno)
+                    << " addr=[" << addr->toString() << "]";
+                fails.push_back(addr);
+                break;
+            }
+            m_socks.push_back(sock);
         }
-        m_socks.push_back(sock);
     }
 
     if (!fails.empty()) {
@@ -81,6 +95,20 @@ bool TcpServer::start() {
     }
     m_isRun = true;
 
+    if (m_reusePort) {
+        // 各监听 socket 的 accept 循环依次绑定到 io_worker 的不同线程
+        std::vector<pid_t> tids = m_ioWorker->getWorkerThreadIds();
+        for (size_t i = 0; i < m_socks.size(); ++i) {
+            pid_t tid = tids.empty() ? -1 : tids[i % tids.size()];
+            m_ioWorker->schedule(
+                std::bind(&TcpServer::startAccept, shared_from_this(), m_socks[i]), tid);
+        }
+        return true;
+    }
+
+    if (m_affinity) {
+        m_ioThreads = m_ioWorker->getWorkerThreadIds();
+    }
     for (auto& sock : m_socks) {
         m_acceptWorker->schedule(std::bind(&TcpServer::startAccept, shared_from_this(), sock));
     }
@@ -94,8 +122,20 @@ void TcpServer::startAccept(Socket::ptr sock) {
         if (client_fd) {
             // 设置读超时时间
             client_fd->setRecvTimeout(m_recvTimeout);
-            m_ioWorker->schedule(
-                std::bind(&TcpServer::handleClient, shared_from_this(), client_fd));
+            if (m_reusePort) {
+                // 留在接受连接的线程上处理，避免跨线程转交
+                m_ioWorker->schedule(
+                    std::bind(&TcpServer::handleClient, shared_from_this(), client_fd),
+                    GetThreadId());
+            } else if (!m_ioThreads.empty()) {
+                // 亲和模式：轮转绑定到一个 IO 线程，连接此后不再跨线程迁移
+                pid_t tid = m_ioThreads[m_nextIoThread++ % m_ioThreads.size()];
+                m_ioWorker->schedule(
+                    std::bind(&TcpServer::handleClient, shared_from_this(), client_fd), tid);
+            } else {
+                m_ioWorker->schedule(
+                    std::bind(&TcpServer::handleClient, shared_from_this(), client_fd));
+            }
         } else {
             IM_LOG_ERROR(g_logger) << "accept errno=" << errno << " errstr=" << strerror(errno);
         }
@@ -109,7 +149,9 @@ void TcpServer::handleClient(Socket::ptr client) {
 void TcpServer::stop() {
     m_isRun = false;
     auto self = shared_from_this();
-    m_acceptWorker->schedule([this, self]() {
+    // 监听 socket 的事件注册在运行 accept 循环的调度器上，需在该调度器上取消
+    IOManager* acceptor = m_reusePort ? m_ioWorker : m_acceptWorker;
+    acceptor->schedule([this, self]() {
         for (auto& sock : m_socks) {
             sock->cancelAll();
             sock->close();
@@ -130,6 +172,22 @@ void TcpServer::setRecvTimeout(uint64_t v) {
     m_recvTimeout = v;
 }
 
+void TcpServer::setReusePort(uint32_t v) {
+    m_reusePort = v;
+}
+
+uint32_t TcpServer::getReusePort() const {
+    return m_reusePort;
+}
+
+void TcpServer::setAffinity(bool v) {
+    m_affinity = v;
+}
+
+bool TcpServer::getAffinity() const {
+    return m_affinity;
+}
+
 void TcpServer::setName(const std::string& v) {
     m_name = v;
 }
@@ -163,7 +221,8 @@ std::string TcpServer::toString(const std::string& prefix) {
     ss << prefix << "[type=" << m_type << " name=" << m_name << " ssl=" << m_ssl
        << " worker=" << (m_worker ? m_worker->getName() : "")
        << " accept=" << (m_acceptWorker ? m_acceptWorker->getName() : "")
-       << " recv_timeout=" << m_recvTimeout << "]" << std::endl;
+       << " recv_timeout=" << m_recvTimeout << " reuse_port=" << m_reusePort
+       << " affinity=" << m_affinity << "]" << std::endl;
     std::string pfx = prefix.empty() ? "    " : prefix;
     for (auto& i : m_socks) {
         ss << pfx << pfx << *i << std::endl;
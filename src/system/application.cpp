@@ -349,8 +349,14 @@ int Application::run_coroutine() {
     FoxThreadMgr::GetInstance()->init();
     FoxThreadMgr::GetInstance()->start();
 
-    // 不再使用雪花ID生成器，改用数据库自增ID。
-    // 如果将来需要恢复分布式ID，可在此处重新初始化 IdWorker。
+    // 初始化雪花ID生成器（消息ID等有序主键），worker id 取自 machine.code
+    try {
+        IM::util::IdWorker::GetInstance().Init(g_machine_code->getValue());
+    } catch (const std::exception& e) {
+        IM_LOG_ERROR(g_logger) << "IdWorker init failed, machine.code=" << g_machine_code->getValue()
+                               << " err=" << e.what();
+        Application::Exit(0);
+    }
 
     // 初始化Redis管理器
     RedisMgr::GetInstance();
@@ -456,6 +462,14 @@ int Application::run_coroutine() {
             server->setName(i.name);
         }
 
+        // SO_REUSEPORT 多监听模式需在绑定前设置
+        if (i.reuse_port > 0) {
+            server->setReusePort(i.reuse_port);
+        }
+        if (i.affinity) {
+            server->setAffinity(true);
+        }
+
         // 绑定服务器地址
         std::vector<Address::ptr> fails;
         if (!server->bind(address, fails, i.ssl)) {
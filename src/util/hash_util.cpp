@@ -6,8 +6,14 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <random>
 #include <stdexcept>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define IM_HASH_UTIL_X86 1
+#include <immintrin.h>
+#endif
+
 // 忽略OpenSSL 3.0的弃用警告
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -119,17 +125,422 @@ uint32_t quick_hash(const void* tmp, uint32_t size) {
     const char* str = (const char*)tmp;
     unsigned int h = 0;
     for (uint32_t i = 0; i < size; ++i) {
-        h = 31 * h + *str;
+        h = 31 * h + str[i];
     }
     return h;
 }
 
+static inline uint64_t rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t fmix64(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3_x64_128，h1/h2 为两路初始种子（标准算法两者相同）
+static void murmur3_x64_128(const void* data, size_t len, uint64_t h1, uint64_t h2,
+                            uint64_t out[2]) {
+    const uint8_t* ptr = (const uint8_t*)data;
+    const uint64_t c1 = 0x87c37b91114253d5ULL, c2 = 0x4cf5ad432745937fULL;
+
+    // handle 16 bytes blocks
+    const size_t blk = len / 16;
+    for (size_t i = 0; i < blk; ++i) {
+        uint64_t k1, k2;
+        memcpy(&k1, ptr + i * 16, 8);
+        memcpy(&k2, ptr + i * 16 + 8, 8);
+
+        k1 *= c1;
+        k1 = rotl64(k1, 31);
+        k1 *= c2;
+        h1 ^= k1;
+        h1 = rotl64(h1, 27);
+        h1 += h2;
+        h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= c2;
+        k2 = rotl64(k2, 33);
+        k2 *= c1;
+        h2 ^= k2;
+        h2 = rotl64(h2, 31);
+        h2 += h1;
+        h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    // handle tail
+    const uint8_t* tail = ptr + blk * 16;
+    uint64_t k1 = 0, k2 = 0;
+    switch (len & 15) {
+        case 15:
+            k2 ^= ((uint64_t)tail[14]) << 48;
+        case 14:
+            k2 ^= ((uint64_t)tail[13]) << 40;
+        case 13:
+            k2 ^= ((uint64_t)tail[12]) << 32;
+        case 12:
+            k2 ^= ((uint64_t)tail[11]) << 24;
+        case 11:
+            k2 ^= ((uint64_t)tail[10]) << 16;
+        case 10:
+            k2 ^= ((uint64_t)tail[9]) << 8;
+        case 9:
+            k2 ^= ((uint64_t)tail[8]);
+            k2 *= c2;
+            k2 = rotl64(k2, 33);
+            k2 *= c1;
+            h2 ^= k2;
+        case 8:
+            k1 ^= ((uint64_t)tail[7]) << 56;
+        case 7:
+            k1 ^= ((uint64_t)tail[6]) << 48;
+        case 6:
+            k1 ^= ((uint64_t)tail[5]) << 40;
+        case 5:
+            k1 ^= ((uint64_t)tail[4]) << 32;
+        case 4:
+            k1 ^= ((uint64_t)tail[3]) << 24;
+        case 3:
+            k1 ^= ((uint64_t)tail[2]) << 16;
+        case 2:
+            k1 ^= ((uint64_t)tail[1]) << 8;
+        case 1:
+            k1 ^= ((uint64_t)tail[0]);
+            k1 *= c1;
+            k1 = rotl64(k1, 31);
+            k1 *= c2;
+            h1 ^= k1;
+    };
+
+    h1 ^= len;
+    h2 ^= len;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+    out[0] = h1;
+    out[1] = h2;
+}
+
+void murmur3_hash128(const void* data, size_t size, uint32_t seed, uint64_t out[2]) {
+    if (!data) {
+        out[0] = out[1] = 0;
+        return;
+    }
+    murmur3_x64_128(data, size, seed, seed, out);
+}
+
+// 单次 x64_128 计算，取前 64 位；seed/seed2 分别作为两路初始状态
 uint64_t murmur3_hash64(const void* str, const uint32_t& size, const uint32_t& seed,
                         const uint32_t& seed2) {
-    return (((uint64_t)murmur3_hash(str, size, seed)) << 32 | murmur3_hash(str, size, seed2));
+    if (!str) return 0;
+    uint64_t out[2];
+    murmur3_x64_128(str, size, seed, seed2, out);
+    return out[0];
 }
 uint64_t murmur3_hash64(const char* str, const uint32_t& seed, const uint32_t& seed2) {
-    return (((uint64_t)murmur3_hash(str, seed)) << 32 | murmur3_hash(str, seed2));
+    if (!str) return 0;
+    uint64_t out[2];
+    murmur3_x64_128(str, strlen(str), seed, seed2, out);
+    return out[0];
+}
+
+// ---------------------------------------------------------------------------
+// hex/base64 向量化内核
+// 编译时不要求 -mavx2/-msse4.1：内核以 target 属性单独编译，首次调用时按 CPU 选择。
+// 每个内核只处理整块数据并返回已消费的输入长度，剩余尾部（以及非法输入所在的块）交给
+// 标量代码处理，因此输出与错误语义与标量实现完全一致。
+// ---------------------------------------------------------------------------
+namespace {
+
+struct SimdKernels {
+    const char* name;
+    size_t (*hex_encode)(const uint8_t* src, size_t len, char* dst);
+    size_t (*hex_decode)(const char* src, size_t len, uint8_t* dst);
+    size_t (*base64_encode)(const uint8_t* src, size_t len, char* dst);
+    // dst 需至少有 len * 3 / 4 字节可写；遇到非法字符（含 '='）所在的块即停止
+    size_t (*base64_decode)(const char* src, size_t len, uint8_t* dst);
+};
+
+size_t ScalarHexEncode(const uint8_t*, size_t, char*) { return 0; }
+size_t ScalarHexDecode(const char*, size_t, uint8_t*) { return 0; }
+size_t ScalarBase64Encode(const uint8_t*, size_t, char*) { return 0; }
+size_t ScalarBase64Decode(const char*, size_t, uint8_t*) { return 0; }
+
+#ifdef IM_HASH_UTIL_X86
+
+// ---- SSE4.1 (含 SSSE3 pshufb) ----
+
+__attribute__((target("sse4.1"))) size_t SseHexEncode(const uint8_t* src, size_t len,
+                                                       char* dst) {
+    const __m128i lut = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b',
+                                      'c', 'd', 'e', 'f');
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+        __m128i lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i*)(dst + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    return i;
+}
+
+// 16 个 hex 字符转为 8 个 16 位的字节值；非法字符在 bad 中置位
+__attribute__((target("sse4.1"))) inline __m128i SseHexPairs(const char* src, int& bad) {
+    const __m128i v = _mm_loadu_si128((const __m128i*)src);
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                        _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), v));
+    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                        _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+    bad |= _mm_movemask_epi8(_mm_or_si128(digit, alpha)) ^ 0xffff;
+    const __m128i val = _mm_blendv_epi8(_mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)),
+                                        _mm_sub_epi8(v, _mm_set1_epi8('0')), digit);
+    // 相邻两个半字节合并：hi * 16 + lo
+    return _mm_maddubs_epi16(val, _mm_set1_epi16(0x0110));
+}
+
+__attribute__((target("sse4.1"))) size_t SseHexDecode(const char* src, size_t len,
+                                                       uint8_t* dst) {
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        int bad = 0;
+        __m128i a = SseHexPairs(src + i, bad);
+        __m128i b = SseHexPairs(src + i + 16, bad);
+        if (bad) {
+            break;
+        }
+        _mm_storeu_si128((__m128i*)(dst + i / 2), _mm_packus_epi16(a, b));
+    }
+    return i;
+}
+
+// 每个 32 位中的 4 个 6 位索引映射为 base64 字符（W. Mula 的 pshufb 查表法）
+__attribute__((target("sse4.1"))) inline __m128i SseBase64Chars(__m128i in) {
+    in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i idx = _mm_or_si128(t1, t3);
+
+    __m128i off = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+    off = _mm_or_si128(off, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), idx),
+                                          _mm_set1_epi8(13)));
+    const __m128i shift = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    return _mm_add_epi8(_mm_shuffle_epi8(shift, off), idx);
+}
+
+__attribute__((target("sse4.1"))) size_t SseBase64Encode(const uint8_t* src, size_t len,
+                                                          char* dst) {
+    // 每次读 16 字节、使用其中 12 字节
+    size_t i = 0;
+    for (; i + 16 <= len; i += 12) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i / 3 * 4), SseBase64Chars(in));
+    }
+    return i;
+}
+
+// base64 字符转 6 位值；非法字符（含 '='）在 bad 中置位
+__attribute__((target("sse4.1"))) inline __m128i SseBase64Values(__m128i in, int& bad) {
+    const __m128i hi = _mm_and_si128(_mm_srli_epi32(in, 4), _mm_set1_epi8(0x0f));
+    const __m128i lo = _mm_and_si128(in, _mm_set1_epi8(0x0f));
+    const __m128i shift_lut = _mm_setr_epi8(0, 0, 0x3e - 0x2b, 0x34 - 0x30, -0x41, -0x41,
+                                            0x1a - 0x61, 0x1a - 0x61, 0, 0, 0, 0, 0, 0, 0, 0);
+    // 按低半字节给出合法的高半字节集合
+    const __m128i mask_lut =
+        _mm_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                      (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50,
+                      0x50, 0x50, 0x54);
+    const __m128i bit_lut = _mm_setr_epi8(0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80,
+                                          0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i shift = _mm_shuffle_epi8(shift_lut, hi);
+    shift = _mm_blendv_epi8(shift, _mm_set1_epi8(16), _mm_cmpeq_epi8(in, _mm_set1_epi8('/')));
+    const __m128i m = _mm_and_si128(_mm_shuffle_epi8(mask_lut, lo), _mm_shuffle_epi8(bit_lut, hi));
+    bad |= _mm_movemask_epi8(_mm_cmpeq_epi8(m, _mm_setzero_si128()));
+    return _mm_add_epi8(in, shift);
+}
+
+__attribute__((target("sse4.1"))) size_t SseBase64Decode(const char* src, size_t len,
+                                                          uint8_t* dst) {
+    // 每次写 16 字节（12 字节有效），保留足够余量保证不越过 len * 3 / 4
+    size_t i = 0;
+    for (; i + 24 <= len; i += 16) {
+        int bad = 0;
+        __m128i v = SseBase64Values(_mm_loadu_si128((const __m128i*)(src + i)), bad);
+        if (bad) {
+            break;
+        }
+        v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+        v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+        v = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1,
+                                              -1));
+        _mm_storeu_si128((__m128i*)(dst + i / 4 * 3), v);
+    }
+    return i;
+}
+
+// ---- AVX2 ----
+
+__attribute__((target("avx2"))) size_t Avx2HexEncode(const uint8_t* src, size_t len,
+                                                      char* dst) {
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'));
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+        __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+        // unpack 按 128 位通道交织，再跨通道恢复顺序
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i*)(dst + i * 2), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + i * 2 + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline __m256i Avx2HexPairs(const char* src, int& bad) {
+    const __m256i v = _mm256_loadu_si256((const __m256i*)src);
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    bad |= ~_mm256_movemask_epi8(_mm256_or_si256(digit, alpha));
+    const __m256i val =
+        _mm256_blendv_epi8(_mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10)),
+                           _mm256_sub_epi8(v, _mm256_set1_epi8('0')), digit);
+    return _mm256_maddubs_epi16(val, _mm256_set1_epi16(0x0110));
+}
+
+__attribute__((target("avx2"))) size_t Avx2HexDecode(const char* src, size_t len,
+                                                      uint8_t* dst) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        int bad = 0;
+        __m256i a = Avx2HexPairs(src + i, bad);
+        __m256i b = Avx2HexPairs(src + i + 32, bad);
+        if (bad) {
+            break;
+        }
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xd8);
+        _mm256_storeu_si256((__m256i*)(dst + i / 2), v);
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) inline __m256i Avx2Base64Chars(__m256i in) {
+    in = _mm256_shuffle_epi8(in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0,
+                                                 1, 10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2,
+                                                 0, 1));
+    const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+    const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+    const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+    const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+    const __m256i idx = _mm256_or_si256(t1, t3);
+
+    __m256i off = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+    off = _mm256_or_si256(off, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx),
+                                                _mm256_set1_epi8(13)));
+    const __m256i shift = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+    return _mm256_add_epi8(_mm256_shuffle_epi8(shift, off), idx);
+}
+
+__attribute__((target("avx2"))) size_t Avx2Base64Encode(const uint8_t* src, size_t len,
+                                                         char* dst) {
+    // 两个通道各取 12 字节：[i, i+16) 与 [i+12, i+28)
+    size_t i = 0;
+    for (; i + 28 <= len; i += 24) {
+        __m256i in = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(src + i))),
+            _mm_loadu_si128((const __m128i*)(src + i + 12)), 1);
+        _mm256_storeu_si256((__m256i*)(dst + i / 3 * 4), Avx2Base64Chars(in));
+    }
+    return i;
+}
+
+__attribute__((target("avx2"))) size_t Avx2Base64Decode(const char* src, size_t len,
+                                                         uint8_t* dst) {
+    const __m256i shift_lut = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0, 0, 0x3e - 0x2b, 0x34 - 0x30, -0x41, -0x41, 0x1a - 0x61, 0x1a - 0x61, 0, 0, 0, 0, 0, 0,
+        0, 0));
+    const __m256i mask_lut = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8((char)0xa8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8,
+                      (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf8, (char)0xf0, 0x54, 0x50,
+                      0x50, 0x50, 0x54));
+    const __m256i bit_lut = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, (char)0x80, 0, 0, 0, 0, 0, 0, 0, 0));
+    const __m256i pack = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    // 每次写 32 字节（24 字节有效）
+    size_t i = 0;
+    for (; i + 48 <= len; i += 32) {
+        const __m256i in = _mm256_loadu_si256((const __m256i*)(src + i));
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi32(in, 4), _mm256_set1_epi8(0x0f));
+        const __m256i lo = _mm256_and_si256(in, _mm256_set1_epi8(0x0f));
+        const __m256i m = _mm256_and_si256(_mm256_shuffle_epi8(mask_lut, lo),
+                                           _mm256_shuffle_epi8(bit_lut, hi));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(m, _mm256_setzero_si256()))) {
+            break;
+        }
+        __m256i shift = _mm256_shuffle_epi8(shift_lut, hi);
+        shift = _mm256_blendv_epi8(shift, _mm256_set1_epi8(16),
+                                   _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/')));
+        __m256i v = _mm256_add_epi8(in, shift);
+        v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+        v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+        v = _mm256_shuffle_epi8(v, pack);
+        v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256((__m256i*)(dst + i / 4 * 3), v);
+    }
+    return i;
+}
+
+#endif  // IM_HASH_UTIL_X86
+
+SimdKernels DetectKernels() {
+    SimdKernels k = {"scalar", ScalarHexEncode, ScalarHexDecode, ScalarBase64Encode,
+                     ScalarBase64Decode};
+#ifdef IM_HASH_UTIL_X86
+    // IM_HASH_SIMD=scalar|sse4.1 可限制最高级别，用于测试与性能对比
+    const char* env = getenv("IM_HASH_SIMD");
+    const std::string limit = env ? env : "";
+    __builtin_cpu_init();
+    if (limit != "scalar" && __builtin_cpu_supports("sse4.1")) {
+        k = {"sse4.1", SseHexEncode, SseHexDecode, SseBase64Encode, SseBase64Decode};
+    }
+    if (limit != "scalar" && limit != "sse4.1" && __builtin_cpu_supports("avx2")) {
+        k = {"avx2", Avx2HexEncode, Avx2HexDecode, Avx2Base64Encode, Avx2Base64Decode};
+    }
+#endif
+    return k;
+}
+
+const SimdKernels& GetKernels() {
+    static const SimdKernels s_kernels = DetectKernels();
+    return s_kernels;
+}
+
+}  // namespace
+
+const char* hash_simd_level() {
+    return GetKernels().name;
 }
 
 std::string base64decode(const std::string& src) {
@@ -140,6 +551,11 @@ std::string base64decode(const std::string& src) {
     const char* ptr = src.c_str();
     const char* end = ptr + src.size();
 
+    // 先用向量内核解码不含填充与非法字符的整块，其余交给下面的逐组解码
+    size_t done = GetKernels().base64_decode(ptr, src.size(), (uint8_t*)writeBuf);
+    ptr += done;
+    writeBuf += done / 4 * 3;
+
     while (ptr < end) {
         int i = 0;
         int padding = 0;
@@ -204,11 +620,16 @@ std::string base64encode(const void* data, size_t len) {
     const char* base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
     std::string ret;
-    ret.reserve(len * 4 / 3 + 2);
+    ret.resize((len + 2) / 3 * 4);
+    char* out = &ret[0];
 
     const unsigned char* ptr = (const unsigned char*)data;
     const unsigned char* end = ptr + len;
 
+    size_t done = GetKernels().base64_encode(ptr, len, out);
+    ptr += done;
+    out += done / 3 * 4;
+
     while (ptr < end) {
         unsigned int packed = 0;
         int i = 0;
@@ -225,15 +646,10 @@ std::string base64encode(const void* data, size_t len) {
             packed <<= 8;
         }
 
-        ret.append(1, base64[packed >> 18]);
-        ret.append(1, base64[(packed >> 12) & 0x3f]);
-        if (padding != 2) {
-            ret.append(1, base64[(packed >> 6) & 0x3f]);
-        }
-        if (padding == 0) {
-            ret.append(1, base64[packed & 0x3f]);
-        }
-        ret.append(padding, '=');
+        *out++ = base64[packed >> 18];
+        *out++ = base64[(packed >> 12) & 0x3f];
+        *out++ = padding != 2 ? base64[(packed >> 6) & 0x3f] : '=';
+        *out++ = padding == 0 ? base64[packed & 0x3f] : '=';
     }
 
     return ret;
@@ -341,7 +757,8 @@ std::string hmac_sha256(const std::string& text, const std::string& key) {
 void hexstring_from_data(const void* data, size_t len, char* output) {
     const unsigned char* buf = (const unsigned char*)data;
     size_t i, j;
-    for (i = j = 0; i < len; ++i) {
+    i = GetKernels().hex_encode(buf, len, output);
+    for (j = i * 2; i < len; ++i) {
         char c;
         c = (buf[i] >> 4) & 0xf;
         c = (c > 9) ? c + 'a' - 10 : c + '0';
@@ -372,7 +789,10 @@ void data_from_hexstring(const char* hexstring, size_t length, void* output) {
     if (length % 2 != 0) {
         throw std::invalid_argument("data_from_hexstring length % 2 != 0");
     }
-    for (size_t i = 0; i < length; ++i) {
+    // 向量内核在遇到非法字符的块处停止，由下面的逐字节解析抛出异常
+    size_t done = GetKernels().hex_decode(hexstring, length, buf);
+    buf += done / 2;
+    for (size_t i = done; i < length; ++i) {
         switch (hexstring[i]) {
             case 'a':
             case 'b':
@@ -530,11 +950,20 @@ std::string random_string(size_t len, const std::string& chars) {
     if (len == 0 || chars.empty()) {
         return "";
     }
+    // 线程独立的 64 位生成器，每次产出拆成两个 32 位，用乘法映射到 [0, count)
+    static thread_local std::mt19937_64 s_rng(((uint64_t)std::random_device{}() << 32) ^
+                                              std::random_device{}());
     std::string rt;
     rt.resize(len);
-    int count = chars.size();
-    for (size_t i = 0; i < len; ++i) {
-        rt[i] = chars[rand() % count];
+    const uint64_t count = chars.size();
+    size_t i = 0;
+    for (; i + 2 <= len; i += 2) {
+        uint64_t r = s_rng();
+        rt[i] = chars[((r & 0xffffffff) * count) >> 32];
+        rt[i + 1] = chars[((r >> 32) * count) >> 32];
+    }
+    if (i < len) {
+        rt[i] = chars[((s_rng() & 0xffffffff) * count) >> 32];
     }
     return rt;
 }
@@ -1,6 +1,7 @@
 #include "util/id_worker.hpp"
 
 #include <chrono>
+#include <random>
 #include <stdexcept>
 #include <thread>
 
@@ -68,4 +69,20 @@ uint64_t IdWorker::NextId() {
     return id;
 }
 
+std::string IdWorker::NextHexId() {
+    static const char* kHex = "0123456789abcdef";
+    static thread_local std::mt19937_64 s_rng(std::random_device{}());
+
+    uint64_t hi = NextId();
+    uint64_t lo = s_rng();
+    std::string rt(32, '0');
+    for (int i = 15; i >= 0; --i) {
+        rt[i] = kHex[hi & 0xF];
+        rt[16 + i] = kHex[lo & 0xF];
+        hi >>= 4;
+        lo >>= 4;
+    }
+    return rt;
+}
+
 }  // namespace IM::util
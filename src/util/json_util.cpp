@@ -1,8 +1,398 @@
 #include "util/json_util.hpp"
 
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
 #include "util/util.hpp"
 
 namespace IM {
+namespace {
+// JSON 嵌套深度上限，与 jsoncpp 默认的 stackLimit 一致
+const int kMaxDepth = 1000;
+
+/**
+ * @brief 递归下降 JSON 解析器，直接构造 Json::Value
+ */
+class FastReader {
+   public:
+    FastReader(const char* begin, const char* end) : m_cur(begin), m_end(end) {}
+
+    bool parse(Json::Value& out) {
+        skipSpace();
+        if (!parseValue(out, 0)) {
+            return false;
+        }
+        skipSpace();
+        return m_cur == m_end;
+    }
+
+   private:
+    void skipSpace() {
+        while (m_cur < m_end &&
+               (*m_cur == ' ' || *m_cur == '\n' || *m_cur == '\r' || *m_cur == '\t')) {
+            ++m_cur;
+        }
+    }
+
+    bool consume(const char* lit, size_t n) {
+        if ((size_t)(m_end - m_cur) < n || memcmp(m_cur, lit, n) != 0) {
+            return false;
+        }
+        m_cur += n;
+        return true;
+    }
+
+    bool parseValue(Json::Value& out, int depth) {
+        if (m_cur == m_end || depth > kMaxDepth) {
+            return false;
+        }
+        switch (*m_cur) {
+            case '{':
+                return parseObject(out, depth);
+            case '[':
+                return parseArray(out, depth);
+            case '"': {
+                const char* b;
+                const char* e;
+                if (!parseString(b, e)) {
+                    return false;
+                }
+                out = Json::Value(b, e);
+                return true;
+            }
+            case 't':
+                out = true;
+                return consume("true", 4);
+            case 'f':
+                out = false;
+                return consume("false", 5);
+            case 'n':
+                out = Json::Value();
+                return consume("null", 4);
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(Json::Value& out, int depth) {
+        ++m_cur;
+        out = Json::Value(Json::objectValue);
+        skipSpace();
+        if (m_cur < m_end && *m_cur == '}') {
+            ++m_cur;
+            return true;
+        }
+        while (true) {
+            const char* kb;
+            const char* ke;
+            if (m_cur == m_end || *m_cur != '"' || !parseString(kb, ke)) {
+                return false;
+            }
+            // 先取得成员槽位再解析值，键在此之后不再引用，值可以复用转义缓冲区
+            Json::Value* slot = out.demand(kb, ke);
+            skipSpace();
+            if (m_cur == m_end || *m_cur != ':') {
+                return false;
+            }
+            ++m_cur;
+            skipSpace();
+            if (!parseValue(*slot, depth + 1)) {
+                return false;
+            }
+            skipSpace();
+            if (m_cur == m_end) {
+                return false;
+            }
+            if (*m_cur == '}') {
+                ++m_cur;
+                return true;
+            }
+            if (*m_cur != ',') {
+                return false;
+            }
+            ++m_cur;
+            skipSpace();
+        }
+    }
+
+    bool parseArray(Json::Value& out, int depth) {
+        ++m_cur;
+        out = Json::Value(Json::arrayValue);
+        skipSpace();
+        if (m_cur < m_end && *m_cur == ']') {
+            ++m_cur;
+            return true;
+        }
+        while (true) {
+            if (!parseValue(out.append(Json::Value()), depth + 1)) {
+                return false;
+            }
+            skipSpace();
+            if (m_cur == m_end) {
+                return false;
+            }
+            if (*m_cur == ']') {
+                ++m_cur;
+                return true;
+            }
+            if (*m_cur != ',') {
+                return false;
+            }
+            ++m_cur;
+            skipSpace();
+        }
+    }
+
+    /**
+     * @brief 解析字符串，[b, e) 指向输入本身（无转义时）或线程局部的解码缓冲区
+     */
+    bool parseString(const char*& b, const char*& e) {
+        const char* start = ++m_cur;
+        while (m_cur < m_end && *m_cur != '"' && *m_cur != '\\') {
+            ++m_cur;
+        }
+        if (m_cur == m_end) {
+            return false;
+        }
+        if (*m_cur == '"') {
+            b = start;
+            e = m_cur++;
+            return true;
+        }
+
+        // 含转义：从第一个反斜杠起解码到缓冲区
+        static thread_local std::string s_scratch;
+        std::string& buf = s_scratch;
+        buf.assign(start, m_cur);
+        while (m_cur < m_end) {
+            char c = *m_cur++;
+            if (c == '"') {
+                b = buf.data();
+                e = b + buf.size();
+                return true;
+            }
+            if (c != '\\') {
+                buf.push_back(c);
+                continue;
+            }
+            if (m_cur == m_end) {
+                return false;
+            }
+            switch (*m_cur++) {
+                case '"':
+                    buf.push_back('"');
+                    break;
+                case '\\':
+                    buf.push_back('\\');
+                    break;
+                case '/':
+                    buf.push_back('/');
+                    break;
+                case 'b':
+                    buf.push_back('\b');
+                    break;
+                case 'f':
+                    buf.push_back('\f');
+                    break;
+                case 'n':
+                    buf.push_back('\n');
+                    break;
+                case 'r':
+                    buf.push_back('\r');
+                    break;
+                case 't':
+                    buf.push_back('\t');
+                    break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!parseCodePoint(cp)) {
+                        return false;
+                    }
+                    appendUtf8(buf, cp);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseHex4(uint32_t& v) {
+        if (m_end - m_cur < 4) {
+            return false;
+        }
+        v = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = *m_cur++;
+            v <<= 4;
+            if (c >= '0' && c <= '9') {
+                v |= c - '0';
+            } else if (c >= 'a' && c <= 'f') {
+                v |= c - 'a' + 10;
+            } else if (c >= 'A' && c <= 'F') {
+                v |= c - 'A' + 10;
+            } else {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool parseCodePoint(uint32_t& cp) {
+        if (!parseHex4(cp)) {
+            return false;
+        }
+        if (cp >= 0xD800 && cp <= 0xDBFF) {
+            // 高代理项后必须紧跟低代理项
+            uint32_t lo;
+            if (!consume("\\u", 2) || !parseHex4(lo) || lo < 0xDC00 || lo > 0xDFFF) {
+                return false;
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+        } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+            return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& buf, uint32_t cp) {
+        if (cp < 0x80) {
+            buf.push_back((char)cp);
+        } else if (cp < 0x800) {
+            buf.push_back((char)(0xC0 | (cp >> 6)));
+            buf.push_back((char)(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+            buf.push_back((char)(0xE0 | (cp >> 12)));
+            buf.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            buf.push_back((char)(0x80 | (cp & 0x3F)));
+        } else {
+            buf.push_back((char)(0xF0 | (cp >> 18)));
+            buf.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+            buf.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+            buf.push_back((char)(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    bool parseNumber(Json::Value& out) {
+        const char* start = m_cur;
+        bool negative = false;
+        if (*m_cur == '-') {
+            negative = true;
+            ++m_cur;
+        }
+        const char* digits = m_cur;
+        while (m_cur < m_end && *m_cur >= '0' && *m_cur <= '9') {
+            ++m_cur;
+        }
+        if (m_cur == digits || (*digits == '0' && m_cur - digits > 1)) {
+            return false;
+        }
+        bool integral = true;
+        if (m_cur < m_end && *m_cur == '.') {
+            integral = false;
+            const char* frac = ++m_cur;
+            while (m_cur < m_end && *m_cur >= '0' && *m_cur <= '9') {
+                ++m_cur;
+            }
+            if (m_cur == frac) {
+                return false;
+            }
+        }
+        if (m_cur < m_end && (*m_cur == 'e' || *m_cur == 'E')) {
+            integral = false;
+            ++m_cur;
+            if (m_cur < m_end && (*m_cur == '+' || *m_cur == '-')) {
+                ++m_cur;
+            }
+            const char* exp = m_cur;
+            while (m_cur < m_end && *m_cur >= '0' && *m_cur <= '9') {
+                ++m_cur;
+            }
+            if (m_cur == exp) {
+                return false;
+            }
+        }
+
+        if (integral) {
+            // 与 jsoncpp 一致：能放进 Int64 的用有符号整数，否则非负数用 UInt64
+            uint64_t v;
+            auto rt = std::from_chars(digits, m_cur, v);
+            if (rt.ec == std::errc()) {
+                if (!negative) {
+                    out = v <= (uint64_t)INT64_MAX ? Json::Value((Json::Int64)v)
+                                                   : Json::Value((Json::UInt64)v);
+                    return true;
+                }
+                if (v <= (uint64_t)INT64_MAX + 1) {
+                    out = Json::Value((Json::Int64)(0 - v));
+                    return true;
+                }
+            }
+            // 超出整数范围，按浮点数处理
+        }
+        double d = 0;
+        auto rt = std::from_chars(start, m_cur, d);
+        if (rt.ec == std::errc::result_out_of_range) {
+            // from_chars 溢出时不写结果，交给 strtod 得到 ±HUGE_VAL 或 0
+            d = strtod(std::string(start, m_cur).c_str(), nullptr);
+        } else if (rt.ec != std::errc()) {
+            return false;
+        }
+        out = d;
+        return true;
+    }
+
+   private:
+    const char* m_cur;
+    const char* m_end;
+};
+
+/**
+ * @brief 构造字符串转义表：0 表示原样输出，'u' 表示写成六位的 Unicode 转义，其余为反斜杠后的字符
+ */
+struct EscapeTable {
+    char v[256];
+    constexpr EscapeTable() : v() {
+        for (int i = 0; i < 0x20; ++i) {
+            v[i] = 'u';
+        }
+        v[(unsigned char)'\b'] = 'b';
+        v[(unsigned char)'\f'] = 'f';
+        v[(unsigned char)'\n'] = 'n';
+        v[(unsigned char)'\r'] = 'r';
+        v[(unsigned char)'\t'] = 't';
+        v[(unsigned char)'"'] = '"';
+        v[(unsigned char)'\\'] = '\\';
+    }
+};
+constexpr EscapeTable kEscape;
+
+template <class T>
+void AppendNumber(std::string& out, T v) {
+    char buf[32];
+    auto rt = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, rt.ptr);
+}
+
+void AppendDouble(std::string& out, double v) {
+    if (!std::isfinite(v)) {
+        // 与 jsoncpp 默认设置一致，非有限值写为 null
+        out.append("null");
+        return;
+    }
+    char buf[32];
+    auto rt = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, rt.ptr);
+    // 保证写回后仍被识别为浮点数
+    if (!memchr(buf, '.', rt.ptr - buf) && !memchr(buf, 'e', rt.ptr - buf)) {
+        out.append(".0");
+    }
+}
+}  // namespace
+
 bool JsonUtil::NeedEscape(const std::string& v) {
     for (auto& c : v) {
         switch (c) {
@@ -213,13 +603,97 @@ uint8_t JsonUtil::GetUint8(const Json::Value& json, const std::string& name,
 }
 
 bool JsonUtil::FromString(Json::Value& json, const std::string& v) {
-    Json::Reader reader;
-    return reader.parse(v, json);
+    return Parse(json, v.data(), v.size());
 }
 
 std::string JsonUtil::ToString(const Json::Value& json) {
-    Json::FastWriter w;
-    return w.write(json);
+    return Write(json);
+}
+
+bool JsonUtil::Parse(Json::Value& json, const char* data, size_t len) {
+    return FastReader(data, data + len).parse(json);
+}
+
+void JsonUtil::WriteString(const char* data, size_t len, std::string& out) {
+    static const char kHex[] = "0123456789abcdef";
+    out.push_back('"');
+    const char* run = data;
+    const char* end = data + len;
+    for (const char* p = data; p < end; ++p) {
+        char esc = kEscape.v[(unsigned char)*p];
+        if (!esc) {
+            continue;
+        }
+        // 不需转义的连续片段整段拷贝
+        out.append(run, p);
+        run = p + 1;
+        if (esc == 'u') {
+            char u[6] = {'\\', 'u', '0', '0', kHex[(unsigned char)*p >> 4],
+                         kHex[*p & 0xF]};
+            out.append(u, sizeof(u));
+        } else {
+            char e[2] = {'\\', esc};
+            out.append(e, sizeof(e));
+        }
+    }
+    out.append(run, end);
+    out.push_back('"');
+}
+
+void JsonUtil::Write(const Json::Value& json, std::string& out) {
+    switch (json.type()) {
+        case Json::nullValue:
+            out.append("null");
+            break;
+        case Json::intValue:
+            AppendNumber(out, json.asLargestInt());
+            break;
+        case Json::uintValue:
+            AppendNumber(out, json.asLargestUInt());
+            break;
+        case Json::realValue:
+            AppendDouble(out, json.asDouble());
+            break;
+        case Json::stringValue: {
+            const char* b = nullptr;
+            const char* e = nullptr;
+            json.getString(&b, &e);
+            WriteString(b, e - b, out);
+            break;
+        }
+        case Json::booleanValue:
+            out.append(json.asBool() ? "true" : "false");
+            break;
+        case Json::arrayValue: {
+            out.push_back('[');
+            Json::ArrayIndex n = json.size();
+            for (Json::ArrayIndex i = 0; i < n; ++i) {
+                if (i) {
+                    out.push_back(',');
+                }
+                Write(json[i], out);
+            }
+            out.push_back(']');
+            break;
+        }
+        case Json::objectValue: {
+            out.push_back('{');
+            bool first = true;
+            for (auto it = json.begin(); it != json.end(); ++it) {
+                if (!first) {
+                    out.push_back(',');
+                }
+                first = false;
+                const char* ke = nullptr;
+                const char* kb = it.memberName(&ke);
+                WriteString(kb, ke - kb, out);
+                out.push_back(':');
+                Write(*it, out);
+            }
+            out.push_back('}');
+            break;
+        }
+    }
 }
 
 }  // namespace IM
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+#include "db/redis.hpp"
+#include "io/iomanager.hpp"
+
+// Redis 客户端往返延迟对比（如 fox_redis vs co_redis）
+// 用法：test_co_redis [config_dir] [coroutines] [requests] name1 [name2 ...]
+// 说明：对每个 redis.config 实例，在 2 线程 IOManager 上启动 coroutines 个协程，
+// 每个协程顺序执行 requests 次 PING，输出总吞吐与平均单次往返耗时。
+
+static auto g_logger = IM_LOG_ROOT();
+
+static void Bench(const std::string& name, size_t coroutines, size_t requests) {
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> total_us{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        IM::IOManager iom(2, false, "redis_bench");
+        for (size_t i = 0; i < coroutines; ++i) {
+            iom.schedule([&]() {
+                for (size_t j = 0; j < requests; ++j) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    auto r = IM::RedisUtil::Cmd(name, "PING");
+                    total_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                                    std::chrono::steady_clock::now() - t0)
+                                    .count();
+                    if (!r) {
+                        ++failed;
+                    }
+                }
+            });
+        }
+        iom.stop();
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    size_t n = coroutines * requests;
+    std::cout << std::left << std::setw(16) << name << std::setw(10) << n << std::setw(8)
+              << failed << std::setw(14) << ms << std::setw(12) << std::fixed
+              << std::setprecision(1) << (ms > 0 ? n * 1000.0 / ms : 0) << (n ? total_us / n : 0)
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        std::cout << "usage: " << argv[0] << " config_dir coroutines requests name1 [name2 ...]"
+                  << std::endl;
+        return 1;
+    }
+    IM::Config::LoadFromConfigDir(argv[1]);
+    size_t coroutines = std::stoull(argv[2]);
+    size_t requests = std::stoull(argv[3]);
+
+    std::cout << std::left << std::setw(16) << "redis" << std::setw(10) << "requests"
+              << std::setw(8) << "failed" << std::setw(14) << "duration_ms" << std::setw(12)
+              << "req/s" << "avg_us" << std::endl;
+    for (int i = 4; i < argc; ++i) {
+        Bench(argv[i], coroutines, requests);
+    }
+    return 0;
+}
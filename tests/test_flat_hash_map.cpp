@@ -0,0 +1,330 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ds/flat_hash_map.hpp"
+#include "ds/hash_map.hpp"
+
+// FlatHashMap / ConcurrentFlatHashMap：与 std::unordered_map 对拍，seqlock 读的一致性，
+// 以及与 HashMap、std::unordered_map 的性能对比
+// 用法：test_flat_hash_map [keys] [threads]
+// 说明：并发基准为 95% get + 5% set，线程数从 1 翻倍到 threads。
+
+using IM::ds::ConcurrentFlatHashMap;
+using IM::ds::FlatHashMap;
+
+static void TestRandomOps() {
+    std::mt19937_64 rng(7);
+    FlatHashMap<uint64_t, uint64_t> m;
+    std::unordered_map<uint64_t, uint64_t> ref;
+    // 键空间小、删除比例高，覆盖删除标记与原容量重建
+    for (int i = 0; i < 400000; ++i) {
+        uint64_t k = rng() % 5000;
+        switch (rng() % 4) {
+            case 0:
+            case 1: {
+                bool inserted = m.set(k, i);
+                assert(inserted == (ref.find(k) == ref.end()));
+                ref[k] = i;
+                break;
+            }
+            case 2: {
+                bool ok = m.del(k);
+                assert(ok == (ref.erase(k) == 1));
+                break;
+            }
+            default: {
+                uint64_t v = 0;
+                bool ok = m.get(k, v);
+                auto it = ref.find(k);
+                assert(ok == (it != ref.end()) && (!ok || v == it->second));
+            }
+        }
+    }
+    assert(m.getTotal() == ref.size());
+    size_t n = 0;
+    m.rforeach([&](const uint64_t& k, const uint64_t& v) {
+        assert(ref.at(k) == v);
+        ++n;
+        return true;
+    });
+    assert(n == ref.size());
+
+    FlatHashMap<std::string, std::string> s;
+    for (int i = 0; i < 10000; ++i) {
+        s["session:" + std::to_string(i)] = std::to_string(i);
+    }
+    for (int i = 0; i < 10000; i += 2) {
+        bool ok = s.del("session:" + std::to_string(i));
+        assert(ok);
+    }
+    std::string v;
+    bool ok = s.get("session:9999", v) && v == "9999" && !s.exists("session:0");
+    assert(ok && s.getTotal() == 5000);
+    s.clear();
+    assert(s.getTotal() == 0 && !s.exists("session:9999"));
+    std::cout << "random ops: ok" << std::endl;
+}
+
+// 值的两个字段互为取反，读者若读到写了一半的值即可发现
+struct Val {
+    uint64_t a;
+    uint64_t b;
+};
+
+static void TestConcurrent() {
+    ConcurrentFlatHashMap<uint64_t, Val> m(4);
+    const uint64_t keys = 20000;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&, r]() {
+            std::mt19937_64 rng(r);
+            uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                Val v;
+                if (m.get(rng() % keys, v)) {
+                    assert(v.b == ~v.a);
+                }
+                ++n;
+            }
+            reads += n;
+        });
+    }
+    // 写者从小容量开始插入（触发多次扩容），再反复覆盖与删除
+    std::mt19937_64 rng(99);
+    for (uint64_t round = 0; round < 20; ++round) {
+        for (uint64_t k = 0; k < keys; ++k) {
+            uint64_t a = rng();
+            m.set(k, Val{a, ~a});
+        }
+        for (uint64_t k = round % 3; k < keys; k += 3) {
+            m.del(k);
+        }
+    }
+    stop = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+    uint64_t total = 0;
+    m.rforeach([&total](const uint64_t&, const Val& v) {
+        assert(v.b == ~v.a);
+        ++total;
+        return true;
+    });
+    assert(total == m.getTotal());
+
+    // 非平凡类型走分片读锁
+    ConcurrentFlatHashMap<std::string, std::string> s;
+    static_assert(!decltype(s)::kOptimistic, "string map must lock");
+    std::thread w([&s]() {
+        for (int i = 0; i < 20000; ++i) {
+            s.set(std::to_string(i % 1000), std::string(i % 64, 'x'));
+        }
+    });
+    for (int i = 0; i < 20000; ++i) {
+        std::string v;
+        if (s.get(std::to_string(i % 1000), v)) {
+            assert(v.find_first_not_of('x') == std::string::npos);
+        }
+    }
+    w.join();
+    assert(s.getTotal() == 1000);
+    std::cout << "concurrent: ok, reads=" << reads << " ";
+    m.dump(std::cout);
+}
+
+static double Mops(uint64_t ops, std::chrono::steady_clock::time_point start) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    return us ? ops * 1.0 / us : 0;
+}
+
+template <class Set, class Get>
+static void BenchSingle(const char* name, const std::vector<uint64_t>& keys, Set&& set,
+                        Get&& get) {
+    auto start = std::chrono::steady_clock::now();
+    for (auto k : keys) {
+        set(k);
+    }
+    double insert = Mops(keys.size(), start);
+    uint64_t found = 0;
+    start = std::chrono::steady_clock::now();
+    for (auto k : keys) {
+        found += get(k);
+    }
+    double hit = Mops(keys.size(), start);
+    start = std::chrono::steady_clock::now();
+    for (auto k : keys) {
+        found += get(k + 1);  // 键均为偶数，+1 必不命中
+    }
+    double miss = Mops(keys.size(), start);
+    assert(found == keys.size());
+    std::cout << "  " << name << ": insert " << insert << " hit " << hit << " miss " << miss
+              << " Mops/s" << std::endl;
+}
+
+static void RunSingleBench(size_t n) {
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> keys(n);
+    for (auto& k : keys) {
+        k = rng() & ~1ULL;
+    }
+    std::cout << "single thread, " << n << " uint64 keys" << std::endl;
+    {
+        IM::ds::HashMap<uint64_t, uint64_t> m(n);
+        BenchSingle(
+            "HashMap", keys, [&](uint64_t k) { m.set(k, k); },
+            [&](uint64_t k) {
+                uint64_t v;
+                return m.get(k, v);
+            });
+    }
+    {
+        std::unordered_map<uint64_t, uint64_t> m;
+        BenchSingle(
+            "unordered_map", keys, [&](uint64_t k) { m[k] = k; },
+            [&](uint64_t k) { return m.find(k) != m.end(); });
+    }
+    {
+        FlatHashMap<uint64_t, uint64_t> m;
+        BenchSingle(
+            "FlatHashMap", keys, [&](uint64_t k) { m.set(k, k); },
+            [&](uint64_t k) { return m.find(k) != nullptr; });
+    }
+    {
+        ConcurrentFlatHashMap<uint64_t, uint64_t> m;
+        BenchSingle(
+            "ConcurrentFlatHashMap", keys, [&](uint64_t k) { m.set(k, k); },
+            [&](uint64_t k) {
+                uint64_t v;
+                return m.get(k, v);
+            });
+    }
+
+    // 字符串键（会话ID 等）
+    std::vector<std::string> skeys;
+    for (size_t i = 0; i < n / 4; ++i) {
+        skeys.push_back("sid:" + std::to_string(keys[i]));
+    }
+    auto bench_str = [&skeys](const char* name, auto& m, auto&& find) {
+        auto start = std::chrono::steady_clock::now();
+        for (auto& k : skeys) {
+            m[k] = 1;
+        }
+        double insert = Mops(skeys.size(), start);
+        uint64_t found = 0;
+        start = std::chrono::steady_clock::now();
+        for (auto& k : skeys) {
+            found += find(m, k);
+        }
+        double hit = Mops(skeys.size(), start);
+        assert(found == skeys.size());
+        std::cout << "  " << name << " string: insert " << insert << " hit " << hit << " Mops/s"
+                  << std::endl;
+    };
+    std::unordered_map<std::string, uint64_t> um;
+    bench_str("unordered_map", um, [](auto& m, const std::string& k) { return m.count(k); });
+    FlatHashMap<std::string, uint64_t> fm;
+    bench_str("FlatHashMap", fm, [](auto& m, const std::string& k) { return m.exists(k); });
+}
+
+// 读多写少：每个线程 95% get、5% set
+template <class Map>
+static double RunMixed(Map& m, const std::vector<uint64_t>& keys, int threads, uint64_t ops) {
+    std::vector<std::thread> ts;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        ts.emplace_back([&, t]() {
+            std::mt19937_64 rng(t);
+            uint64_t sink = 0;
+            for (uint64_t i = 0; i < ops; ++i) {
+                uint64_t r = rng();
+                uint64_t k = keys[r % keys.size()];
+                if ((r >> 48) % 100 < 5) {
+                    m.set(k, r);
+                } else {
+                    sink += m.get(k);
+                }
+            }
+            assert(sink > 0);
+        });
+    }
+    for (auto& t : ts) {
+        t.join();
+    }
+    return Mops(ops * threads, start);
+}
+
+static void RunConcurrentBench(size_t n, int max_threads) {
+    std::mt19937_64 rng(2);
+    std::vector<uint64_t> keys(n);
+    for (auto& k : keys) {
+        k = rng();
+    }
+    // 统一 get/set 接口
+    struct Old {
+        IM::ds::HashMap<uint64_t, uint64_t> m;
+        Old(size_t n) : m(n) {}
+        void set(uint64_t k, uint64_t v) { m.set(k, v); }
+        bool get(uint64_t k) {
+            uint64_t v;
+            return m.get(k, v);
+        }
+    };
+    struct Locked {
+        IM::RWMutex mutex;
+        std::unordered_map<uint64_t, uint64_t> m;
+        void set(uint64_t k, uint64_t v) {
+            IM::RWMutex::WriteLock lock(mutex);
+            m[k] = v;
+        }
+        bool get(uint64_t k) {
+            IM::RWMutex::ReadLock lock(mutex);
+            return m.find(k) != m.end();
+        }
+    };
+    struct Flat {
+        ConcurrentFlatHashMap<uint64_t, uint64_t> m;
+        void set(uint64_t k, uint64_t v) { m.set(k, v); }
+        bool get(uint64_t k) {
+            uint64_t v;
+            return m.get(k, v);
+        }
+    };
+    Old old(n);
+    Locked locked;
+    Flat flat;
+    for (auto k : keys) {
+        old.set(k, k);
+        locked.set(k, k);
+        flat.set(k, k);
+    }
+    const uint64_t ops = 2000000;
+    std::cout << "read-mostly (95% get), " << n << " keys, hardware threads "
+              << std::thread::hardware_concurrency() << std::endl;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        std::cout << "  threads=" << t << ": HashMap " << RunMixed(old, keys, t, ops)
+                  << " unordered_map+RWMutex " << RunMixed(locked, keys, t, ops)
+                  << " ConcurrentFlatHashMap " << RunMixed(flat, keys, t, ops) << " Mops/s"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t keys = argc > 1 ? std::stoull(argv[1]) : 1000000;
+    int threads = argc > 2 ? std::stoi(argv[2]) : 8;
+    TestRandomOps();
+    TestConcurrent();
+    RunSingleBench(keys);
+    RunConcurrentBench(keys, threads);
+    return 0;
+}
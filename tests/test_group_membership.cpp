@@ -0,0 +1,231 @@
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "app/group_membership.hpp"
+
+// 群成员位图缓存：正确性校验 + 群消息扇出开销对比
+// 用法：test_group_membership [members] [online_users] [rounds]
+// 说明：扇出对比两种方式求“群成员 ∩ 本节点在线用户”：
+// - list：逐条取成员列表（相当于 listUsersByTalkId 的结果）逐个查在线哈希表；
+// - bitmap：GroupMembership 取成员位图后与在线位图求交。
+// 不含数据库往返，仅比较内存中的集合运算开销。
+
+using IM::app::GroupMembership;
+
+struct FakeGroup {
+    IM::dao::GroupState state;
+    std::vector<IM::dao::GroupMemberItem> members;
+};
+
+static std::unordered_map<uint64_t, FakeGroup> s_groups;
+static size_t s_loads = 0;
+
+static bool FakeLoader(const uint64_t group_id, IM::dao::GroupState& state,
+                       std::vector<IM::dao::GroupMemberItem>& members, std::string* err) {
+    ++s_loads;
+    auto it = s_groups.find(group_id);
+    if (it == s_groups.end()) {
+        state = IM::dao::GroupState();
+        return true;
+    }
+    state = it->second.state;
+    members = it->second.members;
+    return true;
+}
+
+static void AddMember(FakeGroup& g, uint64_t uid, uint8_t role, std::time_t until = 0) {
+    IM::dao::GroupMemberItem item;
+    item.user_id = uid;
+    item.role = role;
+    item.no_speak_until = until;
+    g.members.push_back(item);
+}
+
+static void TestMembership() {
+    const std::time_t now = time(0);
+    FakeGroup g;
+    g.state.id = 1;
+    g.state.leader_id = 10;
+    AddMember(g, 10, 3);
+    AddMember(g, 11, 2);
+    AddMember(g, 12, 1);
+    AddMember(g, 13, 1, now + 3600);  // 禁言中
+    AddMember(g, 14, 1, now - 10);    // 禁言已过期
+    s_groups[1] = g;
+
+    FakeGroup dismissed;
+    dismissed.state.id = 2;
+    dismissed.state.is_dismissed = 1;
+    s_groups[2] = dismissed;
+
+    GroupMembership::Options opts;
+    opts.max_groups = 16;
+    opts.ttl = 0;
+    GroupMembership gm(opts, FakeLoader);
+
+    uint8_t role = 0;
+    bool ok = gm.getRole(1, 10, role);
+    assert(ok && role == GroupMembership::kRoleLeader);
+    ok = gm.getRole(1, 11, role);
+    assert(ok && role == GroupMembership::kRoleAdmin);
+    ok = gm.getRole(1, 12, role);
+    assert(ok && role == GroupMembership::kRoleMember);
+    ok = gm.getRole(1, 99, role);
+    assert(ok && role == GroupMembership::kRoleNone);
+    assert(s_loads == 1);  // 懒装载一次后命中缓存
+
+    ok = gm.checkSpeak(1, 12).ok && gm.checkSpeak(1, 14).ok &&
+         gm.checkSpeak(1, 13).code == 403 && gm.checkSpeak(1, 99).code == 403 &&
+         gm.checkSpeak(2, 10).code == 404 && gm.checkSpeak(3, 10).code == 404;
+    assert(ok);
+
+    IM::ds::RoaringBitmap bm;
+    std::vector<uint32_t> ids;
+    ok = gm.getMembers(1, bm);
+    bm.listPosAsc(ids);
+    assert(ok && (ids == std::vector<uint32_t>{10, 11, 12, 13, 14}));
+    ok = gm.getSpeakers(1, bm);
+    ids.clear();
+    bm.listPosAsc(ids);
+    assert(ok && (ids == std::vector<uint32_t>{10, 11, 12, 14}));
+
+    // 成员变更
+    gm.onJoin(1, {15, 12});
+    gm.onLeave(1, {11});
+    ok = gm.getRole(1, 15, role);
+    assert(ok && role == GroupMembership::kRoleMember);
+    ok = gm.getRole(1, 11, role);
+    assert(ok && role == GroupMembership::kRoleNone);
+    gm.onRole(1, 15, GroupMembership::kRoleAdmin);
+    ok = gm.getRole(1, 15, role);
+    assert(ok && role == GroupMembership::kRoleAdmin);
+
+    // 禁言/解除/到期
+    gm.onNoSpeak(1, 12, now + 60);
+    ok = gm.checkSpeak(1, 12).code == 403;
+    gm.onNoSpeak(1, 12, 0);
+    ok = ok && gm.checkSpeak(1, 12).ok;
+    gm.onNoSpeak(1, 13, now - 1);
+    ok = ok && gm.checkSpeak(1, 13).ok;
+    assert(ok);
+
+    // 全员禁言：仅管理员与群主可发言
+    gm.onMute(1, true);
+    ok = gm.checkSpeak(1, 12).code == 403 && gm.checkSpeak(1, 15).ok && gm.checkSpeak(1, 10).ok &&
+         gm.getSpeakers(1, bm);
+    ids.clear();
+    bm.listPosAsc(ids);
+    assert(ok && (ids == std::vector<uint32_t>{10, 15}));
+    gm.onMute(1, false);
+
+    // 未缓存的群忽略变更；失效后重新装载
+    gm.onJoin(5, {1});
+    assert(gm.getGroupCount() == 3);
+    size_t loads = s_loads;
+    gm.invalidate(1);
+    ok = gm.getRole(1, 15, role);
+    assert(ok && role == GroupMembership::kRoleNone);
+    assert(s_loads == loads + 1);
+
+    // 全部失效（跨节点通知可能丢失时）：之后的访问重新装载
+    gm.invalidateAll();
+    assert(gm.getGroupCount() == 0);
+    ok = gm.getRole(1, 10, role);
+    assert(ok && role == GroupMembership::kRoleLeader && s_loads == loads + 2);
+
+    // 超出 uint32 的用户ID无法用位图表示，装载失败由调用方回退
+    FakeGroup wide;
+    wide.state.id = 6;
+    AddMember(wide, 1ull << 40, 1);
+    s_groups[6] = wide;
+    ok = !gm.getRole(6, 1, role) && gm.checkSpeak(6, 1).code == 500;
+    assert(ok);
+
+    // LRU：超出上限后淘汰最久未访问的群
+    GroupMembership::Options small;
+    small.max_groups = 16;  // 每分片 1 个
+    GroupMembership lru(small, FakeLoader);
+    ok = lru.getRole(1, 10, role) && lru.getRole(17, 10, role);
+    assert(ok && lru.getGroupCount() == 1);
+    std::cout << "membership: ok" << std::endl;
+}
+
+static void Bench(size_t members, size_t online_users, size_t rounds) {
+    std::mt19937_64 rng(42);
+    const uint64_t user_space = std::max<uint64_t>(members, online_users) * 4;
+    FakeGroup g;
+    g.state.id = 100;
+    g.state.leader_id = 1;
+    std::unordered_set<uint64_t> seen;
+    while (g.members.size() < members) {
+        uint64_t uid = 1 + rng() % user_space;
+        if (seen.insert(uid).second) {
+            AddMember(g, uid, g.members.empty() ? 3 : 1);
+        }
+    }
+    s_groups[100] = g;
+
+    std::unordered_set<uint64_t> online_set;
+    IM::ds::RoaringBitmap online_bm;
+    while (online_set.size() < online_users) {
+        uint64_t uid = 1 + rng() % user_space;
+        if (online_set.insert(uid).second) {
+            online_bm.set(static_cast<uint32_t>(uid), true);
+        }
+    }
+
+    GroupMembership gm(GroupMembership::Options(), FakeLoader);
+    IM::ds::RoaringBitmap warm;
+    gm.getMembers(100, warm);
+
+    std::vector<uint64_t> list;
+    for (auto& m : g.members) {
+        list.push_back(m.user_id);
+    }
+
+    std::cout << std::left << std::setw(10) << "method" << std::setw(10) << "members"
+              << std::setw(10) << "online" << std::setw(10) << "targets" << "ns/fanout"
+              << std::endl;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        // 与原实现一致：每条消息拿到一份成员ID列表后逐个判断是否在线
+        std::vector<uint64_t> copy = list;
+        hits = 0;
+        for (auto uid : copy) {
+            hits += online_set.count(uid);
+        }
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << std::setw(10) << "list" << std::setw(10) << members << std::setw(10)
+              << online_users << std::setw(10) << hits << ns / (long long)rounds << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        IM::ds::RoaringBitmap targets;
+        gm.getMembers(100, targets);
+        targets &= online_bm;
+        hits = targets.getCount();
+    }
+    ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                              start)
+             .count();
+    std::cout << std::setw(10) << "bitmap" << std::setw(10) << members << std::setw(10)
+              << online_users << std::setw(10) << hits << ns / (long long)rounds << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t members = argc > 1 ? std::stoull(argv[1]) : 2000;
+    size_t online = argc > 2 ? std::stoull(argv[2]) : 50000;
+    size_t rounds = argc > 3 ? std::stoull(argv[3]) : 2000;
+    TestMembership();
+    Bench(members, online, rounds);
+    return 0;
+}
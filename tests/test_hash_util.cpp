@@ -0,0 +1,318 @@
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "util/hash_util.hpp"
+
+// hash_util 向量化内核：与逐字节参考实现比对结果，并做微基准对比
+// 用法：test_hash_util [size_kb] [rounds]
+// 说明：IM_HASH_SIMD=scalar|sse4.1 可限制内核级别以覆盖各条路径；
+// 基准中 "legacy" 为改造前的实现（双 32 位 murmur3、逐字节 hex/base64、rand()）。
+
+namespace legacy {
+
+uint64_t murmur3_hash64(const void* str, uint32_t size, uint32_t seed = 1060627423,
+                        uint32_t seed2 = 1050126127) {
+    return ((uint64_t)IM::murmur3_hash(str, size, seed)) << 32 | IM::murmur3_hash(str, size, seed2);
+}
+
+std::string base64encode(const void* data, size_t len) {
+    const char* base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string ret;
+    ret.reserve(len * 4 / 3 + 2);
+    const unsigned char* ptr = (const unsigned char*)data;
+    const unsigned char* end = ptr + len;
+    while (ptr < end) {
+        unsigned int packed = 0;
+        int i = 0;
+        int padding = 0;
+        for (; i < 3 && ptr < end; ++i, ++ptr) {
+            packed = (packed << 8) | *ptr;
+        }
+        if (i == 2) {
+            padding = 1;
+        } else if (i == 1) {
+            padding = 2;
+        }
+        for (; i < 3; ++i) {
+            packed <<= 8;
+        }
+        ret.append(1, base64[packed >> 18]);
+        ret.append(1, base64[(packed >> 12) & 0x3f]);
+        if (padding != 2) {
+            ret.append(1, base64[(packed >> 6) & 0x3f]);
+        }
+        if (padding == 0) {
+            ret.append(1, base64[packed & 0x3f]);
+        }
+        ret.append(padding, '=');
+    }
+    return ret;
+}
+
+std::string base64decode(const std::string& src) {
+    std::string result;
+    result.resize(src.size() * 3 / 4);
+    char* writeBuf = &result[0];
+    const char* ptr = src.c_str();
+    const char* end = ptr + src.size();
+    while (ptr < end) {
+        int i = 0;
+        int padding = 0;
+        int packed = 0;
+        for (; i < 4 && ptr < end; ++i, ++ptr) {
+            if (*ptr == '=') {
+                ++padding;
+                packed <<= 6;
+                continue;
+            }
+            if (padding > 0) {
+                return "";
+            }
+            int val = 0;
+            if (*ptr >= 'A' && *ptr <= 'Z') {
+                val = *ptr - 'A';
+            } else if (*ptr >= 'a' && *ptr <= 'z') {
+                val = *ptr - 'a' + 26;
+            } else if (*ptr >= '0' && *ptr <= '9') {
+                val = *ptr - '0' + 52;
+            } else if (*ptr == '+') {
+                val = 62;
+            } else if (*ptr == '/') {
+                val = 63;
+            } else {
+                return "";
+            }
+            packed = (packed << 6) | val;
+        }
+        if (i != 4 || (padding > 0 && ptr != end) || padding > 2) {
+            return "";
+        }
+        *writeBuf++ = (char)((packed >> 16) & 0xff);
+        if (padding != 2) {
+            *writeBuf++ = (char)((packed >> 8) & 0xff);
+        }
+        if (padding == 0) {
+            *writeBuf++ = (char)(packed & 0xff);
+        }
+    }
+    result.resize(writeBuf - result.c_str());
+    return result;
+}
+
+std::string hexstring_from_data(const std::string& data) {
+    std::string out(data.size() * 2, '\0');
+    for (size_t i = 0; i < data.size(); ++i) {
+        static const char* s_hex = "0123456789abcdef";
+        out[i * 2] = s_hex[(uint8_t)data[i] >> 4];
+        out[i * 2 + 1] = s_hex[(uint8_t)data[i] & 0xf];
+    }
+    return out;
+}
+
+// 解析失败返回 false（对应新实现抛出 std::invalid_argument）
+bool data_from_hexstring(const std::string& hex, std::string& out) {
+    if (hex.size() % 2) {
+        return false;
+    }
+    auto nibble = [](char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    out.resize(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = nibble(hex[i]);
+        int lo = nibble(hex[i + 1]);
+        if (hi < 0 || lo < 0) {
+            return false;
+        }
+        out[i / 2] = (char)(hi << 4 | lo);
+    }
+    return true;
+}
+
+std::string random_string(size_t len, const std::string& chars) {
+    std::string rt(len, '\0');
+    for (size_t i = 0; i < len; ++i) {
+        rt[i] = chars[rand() % chars.size()];
+    }
+    return rt;
+}
+
+}  // namespace legacy
+
+static std::mt19937_64 s_rng(20261019);
+
+static std::string RandomBytes(size_t len) {
+    std::string s(len, '\0');
+    for (auto& c : s) {
+        c = (char)s_rng();
+    }
+    return s;
+}
+
+static void TestMurmur128() {
+    // 参考值来自 MurmurHash3_x64_128 参考实现
+    struct {
+        std::string data;
+        uint32_t seed;
+        uint64_t h1, h2;
+    } cases[] = {
+        {"", 0, 0, 0},
+        {"", 42, 0xf02aa77dfa1b8523ULL, 0xd1016610da11cbb9ULL},
+        {"hello", 0, 0xcbd8a7b341bd9b02ULL, 0x5b1e906a48ae1d19ULL},
+        {"hello", 42, 0xc4b8b3c960af6f08ULL, 0x2334b875b0efbc7aULL},
+        {"The quick brown fox jumps over the lazy dog", 0, 0xe34bbc7bbc071b6cULL,
+         0x7a433ca9c49a9347ULL},
+    };
+    for (auto& c : cases) {
+        uint64_t out[2];
+        IM::murmur3_hash128(c.data.data(), c.data.size(), c.seed, out);
+        assert(out[0] == c.h1 && out[1] == c.h2);
+    }
+    std::string seq;
+    for (int i = 0; i < 31; ++i) {
+        seq.push_back((char)i);
+    }
+    uint64_t out[2];
+    IM::murmur3_hash128(seq.data(), seq.size(), 0, out);
+    assert(out[0] == 0x053dd3e1a32cd094ULL && out[1] == 0x9ee59aefb4005490ULL);
+
+    // 64 位版本：与 const char* 重载一致，不同种子结果不同
+    const char* key = "user:10086";
+    uint64_t h = IM::murmur3_hash64((const void*)key, strlen(key));
+    assert(h == IM::murmur3_hash64(key));
+    assert(h != IM::murmur3_hash64((const void*)key, strlen(key), 1));
+    std::cout << "murmur3_x64_128: ok" << std::endl;
+}
+
+static void TestCodec() {
+    // 覆盖各内核的块边界与尾部
+    for (size_t len = 0; len < 300; ++len) {
+        const std::string data = RandomBytes(len);
+        const std::string hex = IM::hexstring_from_data(data);
+        assert(hex == legacy::hexstring_from_data(data));
+        assert(IM::data_from_hexstring(hex) == data);
+        std::string upper = hex;
+        for (auto& c : upper) {
+            c = (char)toupper(c);
+        }
+        assert(IM::data_from_hexstring(upper) == data);
+
+        const std::string b64 = IM::base64encode(data);
+        assert(b64 == legacy::base64encode(data.data(), data.size()));
+        assert(IM::base64decode(b64) == data);
+    }
+
+    // 非法输入：任意位置替换为非法字符，与参考实现的结果一致
+    const std::string data = RandomBytes(200);
+    const std::string hex = IM::hexstring_from_data(data);
+    const std::string b64 = IM::base64encode(data);
+    const char bad_chars[] = {'g', 'G', ':', '@', '`', '/', ' ', '=', '\0', (char)0x80, (char)0xc6};
+    for (char bad : bad_chars) {
+        for (size_t pos = 0; pos < hex.size(); pos += 7) {
+            std::string h = hex;
+            h[pos] = bad;
+            std::string expect;
+            bool valid = legacy::data_from_hexstring(h, expect);
+            bool thrown = false;
+            std::string got;
+            try {
+                got = IM::data_from_hexstring(h);
+            } catch (const std::invalid_argument&) {
+                thrown = true;
+            }
+            assert(thrown == !valid && (thrown || got == expect));
+        }
+        for (size_t pos = 0; pos < b64.size(); pos += 5) {
+            std::string b = b64;
+            b[pos] = bad;
+            assert(IM::base64decode(b) == legacy::base64decode(b));
+        }
+    }
+    // 填充
+    for (const char* s : {"QQ==", "QUI=", "QUJD", "QQ=A", "Q===", "QUJDRA==QUJD", "QUJ"}) {
+        assert(IM::base64decode(s) == legacy::base64decode(s));
+    }
+    assert(IM::base64decode("").empty() && IM::base64encode("", 0).empty());
+
+    const std::string digits = IM::random_string(1001, "0123456789");
+    assert(digits.size() == 1001 && digits.find_first_not_of("0123456789") == std::string::npos);
+    std::cout << "codec: ok (" << IM::hash_simd_level() << ")" << std::endl;
+}
+
+template <class F>
+static void Bench(const char* name, size_t bytes, size_t rounds, F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; ++r) {
+        f((uint32_t)r);
+    }
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << "  " << name << ": " << (us ? bytes * rounds / us : 0) << " MB/s" << std::endl;
+}
+
+static void RunBench(size_t size_kb, size_t rounds) {
+    const std::string data = RandomBytes(size_kb * 1024);
+    const std::string hex = IM::hexstring_from_data(data);
+    const std::string b64 = IM::base64encode(data);
+    const std::string chars = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    volatile uint64_t sink = 0;
+    std::cout << "bench " << size_kb << "KB x " << rounds << " (" << IM::hash_simd_level() << ")"
+              << std::endl;
+
+    Bench("murmur3_hash64 legacy", data.size(), rounds,
+          [&](uint32_t r) { sink += legacy::murmur3_hash64(data.data(), data.size(), r, ~r); });
+    Bench("murmur3_hash64", data.size(), rounds,
+          [&](uint32_t r) { sink += IM::murmur3_hash64(data.data(), data.size(), r, ~r); });
+    // 短键（ID、用户名等常见场景）
+    const std::string key = "uid:1234567890";
+    Bench("murmur3_hash64 legacy 14B", key.size(), rounds * 4096, [&](uint32_t r) {
+        sink += legacy::murmur3_hash64(key.data(), key.size(), r, ~r);
+    });
+    Bench("murmur3_hash64 14B", key.size(), rounds * 4096,
+          [&](uint32_t r) { sink += IM::murmur3_hash64(key.data(), key.size(), r, ~r); });
+
+    Bench("hex encode legacy", data.size(), rounds,
+          [&](uint32_t) { sink += legacy::hexstring_from_data(data).size(); });
+    Bench("hex encode", data.size(), rounds,
+          [&](uint32_t) { sink += IM::hexstring_from_data(data).size(); });
+    Bench("hex decode legacy", hex.size(), rounds, [&](uint32_t) {
+        std::string out;
+        legacy::data_from_hexstring(hex, out);
+        sink += out.size();
+    });
+    Bench("hex decode", hex.size(), rounds,
+          [&](uint32_t) { sink += IM::data_from_hexstring(hex).size(); });
+
+    Bench("base64 encode legacy", data.size(), rounds,
+          [&](uint32_t) { sink += legacy::base64encode(data.data(), data.size()).size(); });
+    Bench("base64 encode", data.size(), rounds,
+          [&](uint32_t) { sink += IM::base64encode(data).size(); });
+    Bench("base64 decode legacy", b64.size(), rounds,
+          [&](uint32_t) { sink += legacy::base64decode(b64).size(); });
+    Bench("base64 decode", b64.size(), rounds,
+          [&](uint32_t) { sink += IM::base64decode(b64).size(); });
+
+    Bench("random_string legacy", data.size(), rounds,
+          [&](uint32_t) { sink += legacy::random_string(data.size(), chars).size(); });
+    Bench("random_string", data.size(), rounds,
+          [&](uint32_t) { sink += IM::random_string(data.size(), chars).size(); });
+}
+
+int main(int argc, char** argv) {
+    size_t size_kb = argc > 1 ? std::stoull(argv[1]) : 64;
+    size_t rounds = argc > 2 ? std::stoull(argv[2]) : 1000;
+    TestMurmur128();
+    TestCodec();
+    RunBench(size_kb, rounds);
+    return 0;
+}
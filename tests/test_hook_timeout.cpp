@@ -0,0 +1,132 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#include "base/macro.hpp"
+#include "io/iomanager.hpp"
+#include "net/fd_manager.hpp"
+#include "util/time_util.hpp"
+
+// hook IO 超时与内存分配测试
+// 用法：test_hook_timeout [threads] [conns] [rounds]
+// 1. 正确性：每个连接交替进行“超时读”和“有数据读”，检查超时判定与 errno
+// 2. 分配次数：统计数据已就绪的读写、以及需要挂起等待的读各自的 operator new 次数
+
+static std::atomic<uint64_t> g_news{0};
+
+void* operator new(size_t n) {
+    ++g_news;
+    void* p = malloc(n);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static bool MakePair(int sv[2], uint64_t recv_timeout) {
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv)) {
+        return false;
+    }
+    IM::FdMgr::GetInstance()->get(sv[0], true)->setTimeout(SO_RCVTIMEO, recv_timeout);
+    IM::FdMgr::GetInstance()->get(sv[1], true);
+    return true;
+}
+
+static void TestTimeout(size_t threads, size_t conns, size_t rounds) {
+    std::atomic<size_t> reads{0}, timeouts{0};
+    {
+        IM::IOManager iom(threads, false, "timeout");
+        for (size_t k = 0; k < conns; ++k) {
+            iom.schedule([&]() {
+                int sv[2];
+                bool ok = MakePair(sv, 20);
+                assert(ok);
+                int peer = sv[1];
+                for (size_t i = 0; i < rounds; ++i) {
+                    if (i % 2) {
+                        IM::IOManager::GetThis()->addTimer(2, [peer]() { write(peer, "x", 1); });
+                    }
+                    char c;
+                    uint64_t t0 = IM::TimeUtil::NowToMS();
+                    ssize_t n = read(sv[0], &c, 1);
+                    if (n == 1) {
+                        ++reads;
+                    } else {
+                        assert(errno == ETIMEDOUT);
+                        assert(IM::TimeUtil::NowToMS() - t0 >= 19);
+                        ++timeouts;
+                    }
+                }
+                close(sv[0]);
+                close(sv[1]);
+            });
+        }
+        iom.stop();
+    }
+    std::cout << "timeout: reads=" << reads << " timeouts=" << timeouts << std::endl;
+    assert(reads == conns * rounds / 2);
+    assert(timeouts == conns * rounds - conns * rounds / 2);
+}
+
+static void TestAllocs(size_t rounds) {
+    IM::IOManager iom(1, false, "allocs");
+    iom.schedule([rounds]() {
+        int sv[2];
+        bool ok = MakePair(sv, 1000);
+        assert(ok);
+        char c;
+        // 预热：首次等待会创建该 fd 的复用定时器
+        IM::IOManager::GetThis()->schedule([&sv]() { write(sv[1], "x", 1); });
+        read(sv[0], &c, 1);
+
+        uint64_t base = g_news;
+        for (size_t i = 0; i < rounds; ++i) {
+            write(sv[1], "x", 1);
+            read(sv[0], &c, 1);
+        }
+        double ready = double(g_news - base) / rounds / 2;
+
+        // 挂起等待：对端写入由定时器回调完成，回调本身的分配另行扣除
+        base = g_news;
+        int peer = sv[1];
+        auto writer = [peer]() { write(peer, "x", 1); };
+        uint64_t cb_news = 0;
+        for (size_t i = 0; i < rounds; ++i) {
+            uint64_t t = g_news;
+            IM::IOManager::GetThis()->schedule(writer);
+            cb_news += g_news - t;
+            read(sv[0], &c, 1);
+        }
+        double wait = double(g_news - base - cb_news) / rounds;
+
+        std::cout << "allocs per op: ready=" << ready << " wait=" << wait << std::endl;
+        close(sv[0]);
+        close(sv[1]);
+    });
+    iom.stop();
+}
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::stoull(argv[1]) : 2;
+    size_t conns = argc > 2 ? std::stoull(argv[2]) : 20;
+    size_t rounds = argc > 3 ? std::stoull(argv[3]) : 50;
+    IM_LOG_NAME("system")->setLevel(IM::Level::ERROR);
+
+    TestTimeout(threads, conns, rounds);
+    TestAllocs(1000);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#include <fnmatch.h>
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macro.hpp"
+#include "http/http_servlet.hpp"
+#include "io/lock.hpp"
+
+// 路由匹配基准：基数树路由（ServletDispatch）vs 旧实现（读锁 + unordered_map + fnmatch 线性扫描）
+// 用法：test_http_router [threads] [lookups_per_thread]
+// 路由集合取自 src/api 下注册的 /api/v1/* 接口，另加 /wss/* 通配与一个带路径参数的路由。
+
+static const char* kRoutes[] = {
+    "/api/v1/article-annex/delete", "/api/v1/article-annex/forever-delete",
+    "/api/v1/article-annex/recover", "/api/v1/article-annex/recover-list",
+    "/api/v1/article/asterisk", "/api/v1/article/classify/delete",
+    "/api/v1/article/classify/edit", "/api/v1/article/classify/list",
+    "/api/v1/article/classify/sort", "/api/v1/article/delete", "/api/v1/article/detail",
+    "/api/v1/article/editor", "/api/v1/article/forever-delete", "/api/v1/article/list",
+    "/api/v1/article/move", "/api/v1/article/recover", "/api/v1/article/recover-list",
+    "/api/v1/article/tags", "/api/v1/auth/forget", "/api/v1/auth/login", "/api/v1/auth/oauth",
+    "/api/v1/auth/oauth/bind", "/api/v1/auth/oauth/login", "/api/v1/auth/register",
+    "/api/v1/common/send-email", "/api/v1/common/send-sms", "/api/v1/common/send-test",
+    "/api/v1/contact-apply/accept", "/api/v1/contact-apply/create",
+    "/api/v1/contact-apply/decline", "/api/v1/contact-apply/list",
+    "/api/v1/contact-apply/unread-num", "/api/v1/contact-group/list",
+    "/api/v1/contact-group/save", "/api/v1/contact/change-group", "/api/v1/contact/delete",
+    "/api/v1/contact/detail", "/api/v1/contact/edit-remark", "/api/v1/contact/list",
+    "/api/v1/contact/online-status", "/api/v1/contact/search",
+    "/api/v1/emoticon/customize/create", "/api/v1/emoticon/customize/delete",
+    "/api/v1/emoticon/customize/list", "/api/v1/group-apply/agree", "/api/v1/group-apply/all",
+    "/api/v1/group-apply/create", "/api/v1/group-apply/decline", "/api/v1/group-apply/delete",
+    "/api/v1/group-apply/list", "/api/v1/group-apply/unread-num", "/api/v1/group-notice/edit",
+    "/api/v1/group-vote/create", "/api/v1/group-vote/detail", "/api/v1/group-vote/submit",
+    "/api/v1/group/assign-admin", "/api/v1/group/create", "/api/v1/group/detail",
+    "/api/v1/group/dismiss", "/api/v1/group/get-invite-friends", "/api/v1/group/handover",
+    "/api/v1/group/invite", "/api/v1/group/list", "/api/v1/group/member-list",
+    "/api/v1/group/mute", "/api/v1/group/no-speak", "/api/v1/group/overt",
+    "/api/v1/group/overt-list", "/api/v1/group/remark-update", "/api/v1/group/remove-member",
+    "/api/v1/group/secede", "/api/v1/group/setting", "/api/v1/message/delete",
+    "/api/v1/message/forward-records", "/api/v1/message/history-records",
+    "/api/v1/message/records", "/api/v1/message/revoke", "/api/v1/message/send",
+    "/api/v1/message/status", "/api/v1/organize/department-list",
+    "/api/v1/organize/personnel-list", "/api/v1/talk/session-clear-records",
+    "/api/v1/talk/session-clear-unread-num", "/api/v1/talk/session-create",
+    "/api/v1/talk/session-delete", "/api/v1/talk/session-disturb", "/api/v1/talk/session-list",
+    "/api/v1/talk/session-top", "/api/v1/user/detail", "/api/v1/user/detail-update",
+    "/api/v1/user/email-update", "/api/v1/user/mobile-update", "/api/v1/user/password-update",
+    "/api/v1/user/setting", "/api/v1/user/setting/save", "/_/status", "/_/config"};
+
+// 旧实现：读锁 + 精确匹配 + fnmatch 线性扫描
+class LegacyDispatch {
+   public:
+    void add(const std::string& uri, IM::http::Servlet::ptr slt) { m_datas[uri] = slt; }
+    void addGlob(const std::string& uri, IM::http::Servlet::ptr slt) {
+        m_globs.emplace_back(uri, slt);
+    }
+    IM::http::Servlet::ptr match(const std::string& uri) {
+        IM::RWMutex::ReadLock lock(m_mutex);
+        auto it = m_datas.find(uri);
+        if (it != m_datas.end()) {
+            return it->second;
+        }
+        for (auto& i : m_globs) {
+            if (!fnmatch(i.first.c_str(), uri.c_str(), 0)) {
+                return i.second;
+            }
+        }
+        return nullptr;
+    }
+
+   private:
+    IM::RWMutex m_mutex;
+    std::unordered_map<std::string, IM::http::Servlet::ptr> m_datas;
+    std::vector<std::pair<std::string, IM::http::Servlet::ptr>> m_globs;
+};
+
+static IM::http::FunctionServlet::ptr MakeServlet(int32_t id) {
+    return std::make_shared<IM::http::FunctionServlet>(
+        [id](IM::http::HttpRequest::ptr, IM::http::HttpResponse::ptr,
+             IM::http::HttpSession::ptr) { return id; });
+}
+
+static int32_t Call(IM::http::Servlet::ptr slt) {
+    return slt ? slt->handle(nullptr, nullptr, nullptr) : -1;
+}
+
+template <class Fn>
+static void Bench(const char* name, size_t threads, size_t lookups,
+                  const std::vector<std::string>& paths, Fn fn) {
+    std::atomic<uint64_t> hits{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ts;
+    for (size_t t = 0; t < threads; ++t) {
+        ts.emplace_back([&, t]() {
+            uint64_t h = 0;
+            for (size_t i = 0; i < lookups; ++i) {
+                h += fn(paths[(i + t) % paths.size()]) ? 1 : 0;
+            }
+            hits += h;
+        });
+    }
+    for (auto& t : ts) {
+        t.join();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    uint64_t n = threads * lookups;
+    std::cout << std::left << std::setw(10) << name << std::setw(12) << n << std::setw(12) << hits
+              << std::setw(14) << ns / 1000000 << std::fixed << std::setprecision(1)
+              << (ns > 0 ? n * 1000.0 / ns : 0) << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t threads = argc > 1 ? std::stoull(argv[1]) : 4;
+    size_t lookups = argc > 2 ? std::stoull(argv[2]) : 1000000;
+
+    IM::http::ServletDispatch dispatch;
+    LegacyDispatch legacy;
+    int32_t id = 0;
+    for (auto r : kRoutes) {
+        auto slt = MakeServlet(++id);
+        dispatch.addServlet(r, slt);
+        legacy.add(r, slt);
+    }
+    auto ws = MakeServlet(1000);
+    dispatch.addGlobServlet("/wss/*", ws);
+    legacy.addGlob("/wss/*", ws);
+    dispatch.addRoute(IM::http::HttpMethod::GET, "/api/v1/user/:uid/avatar", MakeServlet(2000));
+    dispatch.addGlobServlet("/static/*.png", MakeServlet(3000));
+
+    // 正确性
+    id = 0;
+    for (auto r : kRoutes) {
+        ++id;
+        assert(Call(dispatch.getMatchedServlet(r)) == id);
+    }
+    assert(Call(dispatch.getMatchedServlet("/wss/default.io")) == 1000);
+    assert(Call(dispatch.getMatchedServlet("/static/a/b.png")) == 3000);
+    assert(dispatch.getMatchedServlet("/api/v1/user/detailx") == dispatch.getDefault());
+    assert(dispatch.getMatchedServlet("/api/v1/nope") == dispatch.getDefault());
+
+    auto req = std::make_shared<IM::http::HttpRequest>();
+    req->setMethod(IM::http::HttpMethod::GET);
+    req->setPath("/api/v1/user/42/avatar");
+    assert(Call(dispatch.getMatchedServlet(req)) == 2000);
+    assert(req->getParam("uid") == "42");
+    req->setMethod(IM::http::HttpMethod::POST);
+    auto slt = dispatch.getMatchedServlet(req);
+    assert(slt && slt != dispatch.getDefault());  // 405
+
+    auto login = dispatch.getServlet("/api/v1/auth/login");
+    dispatch.delServlet("/api/v1/auth/login");
+    assert(dispatch.getMatchedServlet("/api/v1/auth/login") == dispatch.getDefault());
+    dispatch.addServlet("/api/v1/auth/login", login);
+
+    // 基准：全部 /api/v1/* 路由 + 通配命中 + 未命中
+    std::vector<std::string> paths(std::begin(kRoutes), std::end(kRoutes));
+    paths.push_back("/wss/default.io");
+    paths.push_back("/api/v1/unknown/path");
+
+    std::cout << std::left << std::setw(10) << "router" << std::setw(12) << "lookups"
+              << std::setw(12) << "hits" << std::setw(14) << "duration_ms" << "lookups/us"
+              << std::endl;
+    Bench("legacy", threads, lookups, paths,
+          [&](const std::string& p) { return legacy.match(p) != nullptr; });
+    auto def = dispatch.getDefault().get();
+    Bench("radix", threads, lookups, paths,
+          [&](const std::string& p) { return dispatch.getMatchedServlet(p).get() != def; });
+    return 0;
+}
@@ -1,9 +1,26 @@
 #include "base/macro.hpp"
-#include "iomanager.hpp"
+#include "io/iomanager.hpp"
+#include <sys/resource.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 共享 epoll 与分片 reactor 的事件吞吐对比
+// 用法：test_iomanager [conns] [duration_ms] [threads...]
+// 每个连接是一对 socketpair，两端都注册读事件，一个字节在两端之间往返：
+// 读到后写回对端并重新注册读事件。统计每秒处理的读事件数。
+// 另测默认配置（共享 epoll、无线程绑定）下每个事件唤醒的调度线程数：外部线程经 socketpair
+// 投递一个字节，未绑定线程的回调读出后回写，统计调度线程的自愿上下文切换次数。
 
 auto g_logger = IM_LOG_ROOT();
 
@@ -49,8 +66,221 @@ void test_timer()
         true);
 }
 
+namespace {
+struct alignas(64) Counter {
+    std::atomic<uint64_t> v{0};
+};
+
+Counter s_events[64];         // 按线程分散的事件计数，避免计数本身成为争用点
+std::atomic<bool> s_running{false};
+
+void OnReadable(IM::IOManager* iom, int fd) {
+    char buf[16];
+    while (read(fd, buf, sizeof(buf)) > 0);
+    s_events[IM::GetThreadId() % 64].v.fetch_add(1, std::memory_order_relaxed);
+    if (!s_running) {
+        return;
+    }
+    write(fd, "x", 1);
+    iom->addEvent(fd, IM::IOManager::READ, std::bind(OnReadable, iom, fd));
+}
+
+uint64_t TotalEvents() {
+    uint64_t n = 0;
+    for (auto& c : s_events) {
+        n += c.v.exchange(0);
+    }
+    return n;
+}
+
+void Bench(bool sharded, size_t threads, const std::vector<int>& fds, uint64_t duration_ms) {
+    IM::IOManager iom(threads, false, "bench", sharded);
+    // 等各线程进入 idle 占用唤醒器，分片模式下 fd 才能分配到它们的 epoll 上
+    usleep(100 * 1000);
+
+    // addEvent 需在调度线程内调用：按连接分块，由各线程分别注册
+    s_running = true;
+    std::vector<pid_t> tids = iom.getWorkerThreadIds();
+    std::atomic<size_t> registered{0};
+    size_t pairs = fds.size() / 2;
+    for (size_t t = 0; t < tids.size(); ++t) {
+        size_t begin = pairs * t / tids.size() * 2;
+        size_t end = pairs * (t + 1) / tids.size() * 2;
+        iom.schedule(
+            [&iom, &fds, &registered, begin, end]() {
+                for (size_t i = begin; i < end; ++i) {
+                    iom.addEvent(fds[i], IM::IOManager::READ, std::bind(OnReadable, &iom, fds[i]));
+                }
+                ++registered;
+            },
+            tids[t]);
+    }
+    while (registered < tids.size()) {
+        usleep(1000);
+    }
+    TotalEvents();
+    auto start = std::chrono::steady_clock::now();
+    // 每对 socketpair 注入一个字节
+    for (size_t i = 0; i < fds.size(); i += 2) {
+        write(fds[i + 1], "x", 1);
+    }
+    usleep(duration_ms * 1000);
+    uint64_t events = TotalEvents();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+
+    // 停止往返，等在途回调结束后取消剩余的等待，调度器才能退出
+    s_running = false;
+    usleep(100 * 1000);
+    std::atomic<bool> cancelled{false};
+    iom.schedule([&iom, &fds, &cancelled]() {
+        for (int fd : fds) {
+            iom.cancelAll(fd);
+        }
+        cancelled = true;
+    });
+    while (!cancelled) {
+        usleep(1000);
+    }
+    iom.stop();
+
+    // 清空残留的字节
+    char buf[16];
+    for (int fd : fds) {
+        while (read(fd, buf, sizeof(buf)) > 0);
+    }
+
+    std::cout << std::left << std::setw(10) << (sharded ? "sharded" : "shared") << std::setw(10)
+              << threads << std::setw(10) << fds.size() / 2 << std::setw(14) << events
+              << (ms > 0 ? events * 1000 / ms : 0) << std::endl;
+}
+// 调度线程累计的自愿上下文切换次数（每次阻塞后被唤醒计一次）
+uint64_t VoluntarySwitches(const std::vector<pid_t>& tids) {
+    uint64_t total = 0;
+    for (pid_t tid : tids) {
+        std::ifstream ifs("/proc/self/task/" + std::to_string(tid) + "/status");
+        std::string line;
+        while (std::getline(ifs, line)) {
+            if (line.compare(0, 24, "voluntary_ctxt_switches:") == 0) {
+                total += std::stoull(line.substr(24));
+            }
+        }
+    }
+    return total;
+}
+
+void OnPing(IM::IOManager* iom, int fd) {
+    char buf[16];
+    while (read(fd, buf, sizeof(buf)) > 0);
+    if (!s_running) {
+        return;
+    }
+    // 先重新注册再回应：对端收到回应后可能立即 cancelAll，不能留下未取消的事件
+    iom->addEvent(fd, IM::IOManager::READ, std::bind(OnPing, iom, fd));
+    write(fd, "x", 1);
+}
+
+void WakeupBench(size_t threads, size_t rounds) {
+    IM::IOManager iom(threads, false, "wakeup");
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv)) {
+        std::cout << "socketpair failed" << std::endl;
+        return;
+    }
+    s_running = true;
+    std::atomic<bool> registered{false};
+    iom.schedule([&iom, &sv, &registered]() {
+        iom.addEvent(sv[0], IM::IOManager::READ, std::bind(OnPing, &iom, sv[0]));
+        registered = true;
+    });
+    while (!registered) {
+        usleep(1000);
+    }
+    // 等所有线程进入 idle
+    usleep(100 * 1000);
+    std::vector<pid_t> tids = iom.getWorkerThreadIds();
+    uint64_t before = VoluntarySwitches(tids);
+    char c = 'x';
+    for (size_t i = 0; i < rounds; ++i) {
+        write(sv[1], &c, 1);
+        pollfd pfd = {sv[1], POLLIN, 0};
+        while (poll(&pfd, 1, -1) != 1);
+        while (read(sv[1], &c, 1) != 1);
+    }
+    uint64_t switches = VoluntarySwitches(tids) - before;
+
+    s_running = false;
+    std::atomic<bool> cancelled{false};
+    iom.schedule([&iom, &sv, &cancelled]() {
+        iom.cancelAll(sv[0]);
+        cancelled = true;
+    });
+    while (!cancelled) {
+        usleep(1000);
+    }
+    iom.stop();
+    close(sv[0]);
+    close(sv[1]);
+    std::cout << std::left << std::setw(10) << threads << std::setw(10) << rounds
+              << std::setw(14) << switches << std::fixed << std::setprecision(2)
+              << switches * 1.0 / rounds << std::endl;
+}
+}  // namespace
+
 int main(int argc, char **argv)
 {
-    test_timer();
+    size_t conns = argc > 1 ? std::stoull(argv[1]) : 65536;
+    uint64_t duration_ms = argc > 2 ? std::stoull(argv[2]) : 2000;
+    std::vector<size_t> thread_counts;
+    for (int i = 3; i < argc; ++i) {
+        thread_counts.push_back(std::stoull(argv[i]));
+    }
+    if (thread_counts.empty()) {
+        thread_counts = {4, 8, 16, 32};
+    }
+    IM_LOG_NAME("system")->setLevel(IM::Level::ERROR);
+
+    // 每个连接两个 fd，受 RLIMIT_NOFILE 限制时减少连接数
+    rlimit rl;
+    getrlimit(RLIMIT_NOFILE, &rl);
+    rl.rlim_cur = rl.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &rl);
+    size_t max_conns = rl.rlim_cur > 1024 ? (rl.rlim_cur - 1024) / 2 : 1;
+    if (conns > max_conns) {
+        std::cout << "RLIMIT_NOFILE=" << rl.rlim_cur << ", conns reduced to " << max_conns
+                  << std::endl;
+        conns = max_conns;
+    }
+
+    std::vector<int> fds;
+    fds.reserve(conns * 2);
+    for (size_t i = 0; i < conns; ++i) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv)) {
+            std::cout << "socketpair failed after " << i << " conns" << std::endl;
+            break;
+        }
+        fds.push_back(sv[0]);
+        fds.push_back(sv[1]);
+    }
+
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(10) << "threads"
+              << std::setw(10) << "conns" << std::setw(14) << "events" << "events/s"
+              << std::endl;
+    for (size_t threads : thread_counts) {
+        Bench(false, threads, fds, duration_ms);
+        Bench(true, threads, fds, duration_ms);
+    }
+
+    for (int fd : fds) {
+        close(fd);
+    }
+
+    std::cout << std::left << std::setw(10) << "threads" << std::setw(10) << "rounds"
+              << std::setw(14) << "wakeups" << "wakeups/event" << std::endl;
+    for (size_t threads : thread_counts) {
+        WakeupBench(threads, 20000);
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "util/json_util.hpp"
+
+// JSON 编解码：正确性校验 + 每条消息 parse+serialize 开销对比
+// 用法：test_json_util [iterations]
+// 说明：以 SendMessage 中典型的 extra（含中文、转义、数组）为样本，
+// 分别用 CharReaderBuilder/StreamWriterBuilder 与 JsonUtil::Parse/Write 完成一次
+// “解析 -> 修改 -> 写回”，输出每条消息的平均耗时(ns)。
+
+static void TestRoundTrip() {
+    const std::string text =
+        R"({"a":1,"b":-2,"c":18446744073709551615,"d":1.5,"e":"x\"y\\z\n\u00e9\ud83d\ude00",)"
+        R"("f":[true,false,null,{}],"g":{"h":[]},"i":-9223372036854775808,"j":1e400})";
+    Json::Value v;
+    bool ok = IM::JsonUtil::Parse(v, text);
+    assert(ok);
+    assert(v["a"].isInt() && v["a"].asInt() == 1);
+    assert(v["b"].asInt64() == -2);
+    assert(v["c"].isUInt64() && v["c"].asUInt64() == 18446744073709551615ull);
+    assert(v["d"].asDouble() == 1.5);
+    assert(v["e"].asString() == "x\"y\\z\n\xc3\xa9\xf0\x9f\x98\x80");
+    assert(v["f"].size() == 4 && v["f"][2].isNull() && v["f"][3].isObject());
+    assert(v["g"]["h"].isArray());
+    assert(v["i"].asInt64() == INT64_MIN);
+    assert(std::isinf(v["j"].asDouble()));
+
+    // 写出后用 jsoncpp 解析应得到相同的值
+    std::string out = IM::JsonUtil::Write(v);
+    Json::Value v2;
+    Json::CharReaderBuilder rb;
+    std::string errs;
+    std::istringstream in(out);
+    ok = Json::parseFromStream(rb, in, &v2, &errs);
+    assert(ok);
+    v["j"] = Json::Value();  // 非有限值写为 null
+    assert(v == v2);
+
+    const std::string w1 = IM::JsonUtil::Write(Json::Value(2.0));
+    const std::string w2 = IM::JsonUtil::Write(Json::Value("\x01"));
+    assert(w1 == "2.0" && w2 == "\"\\u0001\"");
+
+    const char* bad[] = {"",       "{",          "[1,]",   "{\"a\" 1}", "01",  "1.",
+                         "\"abc",  "\"\\ud800\"", "tru",    "{} x",      "-",   "[1 2]",
+                         "\"\\x\"", "{\"a\":}",   "1e",     "{,}"};
+    for (auto s : bad) {
+        Json::Value t;
+        ok = IM::JsonUtil::Parse(t, s);
+        assert(!ok);
+    }
+    std::cout << "round trip: ok" << std::endl;
+}
+
+static std::string SampleExtra() {
+    Json::Value extra;
+    extra["content"] = "今天下午三点开会，地点：\"3号会议室\"\n请准时参加 :)";
+    extra["msg_ids"] = Json::Value(Json::arrayValue);
+    for (int i = 0; i < 5; ++i) {
+        extra["msg_ids"].append("0195f3c2a7b84c3e9d1f00000000000" + std::to_string(i));
+    }
+    Json::Value records(Json::arrayValue);
+    for (int i = 0; i < 5; ++i) {
+        Json::Value it;
+        it["nickname"] = "用户" + std::to_string(i);
+        it["content"] = "预览内容 " + std::to_string(i);
+        records.append(it);
+    }
+    extra["records"] = records;
+    extra["mentions"] = Json::Value(Json::arrayValue);
+    extra["mentions"].append((Json::UInt64)10086);
+    return IM::JsonUtil::Write(extra);
+}
+
+template <class F>
+static void Bench(const std::string& name, size_t iterations, F fn) {
+    size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        bytes += fn().size();
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    std::cout << std::left << std::setw(12) << name << std::setw(12) << iterations
+              << std::setw(14) << ns / 1000000 << std::setw(12) << ns / (long long)iterations
+              << bytes / iterations << std::endl;
+}
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? std::stoull(argv[1]) : 100000;
+    TestRoundTrip();
+
+    const std::string extra = SampleExtra();
+    std::cout << std::left << std::setw(12) << "codec" << std::setw(12) << "messages"
+              << std::setw(14) << "duration_ms" << std::setw(12) << "ns/msg"
+              << "bytes/msg" << std::endl;
+    Bench("jsoncpp", iterations, [&]() {
+        Json::CharReaderBuilder rb;
+        Json::Value root;
+        std::string errs;
+        std::istringstream in(extra);
+        Json::parseFromStream(rb, in, &root, &errs);
+        root["invalid"] = true;
+        Json::StreamWriterBuilder wb;
+        return Json::writeString(wb, root);
+    });
+    Bench("json_util", iterations, [&]() {
+        Json::Value root;
+        IM::JsonUtil::Parse(root, extra);
+        root["invalid"] = true;
+        return IM::JsonUtil::Write(root);
+    });
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "app/message_cache.hpp"
+#include "app/message_envelope.hpp"
+
+// 最近消息缓存：命中、撤回/跨节点失效、发送者资料修改、按 ttl 过期
+// 用法：test_message_cache
+
+using IM::app::RecentMessageCache;
+using IM::dao::MessageRecord;
+
+static const uint64_t kTalk = 7;
+
+static RecentMessageCache::Item MakeItem(uint64_t seq) {
+    RecentMessageCache::Item item;
+    item.rec.msg_id = "m" + std::to_string(seq);
+    item.rec.sequence = seq;
+    item.rec.from_id = 100 + seq % 2;
+    item.rec.nickname = "old";
+    IM::app::MessageEnvelope::Build(item.rec);
+    return item;
+}
+
+// 装载 sequence 为 [1, n] 的会话
+static void Load(RecentMessageCache& cache, uint64_t n, uint64_t talk_id = kTalk) {
+    const uint64_t token = cache.beginLoad(talk_id);
+    assert(token != 0);
+    std::vector<RecentMessageCache::Item> items;
+    for (uint64_t seq = 1; seq <= n; ++seq) {
+        items.push_back(MakeItem(seq));
+    }
+    cache.finishLoad(talk_id, token, std::move(items), /*complete=*/true);
+}
+
+static void TestHit() {
+    RecentMessageCache::Options opts;
+    opts.capacity = 4;
+    opts.ttl = 0;
+    RecentMessageCache cache(opts);
+    std::vector<MessageRecord> out;
+    bool ok = cache.getRecent(kTalk, 100, 2, out);
+    assert(!ok);
+
+    Load(cache, 3);
+    ok = cache.getRecent(kTalk, 100, 2, out);
+    assert(ok && out.size() == 2 && out[0].sequence == 3 && out[1].sequence == 2);
+    // 新消息追加后挤出最旧的一条，不足一页时不再给出结果
+    cache.onSend(kTalk, MakeItem(4).rec);
+    cache.onSend(kTalk, MakeItem(5).rec);
+    ok = cache.getRecent(kTalk, 100, 4, out);
+    assert(ok && out.size() == 4 && out[0].sequence == 5 && out[3].sequence == 2);
+    ok = cache.getRecent(kTalk, 100, 5, out);
+    assert(!ok && cache.getRecordCount() == 4);
+    std::cout << "hit: ok" << std::endl;
+}
+
+static void TestInvalidate() {
+    RecentMessageCache::Options opts;
+    opts.capacity = 8;
+    opts.ttl = 0;
+    RecentMessageCache cache(opts);
+    Load(cache, 3);
+
+    // 本节点撤回：原地移除
+    cache.onRevoke(kTalk, "m2");
+    std::vector<MessageRecord> out;
+    bool ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(ok && out.size() == 2 && out[0].sequence == 3 && out[1].sequence == 1);
+
+    // 其它节点撤回：经 MessageCacheSync 使整个会话失效，下次读取回源
+    cache.invalidate(kTalk);
+    ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(!ok && cache.getRecordCount() == 0);
+
+    // 回源期间收到失效通知，本次回源作废
+    uint64_t token = cache.beginLoad(kTalk);
+    assert(token != 0);
+    cache.invalidate(kTalk);
+    std::vector<RecentMessageCache::Item> items{MakeItem(1)};
+    cache.finishLoad(kTalk, token, std::move(items), true);
+    ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(!ok);
+
+    // 订阅重连：清空全部会话
+    Load(cache, 2);
+    cache.invalidateAll();
+    ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(!ok && cache.getRecordCount() == 0);
+    std::cout << "invalidate: ok" << std::endl;
+}
+
+static void TestProfile() {
+    RecentMessageCache::Options opts;
+    opts.capacity = 8;
+    opts.ttl = 0;
+    RecentMessageCache cache(opts);
+    Load(cache, 3);
+    Load(cache, 1, kTalk + 1);  // 只有用户 101 的消息
+
+    // 本节点修改资料：字段与信封原地更新
+    cache.onProfile(100, "new", "a.png");
+    std::vector<MessageRecord> out;
+    bool ok = cache.getRecent(kTalk, 0, 8, out);
+    assert(ok && out.size() == 3);
+    for (auto& r : out) {
+        const bool mine = r.from_id == 100;
+        assert(r.nickname == (mine ? "new" : "old"));
+        assert(r.json && (r.json->find("\"new\"") != std::string::npos) == mine);
+    }
+
+    // 其它节点修改资料：包含其消息的会话失效，其余会话保留
+    cache.invalidateSender(100);
+    ok = cache.getRecent(kTalk, 0, 8, out);
+    assert(!ok);
+    ok = cache.getRecent(kTalk + 1, 0, 8, out);
+    assert(ok && out.size() == 1);
+    std::cout << "profile: ok" << std::endl;
+}
+
+static void TestExpire() {
+    RecentMessageCache::Options opts;
+    opts.capacity = 8;
+    opts.ttl = 1;
+    RecentMessageCache cache(opts);
+    Load(cache, 2);
+    std::vector<MessageRecord> out;
+    bool ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(ok && out.size() == 2);
+
+    sleep(2);
+    ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(!ok && cache.getRecordCount() == 0);
+    // 过期后可以重新装载
+    Load(cache, 3);
+    ok = cache.getRecent(kTalk, 100, 8, out);
+    assert(ok && out.size() == 3);
+    std::cout << "expire: ok" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    TestHit();
+    TestInvalidate();
+    TestProfile();
+    TestExpire();
+    return 0;
+}
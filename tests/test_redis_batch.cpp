@@ -0,0 +1,79 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "base/macro.hpp"
+#include "config/config.hpp"
+#include "db/redis.hpp"
+#include "io/iomanager.hpp"
+
+// 逐条命令 vs RedisBatch pipeline 的耗时对比
+// 用法：test_redis_batch [config_dir] [redis_name] [keys]
+// 说明：使用 redis.config 中名为 redis_name 的实例，分别以逐条 cmd 与一次 pipeline
+// 执行 keys 次 SET + keys 次 GET，并校验 pipeline 的回复顺序与内容。
+
+static auto g_logger = IM_LOG_ROOT();
+
+static long long ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+static void Run(const std::string& name, size_t keys) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < keys; ++i) {
+        IM::RedisUtil::Cmd(name, {"SET", "bench:batch:" + std::to_string(i), std::to_string(i)});
+    }
+    for (size_t i = 0; i < keys; ++i) {
+        IM::RedisUtil::Cmd(name, {"GET", "bench:batch:" + std::to_string(i)});
+    }
+    long long single_ms = ElapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    IM::RedisBatch batch;
+    for (size_t i = 0; i < keys; ++i) {
+        batch.add({"SET", "bench:batch:" + std::to_string(i), std::to_string(i * 2)});
+    }
+    for (size_t i = 0; i < keys; ++i) {
+        batch.add({"GET", "bench:batch:" + std::to_string(i)});
+    }
+    bool ok = IM::RedisUtil::Pipeline(name, batch);
+    long long batch_ms = ElapsedMs(start);
+
+    size_t mismatch = 0;
+    for (size_t i = 0; i < keys; ++i) {
+        if (batch.getString(keys + i) != std::to_string(i * 2)) {
+            ++mismatch;
+        }
+    }
+
+    IM::RedisBatch trans(true);
+    trans.add("INCR bench:batch:counter");
+    trans.add("INCRBY bench:batch:counter 10");
+    bool trans_ok = IM::RedisUtil::Pipeline(name, trans);
+
+    std::cout << std::left << std::setw(10) << "mode" << std::setw(10) << "cmds"
+              << "duration_ms" << std::endl;
+    std::cout << std::left << std::setw(10) << "single" << std::setw(10) << keys * 2 << single_ms
+              << std::endl;
+    std::cout << std::left << std::setw(10) << "pipeline" << std::setw(10) << keys * 2
+              << batch_ms << std::endl;
+    std::cout << "pipeline ok=" << ok << " failed=" << batch.getFailedCount()
+              << " mismatch=" << mismatch << std::endl;
+    std::cout << "multi ok=" << trans_ok << " incr=" << trans.getInteger(0)
+              << " incrby=" << trans.getInteger(1) << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::string conf_dir = argc > 1 ? argv[1] : "bin/config";
+    std::string name = argc > 2 ? argv[2] : "default";
+    size_t keys = argc > 3 ? std::stoull(argv[3]) : 1000;
+    IM::Config::LoadFromConfigDir(conf_dir);
+
+    // Fox 系列需要在协程中调用
+    IM::IOManager iom(1, false, "redis_batch");
+    iom.schedule([name, keys]() { Run(name, keys); });
+    return 0;
+}
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ds/lru_cache.hpp"
+#include "ds/sharded_cache.hpp"
+
+// ShardedCache：基本语义、容量上限、TTL 回收、扫描抵抗、并发一致性，
+// 以及与 LruCache / HashLruCache 的命中率和读吞吐对比
+// 用法：test_sharded_cache [capacity] [threads]
+// 说明：命中率负载为 Zipf(0.9) 读写，穿插一次性扫描；读吞吐为全命中 get，线程数从 1 翻倍到 threads。
+
+using IM::ds::ShardedCache;
+
+static void TestBasic() {
+    ShardedCache<std::string, std::string> c(1000, 4);
+    assert(c.getMaxSize() == 1000 && c.getShardNum() == 4);
+    bool ok = c.set("a", "1") && c.set("b", "2") && c.set("a", "3");
+    assert(ok && c.size() == 2);
+    std::string v;
+    ok = c.get("a", v) && v == "3" && c.get("b") == "2" && c.get("none").empty();
+    assert(ok && c.exists("b") && !c.exists("none"));
+    ok = c.del("a") && !c.del("a") && !c.exists("a");
+    assert(ok && c.size() == 1);
+    c.clear();
+    assert(c.empty() && !c.exists("b"));
+    auto status = c.getStatus();
+    assert(status.getSet() == 3 && status.getDel() == 2 && status.getHit() == 2);
+
+    // 持续写入新键，条目数不超过上限，超出部分被淘汰或拒绝
+    ShardedCache<uint64_t, uint64_t> m(1000, 8);
+    uint64_t pruned = 0;
+    m.setPruneCallback([&pruned](const uint64_t& k, const uint64_t& v) {
+        assert(k == v);
+        ++pruned;
+    });
+    for (uint64_t i = 0; i < 10000; ++i) {
+        m.set(i, i);
+        assert(m.size() <= m.getMaxSize());
+    }
+    assert(m.size() == m.getMaxSize());
+    assert(pruned + m.getRejected() + m.size() == 10000);
+    assert((uint64_t)m.getStatus().getPrune() == pruned);
+    std::cout << "basic: ok " << m.toStatusString() << std::endl;
+}
+
+static void TestTimeout() {
+    ShardedCache<uint64_t, uint64_t> c(10000, 4, 10);
+    std::vector<uint64_t> pruned;
+    c.setPruneCallback([&pruned](const uint64_t& k, const uint64_t&) { pruned.push_back(k); });
+    for (uint64_t i = 0; i < 100; ++i) {
+        c.set(i, i, i % 2 ? 30 : 0);
+    }
+    // 覆盖写可以延长或取消过期
+    c.set(1, 1, 5000);
+    c.set(3, 3, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    // 未回收前 get 也按过期时间判定
+    uint64_t v = 0;
+    bool ok = !c.get(5, v) && !c.exists(5) && c.get(1, v) && c.get(3, v) && c.get(4, v);
+    assert(ok);
+    size_t n = c.checkTimeout();
+    assert(n == 48 && pruned.size() == 48 && c.size() == 52);
+    assert(c.getStatus().getTimeout() == 48 && c.checkTimeout() == 0);
+
+    // 超出一圈时间轮的 TTL
+    ShardedCache<uint64_t, uint64_t> l(100, 1, 1);
+    ok = l.set(1, 1, 400) && l.set(2, 2, 20);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(ok && l.checkTimeout() == 1 && l.exists(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    assert(l.checkTimeout() == 1 && l.empty());
+    std::cout << "timeout: ok" << std::endl;
+}
+
+// 先 get，未命中再 set（cache-aside）
+template <class Cache>
+static bool Access(Cache& c, uint64_t k) {
+    uint64_t v = 0;
+    if (c.get(k, v)) {
+        return true;
+    }
+    c.set(k, k);
+    return false;
+}
+
+static void TestScan() {
+    const uint64_t cap = 1000;
+    const uint64_t hot = 100;
+    ShardedCache<uint64_t, uint64_t> c(cap, 1);
+    IM::ds::LruCache<uint64_t, uint64_t> lru(cap);
+    for (int r = 0; r < 10; ++r) {
+        for (uint64_t k = 0; k < hot; ++k) {
+            Access(c, k);
+            Access(lru, k);
+        }
+    }
+    // 一次性扫描，每扫 10 个键访问一次热点；热点的重用距离超过容量，LRU 无法命中
+    uint64_t c_hit = 0, lru_hit = 0, n = 0;
+    for (uint64_t i = 0; i < 100000; ++i) {
+        Access(c, 1000000 + i);
+        Access(lru, 1000000 + i);
+        if (i % 10 == 0) {
+            c_hit += Access(c, n % hot);
+            lru_hit += Access(lru, n % hot);
+            ++n;
+        }
+    }
+    std::cout << "scan: hot hit rate ShardedCache " << c_hit * 100 / n << "% LruCache "
+              << lru_hit * 100 / n << "%" << std::endl;
+    assert(c_hit * 10 > n * 9);
+}
+
+static void TestConcurrent() {
+    // 显式指定 4 个条纹，单核环境下也覆盖多条纹的加锁与排空
+    ShardedCache<uint64_t, std::shared_ptr<std::string>> c(5000, 16, 5, 4);
+    std::atomic<uint64_t> hits{0};
+    std::vector<std::thread> ts;
+    for (int t = 0; t < 4; ++t) {
+        ts.emplace_back([&, t]() {
+            std::mt19937_64 rng(t);
+            uint64_t n = 0;
+            for (int i = 0; i < 200000; ++i) {
+                uint64_t r = rng();
+                uint64_t k = r % 20000;
+                switch ((r >> 32) % 10) {
+                    case 0:
+                        c.del(k);
+                        break;
+                    case 1:
+                    case 2:
+                        c.set(k, std::make_shared<std::string>(std::to_string(k)), r % 3 * 10);
+                        break;
+                    default: {
+                        std::shared_ptr<std::string> v;
+                        if (c.get(k, v)) {
+                            assert(v && *v == std::to_string(k));
+                            ++n;
+                        }
+                    }
+                }
+                if (i % 10000 == 0) {
+                    c.checkTimeout();
+                }
+            }
+            hits += n;
+        });
+    }
+    for (auto& t : ts) {
+        t.join();
+    }
+    assert(c.size() <= c.getMaxSize());
+    assert((uint64_t)c.getStatus().getHit() == hits);
+    std::cout << "concurrent: ok " << c.toStatusString() << std::endl;
+}
+
+// Zipf 分布采样：预计算累积概率，二分查找
+class Zipf {
+   public:
+    Zipf(size_t n, double s) : m_cdf(n) {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / std::pow(i + 1, s);
+            m_cdf[i] = sum;
+        }
+        for (auto& p : m_cdf) {
+            p /= sum;
+        }
+    }
+    uint64_t operator()(std::mt19937_64& rng) {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return std::lower_bound(m_cdf.begin(), m_cdf.end(), u) - m_cdf.begin();
+    }
+
+   private:
+    std::vector<double> m_cdf;
+};
+
+template <class Cache>
+static double HitRate(Cache& c, const std::vector<uint64_t>& trace) {
+    uint64_t hit = 0;
+    for (auto k : trace) {
+        hit += Access(c, k);
+    }
+    return hit * 100.0 / trace.size();
+}
+
+static double Mops(uint64_t ops, std::chrono::steady_clock::time_point start) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    return us ? ops * 1.0 / us : 0;
+}
+
+template <class Cache>
+static double RunReads(Cache& c, const std::vector<uint64_t>& keys, int threads, uint64_t ops) {
+    std::vector<std::thread> ts;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        ts.emplace_back([&, t]() {
+            std::mt19937_64 rng(t);
+            uint64_t hit = 0;
+            for (uint64_t i = 0; i < ops; ++i) {
+                uint64_t v = 0;
+                hit += c.get(keys[rng() % keys.size()], v);
+            }
+            assert(hit == ops);
+        });
+    }
+    for (auto& t : ts) {
+        t.join();
+    }
+    return Mops(ops * threads, start);
+}
+
+static void Bench(size_t cap, int max_threads) {
+    // 键空间为容量的 10 倍；每 10 万次访问插入一段 cap 个一次性键的扫描
+    std::mt19937_64 rng(3);
+    Zipf zipf(cap * 10, 0.9);
+    std::vector<uint64_t> trace;
+    uint64_t scan = cap * 100;
+    for (int i = 0; i < 1000000; ++i) {
+        trace.push_back(zipf(rng));
+        if (i % 100000 == 99999) {
+            for (size_t j = 0; j < cap; ++j) {
+                trace.push_back(scan++);
+            }
+        }
+    }
+    IM::ds::LruCache<uint64_t, uint64_t> lru(cap);
+    IM::ds::HashLruCache<uint64_t, uint64_t> hlru(64, cap, 0);
+    ShardedCache<uint64_t, uint64_t> sc(cap);
+    std::cout << "zipf(0.9) hit rate, capacity " << cap << ", " << trace.size()
+              << " accesses: LruCache " << HitRate(lru, trace) << "% HashLruCache "
+              << HitRate(hlru, trace) << "% ShardedCache " << HitRate(sc, trace) << "%"
+              << std::endl;
+
+    // 读吞吐：预先写满后全命中读取
+    std::vector<uint64_t> keys(cap);
+    for (size_t i = 0; i < cap; ++i) {
+        keys[i] = rng();
+    }
+    // 容量留出余量，避免分片不均导致淘汰
+    IM::ds::HashLruCache<uint64_t, uint64_t> hr(64, cap * 2, 0);
+    ShardedCache<uint64_t, uint64_t> sr(cap * 2);
+    for (auto k : keys) {
+        hr.set(k, k);
+        bool ok = sr.set(k, k);
+        assert(ok);
+    }
+    const uint64_t ops = 2000000;
+    std::cout << "read throughput, " << cap << " keys, hardware threads "
+              << std::thread::hardware_concurrency() << std::endl;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        std::cout << "  threads=" << t << ": HashLruCache " << RunReads(hr, keys, t, ops)
+                  << " ShardedCache " << RunReads(sr, keys, t, ops) << " Mops/s" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t cap = argc > 1 ? std::stoull(argv[1]) : 100000;
+    int threads = argc > 2 ? std::stoi(argv[2]) : 8;
+    TestBasic();
+    TestTimeout();
+    TestScan();
+    TestConcurrent();
+    Bench(cap, threads);
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "http/servlets/static_file_servlet.hpp"
+#include "io/iomanager.hpp"
+#include "net/address.hpp"
+#include "net/socket.hpp"
+
+// 静态文件Servlet：条件请求、Range、预压缩、路径穿越校验，以及 sendfile 发送吞吐
+// 用法：test_static_file [file_mb] [rounds]
+// 说明：吞吐对比经回环 TCP 发送同一文件：sendfile（文件响应体）与读入 string 后整体发送。
+
+using namespace IM::http;
+
+static std::string s_root;
+
+static void WriteFile(const std::string& name, const std::string& data) {
+    std::ofstream ofs(s_root + "/" + name, std::ios::trunc | std::ios::binary);
+    ofs << data;
+}
+
+static HttpResponse::ptr Get(StaticFileServlet& slt, const std::string& path,
+                             const HttpRequest::MapType& headers = {},
+                             HttpMethod method = HttpMethod::GET) {
+    HttpRequest::ptr req(new HttpRequest(0x11, false));
+    req->setMethod(method);
+    req->setPath(path);
+    for (auto& i : headers) {
+        req->setHeader(i.first, i.second);
+    }
+    HttpResponse::ptr rsp(new HttpResponse(0x11, false));
+    slt.handle(req, rsp, nullptr);
+    return rsp;
+}
+
+static void TestServlet() {
+    WriteFile("a.txt", "0123456789");
+    WriteFile("app.js", "console.log(1)");
+    WriteFile("app.js.gz", "GZDATA");
+    mkdir((s_root + "/sub").c_str(), 0755);
+    WriteFile("sub/index.html", "<p>hi</p>");
+
+    StaticFileServlet::Options opts;
+    opts.root = s_root;
+    opts.prefix = "/static/";
+    StaticFileServlet slt(opts);
+
+    auto rsp = Get(slt, "/static/a.txt");
+    assert(rsp->getStatus() == HttpStatus::OK && rsp->getFile());
+    assert(rsp->getFileOffset() == 0 && rsp->getFileLength() == 10);
+    assert(rsp->getHeader("Content-Type") == "text/plain; charset=utf-8");
+    const std::string etag = rsp->getHeader("ETag");
+    const std::string last_modified = rsp->getHeader("Last-Modified");
+    assert(!etag.empty() && !last_modified.empty());
+
+    // 条件请求
+    assert(Get(slt, "/static/a.txt", {{"If-None-Match", etag}})->getStatus() ==
+           HttpStatus::NOT_MODIFIED);
+    assert(Get(slt, "/static/a.txt", {{"If-None-Match", "\"x\", W/" + etag}})->getStatus() ==
+           HttpStatus::NOT_MODIFIED);
+    assert(Get(slt, "/static/a.txt", {{"If-None-Match", "\"x\""}})->getStatus() == HttpStatus::OK);
+    assert(Get(slt, "/static/a.txt", {{"If-Modified-Since", last_modified}})->getStatus() ==
+           HttpStatus::NOT_MODIFIED);
+    assert(Get(slt, "/static/a.txt", {{"If-Modified-Since", "Thu, 01 Jan 1970 00:00:00 GMT"}})
+               ->getStatus() == HttpStatus::OK);
+
+    // Range
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=2-5"}});
+    assert(rsp->getStatus() == HttpStatus::PARTIAL_CONTENT);
+    assert(rsp->getFileOffset() == 2 && rsp->getFileLength() == 4);
+    assert(rsp->getHeader("Content-Range") == "bytes 2-5/10");
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=-3"}});
+    assert(rsp->getFileOffset() == 7 && rsp->getFileLength() == 3);
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=8-"}});
+    assert(rsp->getFileOffset() == 8 && rsp->getFileLength() == 2);
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=10-"}});
+    assert(rsp->getStatus() == HttpStatus::RANGE_NOT_SATISFIABLE);
+    assert(rsp->getHeader("Content-Range") == "bytes */10");
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=0-1,4-5"}});
+    assert(rsp->getStatus() == HttpStatus::OK && rsp->getFileLength() == 10);
+    rsp = Get(slt, "/static/a.txt", {{"Range", "bytes=2-5"}, {"If-Range", "\"old\""}});
+    assert(rsp->getStatus() == HttpStatus::OK && rsp->getFileLength() == 10);
+
+    // 预压缩文件
+    rsp = Get(slt, "/static/app.js", {{"Accept-Encoding", "gzip, br"}});
+    assert(rsp->getHeader("Content-Encoding") == "gzip" && rsp->getFileLength() == 6);
+    assert(rsp->getHeader("Content-Type") == "application/javascript; charset=utf-8");
+    rsp = Get(slt, "/static/app.js");
+    assert(rsp->getHeader("Content-Encoding").empty() && rsp->getFileLength() == 14);
+
+    // HEAD、目录默认文件、不存在、路径穿越、方法
+    rsp = Get(slt, "/static/a.txt", {}, HttpMethod::HEAD);
+    assert(!rsp->getFile() && rsp->getHeader("Content-Length") == "10");
+    assert(Get(slt, "/static/sub/")->getFileLength() == 9);
+    assert(Get(slt, "/static/none.txt")->getStatus() == HttpStatus::NOT_FOUND);
+    assert(Get(slt, "/static/sub")->getStatus() == HttpStatus::NOT_FOUND);
+    assert(Get(slt, "/static/../a.txt")->getStatus() == HttpStatus::FORBIDDEN);
+    assert(Get(slt, "/static/%2e%2e/a.txt")->getStatus() == HttpStatus::FORBIDDEN);
+    assert(Get(slt, "/static/a.txt", {}, HttpMethod::POST)->getStatus() ==
+           HttpStatus::METHOD_NOT_ALLOWED);
+    std::cout << "servlet: ok " << slt.getCacheStatus() << std::endl;
+}
+
+static void Bench(size_t file_mb, size_t rounds) {
+    const size_t size = file_mb * 1024 * 1024;
+    WriteFile("big.bin", std::string(size, 'x'));
+    StaticFileServlet::Options opts;
+    opts.root = s_root;
+    StaticFileServlet slt(opts);
+
+    // 服务端在 IOManager 协程中发送（hook 生效），客户端在普通线程中阻塞读取并计数
+    uint64_t received = 0;
+    IM::IOManager iom(1, false, "bench");
+    iom.schedule([&]() {
+        auto listener = IM::Socket::CreateTCPSocket();
+        bool ok = listener->bind(IM::IPv4Address::Create("127.0.0.1", 0)) && listener->listen();
+        assert(ok);
+        const uint16_t port =
+            std::dynamic_pointer_cast<IM::IPAddress>(listener->getLocalAddress())->getPort();
+        std::thread reader([port, &received]() {
+            int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr = {};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int rt = ::connect(fd, (const sockaddr*)&addr, sizeof(addr));
+            assert(rt == 0);
+            std::string buf(1024 * 1024, '\0');
+            ssize_t n = 0;
+            while ((n = ::recv(fd, &buf[0], buf.size(), 0)) > 0) {
+                received += n;
+            }
+            ::close(fd);
+        });
+        auto session = std::make_shared<HttpSession>(listener->accept());
+
+        auto run = [&](const char* name, bool use_file) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t r = 0; r < rounds; ++r) {
+                auto rsp = Get(slt, "/big.bin");
+                if (!use_file) {
+                    // 对照：读入内存后作为 string 响应体发送
+                    std::string body(rsp->getFileLength(), '\0');
+                    ssize_t n = ::pread(rsp->getFile()->getFd(), &body[0], body.size(), 0);
+                    assert(n == (ssize_t)body.size());
+                    rsp->setFileBody(nullptr, 0, 0);
+                    rsp->setBody(body);
+                }
+                int rt = session->sendResponse(rsp);
+                assert(rt > 0);
+            }
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+            std::cout << name << ": " << rounds << " x " << file_mb << "MB in " << us << "us ("
+                      << (us ? size * rounds / us : 0) << " MB/s)" << std::endl;
+        };
+        run("sendfile", true);
+        run("string", false);
+        session->close();
+        reader.join();
+    });
+    iom.stop();
+    assert(received > size * rounds * 2);
+}
+
+int main(int argc, char** argv) {
+    size_t file_mb = argc > 1 ? std::stoull(argv[1]) : 64;
+    size_t rounds = argc > 2 ? std::stoull(argv[2]) : 16;
+    char dir[] = "/tmp/test_static_file_XXXXXX";
+    s_root = mkdtemp(dir);
+    TestServlet();
+    Bench(file_mb, rounds);
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <thread>
+#include <vector>
+
+#include "base/macro.hpp"
+#include "io/iomanager.hpp"
+#include "io/lock.hpp"
+#include "net/tcp_server.hpp"
+
+// SO_REUSEPORT 多监听 / 连接线程亲和测试
+// 用法：test_tcp_reuseport [io_threads] [clients] [conns_per_client]
+// 对比单监听（accept_worker 接受后转交 io_worker）、affinity 与 reuse_port 模式的建连速率，
+// 并检查 affinity / reuse_port 模式下连接始终在同一线程上处理（包括 IO 等待前后）。
+
+static const uint16_t kPort = 18090;
+
+class EchoServer : public IM::TcpServer {
+   public:
+    typedef std::shared_ptr<EchoServer> ptr;
+    using IM::TcpServer::TcpServer;
+
+    std::atomic<uint64_t> handled{0};
+    std::atomic<uint64_t> migrated{0};
+    IM::Mutex mutex;
+    std::map<pid_t, uint64_t> per_thread;
+
+   protected:
+    void handleClient(IM::Socket::ptr client) override {
+        pid_t tid = IM::GetThreadId();
+        {
+            IM::Mutex::Lock lock(mutex);
+            ++per_thread[tid];
+        }
+        char c;
+        // recv 会挂起等待客户端数据，恢复后应仍在原线程
+        if (client->recv(&c, 1) == 1) {
+            client->send(&c, 1);
+        }
+        if (IM::GetThreadId() != tid) {
+            ++migrated;
+        }
+        ++handled;
+        client->close();
+    }
+};
+
+static void Client(size_t conns, std::atomic<uint64_t>& ok) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (size_t i = 0; i < conns; ++i) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) {
+            char c = 'x';
+            if (write(fd, &c, 1) == 1 && read(fd, &c, 1) == 1) {
+                ++ok;
+            }
+        }
+        close(fd);
+    }
+}
+
+// 检查失败时打印原因并返回 false（不用 assert，Release 构建下同样生效）
+static bool Check(bool cond, const char* mode, const char* what) {
+    if (!cond) {
+        std::cerr << mode << ": check failed: " << what << std::endl;
+    }
+    return cond;
+}
+
+static bool Run(const char* mode, uint32_t reuse_port, bool affinity, size_t io_threads,
+                size_t clients, size_t conns) {
+    IM::IOManager io(io_threads, false, "io");
+    IM::IOManager accept(1, false, "accept");
+    EchoServer::ptr server = std::make_shared<EchoServer>(&io, &io, &accept);
+    server->setReusePort(reuse_port);
+    server->setAffinity(affinity);
+    // 与 Application 一致，在协程内创建监听 socket，使其走 hook 的非阻塞路径
+    std::atomic<bool> started{false};
+    bool bound = false;
+    size_t socks = 0;
+    io.schedule([&]() {
+        auto addr = IM::Address::LookupAny("127.0.0.1:" + std::to_string(kPort));
+        bound = addr && server->bind(addr);
+        socks = server->getSocks().size();
+        if (bound) {
+            server->start();
+        }
+        started = true;
+    });
+    while (!started) {
+        usleep(1000);
+    }
+    if (!Check(bound, mode, "bind") ||
+        !Check(socks == (reuse_port ? reuse_port : 1), mode, "listen socket count")) {
+        server->stop();
+        io.stop();
+        accept.stop();
+        return false;
+    }
+
+    std::atomic<uint64_t> ok{0};
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> ts;
+    for (size_t i = 0; i < clients; ++i) {
+        ts.emplace_back(Client, conns, std::ref(ok));
+    }
+    for (auto& t : ts) {
+        t.join();
+    }
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                  std::chrono::steady_clock::now() - start)
+                  .count();
+    while (server->handled < ok) {
+        usleep(1000);
+    }
+    server->stop();
+    io.stop();
+    accept.stop();
+
+    std::cout << std::left << std::setw(12) << mode << std::setw(10) << ok << std::setw(14) << ms
+              << std::setw(12) << (ms > 0 ? ok * 1000 / ms : 0) << std::setw(10)
+              << server->migrated << server->per_thread.size() << std::endl;
+    bool passed = Check(ok == clients * conns, mode, "all connections echoed");
+    if (reuse_port || affinity) {
+        passed = Check(server->migrated == 0, mode, "connections stay on one thread") && passed;
+    }
+    return passed;
+}
+
+int main(int argc, char** argv) {
+    size_t io_threads = argc > 1 ? std::stoull(argv[1]) : 4;
+    size_t clients = argc > 2 ? std::stoull(argv[2]) : 8;
+    size_t conns = argc > 3 ? std::stoull(argv[3]) : 500;
+    IM_LOG_NAME("system")->setLevel(IM::Level::ERROR);
+
+    std::cout << std::left << std::setw(12) << "mode" << std::setw(10) << "conns"
+              << std::setw(14) << "duration_ms" << std::setw(12) << "conns/s" << std::setw(10)
+              << "migrated" << "threads" << std::endl;
+    bool ok = Run("single", 0, false, io_threads, clients, conns);
+    ok = Run("affinity", 0, true, io_threads, clients, conns) && ok;
+    ok = Run("reuse_port", io_threads, false, io_threads, clients, conns) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include <openssl/evp.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "app/upload_service.hpp"
+#include "config/config.hpp"
+#include "io/cpu_pool.hpp"
+#include "io/iomanager.hpp"
+#include "util/util.hpp"
+
+// 分片上传服务：单用户会话数上限、分片合并（在 IOManager 协程中经 CpuPool 执行）、过期清理
+// 用法：test_upload_service
+
+using IM::app::UploadService;
+using IM::app::UploadSessionResult;
+
+static std::string g_dir = "/tmp/test_upload_service_" + std::to_string(getpid());
+
+static std::string Sha256Hex(const std::string& data) {
+    unsigned char md[EVP_MAX_MD_SIZE];
+    unsigned int len = 0;
+    EVP_Digest(data.data(), data.size(), md, &len, EVP_sha256(), nullptr);
+    return IM::hexstring_from_data(md, len);
+}
+
+static UploadSessionResult Write(uint64_t uid, const std::string& id, uint32_t index,
+                                 const std::string& data) {
+    auto reader = [&data](int fd, uint64_t max_size, const UploadService::BodyObserver& observer) {
+        if (data.size() > max_size) {
+            return (int64_t)-2;
+        }
+        if (observer) {
+            observer(data.data(), data.size());
+        }
+        return (int64_t)::write(fd, data.data(), data.size());
+    };
+    return UploadService::WritePart(uid, id, index, reader, "");
+}
+
+// 把文件的 mtime 拨回 secs 秒前
+static void Age(const std::string& path, int secs) {
+    timeval tv[2];
+    gettimeofday(&tv[0], nullptr);
+    tv[0].tv_sec -= secs;
+    tv[1] = tv[0];
+    int rt = ::utimes(path.c_str(), tv);
+    assert(rt == 0);
+}
+
+static void TestSessionLimit() {
+    auto a = UploadService::InitMultipart(1, "a.bin", 10);
+    auto b = UploadService::InitMultipart(1, "b.bin", 10);
+    auto c = UploadService::InitMultipart(1, "c.bin", 10);
+    assert(a.ok && b.ok && !c.ok && c.code == 429);
+    assert(a.data.shard_num == 3 && a.data.shard_size == 4);
+    auto other = UploadService::InitMultipart(2, "d.bin", 10);
+    assert(other.ok);
+
+    // 合并完成后不再占用名额
+    const std::string data = "0123456789";
+    auto r = Write(1, a.data.upload_id, 2, data.substr(8));
+    assert(r.ok && !r.data.finished && r.data.uploaded.size() == 1);
+    r = Write(1, a.data.upload_id, 0, data.substr(0, 4));
+    assert(r.ok && !r.data.finished);
+    r = Write(2, a.data.upload_id, 1, data.substr(4, 4));
+    assert(!r.ok && r.code == 403);
+    r = Write(1, a.data.upload_id, 1, data.substr(4, 4));
+    assert(r.ok && r.data.finished && r.data.sha256 == Sha256Hex(data));
+    std::ifstream ifs(r.data.path);
+    std::string merged((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    assert(merged == data);
+    c = UploadService::InitMultipart(1, "c.bin", 10);
+    assert(c.ok);
+    std::cout << "session limit: ok" << std::endl;
+}
+
+static void TestCleanup() {
+    auto s = UploadService::InitMultipart(3, "e.bin", 10);
+    auto t = UploadService::InitMultipart(3, "f.bin", 10);
+    assert(s.ok && t.ok);
+    auto r = Write(3, s.data.upload_id, 0, "abcd");
+    auto g = UploadService::InitMultipart(3, "g.bin", 10);
+    assert(r.ok && !g.ok);
+
+    // s 长时间无写入；t 仍在上传
+    const std::string dir = g_dir + "/" + s.data.upload_id;
+    Age(dir, 3600);
+    // 已完成会话中残留的旧分片
+    auto done = UploadService::InitMultipart(4, "h.bin", 4);
+    r = Write(4, done.data.upload_id, 0, "wxyz");
+    assert(done.ok && r.ok && r.data.finished);
+    const std::string stray = g_dir + "/" + done.data.upload_id + "/0.part";
+    std::ofstream(stray) << "wxyz";
+    Age(stray, 3600);
+
+    size_t n = UploadService::CleanupExpired();
+    assert(n == 1);
+    assert(access(dir.c_str(), F_OK) != 0 && access(stray.c_str(), F_OK) != 0);
+    assert(access(r.data.path.c_str(), F_OK) == 0);
+    auto expired = UploadService::GetStatus(3, s.data.upload_id);
+    auto alive = UploadService::GetStatus(3, t.data.upload_id);
+    assert(expired.code == 404 && alive.ok && alive.data.uploaded.empty());
+    // 过期会话释放了名额
+    g = UploadService::InitMultipart(3, "g.bin", 10);
+    assert(g.ok);
+    std::cout << "cleanup: ok" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    IM::Config::Lookup<std::string>("upload.dir", "")->setValue(g_dir);
+    IM::Config::Lookup<uint32_t>("upload.shard_size", 0)->setValue(4);
+    IM::Config::Lookup<uint32_t>("upload.max_sessions_per_user", 0)->setValue(2);
+    IM::Config::Lookup<uint32_t>("upload.session_ttl", 0)->setValue(600);
+    {
+        // 协程在 CpuPool::await 中挂起时调度器没有待处理任务，需等用例跑完再 stop
+        std::atomic<bool> done{false};
+        IM::IOManager iom(1, false, "upload");
+        iom.schedule([&done]() {
+            TestSessionLimit();
+            TestCleanup();
+            done = true;
+        });
+        while (!done) {
+            usleep(1000);
+        }
+        iom.stop();
+    }
+    IM::CpuPoolMgr::GetInstance()->stop();
+    IM::FSUtil::Rm(g_dir);
+    return 0;
+}